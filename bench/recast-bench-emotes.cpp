@@ -0,0 +1,76 @@
+/*
+ * recast-bench-emotes.cpp -- RecastEmoteCache stand-in for benchmarks.
+ *
+ * Links in place of src/recast-emote-cache.cpp so the chat delegate can
+ * run without OBS or the network. Every key resolves to a generated,
+ * already-decoded image (a warm cache); once disabled nothing
+ * ever loads and rows fall back to the emote text.
+ */
+
+#include "recast-emote-cache.h"
+#include "recast-bench-emotes.h"
+
+#include <QColor>
+#include <QPixmap>
+
+RecastEmoteCache *RecastEmoteCache::instance_ = nullptr;
+
+static bool images_enabled = true;
+
+void recast_bench_emotes_set_enabled(bool enabled)
+{
+	images_enabled = enabled;
+}
+
+RecastEmoteCache *RecastEmoteCache::instance()
+{
+	if (!instance_)
+		instance_ = new RecastEmoteCache();
+	return instance_;
+}
+
+void RecastEmoteCache::destroyInstance()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+RecastEmoteCache::RecastEmoteCache(QObject *parent)
+	: QObject(parent), pool_(nullptr)
+{
+	images_.setMaxCost(MAX_COST_BYTES);
+}
+
+RecastEmoteCache::~RecastEmoteCache() {}
+
+const QPixmap *RecastEmoteCache::image(const QString &key, const QUrl &url,
+				       bool *pending)
+{
+	Q_UNUSED(url);
+	if (pending)
+		*pending = false;
+	if (!images_enabled)
+		return nullptr;
+
+	if (QPixmap *pm = images_.object(key))
+		return pm;
+
+	/* Decoded emotes are 112 px high; badges are square */
+	auto *pm = new QPixmap(key.startsWith(QStringLiteral("twitch-badge:"))
+				       ? QSize(72, 72)
+				       : QSize(112, 112));
+	pm->fill(QColor::fromHsv((int)(qHash(key) % 360), 160, 220));
+	int cost = pm->width() * pm->height() * 4;
+	images_.insert(key, pm, cost);
+	return images_.object(key);
+}
+
+QUrl RecastEmoteCache::twitchBadgeUrl(const QString &badge) const
+{
+	return QUrl(QStringLiteral("bench://badge/") + badge);
+}
+
+void RecastEmoteCache::loadTwitchBadges(const QString &room_id)
+{
+	Q_UNUSED(room_id);
+}
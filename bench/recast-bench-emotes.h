@@ -0,0 +1,5 @@
+#pragma once
+
+/* Benchmark-only switch for the RecastEmoteCache stand-in: when disabled,
+ * no image ever loads and the chat delegate lays out the emote text. */
+void recast_bench_emotes_set_enabled(bool enabled);
@@ -0,0 +1,220 @@
+/*
+ * recast-irc-bench.cpp -- Twitch IRC parsing micro-benchmark.
+ *
+ * Replays a capture of raw IRC lines (one per line, as received from
+ * irc-ws.chat.twitch.tv) through the old QString::mid/split parser and
+ * through the QStringView tokenizer, materializing the same displayed
+ * fields in both.
+ *
+ *   recast-irc-bench [capture.txt] [iterations]
+ *
+ * Without a capture argument the bundled data/twitch-irc-sample.txt is
+ * used.
+ */
+
+#include "recast-irc.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+
+#include <cstdio>
+#include <vector>
+
+#ifndef RECAST_BENCH_DATA_DIR
+#define RECAST_BENCH_DATA_DIR "data"
+#endif
+
+/* The displayed subset of RecastChatMessage */
+struct BenchMessage {
+	QString username;
+	QString displayName;
+	QString message;
+	QColor nameColor;
+	bool isMod = false;
+	bool isSub = false;
+	bool isOwner = false;
+};
+
+/* ---- Previous parser (QString slicing), kept for comparison ---- */
+
+static bool legacy_parse(const QString &line, BenchMessage *out)
+{
+	QString tags_str;
+	QString remainder = line;
+
+	if (remainder.startsWith('@')) {
+		int space = remainder.indexOf(' ');
+		if (space < 0)
+			return false;
+		tags_str = remainder.mid(1, space - 1);
+		remainder = remainder.mid(space + 1);
+	}
+
+	QString prefix;
+	if (remainder.startsWith(':')) {
+		int space = remainder.indexOf(' ');
+		if (space < 0)
+			return false;
+		prefix = remainder.mid(1, space - 1);
+		remainder = remainder.mid(space + 1);
+	}
+
+	int space = remainder.indexOf(' ');
+	QString command;
+	QString params;
+	if (space >= 0) {
+		command = remainder.left(space);
+		params = remainder.mid(space + 1);
+	} else {
+		command = remainder;
+	}
+
+	if (command != QStringLiteral("PRIVMSG"))
+		return false;
+
+	int colon = params.indexOf(':');
+	if (colon < 0)
+		return false;
+
+	BenchMessage msg;
+	msg.message = params.mid(colon + 1);
+
+	int excl = prefix.indexOf('!');
+	if (excl > 0)
+		msg.username = prefix.left(excl);
+
+	QStringList tag_list = tags_str.split(';', Qt::SkipEmptyParts);
+	for (const QString &tag : tag_list) {
+		int eq = tag.indexOf('=');
+		if (eq < 0)
+			continue;
+		QString key = tag.left(eq);
+		QString value = tag.mid(eq + 1);
+
+		if (key == QStringLiteral("display-name"))
+			msg.displayName = value;
+		else if (key == QStringLiteral("color") && !value.isEmpty())
+			msg.nameColor = QColor(value);
+		else if (key == QStringLiteral("mod"))
+			msg.isMod = (value == QStringLiteral("1"));
+		else if (key == QStringLiteral("subscriber"))
+			msg.isSub = (value == QStringLiteral("1"));
+		else if (key == QStringLiteral("badges") &&
+			 value.contains(QStringLiteral("broadcaster")))
+			msg.isOwner = true;
+	}
+
+	*out = msg;
+	return true;
+}
+
+/* ---- Tokenizer (mirrors RecastTwitchChat::parsePrivmsg) ---- */
+
+static bool view_parse(QStringView line, BenchMessage *out)
+{
+	RecastIrcMessage irc;
+	if (!recast_irc_parse(line, &irc))
+		return false;
+	if (irc.command != u"PRIVMSG" || !irc.has_trailing)
+		return false;
+
+	BenchMessage msg;
+	msg.message = irc.trailing.toString();
+	if (irc.prefix.contains(u'!'))
+		msg.username = irc.nick().toString();
+
+	RecastIrcTagIterator tags(irc.tags);
+	QStringView key, value;
+	while (tags.next(&key, &value)) {
+		if (key == u"display-name")
+			msg.displayName = value.toString();
+		else if (key == u"color" && !value.isEmpty())
+			msg.nameColor = QColor(value.toString());
+		else if (key == u"mod")
+			msg.isMod = (value == u"1");
+		else if (key == u"subscriber")
+			msg.isSub = (value == u"1");
+		else if (key == u"badges" && value.contains(u"broadcaster"))
+			msg.isOwner = true;
+	}
+
+	*out = msg;
+	return true;
+}
+
+/* ---- Driver ---- */
+
+template<typename Fn>
+static double run(const char *name, const std::vector<QString> &lines,
+		  int iterations, Fn parse)
+{
+	size_t checksum = 0;
+	QElapsedTimer timer;
+	timer.start();
+
+	for (int i = 0; i < iterations; i++) {
+		for (const QString &line : lines) {
+			BenchMessage msg;
+			if (parse(line, &msg))
+				checksum += (size_t)msg.message.size() +
+					    (size_t)msg.displayName.size();
+		}
+	}
+
+	qint64 ns = timer.nsecsElapsed();
+	double total = (double)iterations * (double)lines.size();
+	double ns_per_line = (double)ns / total;
+
+	printf("%-10s %10.1f ns/line %12.0f lines/s  (checksum %zu)\n", name,
+	       ns_per_line, 1e9 / ns_per_line, checksum);
+	return ns_per_line;
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+
+	QString path = argc > 1 ? QString::fromLocal8Bit(argv[1])
+				: QStringLiteral(RECAST_BENCH_DATA_DIR
+						 "/twitch-irc-sample.txt");
+	int iterations = argc > 2 ? atoi(argv[2]) : 20000;
+	if (iterations <= 0)
+		iterations = 1;
+
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		fprintf(stderr, "cannot open %s\n", qPrintable(path));
+		return 1;
+	}
+
+	std::vector<QString> lines;
+	QTextStream in(&file);
+	while (!in.atEnd()) {
+		QString line = in.readLine();
+		if (!line.isEmpty())
+			lines.push_back(line);
+	}
+	if (lines.empty()) {
+		fprintf(stderr, "%s has no lines\n", qPrintable(path));
+		return 1;
+	}
+
+	printf("%zu lines x %d iterations from %s\n", lines.size(),
+	       iterations, qPrintable(path));
+
+	double legacy = run("legacy", lines, iterations,
+			    [](const QString &l, BenchMessage *m) {
+				    return legacy_parse(l, m);
+			    });
+	double view = run("view", lines, iterations,
+			  [](const QString &l, BenchMessage *m) {
+				  return view_parse(l, m);
+			  });
+
+	printf("speedup    %10.2fx\n", legacy / view);
+	return 0;
+}
@@ -0,0 +1,711 @@
+/*
+ * recast-replay-bench.cpp -- Headless chat and events replay benchmark.
+ *
+ * Replays recorded platform traffic through the code the docks run,
+ * without OBS, on an offscreen QApplication:
+ *
+ *   network thread: frame -> IRC/JSON decode -> recast_parse_*
+ *   UI thread:      queued delivery -> RecastBatchQueue -> model
+ *                   append -> QListView paint through the delegates
+ *
+ * Each capture is sent at its base rate (what a busy channel produces)
+ * times --rate, looping over the capture for --duration seconds. Every
+ * run reports sustained messages/s, UI-thread time and allocations per
+ * message, and parse-to-model latency, as JSON.
+ *
+ *   recast-replay-bench [--feed NAME] [--rate 1,10,100] [--duration S]
+ *                       [--data DIR] [--out FILE] [--no-images]
+ *
+ * Captures (bench/data):
+ *   twitch-irc        raw IRC lines           20 frames/s
+ *   twitch-eventsub   EventSub WebSocket JSON  1 frame/s
+ *   kick-pusher       Pusher WebSocket JSON   10 frames/s
+ *   youtube-livechat  liveChatMessages pages   one per 2 s poll
+ *
+ * Allocations are counted by interposing malloc on glibc (which also
+ * sees Qt's own string and container buffers) and through operator new
+ * elsewhere.
+ */
+
+#include "recast-irc.h"
+#include "recast-feed-parse.h"
+#include "recast-chat-view.h"
+#include "recast-events-view.h"
+#include "recast-emote-cache.h"
+#include "recast-ui-batch.h"
+#include "recast-bench-emotes.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QListView>
+#include <QScrollBar>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QWidget>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifndef RECAST_BENCH_DATA_DIR
+#define RECAST_BENCH_DATA_DIR "data"
+#endif
+
+/* ---- Allocation counting ---- */
+
+/* Only ever touched by its own thread; trivially constructible, so
+ * reading it from inside malloc needs no allocation itself */
+static thread_local unsigned long long thread_allocs = 0;
+
+#if defined(__GLIBC__)
+#define ALLOC_COUNTER "malloc"
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) noexcept
+{
+	thread_allocs++;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) noexcept
+{
+	thread_allocs++;
+	return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+	thread_allocs++;
+	return __libc_realloc(ptr, size);
+}
+}
+#else
+#define ALLOC_COUNTER "operator-new"
+void *operator new(size_t size)
+{
+	thread_allocs++;
+	if (void *p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+	free(p);
+}
+#endif
+
+static qint64 now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+/* Adds the scope's duration and allocations to the given totals */
+class Measure {
+public:
+	Measure(qint64 *ns, unsigned long long *allocs)
+		: ns_(ns), allocs_(allocs), start_(now_ns()),
+		  start_allocs_(thread_allocs)
+	{
+	}
+
+	~Measure()
+	{
+		*allocs_ += thread_allocs - start_allocs_;
+		*ns_ += now_ns() - start_;
+	}
+
+	Measure(const Measure &) = delete;
+	Measure &operator=(const Measure &) = delete;
+
+private:
+	qint64 *ns_;
+	unsigned long long *allocs_;
+	qint64 start_;
+	unsigned long long start_allocs_;
+};
+
+/* ====================================================================
+ * UI side -- the docks' model/view stack
+ * ==================================================================== */
+
+struct UiStats {
+	qint64 ns = 0;
+	unsigned long long allocs = 0;
+	quint64 received = 0;
+	quint64 shown = 0; /* reached a model; the queues drop past capacity */
+	int flushes = 0;
+	int paints = 0;
+	std::vector<qint64> latency_ms;
+};
+
+/* QListView that charges its paints to the run */
+class BenchListView : public QListView {
+public:
+	explicit BenchListView(UiStats *stats) : stats_(stats) {}
+
+protected:
+	void paintEvent(QPaintEvent *event) override
+	{
+		Measure m(&stats_->ns, &stats_->allocs);
+		stats_->paints++;
+		QListView::paintEvent(event);
+	}
+
+private:
+	UiStats *stats_;
+};
+
+/*
+ * BenchDocks -- Chat and events feeds, set up and flushed like
+ * RecastChatDock and RecastEventsDock (same capacities, flush interval,
+ * view flags and scroll handling).
+ */
+class BenchDocks : public QWidget {
+public:
+	static const int MAX_MESSAGES = 500;
+	static const int MAX_EVENTS = 200;
+	static const int FLUSH_INTERVAL_MS = 33;
+
+	BenchDocks()
+	{
+		auto *layout = new QVBoxLayout(this);
+		layout->setContentsMargins(0, 0, 0, 0);
+
+		chat_model_ = new RecastChatModel(MAX_MESSAGES, this);
+		chat_delegate_ = new RecastChatDelegate(chat_model_, this);
+		chat_view_ = new BenchListView(&stats_);
+		setupView(chat_view_, chat_model_, chat_delegate_);
+		layout->addWidget(chat_view_, 1);
+
+		events_model_ = new RecastEventsModel(MAX_EVENTS, this);
+		events_delegate_ = new RecastEventsDelegate(events_model_, this);
+		events_view_ = new BenchListView(&stats_);
+		setupView(events_view_, events_model_, events_delegate_);
+		layout->addWidget(events_view_, 1);
+
+		chat_pending_ =
+			std::make_unique<RecastBatchQueue<RecastChatMessage>>(
+				this, FLUSH_INTERVAL_MS, MAX_MESSAGES,
+				[this](std::vector<RecastChatMessage> &batch) {
+					flushMessages(batch);
+				});
+		events_pending_ =
+			std::make_unique<RecastBatchQueue<RecastPlatformEvent>>(
+				this, FLUSH_INTERVAL_MS, MAX_EVENTS,
+				[this](std::vector<RecastPlatformEvent> &batch) {
+					flushEvents(batch);
+				});
+
+		resize(400, 900);
+	}
+
+	/* Empty both feeds and settle the repaint before the next run */
+	void reset()
+	{
+		chat_pending_->clear();
+		events_pending_->clear();
+		chat_model_->clear();
+		events_model_->clear();
+		QCoreApplication::processEvents();
+		stats_ = UiStats();
+	}
+
+	void onMessage(const RecastChatMessage &msg)
+	{
+		Measure m(&stats_.ns, &stats_.allocs);
+		stats_.received++;
+		chat_pending_->push(msg);
+	}
+
+	void onEvent(const RecastPlatformEvent &evt)
+	{
+		Measure m(&stats_.ns, &stats_.allocs);
+		stats_.received++;
+		events_pending_->push(evt);
+	}
+
+	void flushAll()
+	{
+		chat_pending_->flush();
+		events_pending_->flush();
+	}
+
+	UiStats &stats() { return stats_; }
+
+private:
+	RecastChatModel *chat_model_;
+	RecastChatDelegate *chat_delegate_;
+	BenchListView *chat_view_;
+	RecastEventsModel *events_model_;
+	RecastEventsDelegate *events_delegate_;
+	BenchListView *events_view_;
+
+	std::unique_ptr<RecastBatchQueue<RecastChatMessage>> chat_pending_;
+	std::unique_ptr<RecastBatchQueue<RecastPlatformEvent>> events_pending_;
+
+	UiStats stats_;
+
+	static void setupView(QListView *view, QAbstractItemModel *model,
+			      QAbstractItemDelegate *delegate)
+	{
+		view->setModel(model);
+		view->setItemDelegate(delegate);
+		view->setSelectionMode(QAbstractItemView::NoSelection);
+		view->setFocusPolicy(Qt::NoFocus);
+		view->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+		view->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+		view->setResizeMode(QListView::Adjust);
+		view->setUniformItemSizes(false);
+	}
+
+	void noteLatency(qint64 timestamp)
+	{
+		stats_.latency_ms.push_back(
+			QDateTime::currentMSecsSinceEpoch() - timestamp);
+	}
+
+	void flushMessages(std::vector<RecastChatMessage> &batch)
+	{
+		Measure m(&stats_.ns, &stats_.allocs);
+		stats_.flushes++;
+		stats_.shown += batch.size();
+		for (const RecastChatMessage &msg : batch)
+			noteLatency(msg.timestamp);
+
+		QScrollBar *sb = chat_view_->verticalScrollBar();
+		bool was_at_bottom = sb->value() >= sb->maximum() - 10;
+		chat_model_->appendMessages(batch);
+		if (was_at_bottom)
+			chat_view_->scrollToBottom();
+	}
+
+	void flushEvents(std::vector<RecastPlatformEvent> &batch)
+	{
+		Measure m(&stats_.ns, &stats_.allocs);
+		stats_.flushes++;
+		stats_.shown += batch.size();
+		for (const RecastPlatformEvent &evt : batch)
+			noteLatency(evt.timestamp);
+
+		events_model_->prependEvents(batch);
+		events_view_->scrollToTop();
+	}
+};
+
+/* ====================================================================
+ * Network side -- decoding as the providers and hubs do it
+ * ==================================================================== */
+
+struct NetStats {
+	qint64 ns = 0;
+	unsigned long long allocs = 0;
+	quint64 frames = 0;
+	quint64 messages = 0;
+};
+
+/* Hands parsed items to the UI thread, one queued call each, the way
+ * the providers' signals cross over */
+class ReplaySink {
+public:
+	ReplaySink(BenchDocks *ui, NetStats *stats) : ui_(ui), stats_(stats) {}
+
+	void chat(const RecastChatMessage &msg)
+	{
+		stats_->messages++;
+		BenchDocks *ui = ui_;
+		QMetaObject::invokeMethod(
+			ui, [ui, msg]() { ui->onMessage(msg); },
+			Qt::QueuedConnection);
+	}
+
+	void event(const RecastPlatformEvent &evt)
+	{
+		stats_->messages++;
+		BenchDocks *ui = ui_;
+		QMetaObject::invokeMethod(
+			ui, [ui, evt]() { ui->onEvent(evt); },
+			Qt::QueuedConnection);
+	}
+
+private:
+	BenchDocks *ui_;
+	NetStats *stats_;
+};
+
+/* RecastTwitchChat::onTextMessageReceived / parseLine */
+static void decode_twitch_irc(const QString &frame, ReplaySink &sink)
+{
+	recast_irc_for_each_line(frame, [&sink](QStringView line) {
+		RecastIrcMessage irc;
+		if (line.length() > 16384 || !recast_irc_parse(line, &irc))
+			return;
+		if (irc.command == u"PRIVMSG" && irc.has_trailing)
+			sink.chat(recast_parse_twitch_privmsg(irc));
+	});
+}
+
+/* RecastTwitchEvents::onTextMessageReceived, notifications only */
+static void decode_twitch_eventsub(const QString &frame, ReplaySink &sink)
+{
+	QJsonObject root = QJsonDocument::fromJson(frame.toUtf8()).object();
+	QJsonObject metadata = root.value("metadata").toObject();
+	if (metadata.value("message_type").toString() != "notification")
+		return;
+
+	QJsonObject payload = root.value("payload").toObject();
+	QString sub_type =
+		payload.value("subscription").toObject().value("type").toString();
+	RecastPlatformEvent evt = recast_parse_eventsub_event(
+		sub_type, payload.value("event").toObject());
+	if (evt.type == EVENT_UNKNOWN)
+		return;
+
+	evt.id = metadata.value("message_id").toString();
+	sink.event(evt);
+}
+
+/* RecastKickHub::onTextMessageReceived, then both Kick providers */
+static void decode_kick_pusher(const QString &frame, ReplaySink &sink)
+{
+	QJsonObject root = QJsonDocument::fromJson(frame.toUtf8()).object();
+	QString event = root.value(QStringLiteral("event")).toString();
+	if (event.isEmpty() || event.startsWith(QStringLiteral("pusher:")) ||
+	    event.startsWith(QStringLiteral("pusher_internal:")))
+		return;
+
+	QJsonObject data;
+	QJsonValue data_val = root.value(QStringLiteral("data"));
+	if (data_val.isString())
+		data = QJsonDocument::fromJson(data_val.toString().toUtf8())
+			       .object();
+	else
+		data = data_val.toObject();
+
+	bool chatroom = root.value(QStringLiteral("channel"))
+				.toString()
+				.startsWith(QStringLiteral("chatrooms."));
+	if (chatroom &&
+	    event == QStringLiteral("App\\Events\\ChatMessageEvent"))
+		sink.chat(recast_parse_kick_chat(data));
+
+	RecastPlatformEvent evt = recast_parse_kick_event(event, data);
+	if (evt.type != EVENT_UNKNOWN)
+		sink.event(evt);
+}
+
+/* RecastYouTubeLiveChat page split, then both YouTube providers */
+static void decode_youtube_livechat(const QString &frame, ReplaySink &sink)
+{
+	QJsonObject root = QJsonDocument::fromJson(frame.toUtf8()).object();
+	const QJsonArray items = root.value(QStringLiteral("items")).toArray();
+	for (const QJsonValue &val : items) {
+		QJsonObject item = val.toObject();
+		RecastChatMessage msg;
+		if (recast_parse_youtube_chat(item, &msg)) {
+			sink.chat(msg);
+			continue;
+		}
+		RecastPlatformEvent evt = recast_parse_youtube_event(item);
+		if (evt.type != EVENT_UNKNOWN)
+			sink.event(evt);
+	}
+}
+
+struct Feed {
+	const char *name;
+	const char *file;
+	double frames_per_sec; /* at 1x */
+	void (*decode)(const QString &frame, ReplaySink &sink);
+};
+
+static const Feed feeds[] = {
+	{"twitch-irc", "twitch-irc-sample.txt", 20.0, decode_twitch_irc},
+	{"twitch-eventsub", "twitch-eventsub-sample.jsonl", 1.0,
+	 decode_twitch_eventsub},
+	{"kick-pusher", "kick-pusher-sample.jsonl", 10.0, decode_kick_pusher},
+	{"youtube-livechat", "youtube-livechat-sample.jsonl", 0.5,
+	 decode_youtube_livechat},
+};
+
+/* One frame per non-empty line, as received off the socket */
+static bool load_frames(const QString &path, std::vector<QString> *frames)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		fprintf(stderr, "cannot open %s\n", qPrintable(path));
+		return false;
+	}
+
+	QTextStream in(&file);
+	while (!in.atEnd()) {
+		QString line = in.readLine();
+		if (!line.isEmpty())
+			frames->push_back(line);
+	}
+	if (frames->empty()) {
+		fprintf(stderr, "%s has no frames\n", qPrintable(path));
+		return false;
+	}
+	return true;
+}
+
+/* ====================================================================
+ * Driver
+ * ==================================================================== */
+
+static const int SEND_TICK_MS = 5;
+
+static qint64 percentile(std::vector<qint64> &v, double q)
+{
+	if (v.empty())
+		return 0;
+	size_t i = (size_t)(q * (double)(v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + (long)i, v.end());
+	return v[i];
+}
+
+static QJsonObject run_feed(const Feed &feed,
+			    const std::vector<QString> &frames, int rate,
+			    int duration_s, BenchDocks *ui, QObject *net_ctx)
+{
+	ui->reset();
+	NetStats net;
+
+	const double fps = feed.frames_per_sec * rate;
+	const quint64 total = (quint64)(fps * duration_s + 0.5);
+
+	QEventLoop loop;
+	qint64 sent_ns = 0;
+	const qint64 start_ns = now_ns();
+
+	/* Frames go out on a fixed tick, as many as are due by now */
+	QMetaObject::invokeMethod(
+		net_ctx,
+		[&]() {
+			auto *timer = new QTimer;
+			timer->setTimerType(Qt::PreciseTimer);
+			auto *sink = new ReplaySink(ui, &net);
+			auto tick = [&, timer, sink]() {
+				double elapsed_s = (now_ns() - start_ns) / 1e9;
+				quint64 due = std::min(
+					total, (quint64)(elapsed_s * fps) + 1);
+				while (net.frames < due) {
+					const QString &frame =
+						frames[net.frames % frames.size()];
+					Measure m(&net.ns, &net.allocs);
+					feed.decode(frame, *sink);
+					net.frames++;
+				}
+				if (net.frames < total)
+					return;
+
+				timer->stop();
+				timer->deleteLater();
+				delete sink;
+				sent_ns = now_ns() - start_ns;
+				/* Queued behind every item just sent */
+				QMetaObject::invokeMethod(
+					&loop, [&loop]() { loop.quit(); },
+					Qt::QueuedConnection);
+			};
+			QObject::connect(timer, &QTimer::timeout, tick);
+			timer->start(SEND_TICK_MS);
+			tick();
+		},
+		Qt::QueuedConnection);
+
+	loop.exec();
+
+	/* Drain: deliver what the queues still hold and paint it once */
+	ui->flushAll();
+	QCoreApplication::processEvents();
+	const qint64 wall_ns = now_ns() - start_ns;
+
+	UiStats &st = ui->stats();
+	double msgs = st.received ? (double)st.received : 1.0;
+
+	QJsonObject r;
+	r["feed"] = feed.name;
+	r["rate"] = rate;
+	r["duration_s"] = duration_s;
+	r["frames"] = (double)net.frames;
+	r["messages"] = (double)st.received;
+	r["shown"] = (double)st.shown;
+	r["offered_per_sec"] = sent_ns > 0 ? net.messages / (sent_ns / 1e9) : 0.0;
+	r["msgs_per_sec"] = st.received / (wall_ns / 1e9);
+	r["drain_ms"] = (wall_ns - sent_ns) / 1e6;
+	r["parse_ns_per_msg"] = net.ns / msgs;
+	r["parse_allocs_per_msg"] = net.allocs / msgs;
+	r["ui_ns_per_msg"] = st.ns / msgs;
+	r["ui_allocs_per_msg"] = st.allocs / msgs;
+	r["ui_busy_pct"] = 100.0 * st.ns / wall_ns;
+	r["flushes"] = st.flushes;
+	r["paints"] = st.paints;
+	r["latency_p50_ms"] = (double)percentile(st.latency_ms, 0.50);
+	r["latency_p99_ms"] = (double)percentile(st.latency_ms, 0.99);
+
+	fprintf(stderr,
+		"%-17s %3dx %9.0f msg/s  ui %8.2f us/msg %7.1f allocs/msg"
+		"  parse %7.2f us/msg %7.1f allocs/msg  p99 %4lld ms\n",
+		feed.name, rate, r["msgs_per_sec"].toDouble(),
+		st.ns / msgs / 1000.0, st.allocs / msgs,
+		net.ns / msgs / 1000.0, net.allocs / msgs,
+		(long long)r["latency_p99_ms"].toDouble());
+	return r;
+}
+
+int main(int argc, char **argv)
+{
+	/* Headless unless a platform was asked for explicitly */
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QApplication app(argc, argv);
+	qRegisterMetaType<RecastChatMessage>();
+	qRegisterMetaType<RecastPlatformEvent>();
+
+	QCommandLineParser cli;
+	cli.setApplicationDescription(
+		"Replays recorded chat and event traffic through the Recast "
+		"parsers and feed views.");
+	cli.addHelpOption();
+	QCommandLineOption feed_opt("feed", "Capture to replay, or all.",
+				    "name", "all");
+	QCommandLineOption rate_opt("rate",
+				    "Comma-separated speed-ups, 1 to 100.",
+				    "list", "1,10,100");
+	QCommandLineOption duration_opt("duration", "Seconds per run.",
+					"seconds", "5");
+	QCommandLineOption data_opt("data", "Capture directory.", "dir",
+				    RECAST_BENCH_DATA_DIR);
+	QCommandLineOption out_opt("out", "Write JSON here, not stdout.",
+				   "file");
+	QCommandLineOption images_opt(
+		"no-images", "Lay out emote text instead of cached images.");
+	cli.addOptions({feed_opt, rate_opt, duration_opt, data_opt, out_opt,
+			images_opt});
+	cli.process(app);
+
+	std::vector<int> rates;
+	for (const QString &s : cli.value(rate_opt).split(',')) {
+		bool ok = false;
+		int rate = s.trimmed().toInt(&ok);
+		if (!ok || rate < 1 || rate > 100) {
+			fprintf(stderr, "rate must be 1 to 100: %s\n",
+				qPrintable(s));
+			return 1;
+		}
+		rates.push_back(rate);
+	}
+
+	bool ok = false;
+	int duration_s = cli.value(duration_opt).toInt(&ok);
+	if (!ok || duration_s <= 0) {
+		fprintf(stderr, "bad duration: %s\n",
+			qPrintable(cli.value(duration_opt)));
+		return 1;
+	}
+
+	const QString feed_name = cli.value(feed_opt);
+	std::vector<const Feed *> selected;
+	for (const Feed &f : feeds)
+		if (feed_name == "all" || feed_name == f.name)
+			selected.push_back(&f);
+	if (selected.empty()) {
+		fprintf(stderr, "unknown feed: %s\n", qPrintable(feed_name));
+		return 1;
+	}
+
+	const bool images = !cli.isSet(images_opt);
+	recast_bench_emotes_set_enabled(images);
+
+	/* Stands in for RecastNetwork's thread */
+	QThread net_thread;
+	auto *net_ctx = new QObject;
+	net_ctx->moveToThread(&net_thread);
+	QObject::connect(&net_thread, &QThread::finished, net_ctx,
+			 &QObject::deleteLater);
+	net_thread.start();
+
+	BenchDocks ui;
+	ui.show();
+	QCoreApplication::processEvents();
+
+	QJsonArray runs;
+	for (const Feed *feed : selected) {
+		std::vector<QString> frames;
+		if (!load_frames(cli.value(data_opt) + "/" + feed->file,
+				 &frames)) {
+			net_thread.quit();
+			net_thread.wait();
+			return 1;
+		}
+		for (int rate : rates)
+			runs.append(run_feed(*feed, frames, rate, duration_s,
+					     &ui, net_ctx));
+	}
+
+	net_thread.quit();
+	net_thread.wait();
+	RecastEmoteCache::destroyInstance();
+
+	QJsonObject result;
+	result["bench"] = "recast-replay";
+	result["qt"] = qVersion();
+	result["platform"] = QGuiApplication::platformName();
+	result["alloc_counter"] = ALLOC_COUNTER;
+	result["images"] = images;
+	result["runs"] = runs;
+	QByteArray json = QJsonDocument(result).toJson(QJsonDocument::Indented);
+
+	if (cli.isSet(out_opt)) {
+		QFile out(cli.value(out_opt));
+		if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			fprintf(stderr, "cannot write %s\n",
+				qPrintable(cli.value(out_opt)));
+			return 1;
+		}
+		out.write(json);
+	} else {
+		fwrite(json.constData(), 1, (size_t)json.size(), stdout);
+	}
+	return 0;
+}
@@ -16,6 +16,7 @@
 /* C-only forward declarations for the new dock system (C++ implementation) */
 void recast_ui_create(void);
 void recast_ui_destroy(void);
+void recast_vertical_register_source(void);
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("recast-obs-plugin", "en-US")
@@ -40,6 +41,7 @@ bool obs_module_load(void)
 	blog(LOG_INFO, "[Recast] Loading plugin v%s", "3.0.0");
 
 	recast_output_register();
+	recast_vertical_register_source();
 
 	/* Defer dock creation until OBS UI is ready */
 	obs_frontend_add_event_callback(on_frontend_event, NULL);
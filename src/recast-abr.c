@@ -0,0 +1,111 @@
+/*
+ * recast-abr.c -- Congestion/drop driven bitrate steps.
+ */
+
+#include "recast-abr.h"
+
+/* Back off when recent samples show congestion or drops */
+#define CONGESTION_HIGH 0.40f
+#define CONGESTION_LOW 0.10f
+#define DROP_RATE_HIGH 0.01f
+#define BAD_WINDOW 3
+
+/* Step sizes */
+#define STEP_DOWN_FACTOR 0.75
+#define STEP_UP_KBPS 250
+
+/* Ticks to wait: after a change for the encoder to settle, and of
+ * clean samples before probing upwards */
+#define HOLD_AFTER_CHANGE 3
+#define CLEAN_BEFORE_UP 10
+
+static int clamp_kbps(const recast_abr_config_t *cfg, int kbps)
+{
+	if (kbps < cfg->floor_kbps)
+		kbps = cfg->floor_kbps;
+	if (kbps > cfg->ceiling_kbps)
+		kbps = cfg->ceiling_kbps;
+	return kbps;
+}
+
+void recast_abr_config_init(recast_abr_config_t *cfg)
+{
+	cfg->enabled = false;
+	cfg->floor_kbps = 1000;
+	cfg->ceiling_kbps = 6000;
+}
+
+void recast_abr_config_load(recast_abr_config_t *cfg, obs_data_t *data)
+{
+	recast_abr_config_init(cfg);
+	if (!data)
+		return;
+
+	cfg->enabled = obs_data_get_bool(data, "enabled");
+	int floor_kbps = (int)obs_data_get_int(data, "floorKbps");
+	int ceiling_kbps = (int)obs_data_get_int(data, "ceilingKbps");
+	if (floor_kbps > 0)
+		cfg->floor_kbps = floor_kbps;
+	if (ceiling_kbps > 0)
+		cfg->ceiling_kbps = ceiling_kbps;
+	if (cfg->ceiling_kbps < cfg->floor_kbps)
+		cfg->ceiling_kbps = cfg->floor_kbps;
+}
+
+void recast_abr_config_save(const recast_abr_config_t *cfg, obs_data_t *data)
+{
+	obs_data_set_bool(data, "enabled", cfg->enabled);
+	obs_data_set_int(data, "floorKbps", cfg->floor_kbps);
+	obs_data_set_int(data, "ceilingKbps", cfg->ceiling_kbps);
+}
+
+void recast_abr_reset(recast_abr_state_t *st, const recast_abr_config_t *cfg,
+		      int start_kbps)
+{
+	st->current_kbps = clamp_kbps(cfg, start_kbps);
+	st->clean_ticks = 0;
+	st->hold_ticks = HOLD_AFTER_CHANGE;
+}
+
+int recast_abr_evaluate(recast_abr_state_t *st,
+			const recast_abr_config_t *cfg,
+			const recast_stats_ring_t *ring)
+{
+	if (!cfg->enabled || st->current_kbps <= 0 || ring->count == 0)
+		return 0;
+
+	if (st->hold_ticks > 0) {
+		st->hold_ticks--;
+		return 0;
+	}
+
+	bool bad = recast_stats_peak_congestion(ring, BAD_WINDOW) >=
+			   CONGESTION_HIGH ||
+		   recast_stats_peak_drop_rate(ring, BAD_WINDOW) >=
+			   DROP_RATE_HIGH;
+	bool clean = recast_stats_congestion(ring) < CONGESTION_LOW &&
+		     recast_stats_drop_rate(ring) == 0.0f;
+
+	int target = st->current_kbps;
+
+	if (bad) {
+		st->clean_ticks = 0;
+		target = clamp_kbps(
+			cfg, (int)(st->current_kbps * STEP_DOWN_FACTOR));
+	} else if (clean) {
+		if (++st->clean_ticks >= CLEAN_BEFORE_UP) {
+			st->clean_ticks = 0;
+			target = clamp_kbps(cfg,
+					    st->current_kbps + STEP_UP_KBPS);
+		}
+	} else {
+		st->clean_ticks = 0;
+	}
+
+	if (target == st->current_kbps)
+		return 0;
+
+	st->current_kbps = target;
+	st->hold_ticks = HOLD_AFTER_CHANGE;
+	return target;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <obs-module.h>
+#include "recast-stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Adaptive bitrate -- per-destination bitrate steering from telemetry.
+ *
+ * Evaluated once per stats tick on the destination's stats ring. A
+ * congested or dropping output steps down multiplicatively (fast back
+ * off); a clean one steps up additively after a stable period, so one
+ * bad ingest converges below the uplink without dragging the others.
+ *
+ * Only a destination with its own encoder can be steered, so enabling
+ * ABR gives the destination a dedicated pooled encoder when it starts.
+ */
+
+typedef struct recast_abr_config {
+	bool enabled;
+	int floor_kbps;
+	int ceiling_kbps;
+} recast_abr_config_t;
+
+typedef struct recast_abr_state {
+	int current_kbps; /* 0 = not running */
+	int clean_ticks;  /* consecutive healthy samples */
+	int hold_ticks;   /* no decisions while > 0 */
+} recast_abr_state_t;
+
+/* Disabled, 1000..6000 kbps. */
+void recast_abr_config_init(recast_abr_config_t *cfg);
+void recast_abr_config_load(recast_abr_config_t *cfg, obs_data_t *data);
+void recast_abr_config_save(const recast_abr_config_t *cfg, obs_data_t *data);
+
+/* Start from the encoder's configured bitrate, clamped to the range. */
+void recast_abr_reset(recast_abr_state_t *st, const recast_abr_config_t *cfg,
+		      int start_kbps);
+
+/* Returns the new target bitrate, or 0 to keep the current one. */
+int recast_abr_evaluate(recast_abr_state_t *st,
+			const recast_abr_config_t *cfg,
+			const recast_stats_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
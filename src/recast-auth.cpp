@@ -7,6 +7,7 @@
  */
 
 #include "recast-auth.h"
+#include "recast-network.h"
 
 #include <QCryptographicHash>
 #include <QDesktopServices>
@@ -20,6 +21,7 @@
 #include <QMessageBox>
 #include <QRandomGenerator>
 #include <QTcpSocket>
+#include <QThread>
 #include <QUrl>
 #include <QUrlQuery>
 #include <QVBoxLayout>
@@ -38,8 +40,6 @@ QMutex RecastAuthManager::instance_mutex_;
 RecastAuthManager::RecastAuthManager(QObject *parent)
 	: QObject(parent)
 {
-	net_ = new QNetworkAccessManager(this);
-
 	refresh_timer_ = new QTimer(this);
 	refresh_timer_->setInterval(60 * 1000); /* check every 60s */
 	connect(refresh_timer_, &QTimer::timeout,
@@ -76,14 +76,27 @@ void RecastAuthManager::destroyInstance()
 
 bool RecastAuthManager::isAuthenticated(const QString &platform) const
 {
+	QMutexLocker lock(&tokens_mutex_);
 	if (!tokens_.contains(platform))
 		return false;
 	const RecastAuthToken &t = tokens_[platform];
 	return !t.access_token.isEmpty();
 }
 
+bool RecastAuthManager::tokenCopy(const QString &platform,
+				  RecastAuthToken *out) const
+{
+	QMutexLocker lock(&tokens_mutex_);
+	auto it = tokens_.constFind(platform);
+	if (it == tokens_.constEnd())
+		return false;
+	*out = *it;
+	return true;
+}
+
 QString RecastAuthManager::accessToken(const QString &platform) const
 {
+	QMutexLocker lock(&tokens_mutex_);
 	if (!tokens_.contains(platform))
 		return QString();
 	return tokens_[platform].access_token;
@@ -91,6 +104,7 @@ QString RecastAuthManager::accessToken(const QString &platform) const
 
 QString RecastAuthManager::clientId(const QString &platform) const
 {
+	QMutexLocker lock(&tokens_mutex_);
 	if (!tokens_.contains(platform))
 		return QString();
 	return tokens_[platform].client_id;
@@ -98,6 +112,7 @@ QString RecastAuthManager::clientId(const QString &platform) const
 
 QString RecastAuthManager::userId(const QString &platform) const
 {
+	QMutexLocker lock(&tokens_mutex_);
 	if (!tokens_.contains(platform))
 		return QString();
 	return tokens_[platform].user_id;
@@ -105,6 +120,7 @@ QString RecastAuthManager::userId(const QString &platform) const
 
 QString RecastAuthManager::userName(const QString &platform) const
 {
+	QMutexLocker lock(&tokens_mutex_);
 	if (!tokens_.contains(platform))
 		return QString();
 	return tokens_[platform].user_name;
@@ -124,8 +140,13 @@ void RecastAuthManager::startAuth(const QString &platform)
 
 void RecastAuthManager::logout(const QString &platform)
 {
-	if (tokens_.contains(platform)) {
-		tokens_.remove(platform);
+	bool removed;
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		removed = tokens_.remove(platform) > 0;
+	}
+
+	if (removed) {
 		blog(LOG_INFO, "[Recast] Logged out of %s",
 		     platform.toUtf8().constData());
 		emit authStateChanged(platform, false);
@@ -161,7 +182,10 @@ void RecastAuthManager::loadFromConfig(obs_data_t *auth_data)
 			obs_data_get_string(pd, "user_name"));
 		t.expires_at = (qint64)obs_data_get_int(pd, "expires_at");
 
-		tokens_[p] = t;
+		{
+			QMutexLocker lock(&tokens_mutex_);
+			tokens_[p] = t;
+		}
 		obs_data_release(pd);
 
 		if (!t.access_token.isEmpty()) {
@@ -175,9 +199,15 @@ void RecastAuthManager::loadFromConfig(obs_data_t *auth_data)
 
 obs_data_t *RecastAuthManager::saveToConfig() const
 {
+	QMap<QString, RecastAuthToken> tokens;
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		tokens = tokens_;
+	}
+
 	obs_data_t *auth_data = obs_data_create();
 
-	for (auto it = tokens_.constBegin(); it != tokens_.constEnd(); ++it) {
+	for (auto it = tokens.constBegin(); it != tokens.constEnd(); ++it) {
 		const QString &platform = it.key();
 		const RecastAuthToken &t = it.value();
 
@@ -206,28 +236,147 @@ obs_data_t *RecastAuthManager::saveToConfig() const
 
 /* ---- Token refresh ---- */
 
+static const qint64 REFRESH_MARGIN_SEC = 5 * 60; /* before expiry */
+static const qint64 REFRESH_RETRY_SEC = 30;      /* after a failure */
+
+bool RecastAuthManager::needsRefreshLocked(const QString &platform) const
+{
+	auto it = tokens_.constFind(platform);
+	if (it == tokens_.constEnd() || it->refresh_token.isEmpty())
+		return false;
+
+	qint64 now = QDateTime::currentSecsSinceEpoch();
+	if (now < refresh_retry_at_.value(platform, 0))
+		return false;
+	return it->expires_at > 0 && now >= it->expires_at - REFRESH_MARGIN_SEC;
+}
+
 void RecastAuthManager::refreshTokenIfNeeded(const QString &platform)
 {
-	if (!tokens_.contains(platform))
-		return;
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		if (refreshing_.contains(platform) ||
+		    !needsRefreshLocked(platform))
+			return;
+		refreshing_.insert(platform);
+	}
+	startRefresh(platform);
+}
 
-	const RecastAuthToken &t = tokens_[platform];
-	if (t.refresh_token.isEmpty())
-		return;
+/* Refresh now, or join the refresh already in flight */
+void RecastAuthManager::requestRefresh(const QString &platform)
+{
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		if (refreshing_.contains(platform))
+			return;
+		refreshing_.insert(platform);
+	}
+	startRefresh(platform);
+}
 
-	qint64 now = QDateTime::currentSecsSinceEpoch();
-	qint64 margin = 5 * 60; /* refresh 5 minutes before expiry */
+void RecastAuthManager::startRefresh(const QString &platform)
+{
+	qint64 expires_at;
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		expires_at = tokens_.value(platform).expires_at;
+	}
+	blog(LOG_INFO,
+	     "[Recast] Refreshing %s token (expires_at=%lld, now=%lld)",
+	     platform.toUtf8().constData(), (long long)expires_at,
+	     (long long)QDateTime::currentSecsSinceEpoch());
+
+	bool sent = false;
+	if (platform == "twitch")
+		sent = refreshTwitchToken();
+	else if (platform == "youtube")
+		sent = refreshYouTubeToken();
+	if (!sent)
+		finishRefresh(platform, false);
+}
+
+/* Ends the in-flight refresh and replays the requests that waited */
+void RecastAuthManager::finishRefresh(const QString &platform, bool ok)
+{
+	QList<TokenWaiter> waiters;
+	QString token;
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		refreshing_.remove(platform);
+		if (ok)
+			refresh_retry_at_.remove(platform);
+		else
+			refresh_retry_at_[platform] =
+				QDateTime::currentSecsSinceEpoch() +
+				REFRESH_RETRY_SEC;
+		waiters = token_waiters_.take(platform);
+		token = tokens_.value(platform).access_token;
+	}
+
+	/* Providers only die while the UI thread is blocked on the
+	 * worker, so a live context here stays alive until posted to */
+	for (const TokenWaiter &w : waiters) {
+		if (!w.context)
+			continue;
+		TokenCallback fn = w.fn;
+		RecastNetwork::post(w.context, [fn, token]() { fn(token); });
+	}
+}
+
+void RecastAuthManager::withAccessToken(const QString &platform,
+					QObject *context, TokenCallback fn)
+{
+	if (!context || !fn)
+		return;
 
-	if (t.expires_at > 0 && now >= (t.expires_at - margin)) {
-		blog(LOG_INFO, "[Recast] Refreshing %s token (expires_at=%lld, now=%lld)",
-		     platform.toUtf8().constData(),
-		     (long long)t.expires_at, (long long)now);
+	QString token;
+	{
+		QMutexLocker lock(&tokens_mutex_);
+		if (refreshing_.contains(platform) ||
+		    needsRefreshLocked(platform)) {
+			token_waiters_[platform].append(
+				{context, std::move(fn)});
+			if (refreshing_.contains(platform))
+				return;
+			refreshing_.insert(platform);
 
-		if (platform == "twitch")
-			refreshTwitchToken();
-		else if (platform == "youtube")
-			refreshYouTubeToken();
+			/* The refresh request goes out on the UI thread */
+			QMetaObject::invokeMethod(
+				this,
+				[this, platform]() { startRefresh(platform); },
+				Qt::QueuedConnection);
+			return;
+		}
+		token = tokens_.value(platform).access_token;
 	}
+
+	if (QThread::currentThread() == context->thread())
+		fn(token);
+	else
+		RecastNetwork::post(context, [fn, token]() { fn(token); });
+}
+
+bool RecastAuthManager::handleUnauthorized(const QString &platform,
+					   QNetworkReply *reply)
+{
+	if (!reply || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute)
+				      .toInt() != 401)
+		return false;
+
+	QByteArray header = reply->request().rawHeader("Authorization");
+	QString token = QString::fromUtf8(header.mid(header.indexOf(' ') + 1));
+
+	QMutexLocker lock(&tokens_mutex_);
+	auto it = tokens_.find(platform);
+	if (it == tokens_.end() || token.isEmpty() ||
+	    it->access_token != token)
+		return true;
+
+	it->expires_at = 1; /* long past: refresh before the next use */
+	blog(LOG_INFO, "[Recast] %s token rejected, refreshing on next use",
+	     platform.toUtf8().constData());
+	return true;
 }
 
 void RecastAuthManager::onRefreshTimer()
@@ -245,11 +394,9 @@ void RecastAuthManager::onRefreshTimer()
 
 void RecastAuthManager::startTwitchAuth()
 {
-	QString client_id;
-	if (tokens_.contains("twitch") &&
-	    !tokens_["twitch"].client_id.isEmpty()) {
-		client_id = tokens_["twitch"].client_id;
-	}
+	RecastAuthToken stored;
+	tokenCopy("twitch", &stored);
+	QString client_id = stored.client_id;
 
 	if (client_id.isEmpty()) {
 		emit authError("twitch",
@@ -272,8 +419,8 @@ void RecastAuthManager::startTwitchAuth()
 	req.setHeader(QNetworkRequest::ContentTypeHeader,
 		      "application/x-www-form-urlencoded");
 
-	QNetworkReply *reply = net_->post(req, params.toString(
-		QUrl::FullyEncoded).toUtf8());
+	QNetworkReply *reply = RecastNetwork::manager()->post(
+		req, params.toString(QUrl::FullyEncoded).toUtf8());
 
 	connect(reply, &QNetworkReply::finished, this, [this, reply, client_id]() {
 		reply->deleteLater();
@@ -364,10 +511,11 @@ void RecastAuthManager::startTwitchAuth()
 				QNetworkRequest::ContentTypeHeader,
 				"application/x-www-form-urlencoded");
 
-			QNetworkReply *tokenReply = net_->post(
-				tokenReq,
-				tokenParams.toString(
-					QUrl::FullyEncoded).toUtf8());
+			QNetworkReply *tokenReply =
+				RecastNetwork::manager()->post(
+					tokenReq,
+					tokenParams.toString(
+						QUrl::FullyEncoded).toUtf8());
 
 			connect(tokenReply, &QNetworkReply::finished, this,
 				[this, tokenReply, client_id, waitDlg,
@@ -397,13 +545,18 @@ void RecastAuthManager::startTwitchAuth()
 						tobj.value("expires_in")
 							.toInt(0);
 
-					RecastAuthToken &t = tokens_["twitch"];
-					t.client_id = client_id;
-					t.access_token = access;
-					t.refresh_token = refresh;
-					t.expires_at =
-						QDateTime::currentSecsSinceEpoch()
-						+ expires_in;
+					{
+						QMutexLocker lock(
+							&tokens_mutex_);
+						RecastAuthToken &t =
+							tokens_["twitch"];
+						t.client_id = client_id;
+						t.access_token = access;
+						t.refresh_token = refresh;
+						t.expires_at =
+							QDateTime::currentSecsSinceEpoch()
+							+ expires_in;
+					}
 
 					blog(LOG_INFO,
 					     "[Recast] Twitch auth "
@@ -449,7 +602,7 @@ void RecastAuthManager::fetchTwitchUserInfo(const QString &client_id,
 			 ("Bearer " + access_token).toUtf8());
 	req.setRawHeader("Client-Id", client_id.toUtf8());
 
-	QNetworkReply *reply = net_->get(req);
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
 	connect(reply, &QNetworkReply::finished, this,
 		[this, reply]() {
 		reply->deleteLater();
@@ -470,14 +623,19 @@ void RecastAuthManager::fetchTwitchUserInfo(const QString &client_id,
 		}
 
 		QJsonObject user = data[0].toObject();
-		RecastAuthToken &t = tokens_["twitch"];
-		t.user_id = user.value("id").toString();
-		t.user_name = user.value("display_name").toString();
+		QString user_id = user.value("id").toString();
+		QString user_name = user.value("display_name").toString();
+		{
+			QMutexLocker lock(&tokens_mutex_);
+			RecastAuthToken &t = tokens_["twitch"];
+			t.user_id = user_id;
+			t.user_name = user_name;
+		}
 
 		blog(LOG_INFO,
 		     "[Recast] Twitch authenticated as %s (ID: %s)",
-		     t.user_name.toUtf8().constData(),
-		     t.user_id.toUtf8().constData());
+		     user_name.toUtf8().constData(),
+		     user_id.toUtf8().constData());
 
 		emit authStateChanged("twitch", true);
 	});
@@ -491,7 +649,7 @@ void RecastAuthManager::validateTwitchToken(const QString &access_token)
 	req.setRawHeader("Authorization",
 			 ("OAuth " + access_token).toUtf8());
 
-	QNetworkReply *reply = net_->get(req);
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
 	connect(reply, &QNetworkReply::finished, this,
 		[this, reply]() {
 		reply->deleteLater();
@@ -500,7 +658,7 @@ void RecastAuthManager::validateTwitchToken(const QString &access_token)
 			blog(LOG_INFO,
 			     "[Recast] Twitch token validation failed, "
 			     "attempting refresh");
-			refreshTwitchToken();
+			requestRefresh("twitch");
 			return;
 		}
 
@@ -509,6 +667,7 @@ void RecastAuthManager::validateTwitchToken(const QString &access_token)
 		int expires_in = obj.value("expires_in").toInt(0);
 
 		if (expires_in > 0) {
+			QMutexLocker lock(&tokens_mutex_);
 			RecastAuthToken &t = tokens_["twitch"];
 			t.expires_at = QDateTime::currentSecsSinceEpoch()
 				       + expires_in;
@@ -516,14 +675,14 @@ void RecastAuthManager::validateTwitchToken(const QString &access_token)
 	});
 }
 
-void RecastAuthManager::refreshTwitchToken()
+bool RecastAuthManager::refreshTwitchToken()
 {
-	if (!tokens_.contains("twitch"))
-		return;
+	RecastAuthToken t;
+	if (!tokenCopy("twitch", &t))
+		return false;
 
-	const RecastAuthToken &t = tokens_["twitch"];
 	if (t.refresh_token.isEmpty() || t.client_id.isEmpty())
-		return;
+		return false;
 
 	QUrl url("https://id.twitch.tv/oauth2/token");
 	QUrlQuery params;
@@ -537,8 +696,8 @@ void RecastAuthManager::refreshTwitchToken()
 	req.setHeader(QNetworkRequest::ContentTypeHeader,
 		      "application/x-www-form-urlencoded");
 
-	QNetworkReply *reply = net_->post(req, params.toString(
-		QUrl::FullyEncoded).toUtf8());
+	QNetworkReply *reply = RecastNetwork::manager()->post(
+		req, params.toString(QUrl::FullyEncoded).toUtf8());
 
 	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
 		reply->deleteLater();
@@ -550,6 +709,7 @@ void RecastAuthManager::refreshTwitchToken()
 			emit authError("twitch",
 				"Token refresh failed: " +
 				reply->errorString());
+			finishRefresh("twitch", false);
 			return;
 		}
 
@@ -564,21 +724,28 @@ void RecastAuthManager::refreshTwitchToken()
 			     err.toUtf8().constData());
 			emit authError("twitch",
 				"Token refresh error: " + err);
+			finishRefresh("twitch", false);
 			return;
 		}
 
-		RecastAuthToken &t = tokens_["twitch"];
-		t.access_token = obj.value("access_token").toString();
-		t.refresh_token = obj.value("refresh_token").toString();
 		int expires_in = obj.value("expires_in").toInt(0);
-		t.expires_at = QDateTime::currentSecsSinceEpoch()
-			       + expires_in;
+		{
+			QMutexLocker lock(&tokens_mutex_);
+			RecastAuthToken &t = tokens_["twitch"];
+			t.access_token = obj.value("access_token").toString();
+			t.refresh_token =
+				obj.value("refresh_token").toString();
+			t.expires_at = QDateTime::currentSecsSinceEpoch()
+				       + expires_in;
+		}
 
 		blog(LOG_INFO, "[Recast] Twitch token refreshed "
 		     "(expires in %ds)", expires_in);
 
+		finishRefresh("twitch", true);
 		emit authStateChanged("twitch", true);
 	});
+	return true;
 }
 
 /* ====================================================================
@@ -613,12 +780,10 @@ static QString generateCodeChallenge(const QString &verifier)
 
 void RecastAuthManager::startYouTubeAuth()
 {
-	QString client_id;
-	QString client_secret;
-	if (tokens_.contains("youtube")) {
-		client_id = tokens_["youtube"].client_id;
-		client_secret = tokens_["youtube"].client_secret;
-	}
+	RecastAuthToken stored;
+	tokenCopy("youtube", &stored);
+	QString client_id = stored.client_id;
+	QString client_secret = stored.client_secret;
 
 	if (client_id.isEmpty()) {
 		emit authError("youtube",
@@ -744,11 +909,10 @@ void RecastAuthManager::exchangeYouTubeCode(const QString &code,
 					    const QString &code_verifier,
 					    const QString &redirect_uri)
 {
-	if (!tokens_.contains("youtube"))
+	RecastAuthToken t;
+	if (!tokenCopy("youtube", &t))
 		return;
 
-	const RecastAuthToken &t = tokens_["youtube"];
-
 	QUrl url("https://oauth2.googleapis.com/token");
 	QUrlQuery params;
 	params.addQueryItem("code", code);
@@ -763,8 +927,8 @@ void RecastAuthManager::exchangeYouTubeCode(const QString &code,
 	req.setHeader(QNetworkRequest::ContentTypeHeader,
 		      "application/x-www-form-urlencoded");
 
-	QNetworkReply *reply = net_->post(req, params.toString(
-		QUrl::FullyEncoded).toUtf8());
+	QNetworkReply *reply = RecastNetwork::manager()->post(
+		req, params.toString(QUrl::FullyEncoded).toUtf8());
 
 	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
 		reply->deleteLater();
@@ -787,20 +951,24 @@ void RecastAuthManager::exchangeYouTubeCode(const QString &code,
 			return;
 		}
 
-		RecastAuthToken &t = tokens_["youtube"];
-		t.access_token = obj.value("access_token").toString();
-		if (obj.contains("refresh_token"))
-			t.refresh_token =
-				obj.value("refresh_token").toString();
+		QString access = obj.value("access_token").toString();
 		int expires_in = obj.value("expires_in").toInt(0);
-		t.expires_at = QDateTime::currentSecsSinceEpoch()
-			       + expires_in;
+		{
+			QMutexLocker lock(&tokens_mutex_);
+			RecastAuthToken &t = tokens_["youtube"];
+			t.access_token = access;
+			if (obj.contains("refresh_token"))
+				t.refresh_token =
+					obj.value("refresh_token").toString();
+			t.expires_at = QDateTime::currentSecsSinceEpoch()
+				       + expires_in;
+		}
 
 		blog(LOG_INFO,
 		     "[Recast] YouTube token obtained, "
 		     "fetching channel info");
 
-		fetchYouTubeChannelInfo(t.access_token);
+		fetchYouTubeChannelInfo(access);
 	});
 }
 
@@ -813,7 +981,7 @@ void RecastAuthManager::fetchYouTubeChannelInfo(const QString &access_token)
 	req.setRawHeader("Authorization",
 			 ("Bearer " + access_token).toUtf8());
 
-	QNetworkReply *reply = net_->get(req);
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
 	connect(reply, &QNetworkReply::finished, this,
 		[this, reply]() {
 		reply->deleteLater();
@@ -834,30 +1002,34 @@ void RecastAuthManager::fetchYouTubeChannelInfo(const QString &access_token)
 		}
 
 		QJsonObject channel = items[0].toObject();
-		RecastAuthToken &t = tokens_["youtube"];
-		t.user_id = channel.value("id").toString();
-
 		QJsonObject snippet =
 			channel.value("snippet").toObject();
-		t.user_name = snippet.value("title").toString();
+		QString user_id = channel.value("id").toString();
+		QString user_name = snippet.value("title").toString();
+		{
+			QMutexLocker lock(&tokens_mutex_);
+			RecastAuthToken &t = tokens_["youtube"];
+			t.user_id = user_id;
+			t.user_name = user_name;
+		}
 
 		blog(LOG_INFO,
 		     "[Recast] YouTube authenticated as %s (ID: %s)",
-		     t.user_name.toUtf8().constData(),
-		     t.user_id.toUtf8().constData());
+		     user_name.toUtf8().constData(),
+		     user_id.toUtf8().constData());
 
 		emit authStateChanged("youtube", true);
 	});
 }
 
-void RecastAuthManager::refreshYouTubeToken()
+bool RecastAuthManager::refreshYouTubeToken()
 {
-	if (!tokens_.contains("youtube"))
-		return;
+	RecastAuthToken t;
+	if (!tokenCopy("youtube", &t))
+		return false;
 
-	const RecastAuthToken &t = tokens_["youtube"];
 	if (t.refresh_token.isEmpty() || t.client_id.isEmpty())
-		return;
+		return false;
 
 	QUrl url("https://oauth2.googleapis.com/token");
 	QUrlQuery params;
@@ -871,8 +1043,8 @@ void RecastAuthManager::refreshYouTubeToken()
 	req.setHeader(QNetworkRequest::ContentTypeHeader,
 		      "application/x-www-form-urlencoded");
 
-	QNetworkReply *reply = net_->post(req, params.toString(
-		QUrl::FullyEncoded).toUtf8());
+	QNetworkReply *reply = RecastNetwork::manager()->post(
+		req, params.toString(QUrl::FullyEncoded).toUtf8());
 
 	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
 		reply->deleteLater();
@@ -884,6 +1056,7 @@ void RecastAuthManager::refreshYouTubeToken()
 			emit authError("youtube",
 				"Token refresh failed: " +
 				reply->errorString());
+			finishRefresh("youtube", false);
 			return;
 		}
 
@@ -898,23 +1071,29 @@ void RecastAuthManager::refreshYouTubeToken()
 			     err.toUtf8().constData());
 			emit authError("youtube",
 				"Token refresh error: " + err);
+			finishRefresh("youtube", false);
 			return;
 		}
 
-		RecastAuthToken &t = tokens_["youtube"];
-		t.access_token = obj.value("access_token").toString();
-		if (obj.contains("refresh_token"))
-			t.refresh_token =
-				obj.value("refresh_token").toString();
 		int expires_in = obj.value("expires_in").toInt(0);
-		t.expires_at = QDateTime::currentSecsSinceEpoch()
-			       + expires_in;
+		{
+			QMutexLocker lock(&tokens_mutex_);
+			RecastAuthToken &t = tokens_["youtube"];
+			t.access_token = obj.value("access_token").toString();
+			if (obj.contains("refresh_token"))
+				t.refresh_token =
+					obj.value("refresh_token").toString();
+			t.expires_at = QDateTime::currentSecsSinceEpoch()
+				       + expires_in;
+		}
 
 		blog(LOG_INFO, "[Recast] YouTube token refreshed "
 		     "(expires in %ds)", expires_in);
 
+		finishRefresh("youtube", true);
 		emit authStateChanged("youtube", true);
 	});
+	return true;
 }
 
 /* ====================================================================
@@ -5,14 +5,18 @@
 #include <QLineEdit>
 #include <QLabel>
 #include <QPushButton>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QList>
 #include <QMap>
 #include <QMutex>
+#include <QPointer>
+#include <QSet>
 #include <QString>
 #include <QTcpServer>
 
+#include <functional>
+
 extern "C" {
 #include <obs.h>
 }
@@ -35,6 +39,10 @@ struct RecastAuthToken {
  *
  * Handles device-code (Twitch) and authorization-code+PKCE (YouTube) flows,
  * stores tokens in the plugin config JSON, and auto-refreshes before expiry.
+ *
+ * At most one refresh per platform is in flight. Requests made through
+ * withAccessToken() while it runs wait for it and are replayed with the
+ * new token, instead of going out with the old one and failing.
  */
 class RecastAuthManager : public QObject {
 	Q_OBJECT
@@ -57,6 +65,20 @@ public:
 
 	void refreshTokenIfNeeded(const QString &platform);
 
+	using TokenCallback = std::function<void(const QString &token)>;
+
+	/* Call fn(token) on context's thread with the platform's access
+	 * token ("" if not authenticated). If a refresh is in flight or
+	 * the token is about to expire, fn is queued until that refresh
+	 * finishes. Any thread; fn is dropped if context dies first. */
+	void withAccessToken(const QString &platform, QObject *context,
+			     TokenCallback fn);
+
+	/* If reply got 401, its Bearer token is treated as expired (unless
+	 * it was replaced meanwhile), so the next withAccessToken()
+	 * refreshes first. Returns true on 401. Any thread. */
+	bool handleUnauthorized(const QString &platform, QNetworkReply *reply);
+
 signals:
 	void authStateChanged(const QString &platform, bool authenticated);
 	void authError(const QString &platform, const QString &error);
@@ -68,10 +90,28 @@ private:
 	static RecastAuthManager *instance_;
 	static QMutex instance_mutex_;
 
-	QNetworkAccessManager *net_;
+	/* Written on the UI thread, read by providers on the network
+	 * thread through the public accessors. */
 	QMap<QString, RecastAuthToken> tokens_;
+	mutable QMutex tokens_mutex_;
 	QTimer *refresh_timer_;
 
+	/* Coalesced refresh, also under tokens_mutex_ */
+	struct TokenWaiter {
+		QPointer<QObject> context;
+		TokenCallback fn;
+	};
+	QSet<QString> refreshing_;
+	QMap<QString, QList<TokenWaiter>> token_waiters_;
+	QMap<QString, qint64> refresh_retry_at_; /* after a failure */
+
+	/* Copy of the platform's token under tokens_mutex_ */
+	bool tokenCopy(const QString &platform, RecastAuthToken *out) const;
+	bool needsRefreshLocked(const QString &platform) const;
+	void requestRefresh(const QString &platform);
+	void startRefresh(const QString &platform);
+	void finishRefresh(const QString &platform, bool ok);
+
 	/* Twitch device-code flow */
 	void startTwitchAuth();
 	void pollTwitchDeviceCode(const QString &device_code,
@@ -79,7 +119,7 @@ private:
 	void fetchTwitchUserInfo(const QString &client_id,
 				 const QString &access_token);
 	void validateTwitchToken(const QString &access_token);
-	void refreshTwitchToken();
+	bool refreshTwitchToken();
 
 	/* YouTube auth-code + PKCE flow */
 	void startYouTubeAuth();
@@ -87,7 +127,7 @@ private:
 				 const QString &code_verifier,
 				 const QString &redirect_uri);
 	void fetchYouTubeChannelInfo(const QString &access_token);
-	void refreshYouTubeToken();
+	bool refreshYouTubeToken();
 
 	/* Loopback server for YouTube */
 	QTcpServer *loopback_server_ = nullptr;
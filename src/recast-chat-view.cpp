@@ -0,0 +1,396 @@
+/*
+ * recast-chat-view.cpp -- Model/view chat display.
+ *
+ * Replaces the QTextBrowser/insertHtml chat log: messages live in a
+ * ring buffer model and a delegate paints each visible row from a
+ * cached text layout.
+ */
+
+#include "recast-chat-view.h"
+#include "recast-emote-cache.h"
+
+#include <QAbstractItemView>
+#include <QFontMetricsF>
+#include <QPainter>
+#include <QtMath>
+
+static const int ROW_PAD_H = 4;
+static const int ROW_PAD_V = 2;
+
+static const QColor TEXT_COLOR(0xdd, 0xdd, 0xdd);
+static const QColor DEFAULT_NAME_COLOR(0xcc, 0xcc, 0xcc);
+static const QColor OWNER_BADGE_COLOR(0xff, 0x44, 0x44);
+static const QColor MOD_BADGE_COLOR(0x44, 0xff, 0x44);
+
+/* ====================================================================
+ * RecastChatModel
+ * ==================================================================== */
+
+RecastChatModel::RecastChatModel(int capacity, QObject *parent)
+	: QAbstractListModel(parent), capacity_(capacity > 0 ? capacity : 1)
+{
+	ring_.resize(capacity_);
+}
+
+int RecastChatModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : count_;
+}
+
+QVariant RecastChatModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() < 0 || index.row() >= count_)
+		return QVariant();
+
+	const RecastChatMessage &msg = messageAt(index.row());
+	if (role == Qt::DisplayRole)
+		return QStringLiteral("%1: %2").arg(msg.displayName,
+						     msg.message);
+	if (role == Qt::ToolTipRole)
+		return msg.platform;
+	return QVariant();
+}
+
+void RecastChatModel::dropOldest(int n)
+{
+	if (n <= 0)
+		return;
+
+	beginRemoveRows(QModelIndex(), 0, n - 1);
+	for (int i = 0; i < n; i++) {
+		Row &r = ring_[head_];
+		r.msg = RecastChatMessage();
+		r.layout = RowLayout();
+		head_ = (head_ + 1) % capacity_;
+	}
+	count_ -= n;
+	endRemoveRows();
+}
+
+void RecastChatModel::appendMessage(const RecastChatMessage &msg)
+{
+	if (count_ == capacity_)
+		dropOldest(1);
+
+	beginInsertRows(QModelIndex(), count_, count_);
+	Row &r = ring_[slot(count_)];
+	r.msg = msg;
+	r.layout = RowLayout();
+	count_++;
+	endInsertRows();
+}
+
+void RecastChatModel::appendMessages(const std::vector<RecastChatMessage> &msgs)
+{
+	if (msgs.empty())
+		return;
+
+	/* Only the newest capacity_ messages can survive the batch */
+	int n = (int)msgs.size();
+	int first = n > capacity_ ? n - capacity_ : 0;
+	n -= first;
+
+	dropOldest(count_ + n - capacity_);
+
+	beginInsertRows(QModelIndex(), count_, count_ + n - 1);
+	for (int i = 0; i < n; i++) {
+		Row &r = ring_[slot(count_ + i)];
+		r.msg = msgs[first + i];
+		r.layout = RowLayout();
+	}
+	count_ += n;
+	endInsertRows();
+}
+
+void RecastChatModel::clear()
+{
+	beginResetModel();
+	for (Row &r : ring_) {
+		r.msg = RecastChatMessage();
+		r.layout = RowLayout();
+	}
+	head_ = 0;
+	count_ = 0;
+	endResetModel();
+}
+
+void RecastChatModel::invalidatePendingImages()
+{
+	int first = -1, last = -1;
+	for (int row = 0; row < count_; row++) {
+		RowLayout &l = ring_[slot(row)].layout;
+		if (!l.pending)
+			continue;
+		l = RowLayout();
+		if (first < 0)
+			first = row;
+		last = row;
+	}
+
+	if (first >= 0)
+		emit dataChanged(index(first), index(last));
+}
+
+const RecastChatMessage &RecastChatModel::messageAt(int row) const
+{
+	return ring_[slot(row)].msg;
+}
+
+RecastChatModel::RowLayout &RecastChatModel::layoutAt(int row) const
+{
+	return ring_[slot(row)].layout;
+}
+
+/* ====================================================================
+ * RecastChatDelegate
+ * ==================================================================== */
+
+RecastChatDelegate::RecastChatDelegate(RecastChatModel *model,
+				       QObject *parent)
+	: QStyledItemDelegate(parent), model_(model)
+{
+}
+
+QColor RecastChatDelegate::platformColor(const QString &platform)
+{
+	if (platform == QStringLiteral("twitch"))
+		return QColor(0x91, 0x46, 0xFF);
+	if (platform == QStringLiteral("youtube"))
+		return QColor(0xFF, 0x00, 0x00);
+	if (platform == QStringLiteral("kick"))
+		return QColor(0x53, 0xFC, 0x18);
+	return QColor(0x88, 0x88, 0x88);
+}
+
+QString RecastChatDelegate::platformLetter(const QString &platform)
+{
+	if (platform == QStringLiteral("twitch"))
+		return QStringLiteral("T");
+	if (platform == QStringLiteral("youtube"))
+		return QStringLiteral("Y");
+	if (platform == QStringLiteral("kick"))
+		return QStringLiteral("K");
+	return QStringLiteral("?");
+}
+
+static QFont scaled_font(const QFont &base, qreal scale)
+{
+	QFont f = base;
+	if (base.pixelSize() > 0)
+		f.setPixelSize(qMax(1, qRound(base.pixelSize() * scale)));
+	else
+		f.setPointSizeF(base.pointSizeF() * scale);
+	return f;
+}
+
+static void add_range(QList<QTextLayout::FormatRange> &formats, int start,
+		      int length, const QColor &color, bool bold,
+		      const QFont &font)
+{
+	QTextLayout::FormatRange range;
+	range.start = start;
+	range.length = length;
+	range.format.setFont(font);
+	range.format.setForeground(color);
+	if (bold)
+		range.format.setFontWeight(QFont::Bold);
+	formats.append(range);
+}
+
+/* Append a placeholder for pm scaled to the line height, or return
+ * false (and note whether it is still loading) if it is not cached */
+static bool add_image(QString &text, QList<QTextLayout::FormatRange> &formats,
+		      RecastChatModel::RowLayout &cache, const QFont &font,
+		      const QString &key, const QUrl &url)
+{
+	bool pending = false;
+	const QPixmap *pm =
+		RecastEmoteCache::instance()->image(key, url, &pending);
+	if (!pm || pm->isNull() || pm->height() <= 0) {
+		cache.pending = cache.pending || pending;
+		return false;
+	}
+
+	QFontMetricsF fm(font);
+	qreal h = fm.height();
+	qreal w = h * pm->width() / pm->height();
+
+	QTextLayout::FormatRange range;
+	range.start = text.size();
+	range.length = 1;
+	range.format.setFont(font);
+	range.format.setFontLetterSpacingType(QFont::AbsoluteSpacing);
+	range.format.setFontLetterSpacing(w - fm.horizontalAdvance(QChar(0xA0)));
+	formats.append(range);
+
+	RecastChatModel::ImageSpan span;
+	span.pos = text.size();
+	span.size = QSizeF(w, h);
+	span.key = key;
+	span.url = url;
+	cache.images.push_back(span);
+
+	text += QChar(0xA0);
+	return true;
+}
+
+RecastChatModel::RowLayout &
+RecastChatDelegate::ensureLayout(int row, const QFont &font, int width) const
+{
+	RecastChatModel::RowLayout &cache = model_->layoutAt(row);
+	if (cache.layout && cache.width == width)
+		return cache;
+
+	const RecastChatMessage &msg = model_->messageAt(row);
+	const QFont small = scaled_font(font, 0.8);
+	cache.images.clear();
+	cache.pending = false;
+
+	/* "[T] <badge> Name: message" with per-span colours */
+	QString text;
+	QList<QTextLayout::FormatRange> formats;
+
+	QString tag = QStringLiteral("[%1] ").arg(
+		platformLetter(msg.platform));
+	add_range(formats, 0, tag.size() - 1, platformColor(msg.platform),
+		  true, small);
+	text += tag;
+
+	/* Badge images where the platform provides them, glyphs otherwise */
+	bool have_badges = false;
+	for (const QString &badge : msg.badges) {
+		QUrl url = RecastEmoteCache::instance()->twitchBadgeUrl(badge);
+		if (url.isEmpty())
+			continue;
+		if (add_image(text, formats, cache, small,
+			      QStringLiteral("twitch-badge:") + badge, url)) {
+			text += QLatin1Char(' ');
+			have_badges = true;
+		}
+	}
+
+	if (!have_badges && (msg.isOwner || msg.isMod)) {
+		/* U+2605 star for the owner, U+2694 swords for mods */
+		QChar badge = msg.isOwner ? QChar(0x2605) : QChar(0x2694);
+		add_range(formats, text.size(), 1,
+			  msg.isOwner ? OWNER_BADGE_COLOR : MOD_BADGE_COLOR,
+			  false, small);
+		text += badge;
+		text += QLatin1Char(' ');
+	}
+
+	add_range(formats, text.size(), msg.displayName.size(),
+		  msg.nameColor.isValid() ? msg.nameColor : DEFAULT_NAME_COLOR,
+		  true, font);
+	text += msg.displayName;
+
+	add_range(formats, text.size(), 2, TEXT_COLOR, false, font);
+	text += QStringLiteral(": ");
+
+	/* Message text, with emotes swapped for images once cached */
+	int pos = 0;
+	for (const RecastChatEmote &e : msg.emotes) {
+		if (e.start < pos || e.start + e.length > msg.message.size())
+			continue;
+		if (e.start > pos) {
+			add_range(formats, text.size(), e.start - pos,
+				  TEXT_COLOR, false, font);
+			text += QStringView(msg.message).sliced(pos,
+								e.start - pos);
+		}
+		if (!add_image(text, formats, cache, font, e.key, e.url)) {
+			add_range(formats, text.size(), e.length, TEXT_COLOR,
+				  false, font);
+			text += QStringView(msg.message).sliced(e.start,
+								e.length);
+		}
+		pos = e.start + e.length;
+	}
+	if (pos < msg.message.size()) {
+		add_range(formats, text.size(), msg.message.size() - pos,
+			  TEXT_COLOR, false, font);
+		text += QStringView(msg.message).sliced(pos);
+	}
+
+	auto layout = std::make_unique<QTextLayout>(text, font);
+	layout->setFormats(formats);
+
+	QTextOption opt;
+	opt.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+	layout->setTextOption(opt);
+
+	qreal line_width = qMax(1, width - 2 * ROW_PAD_H);
+	qreal y = 0;
+	layout->beginLayout();
+	for (;;) {
+		QTextLine line = layout->createLine();
+		if (!line.isValid())
+			break;
+		line.setLineWidth(line_width);
+		line.setPosition(QPointF(0, y));
+		y += line.height();
+	}
+	layout->endLayout();
+
+	cache.layout = std::move(layout);
+	cache.width = width;
+	cache.height = qCeil(y) + 2 * ROW_PAD_V;
+	return cache;
+}
+
+/* QListView does not pass a row rect to sizeHint(); rows span the
+ * viewport, so size against its width. */
+static int row_width(const QStyleOptionViewItem &option)
+{
+	auto *view = qobject_cast<const QAbstractItemView *>(option.widget);
+	return view ? view->viewport()->width() : option.rect.width();
+}
+
+QSize RecastChatDelegate::sizeHint(const QStyleOptionViewItem &option,
+				   const QModelIndex &index) const
+{
+	int width = row_width(option);
+	if (width <= 0)
+		return QSize(0, option.fontMetrics.height() + 2 * ROW_PAD_V);
+
+	RecastChatModel::RowLayout &cache =
+		ensureLayout(index.row(), option.font, width);
+	return QSize(width, cache.height);
+}
+
+void RecastChatDelegate::paint(QPainter *painter,
+			       const QStyleOptionViewItem &option,
+			       const QModelIndex &index) const
+{
+	RecastChatModel::RowLayout &cache =
+		ensureLayout(index.row(), option.font, row_width(option));
+
+	QPointF origin(option.rect.left() + ROW_PAD_H,
+		       option.rect.top() + ROW_PAD_V);
+
+	painter->save();
+	painter->setPen(TEXT_COLOR);
+	cache.layout->draw(painter, origin);
+
+	if (!cache.images.empty()) {
+		painter->setRenderHint(QPainter::SmoothPixmapTransform);
+		RecastEmoteCache *emotes = RecastEmoteCache::instance();
+		for (const RecastChatModel::ImageSpan &span : cache.images) {
+			/* May have been evicted since layout; reloads */
+			const QPixmap *pm = emotes->image(span.key, span.url);
+			if (!pm)
+				continue;
+			QTextLine line =
+				cache.layout->lineForTextPosition(span.pos);
+			if (!line.isValid())
+				continue;
+			QPointF at(line.cursorToX(span.pos),
+				   line.y() +
+					   (line.height() - span.size.height()) /
+						   2);
+			painter->drawPixmap(QRectF(origin + at, span.size), *pm,
+					    QRectF(pm->rect()));
+		}
+	}
+	painter->restore();
+}
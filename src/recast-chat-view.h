@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QTextLayout>
+#include <QColor>
+
+#include <memory>
+#include <vector>
+
+#include "recast-feed-parse.h"
+
+/*
+ * RecastChatModel -- Fixed-capacity ring buffer of chat messages.
+ *
+ * Appending is O(1) per message; once full, the oldest rows are dropped
+ * in the same step. A batch append emits one remove and one insert.
+ * Each row also carries the delegate's cached text layout so the layout
+ * is freed together with the message.
+ */
+
+class RecastChatModel : public QAbstractListModel {
+	Q_OBJECT
+
+public:
+	/* Emote/badge drawn over the placeholder at text position pos */
+	struct ImageSpan {
+		int pos = 0;
+		QSizeF size;
+		QString key;
+		QUrl url;
+	};
+
+	/* Cached layout for one row at a given width. pending is set
+	 * when an image was still loading and the text stood in for it. */
+	struct RowLayout {
+		int width = -1;
+		int height = 0;
+		std::unique_ptr<QTextLayout> layout;
+		std::vector<ImageSpan> images;
+		bool pending = false;
+	};
+
+	explicit RecastChatModel(int capacity, QObject *parent = nullptr);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role) const override;
+
+	void appendMessage(const RecastChatMessage &msg);
+	void appendMessages(const std::vector<RecastChatMessage> &msgs);
+	void clear();
+
+	/* Drop the layouts of rows waiting on images */
+	void invalidatePendingImages();
+
+	const RecastChatMessage &messageAt(int row) const;
+	RowLayout &layoutAt(int row) const;
+
+private:
+	struct Row {
+		RecastChatMessage msg;
+		mutable RowLayout layout;
+	};
+
+	std::vector<Row> ring_;
+	int capacity_;
+	int head_ = 0;  /* slot of row 0 */
+	int count_ = 0;
+
+	int slot(int row) const { return (head_ + row) % capacity_; }
+	void dropOldest(int n);
+};
+
+/*
+ * RecastChatDelegate -- Paints chat rows from cached QTextLayouts.
+ *
+ * A row's layout is built once per width and reused for both sizeHint()
+ * and paint(); the view only paints rows inside the viewport.
+ *
+ * Emotes and badges that are already in RecastEmoteCache are laid out
+ * as a no-break space widened to the image's advance, and the pixmap
+ * is drawn over it. Until an image arrives its text is shown instead.
+ */
+
+class RecastChatDelegate : public QStyledItemDelegate {
+	Q_OBJECT
+
+public:
+	explicit RecastChatDelegate(RecastChatModel *model,
+				    QObject *parent = nullptr);
+
+	void paint(QPainter *painter, const QStyleOptionViewItem &option,
+		   const QModelIndex &index) const override;
+	QSize sizeHint(const QStyleOptionViewItem &option,
+		       const QModelIndex &index) const override;
+
+	static QColor platformColor(const QString &platform);
+	static QString platformLetter(const QString &platform);
+
+private:
+	RecastChatModel *model_;
+
+	RecastChatModel::RowLayout &ensureLayout(int row, const QFont &font,
+						 int width) const;
+};
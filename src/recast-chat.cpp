@@ -7,17 +7,26 @@
  */
 
 #include "recast-chat.h"
+#include "recast-chat-view.h"
+#include "recast-irc.h"
+#include "recast-feed-parse.h"
 #include "recast-auth.h"
+#include "recast-youtube-livechat.h"
+#include "recast-kick-hub.h"
+#include "recast-network.h"
 #include "recast-platform-icons.h"
+#include "recast-emote-cache.h"
+#include "recast-perf.h"
 
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QDateTime>
 #include <QUrlQuery>
 #include <QScrollBar>
 #include <QStyle>
 
+#include <algorithm>
+
 extern "C" {
 #include <obs-module.h>
 }
@@ -146,10 +155,9 @@ void RecastTwitchChat::onDisconnected()
 void RecastTwitchChat::onTextMessageReceived(const QString &raw)
 {
 	/* Twitch may send multiple lines in one message */
-	QStringList lines = raw.split(QStringLiteral("\r\n"),
-				      Qt::SkipEmptyParts);
-	for (const QString &line : lines)
+	recast_irc_for_each_line(raw, [this](QStringView line) {
 		parseLine(line);
+	});
 }
 
 void RecastTwitchChat::onReconnectTimer()
@@ -160,20 +168,14 @@ void RecastTwitchChat::onReconnectTimer()
 	}
 }
 
-void RecastTwitchChat::parseLine(const QString &line)
+void RecastTwitchChat::parseLine(QStringView line)
 {
+	RECAST_PERF_SCOPE(RECAST_PERF_IRC_PARSE);
+
 	/* Reject absurdly long lines to prevent memory issues */
 	if (line.length() > 16384)
 		return;
 
-	/* Handle PING keepalive */
-	if (line.startsWith(QStringLiteral("PING"))) {
-		QString pong = line;
-		pong.replace(0, 4, QStringLiteral("PONG"));
-		ws_->sendTextMessage(pong);
-		return;
-	}
-
 	/*
 	 * IRC message format with tags:
 	 * @tags :prefix COMMAND params :trailing
@@ -182,120 +184,54 @@ void RecastTwitchChat::parseLine(const QString &line)
 	 * @badge-info=;badges=broadcaster/1;color=#FF0000;
 	 *  display-name=User;emotes=;...;user-type=
 	 *  :user!user@user.tmi.twitch.tv PRIVMSG #channel :Hello World
+	 *
+	 * The tokenizer only hands out views into the line; strings are
+	 * created for the fields we display.
 	 */
+	RecastIrcMessage irc;
+	if (!recast_irc_parse(line, &irc))
+		return;
 
-	QString tags_str;
-	QString remainder = line;
-
-	/* Extract tags (starts with @) */
-	if (remainder.startsWith('@')) {
-		int space = remainder.indexOf(' ');
-		if (space < 0)
-			return;
-		tags_str = remainder.mid(1, space - 1);
-		remainder = remainder.mid(space + 1);
-	}
-
-	/* Extract prefix (starts with :) */
-	QString prefix;
-	if (remainder.startsWith(':')) {
-		int space = remainder.indexOf(' ');
-		if (space < 0)
-			return;
-		prefix = remainder.mid(1, space - 1);
-		remainder = remainder.mid(space + 1);
-	}
-
-	/* Extract command */
-	int space = remainder.indexOf(' ');
-	QString command;
-	QString params;
-	if (space >= 0) {
-		command = remainder.left(space);
-		params = remainder.mid(space + 1);
-	} else {
-		command = remainder;
+	/* Handle PING keepalive */
+	if (irc.command == u"PING") {
+		qsizetype args = irc.command.data() - line.data() + 4;
+		ws_->sendTextMessage(QStringLiteral("PONG") +
+				     line.sliced(args));
+		return;
 	}
 
-	if (command == QStringLiteral("PRIVMSG")) {
-		/* Extract trailing message after the second ':' */
-		int colon = params.indexOf(':');
-		if (colon < 0)
-			return;
-		QString trailing = params.mid(colon + 1);
-
-		RecastChatMessage msg =
-			parsePrivmsg(tags_str, prefix, trailing);
-		emit messageReceived(msg);
+	if (irc.command == u"PRIVMSG" && irc.has_trailing) {
+		emit messageReceived(recast_parse_twitch_privmsg(irc));
+		return;
 	}
-}
 
-RecastChatMessage RecastTwitchChat::parsePrivmsg(const QString &tags,
-						 const QString &prefix,
-						 const QString &trailing)
-{
-	RecastChatMessage msg;
-	msg.platform = QStringLiteral("twitch");
-	msg.message = trailing;
-	msg.timestamp = QDateTime::currentMSecsSinceEpoch();
-
-	/* Extract username from prefix (user!user@user.tmi.twitch.tv) */
-	int excl = prefix.indexOf('!');
-	if (excl > 0)
-		msg.username = prefix.left(excl);
-
-	/* Parse IRCv3 tags: semicolon-separated key=value pairs */
-	QStringList tag_list = tags.split(';', Qt::SkipEmptyParts);
-	for (const QString &tag : tag_list) {
-		int eq = tag.indexOf('=');
-		if (eq < 0)
-			continue;
-
-		QString key = tag.left(eq);
-		QString value = tag.mid(eq + 1);
-
-		if (key == QStringLiteral("display-name")) {
-			msg.displayName = value;
-		} else if (key == QStringLiteral("color")) {
-			if (!value.isEmpty())
-				msg.nameColor = QColor(value);
-		} else if (key == QStringLiteral("mod")) {
-			msg.isMod = (value == QStringLiteral("1"));
-		} else if (key == QStringLiteral("subscriber")) {
-			msg.isSub = (value == QStringLiteral("1"));
-		} else if (key == QStringLiteral("badges")) {
-			if (value.contains(QStringLiteral("broadcaster")))
-				msg.isOwner = true;
+	/* ROOMSTATE carries the channel id that keys its badge set */
+	if (irc.command == u"ROOMSTATE") {
+		RecastIrcTagIterator tags(irc.tags);
+		QStringView key, value;
+		while (tags.next(&key, &value)) {
+			if (key != u"room-id" || value.isEmpty())
+				continue;
+			QString room_id = value.toString();
+			RecastEmoteCache *cache = RecastEmoteCache::instance();
+			QMetaObject::invokeMethod(
+				cache,
+				[cache, room_id]() {
+					cache->loadTwitchBadges(room_id);
+				},
+				Qt::QueuedConnection);
+			break;
 		}
 	}
-
-	/* Fallback: use username if display-name was empty */
-	if (msg.displayName.isEmpty())
-		msg.displayName = msg.username;
-
-	/* Default color if none was set */
-	if (!msg.nameColor.isValid())
-		msg.nameColor = QColor(145, 70, 255);
-
-	return msg;
 }
 
 /* ====================================================================
- * RecastYouTubeChat -- REST polling
+ * RecastYouTubeChat -- liveChat text via the shared poller
  * ==================================================================== */
 
 RecastYouTubeChat::RecastYouTubeChat(QObject *parent)
 	: RecastChatProvider(parent)
 {
-	net_ = new QNetworkAccessManager(this);
-	poll_timer_ = new QTimer(this);
-	reconnect_timer_ = new QTimer(this);
-	reconnect_timer_->setSingleShot(true);
-
-	connect(poll_timer_, &QTimer::timeout,
-		this, &RecastYouTubeChat::onPollTimer);
-	connect(reconnect_timer_, &QTimer::timeout,
-		this, &RecastYouTubeChat::onReconnectTimer);
 }
 
 RecastYouTubeChat::~RecastYouTubeChat()
@@ -309,30 +245,54 @@ void RecastYouTubeChat::connectToChat(const QString &channel)
 	 * authenticated user's active broadcast */
 	Q_UNUSED(channel);
 
+	if (subscribed_)
+		return;
+
 	blog(LOG_INFO, "[Recast Chat] YouTube connecting...");
-	fetchLiveChatId();
+
+	auto *poller = RecastYouTubeLiveChat::instance();
+	connect(poller, &RecastYouTubeLiveChat::connectionStateChanged,
+		this, &RecastYouTubeChat::onPollerStateChanged);
+	connect(poller, &RecastYouTubeLiveChat::chatItems,
+		this, &RecastYouTubeChat::onChatItems);
+	subscribed_ = true;
+	poller->subscribe(this);
+
+	onPollerStateChanged(poller->isConnected());
 }
 
 void RecastYouTubeChat::disconnect()
 {
-	poll_timer_->stop();
-	reconnect_timer_->stop();
-	live_chat_id_.clear();
-	next_page_token_.clear();
-
-	if (connected_) {
-		connected_ = false;
-		emit connectionStateChanged(false);
+	if (subscribed_) {
+		subscribed_ = false;
+		auto *poller = RecastYouTubeLiveChat::instance();
+		QObject::disconnect(poller, nullptr, this, nullptr);
+		poller->unsubscribe(this);
 	}
+
+	onPollerStateChanged(false);
 }
 
 void RecastYouTubeChat::sendMessage(const QString &msg)
 {
-	if (!connected_ || live_chat_id_.isEmpty())
+	if (!connected_)
 		return;
 
-	auto *auth = RecastAuthManager::instance();
-	QString token = auth->accessToken(QStringLiteral("youtube"));
+	QString live_chat_id = RecastYouTubeLiveChat::instance()->liveChatId();
+	if (live_chat_id.isEmpty())
+		return;
+
+	RecastAuthManager::instance()->withAccessToken(
+		QStringLiteral("youtube"), this,
+		[this, msg, live_chat_id](const QString &token) {
+			sendWithToken(msg, live_chat_id, token);
+		});
+}
+
+void RecastYouTubeChat::sendWithToken(const QString &msg,
+				      const QString &live_chat_id,
+				      const QString &token)
+{
 	if (token.isEmpty())
 		return;
 
@@ -349,7 +309,7 @@ void RecastYouTubeChat::sendMessage(const QString &msg)
 			 QStringLiteral("Bearer %1").arg(token).toUtf8());
 
 	QJsonObject snippet;
-	snippet[QStringLiteral("liveChatId")] = live_chat_id_;
+	snippet[QStringLiteral("liveChatId")] = live_chat_id;
 	snippet[QStringLiteral("type")] =
 		QStringLiteral("textMessageEvent");
 
@@ -360,7 +320,7 @@ void RecastYouTubeChat::sendMessage(const QString &msg)
 	QJsonObject body;
 	body[QStringLiteral("snippet")] = snippet;
 
-	QNetworkReply *reply = net_->post(
+	QNetworkReply *reply = RecastNetwork::manager()->post(
 		req, QJsonDocument(body).toJson(QJsonDocument::Compact));
 
 	connect(reply, &QNetworkReply::finished, reply, [reply]() {
@@ -368,6 +328,8 @@ void RecastYouTubeChat::sendMessage(const QString &msg)
 			blog(LOG_ERROR,
 			     "[Recast Chat] YouTube send error: %s",
 			     reply->errorString().toUtf8().constData());
+			RecastAuthManager::instance()->handleUnauthorized(
+				QStringLiteral("youtube"), reply);
 		}
 		reply->deleteLater();
 	});
@@ -378,244 +340,32 @@ bool RecastYouTubeChat::isConnected() const
 	return connected_;
 }
 
-void RecastYouTubeChat::onPollTimer()
-{
-	if (connected_)
-		pollMessages();
-}
-
-void RecastYouTubeChat::onReconnectTimer()
-{
-	if (!connected_) {
-		blog(LOG_INFO, "[Recast Chat] YouTube reconnecting...");
-		fetchLiveChatId();
-	}
-}
-
-void RecastYouTubeChat::fetchLiveChatId()
+void RecastYouTubeChat::onPollerStateChanged(bool connected)
 {
-	auto *auth = RecastAuthManager::instance();
-	QString token = auth->accessToken(QStringLiteral("youtube"));
-
-	if (token.isEmpty()) {
-		blog(LOG_ERROR,
-		     "[Recast Chat] YouTube: no auth token available");
-		reconnect_timer_->start(5000);
+	connected = connected && subscribed_;
+	if (connected_ == connected)
 		return;
-	}
-
-	QUrl url(QStringLiteral(
-		"https://www.googleapis.com/youtube/v3/liveBroadcasts"
-		"?part=snippet&broadcastStatus=active&mine=true"));
-
-	QNetworkRequest req(url);
-	req.setTransferTimeout(15000);
-	req.setRawHeader("Authorization",
-			 QStringLiteral("Bearer %1").arg(token).toUtf8());
-
-	QNetworkReply *reply = net_->get(req);
-
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-		reply->deleteLater();
-
-		if (reply->error() != QNetworkReply::NoError) {
-			blog(LOG_ERROR,
-			     "[Recast Chat] YouTube liveBroadcasts error: %s",
-			     reply->errorString().toUtf8().constData());
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		QJsonDocument doc =
-			QJsonDocument::fromJson(reply->readAll());
-		QJsonArray items =
-			doc.object().value(QStringLiteral("items"))
-				.toArray();
-
-		if (items.isEmpty()) {
-			blog(LOG_INFO,
-			     "[Recast Chat] YouTube: no active broadcast "
-			     "found, retrying...");
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		QJsonObject broadcast = items.first().toObject();
-		live_chat_id_ =
-			broadcast.value(QStringLiteral("snippet"))
-				.toObject()
-				.value(QStringLiteral("liveChatId"))
-				.toString();
-
-		if (live_chat_id_.isEmpty()) {
-			blog(LOG_ERROR,
-			     "[Recast Chat] YouTube: liveChatId missing");
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		blog(LOG_INFO,
-		     "[Recast Chat] YouTube connected, liveChatId=%s",
-		     live_chat_id_.toUtf8().constData());
 
-		connected_ = true;
-		emit connectionStateChanged(true);
-
-		/* Start polling */
-		next_page_token_.clear();
-		poll_timer_->start(poll_interval_ms_);
-
-		/* Do first poll immediately */
-		pollMessages();
-	});
+	connected_ = connected;
+	emit connectionStateChanged(connected);
 }
 
-void RecastYouTubeChat::pollMessages()
+void RecastYouTubeChat::onChatItems(const QJsonArray &items)
 {
-	auto *auth = RecastAuthManager::instance();
-	QString token = auth->accessToken(QStringLiteral("youtube"));
-
-	if (token.isEmpty() || live_chat_id_.isEmpty())
-		return;
-
-	QUrl url(QStringLiteral(
-		"https://www.googleapis.com/youtube/v3/liveChat/messages"));
-
-	QUrlQuery query;
-	query.addQueryItem(QStringLiteral("liveChatId"), live_chat_id_);
-	query.addQueryItem(QStringLiteral("part"),
-			   QStringLiteral("snippet,authorDetails"));
-	if (!next_page_token_.isEmpty())
-		query.addQueryItem(QStringLiteral("pageToken"),
-				   next_page_token_);
-	url.setQuery(query);
-
-	QNetworkRequest req(url);
-	req.setTransferTimeout(15000);
-	req.setRawHeader("Authorization",
-			 QStringLiteral("Bearer %1").arg(token).toUtf8());
-
-	QNetworkReply *reply = net_->get(req);
-
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-		reply->deleteLater();
-
-		if (reply->error() != QNetworkReply::NoError) {
-			blog(LOG_ERROR,
-			     "[Recast Chat] YouTube poll error: %s",
-			     reply->errorString().toUtf8().constData());
-
-			/* If 403 or similar, the broadcast may have ended */
-			int status = reply->attribute(
-				QNetworkRequest::HttpStatusCodeAttribute)
-				.toInt();
-			if (status == 403 || status == 404) {
-				disconnect();
-				reconnect_timer_->start(5000);
-			}
-			return;
-		}
-
-		QJsonDocument doc =
-			QJsonDocument::fromJson(reply->readAll());
-		QJsonObject root = doc.object();
-
-		/* Update page token */
-		next_page_token_ = root.value(
-			QStringLiteral("nextPageToken")).toString();
-
-		/* Respect polling interval from server */
-		int interval = root.value(
-			QStringLiteral("pollingIntervalMillis"))
-			.toInt(5000);
-		if (interval < 1000)
-			interval = 1000;
-		if (interval != poll_interval_ms_) {
-			poll_interval_ms_ = interval;
-			poll_timer_->setInterval(poll_interval_ms_);
-		}
-
-		/* Process messages */
-		QJsonArray items = root.value(
-			QStringLiteral("items")).toArray();
-
-		for (const QJsonValue &val : items) {
-			QJsonObject item = val.toObject();
-			QJsonObject snippet = item.value(
-				QStringLiteral("snippet")).toObject();
-			QJsonObject author = item.value(
-				QStringLiteral("authorDetails")).toObject();
-
-			/* Only handle text messages */
-			QString type = snippet.value(
-				QStringLiteral("type")).toString();
-			if (type != QStringLiteral("textMessageEvent"))
-				continue;
-
-			RecastChatMessage msg;
-			msg.platform = QStringLiteral("youtube");
-			msg.displayName = author.value(
-				QStringLiteral("displayName")).toString();
-			msg.username = author.value(
-				QStringLiteral("channelId")).toString();
-			msg.message = snippet.value(
-				QStringLiteral("textMessageDetails"))
-				.toObject()
-				.value(QStringLiteral("messageText"))
-				.toString();
-			msg.timestamp =
-				QDateTime::currentMSecsSinceEpoch();
-
-			/* Assign color based on role */
-			bool isOwner = author.value(
-				QStringLiteral("isChatOwner"))
-				.toBool();
-			bool isMod = author.value(
-				QStringLiteral("isChatModerator"))
-				.toBool();
-			bool isMember = author.value(
-				QStringLiteral("isChatSponsor"))
-				.toBool();
-
-			msg.isOwner = isOwner;
-			msg.isMod = isMod;
-			msg.isSub = isMember;
-
-			if (isOwner)
-				msg.nameColor = QColor(255, 0, 0);
-			else if (isMod)
-				msg.nameColor = QColor(90, 90, 255);
-			else if (isMember)
-				msg.nameColor = QColor(44, 166, 63);
-			else
-				msg.nameColor = QColor(255, 0, 0);
-
+	for (const QJsonValue &val : items) {
+		RecastChatMessage msg;
+		if (recast_parse_youtube_chat(val.toObject(), &msg))
 			emit messageReceived(msg);
-		}
-	});
+	}
 }
 
 /* ====================================================================
- * RecastKickChat -- Pusher WebSocket
+ * RecastKickChat -- chatroom messages via the shared Pusher hub
  * ==================================================================== */
 
 RecastKickChat::RecastKickChat(QObject *parent)
 	: RecastChatProvider(parent)
 {
-	ws_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest,
-			     this);
-	net_ = new QNetworkAccessManager(this);
-	reconnect_timer_ = new QTimer(this);
-	reconnect_timer_->setSingleShot(true);
-
-	connect(ws_, &QWebSocket::connected,
-		this, &RecastKickChat::onConnected);
-	connect(ws_, &QWebSocket::disconnected,
-		this, &RecastKickChat::onDisconnected);
-	connect(ws_, &QWebSocket::textMessageReceived,
-		this, &RecastKickChat::onTextMessageReceived);
-	connect(reconnect_timer_, &QTimer::timeout,
-		this, &RecastKickChat::onReconnectTimer);
 }
 
 RecastKickChat::~RecastKickChat()
@@ -630,21 +380,29 @@ void RecastKickChat::connectToChat(const QString &channel)
 	blog(LOG_INFO, "[Recast Chat] Kick connecting for channel '%s'",
 	     channel_slug_.toUtf8().constData());
 
-	fetchChannelInfo();
+	auto *hub = RecastKickHub::instance();
+	if (!subscribed_) {
+		connect(hub, &RecastKickHub::connectionStateChanged,
+			this, &RecastKickChat::onHubStateChanged);
+		connect(hub, &RecastKickHub::pusherEvent,
+			this, &RecastKickChat::onPusherEvent);
+		subscribed_ = true;
+	}
+	hub->subscribe(this, channel_slug_, RecastKickHub::TOPIC_CHATROOM);
+
+	onHubStateChanged(hub->isConnected());
 }
 
 void RecastKickChat::disconnect()
 {
-	reconnect_timer_->stop();
-
-	if (ws_->state() != QAbstractSocket::UnconnectedState) {
-		ws_->close();
+	if (subscribed_) {
+		subscribed_ = false;
+		auto *hub = RecastKickHub::instance();
+		QObject::disconnect(hub, nullptr, this, nullptr);
+		hub->unsubscribe(this);
 	}
 
-	if (connected_) {
-		connected_ = false;
-		emit connectionStateChanged(false);
-	}
+	onHubStateChanged(false);
 }
 
 void RecastKickChat::sendMessage(const QString &msg)
@@ -658,205 +416,22 @@ bool RecastKickChat::isConnected() const
 	return connected_;
 }
 
-void RecastKickChat::fetchChannelInfo()
+void RecastKickChat::onHubStateChanged(bool connected)
 {
-	QUrl url(QStringLiteral("https://kick.com/api/v2/channels/%1")
-		.arg(channel_slug_));
-
-	QNetworkRequest req(url);
-	req.setTransferTimeout(15000);
-	req.setRawHeader("Accept", "application/json");
-
-	QNetworkReply *reply = net_->get(req);
-
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-		reply->deleteLater();
-
-		if (reply->error() != QNetworkReply::NoError) {
-			blog(LOG_ERROR,
-			     "[Recast Chat] Kick channel info error: %s",
-			     reply->errorString().toUtf8().constData());
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		QJsonDocument doc =
-			QJsonDocument::fromJson(reply->readAll());
-		QJsonObject root = doc.object();
-
-		chatroom_id_ = root.value(QStringLiteral("chatroom"))
-			.toObject()
-			.value(QStringLiteral("id"))
-			.toInt(0);
-
-		if (chatroom_id_ == 0) {
-			blog(LOG_ERROR,
-			     "[Recast Chat] Kick: chatroom id not found "
-			     "for '%s'",
-			     channel_slug_.toUtf8().constData());
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		blog(LOG_INFO,
-		     "[Recast Chat] Kick chatroom_id=%d for '%s'",
-		     chatroom_id_,
-		     channel_slug_.toUtf8().constData());
-
-		connectPusher();
-	});
-}
-
-void RecastKickChat::connectPusher()
-{
-	QUrl url(QStringLiteral(
-		"wss://ws-us2.pusher.com/app/"
-		"32cbd69e4b950bf97679"
-		"?protocol=7&client=js&version=8.4.0-rc2&flash=false"));
-
-	ws_->open(url);
-}
-
-void RecastKickChat::onConnected()
-{
-	blog(LOG_INFO, "[Recast Chat] Kick Pusher WebSocket connected");
-	/* Wait for pusher:connection_established before subscribing */
-}
-
-void RecastKickChat::onDisconnected()
-{
-	blog(LOG_INFO, "[Recast Chat] Kick Pusher WebSocket disconnected");
-
-	if (connected_) {
-		connected_ = false;
-		emit connectionStateChanged(false);
-	}
-
-	/* Schedule reconnect */
-	if (!channel_slug_.isEmpty()) {
-		reconnect_timer_->start(5000);
-	}
-}
-
-void RecastKickChat::onTextMessageReceived(const QString &raw)
-{
-	QJsonDocument doc = QJsonDocument::fromJson(raw.toUtf8());
-	if (!doc.isObject())
+	connected = connected && subscribed_;
+	if (connected_ == connected)
 		return;
 
-	QJsonObject obj = doc.object();
-	QString event = obj.value(QStringLiteral("event")).toString();
-
-	if (event == QStringLiteral("pusher:connection_established")) {
-		/* Connection ready -- subscribe to chatroom channel */
-		blog(LOG_INFO,
-		     "[Recast Chat] Kick Pusher connection established");
-		subscribeToChatroom();
-
-	} else if (event == QStringLiteral("pusher_internal:subscription_succeeded")) {
-		blog(LOG_INFO,
-		     "[Recast Chat] Kick subscribed to chatroom %d",
-		     chatroom_id_);
-		connected_ = true;
-		emit connectionStateChanged(true);
-
-	} else if (event == QStringLiteral("pusher:ping")) {
-		/* Respond to Pusher keepalive ping */
-		QJsonObject pong;
-		pong[QStringLiteral("event")] =
-			QStringLiteral("pusher:pong");
-		pong[QStringLiteral("data")] = QJsonObject();
-		ws_->sendTextMessage(QString::fromUtf8(
-			QJsonDocument(pong).toJson(
-				QJsonDocument::Compact)));
-
-	} else if (event == QStringLiteral("App\\Events\\ChatMessageEvent")) {
-		QString data_str = obj.value(
-			QStringLiteral("data")).toString();
-		parseChatMessageEvent(data_str);
-	}
+	connected_ = connected;
+	emit connectionStateChanged(connected);
 }
 
-void RecastKickChat::onReconnectTimer()
+void RecastKickChat::onPusherEvent(const QString &event,
+				   const QJsonObject &data, int topic)
 {
-	if (!channel_slug_.isEmpty() && !connected_) {
-		blog(LOG_INFO, "[Recast Chat] Kick reconnecting...");
-		fetchChannelInfo();
-	}
-}
-
-void RecastKickChat::subscribeToChatroom()
-{
-	QString channel = QStringLiteral("chatrooms.%1.v2")
-		.arg(chatroom_id_);
-
-	QJsonObject data;
-	data[QStringLiteral("channel")] = channel;
-
-	QJsonObject msg;
-	msg[QStringLiteral("event")] =
-		QStringLiteral("pusher:subscribe");
-	msg[QStringLiteral("data")] = data;
-
-	ws_->sendTextMessage(QString::fromUtf8(
-		QJsonDocument(msg).toJson(QJsonDocument::Compact)));
-}
-
-void RecastKickChat::parseChatMessageEvent(const QString &data_str)
-{
-	/*
-	 * The data field is a JSON-encoded string that must be parsed again.
-	 * Contains: id, chatroom_id, content, created_at,
-	 *           sender { id, username, slug,
-	 *                    identity { color, badges [] } }
-	 */
-	QJsonDocument doc = QJsonDocument::fromJson(data_str.toUtf8());
-	if (!doc.isObject())
-		return;
-
-	QJsonObject root = doc.object();
-
-	RecastChatMessage msg;
-	msg.platform = QStringLiteral("kick");
-	msg.message = root.value(QStringLiteral("content")).toString();
-	msg.timestamp = QDateTime::currentMSecsSinceEpoch();
-
-	QJsonObject sender = root.value(
-		QStringLiteral("sender")).toObject();
-	msg.username = sender.value(
-		QStringLiteral("slug")).toString();
-	msg.displayName = sender.value(
-		QStringLiteral("username")).toString();
-
-	/* Identity provides color and badges */
-	QJsonObject identity = sender.value(
-		QStringLiteral("identity")).toObject();
-	QString color = identity.value(
-		QStringLiteral("color")).toString();
-	if (!color.isEmpty()) {
-		if (!color.startsWith('#'))
-			color.prepend('#');
-		msg.nameColor = QColor(color);
-	}
-	if (!msg.nameColor.isValid())
-		msg.nameColor = QColor(83, 252, 24);
-
-	/* Check badges for moderator / broadcaster / subscriber */
-	QJsonArray badges = identity.value(
-		QStringLiteral("badges")).toArray();
-	for (const QJsonValue &badge_val : badges) {
-		QJsonObject badge = badge_val.toObject();
-		QString badge_type = badge.value(
-			QStringLiteral("type")).toString();
-		if (badge_type == QStringLiteral("moderator"))
-			msg.isMod = true;
-		else if (badge_type == QStringLiteral("broadcaster"))
-			msg.isOwner = true;
-		else if (badge_type == QStringLiteral("subscriber"))
-			msg.isSub = true;
-	}
-
-	emit messageReceived(msg);
+	if (topic == RecastKickHub::TOPIC_CHATROOM &&
+	    event == QStringLiteral("App\\Events\\ChatMessageEvent"))
+		emit messageReceived(recast_parse_kick_chat(data));
 }
 
 /* ====================================================================
@@ -878,17 +453,40 @@ RecastChatDock::RecastChatDock(QWidget *parent)
 	indicators_layout_->addStretch();
 	main_layout->addWidget(indicators_widget_);
 
-	/* ---- Chat display (read-only HTML) ---- */
-	chat_display_ = new QTextBrowser;
-	chat_display_->setReadOnly(true);
-	chat_display_->setOpenExternalLinks(false);
-	chat_display_->setStyleSheet(
-		"QTextBrowser { background: #1e1e1e; color: #ddd; "
+	/* ---- Chat display (ring buffer model + painted rows) ---- */
+	chat_model_ = new RecastChatModel(MAX_MESSAGES, this);
+	chat_delegate_ = new RecastChatDelegate(chat_model_, this);
+
+	chat_view_ = new QListView;
+	chat_view_->setModel(chat_model_);
+	chat_view_->setItemDelegate(chat_delegate_);
+	chat_view_->setSelectionMode(QAbstractItemView::NoSelection);
+	chat_view_->setFocusPolicy(Qt::NoFocus);
+	chat_view_->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+	chat_view_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+	chat_view_->setResizeMode(QListView::Adjust);
+	chat_view_->setUniformItemSizes(false);
+	chat_view_->setStyleSheet(
+		"QListView { background: #1e1e1e; color: #ddd; "
 		"border: none; padding: 4px; font-size: 13px; }");
-	chat_display_->document()->setDefaultStyleSheet(
-		"body { margin: 0; padding: 0; }"
-		"a { color: #8ab4f8; }");
-	main_layout->addWidget(chat_display_, 1);
+	main_layout->addWidget(chat_view_, 1);
+
+	pending_ = std::make_unique<RecastBatchQueue<RecastChatMessage>>(
+		this, FLUSH_INTERVAL_MS, MAX_MESSAGES,
+		[this](std::vector<RecastChatMessage> &batch) {
+			flushMessages(batch);
+		});
+
+	images_timer_ = new QTimer(this);
+	images_timer_->setSingleShot(true);
+	images_timer_->setInterval(IMAGES_INTERVAL_MS);
+	connect(images_timer_, &QTimer::timeout, this,
+		&RecastChatDock::onImagesReady);
+	connect(RecastEmoteCache::instance(), &RecastEmoteCache::imageReady,
+		this, [this]() {
+			if (!images_timer_->isActive())
+				images_timer_->start();
+		});
 
 	/* ---- Input row ---- */
 	auto *input_row = new QHBoxLayout;
@@ -920,6 +518,7 @@ RecastChatDock::RecastChatDock(QWidget *parent)
 
 RecastChatDock::~RecastChatDock()
 {
+	pending_->clear();
 	providers_.clear();
 }
 
@@ -942,8 +541,7 @@ void RecastChatDock::addProvider(RecastChatProvider *provider)
 	indicator->setFixedSize(20, 20);
 
 	/* Get platform icon */
-	QIcon icon = recast_platform_icon(provider->platform());
-	indicator->setPixmap(icon.pixmap(16, 16));
+	indicator->setPixmap(recast_platform_pixmap(provider->platform(), 16));
 	indicator->setToolTip(
 		QStringLiteral("%1: Disconnected")
 			.arg(provider->platform()));
@@ -984,7 +582,7 @@ void RecastChatDock::removeProvider(RecastChatProvider *provider)
 
 void RecastChatDock::onMessageReceived(const RecastChatMessage &msg)
 {
-	appendMessage(msg);
+	pending_->push(msg);
 }
 
 void RecastChatDock::onConnectionStateChanged(bool connected)
@@ -999,71 +597,42 @@ void RecastChatDock::onSendClicked()
 	if (text.isEmpty())
 		return;
 
-	/* Send to all connected providers */
+	/* Send to all connected providers (on the network thread) */
 	for (auto *provider : providers_) {
 		if (provider->isConnected())
-			provider->sendMessage(text);
+			RecastNetwork::post(provider, [provider, text]() {
+				provider->sendMessage(text);
+			});
 	}
 
 	input_->clear();
 }
 
-void RecastChatDock::appendMessage(const RecastChatMessage &msg)
+void RecastChatDock::flushMessages(std::vector<RecastChatMessage> &batch)
 {
 	/* Check if user has scrolled up */
 	bool was_at_bottom = isScrolledToBottom();
 
-	/* Build HTML line */
-	QString pcolor = platformColor(msg.platform);
-	QString pletter = platformLetter(msg.platform);
-	QString name_color = msg.nameColor.isValid()
-		? msg.nameColor.name()
-		: QStringLiteral("#cccccc");
-
-	/* Badge indicators */
-	QString badges;
-	if (msg.isOwner)
-		badges += QStringLiteral(
-			"<span style='color:#ff4444;font-size:10px;'>"
-			"&#9733;</span> ");
-	else if (msg.isMod)
-		badges += QStringLiteral(
-			"<span style='color:#44ff44;font-size:10px;'>"
-			"&#9876;</span> ");
-
-	QString html = QStringLiteral(
-		"<span style='color:%1;font-size:10px;font-weight:bold;'>"
-		"[%2]</span> "
-		"%3"
-		"<b style='color:%4;'>%5</b>"
-		"<span style='color:#dddddd;'>: %6</span><br>")
-		.arg(pcolor,
-		     pletter,
-		     badges,
-		     name_color,
-		     escapeHtml(msg.displayName),
-		     escapeHtml(msg.message));
-
-	chat_display_->moveCursor(QTextCursor::End);
-	chat_display_->insertHtml(html);
-	message_count_++;
-
-	/* Trim old messages if over limit */
-	if (message_count_ > MAX_MESSAGES) {
-		QTextCursor cursor = chat_display_->textCursor();
-		cursor.movePosition(QTextCursor::Start);
-		cursor.movePosition(QTextCursor::Down,
-				    QTextCursor::KeepAnchor,
-				    message_count_ - MAX_MESSAGES);
-		cursor.removeSelectedText();
-		message_count_ = MAX_MESSAGES;
+	/* One insert (and at most one trim) for the whole batch */
+	{
+		RECAST_PERF_SCOPE(RECAST_PERF_CHAT_APPEND);
+		chat_model_->appendMessages(batch);
 	}
 
 	/* Auto-scroll to bottom if user was already there */
-	if (was_at_bottom) {
-		QScrollBar *sb = chat_display_->verticalScrollBar();
-		sb->setValue(sb->maximum());
-	}
+	if (was_at_bottom)
+		chat_view_->scrollToBottom();
+}
+
+void RecastChatDock::onImagesReady()
+{
+	bool was_at_bottom = isScrolledToBottom();
+
+	chat_model_->invalidatePendingImages();
+	chat_view_->viewport()->update();
+
+	if (was_at_bottom)
+		chat_view_->scrollToBottom();
 }
 
 void RecastChatDock::updateIndicator(RecastChatProvider *provider,
@@ -1090,38 +659,6 @@ void RecastChatDock::updateIndicator(RecastChatProvider *provider,
 
 bool RecastChatDock::isScrolledToBottom() const
 {
-	QScrollBar *sb = chat_display_->verticalScrollBar();
+	QScrollBar *sb = chat_view_->verticalScrollBar();
 	return sb->value() >= sb->maximum() - 10;
 }
-
-QString RecastChatDock::platformColor(const QString &platform) const
-{
-	if (platform == QStringLiteral("twitch"))
-		return QStringLiteral("#9146FF");
-	if (platform == QStringLiteral("youtube"))
-		return QStringLiteral("#FF0000");
-	if (platform == QStringLiteral("kick"))
-		return QStringLiteral("#53FC18");
-	return QStringLiteral("#888888");
-}
-
-QString RecastChatDock::platformLetter(const QString &platform) const
-{
-	if (platform == QStringLiteral("twitch"))
-		return QStringLiteral("T");
-	if (platform == QStringLiteral("youtube"))
-		return QStringLiteral("Y");
-	if (platform == QStringLiteral("kick"))
-		return QStringLiteral("K");
-	return QStringLiteral("?");
-}
-
-QString RecastChatDock::escapeHtml(const QString &text)
-{
-	QString escaped = text;
-	escaped.replace('&', QStringLiteral("&amp;"));
-	escaped.replace('<', QStringLiteral("&lt;"));
-	escaped.replace('>', QStringLiteral("&gt;"));
-	escaped.replace('"', QStringLiteral("&quot;"));
-	return escaped;
-}
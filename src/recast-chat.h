@@ -2,42 +2,41 @@
 
 #include <QObject>
 #include <QWidget>
-#include <QTextBrowser>
+#include <QListView>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QWebSocket>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
 #include <QColor>
 #include <QString>
+#include <QStringView>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
 #include <QScrollBar>
+#include <QStringList>
+#include <QUrl>
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include "recast-feed-parse.h"
+#include "recast-ui-batch.h"
+
 extern "C" {
 #include <obs.h>
 }
 
-/* ---- Chat message shared by all providers ---- */
-
-struct RecastChatMessage {
-	QString platform;    /* twitch, youtube, kick */
-	QString username;
-	QString displayName;
-	QString message;
-	QColor nameColor;
-	bool isMod = false;
-	bool isSub = false;
-	bool isOwner = false;
-	qint64 timestamp = 0;
-};
-
 /* ---- Abstract chat provider ---- */
 
+/* Providers live on the network thread (RecastNetwork); only
+ * isConnected() and platform() may be called from the UI. */
+
 class RecastChatProvider : public QObject {
 	Q_OBJECT
 
@@ -82,15 +81,12 @@ private:
 	QWebSocket *ws_ = nullptr;
 	QTimer *reconnect_timer_ = nullptr;
 	QString channel_;
-	bool connected_ = false;
+	std::atomic<bool> connected_{false};
 
-	void parseLine(const QString &line);
-	RecastChatMessage parsePrivmsg(const QString &tags,
-				       const QString &prefix,
-				       const QString &trailing);
+	void parseLine(QStringView line);
 };
 
-/* ---- YouTube Live Chat via polling ---- */
+/* ---- YouTube Live Chat via the shared liveChat poller ---- */
 
 class RecastYouTubeChat : public RecastChatProvider {
 	Q_OBJECT
@@ -105,24 +101,18 @@ public:
 	bool isConnected() const override;
 	QString platform() const override { return QStringLiteral("youtube"); }
 
-private slots:
-	void onPollTimer();
-	void onReconnectTimer();
-
 private:
-	QNetworkAccessManager *net_ = nullptr;
-	QTimer *poll_timer_ = nullptr;
-	QTimer *reconnect_timer_ = nullptr;
-	QString live_chat_id_;
-	QString next_page_token_;
-	int poll_interval_ms_ = 5000;
-	bool connected_ = false;
-
-	void fetchLiveChatId();
-	void pollMessages();
+	/* Polling is shared with the events feed (RecastYouTubeLiveChat) */
+	bool subscribed_ = false;
+	std::atomic<bool> connected_{false};
+
+	void onPollerStateChanged(bool connected);
+	void onChatItems(const QJsonArray &items);
+	void sendWithToken(const QString &msg, const QString &live_chat_id,
+			   const QString &token);
 };
 
-/* ---- Kick chat via Pusher WebSocket ---- */
+/* ---- Kick chat via the shared Pusher connection ---- */
 
 class RecastKickChat : public RecastChatProvider {
 	Q_OBJECT
@@ -137,28 +127,23 @@ public:
 	bool isConnected() const override;
 	QString platform() const override { return QStringLiteral("kick"); }
 
-private slots:
-	void onConnected();
-	void onDisconnected();
-	void onTextMessageReceived(const QString &raw);
-	void onReconnectTimer();
-
 private:
-	QWebSocket *ws_ = nullptr;
-	QNetworkAccessManager *net_ = nullptr;
-	QTimer *reconnect_timer_ = nullptr;
+	/* Socket and channel lookup are shared with the events feed
+	 * (RecastKickHub) */
 	QString channel_slug_;
-	int chatroom_id_ = 0;
-	bool connected_ = false;
+	bool subscribed_ = false;
+	std::atomic<bool> connected_{false};
 
-	void fetchChannelInfo();
-	void connectPusher();
-	void subscribeToChatroom();
-	void parseChatMessageEvent(const QString &data_str);
+	void onHubStateChanged(bool connected);
+	void onPusherEvent(const QString &event, const QJsonObject &data,
+			   int topic);
 };
 
 /* ---- Unified chat dock ---- */
 
+class RecastChatModel;
+class RecastChatDelegate;
+
 class RecastChatDock : public QWidget {
 	Q_OBJECT
 
@@ -175,7 +160,9 @@ private slots:
 	void onSendClicked();
 
 private:
-	QTextBrowser *chat_display_ = nullptr;
+	QListView *chat_view_ = nullptr;
+	RecastChatModel *chat_model_ = nullptr;
+	RecastChatDelegate *chat_delegate_ = nullptr;
 	QLineEdit *input_ = nullptr;
 	QPushButton *send_btn_ = nullptr;
 	QHBoxLayout *indicators_layout_ = nullptr;
@@ -183,14 +170,19 @@ private:
 
 	std::vector<RecastChatProvider *> providers_;
 	QMap<RecastChatProvider *, QLabel *> indicator_labels_;
-	int message_count_ = 0;
+
+	/* Arrivals are coalesced and flushed once per UI tick */
+	std::unique_ptr<RecastBatchQueue<RecastChatMessage>> pending_;
+
+	/* Emote arrivals are coalesced into one relayout */
+	QTimer *images_timer_ = nullptr;
 
 	static const int MAX_MESSAGES = 500;
+	static const int FLUSH_INTERVAL_MS = 33;
+	static const int IMAGES_INTERVAL_MS = 100;
 
-	void appendMessage(const RecastChatMessage &msg);
+	void flushMessages(std::vector<RecastChatMessage> &batch);
+	void onImagesReady();
 	void updateIndicator(RecastChatProvider *provider, bool connected);
 	bool isScrolledToBottom() const;
-	QString platformColor(const QString &platform) const;
-	QString platformLetter(const QString &platform) const;
-	static QString escapeHtml(const QString &text);
 };
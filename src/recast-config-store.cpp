@@ -0,0 +1,307 @@
+/*
+ * recast-config-store.cpp -- Debounced, sectioned config persistence.
+ */
+
+#include "recast-config-store.h"
+#include "recast-perf.h"
+
+#include <QMutexLocker>
+
+extern "C" {
+#include <obs-module.h>
+#include <util/platform.h>
+#include "recast-config.h"
+}
+
+static const int FLUSH_DELAY_MS = 500;
+
+RecastConfigStore *RecastConfigStore::instance_ = nullptr;
+
+/* ---- JSON helpers ---- */
+
+/* Object members of part's JSON, without the enclosing braces */
+static QByteArray members_json(obs_data_t *part)
+{
+	QByteArray json = QByteArray(obs_data_get_json(part)).trimmed();
+	if (json.size() < 2)
+		return QByteArray();
+	return json.mid(1, json.size() - 2).trimmed();
+}
+
+static void move_item(obs_data_t *dst, obs_data_t *src, const char *key)
+{
+	obs_data_item_t *item = obs_data_item_byname(src, key);
+	if (!item)
+		return;
+
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_OBJECT: {
+		obs_data_t *obj = obs_data_item_get_obj(item);
+		obs_data_set_obj(dst, key, obj);
+		obs_data_release(obj);
+		break;
+	}
+	case OBS_DATA_ARRAY: {
+		obs_data_array_t *arr = obs_data_item_get_array(item);
+		obs_data_set_array(dst, key, arr);
+		obs_data_array_release(arr);
+		break;
+	}
+	case OBS_DATA_STRING:
+		obs_data_set_string(dst, key, obs_data_item_get_string(item));
+		break;
+	default:
+		break;
+	}
+
+	obs_data_item_release(&item);
+	obs_data_erase(src, key);
+}
+
+/* ---- Lifecycle ---- */
+
+RecastConfigStore::RecastConfigStore(QObject *parent) : QObject(parent)
+{
+	sections_[0].key = "vertical";
+	sections_[1].key = "destinations";
+	sections_[2].key = "auth";
+	sections_[3].key = "mainwindow_state";
+
+	flush_timer_ = new QTimer(this);
+	flush_timer_->setSingleShot(true);
+	connect(flush_timer_, &QTimer::timeout, this, [this]() { flush(); });
+
+	pool_ = new QThreadPool(this);
+	pool_->setMaxThreadCount(1);
+
+	load();
+}
+
+RecastConfigStore::~RecastConfigStore()
+{
+	if (dirty_)
+		blog(LOG_WARNING,
+		     "[Recast] Config sections 0x%x changed after the last "
+		     "save and were not written",
+		     dirty_);
+
+	pool_->waitForDone();
+	for (SectionState &s : sections_)
+		obs_data_release(s.data);
+	obs_data_release(values_);
+}
+
+RecastConfigStore *RecastConfigStore::instance()
+{
+	if (!instance_)
+		instance_ = new RecastConfigStore();
+	return instance_;
+}
+
+void RecastConfigStore::destroyInstance()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+void RecastConfigStore::load()
+{
+	obs_data_t *root = nullptr;
+	char *path = recast_config_get_path();
+	if (path) {
+		root = obs_data_create_from_json_file_safe(path, "bak");
+		bfree(path);
+	}
+	if (!root)
+		root = obs_data_create();
+
+	/* Split the sections out; whatever is left are loose values */
+	for (SectionState &s : sections_) {
+		obs_data_t *part = obs_data_create();
+		move_item(part, root, s.key);
+		s.json = members_json(part);
+		s.data = part;
+	}
+	values_ = root;
+}
+
+/* ---- Sections and values ---- */
+
+void RecastConfigStore::setSerializer(Section section, Serializer fn)
+{
+	for (int i = 0; i < 4; i++) {
+		if (section == (1 << i))
+			sections_[i].serialize = std::move(fn);
+	}
+}
+
+obs_data_t *RecastConfigStore::snapshot() const
+{
+	return obs_data_create_from_json(assemble().constData());
+}
+
+obs_data_t *RecastConfigStore::section(Section section) const
+{
+	for (int i = 0; i < 4; i++) {
+		if (section == (1 << i) && sections_[i].data) {
+			obs_data_addref(sections_[i].data);
+			return sections_[i].data;
+		}
+	}
+	return nullptr;
+}
+
+QString RecastConfigStore::value(const char *key) const
+{
+	return QString::fromUtf8(obs_data_get_string(values_, key));
+}
+
+bool RecastConfigStore::hasValue(const char *key) const
+{
+	return obs_data_has_user_value(values_, key);
+}
+
+void RecastConfigStore::setValue(const char *key, const char *value)
+{
+	if (obs_data_has_user_value(values_, key) &&
+	    strcmp(obs_data_get_string(values_, key), value ? value : "") == 0)
+		return;
+
+	obs_data_set_string(values_, key, value ? value : "");
+	values_dirty_ = true;
+	scheduleFlush();
+}
+
+void RecastConfigStore::eraseValue(const char *key)
+{
+	if (!obs_data_has_user_value(values_, key))
+		return;
+
+	obs_data_erase(values_, key);
+	values_dirty_ = true;
+	scheduleFlush();
+}
+
+void RecastConfigStore::markDirty(int sections)
+{
+	dirty_ |= sections & SECTION_ALL;
+	scheduleFlush();
+}
+
+void RecastConfigStore::scheduleFlush()
+{
+	/* Not restarted on every change, so a continuous drag still
+	 * saves every FLUSH_DELAY_MS */
+	if (!flush_timer_->isActive())
+		flush_timer_->start(FLUSH_DELAY_MS);
+}
+
+/* ---- Flush ---- */
+
+QByteArray RecastConfigStore::assemble() const
+{
+	QByteArray out = "{";
+	bool first = true;
+
+	auto append = [&](const QByteArray &members) {
+		if (members.isEmpty())
+			return;
+		if (!first)
+			out += ",";
+		out += members;
+		first = false;
+	};
+
+	for (const SectionState &s : sections_)
+		append(s.json);
+	append(members_json(values_));
+
+	out += "}";
+	return out;
+}
+
+void RecastConfigStore::flush(int mask)
+{
+	int todo = dirty_ & mask;
+	if (!todo && !values_dirty_)
+		return;
+
+	RECAST_PERF_SCOPE(RECAST_PERF_CONFIG_SAVE);
+
+	for (int i = 0; i < 4; i++) {
+		SectionState &s = sections_[i];
+		if (!(todo & (1 << i)) || !s.serialize)
+			continue;
+
+		obs_data_t *part = obs_data_create();
+		s.serialize(part);
+		s.json = members_json(part);
+		obs_data_release(s.data);
+		s.data = part;
+	}
+	dirty_ &= ~todo;
+	values_dirty_ = false;
+
+	if (dirty_)
+		scheduleFlush();
+
+	char *path = recast_config_get_path();
+	if (!path)
+		return;
+
+	QMutexLocker lock(&write_mutex_);
+	pending_json_ = assemble();
+	pending_path_ = QString::fromUtf8(path);
+	bfree(path);
+
+	if (!write_queued_) {
+		write_queued_ = true;
+		pool_->start([this]() { writePending(); });
+	}
+}
+
+void RecastConfigStore::flushSync(int mask)
+{
+	flush(mask);
+	pool_->waitForDone();
+}
+
+void RecastConfigStore::writePending()
+{
+	for (;;) {
+		QByteArray json;
+		QByteArray path;
+		{
+			QMutexLocker lock(&write_mutex_);
+			if (pending_json_.isEmpty()) {
+				write_queued_ = false;
+				return;
+			}
+			json.swap(pending_json_);
+			path = pending_path_.toUtf8();
+		}
+
+		if (os_quick_write_utf8_file_safe(path.constData(),
+						  json.constData(),
+						  (size_t)json.size(), false,
+						  "tmp", "bak"))
+			blog(LOG_DEBUG, "[Recast] Config saved to %s",
+			     path.constData());
+		else
+			blog(LOG_ERROR, "[Recast] Failed to write config %s",
+			     path.constData());
+	}
+}
+
+/* ---- C API (recast-config.h) ---- */
+
+extern "C" char *recast_config_get_value(const char *key)
+{
+	QByteArray v = RecastConfigStore::instance()->value(key).toUtf8();
+	return bstrdup(v.constData());
+}
+
+extern "C" void recast_config_set_value(const char *key, const char *value)
+{
+	RecastConfigStore::instance()->setValue(key, value);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <functional>
+
+extern "C" {
+#include <obs.h>
+}
+
+/*
+ * RecastConfigStore -- Debounced, sectioned writer for recast-outputs.json.
+ *
+ * The file is split into sections (vertical canvas, destinations, auth,
+ * window state) plus loose top-level values. Each section keeps the
+ * JSON it was last serialized to; markDirty() only schedules the
+ * sections that actually changed, and the next flush re-serializes just
+ * those before stitching the cached pieces into one document. The
+ * parsed object of each section is kept alongside, so startup reads the
+ * file once and every consumer shares that parse.
+ *
+ * Changes are coalesced for FLUSH_DELAY_MS, then the file is written on
+ * a background thread via a temp file + rename, keeping a .bak of the
+ * previous version; loading falls back to the .bak if the main file is
+ * unreadable.
+ *
+ * UI thread only, except for the internal writer.
+ */
+class RecastConfigStore : public QObject {
+	Q_OBJECT
+
+public:
+	enum Section {
+		SECTION_VERTICAL = 1 << 0,     /* "vertical" */
+		SECTION_DESTINATIONS = 1 << 1, /* "destinations" */
+		SECTION_AUTH = 1 << 2,         /* "auth" */
+		SECTION_WINDOW = 1 << 3,       /* "mainwindow_state" */
+		SECTION_ALL = 0xf,
+	};
+
+	/* Writes the section's keys into part (a fresh object) */
+	using Serializer = std::function<void(obs_data_t *part)>;
+
+	static RecastConfigStore *instance();
+	static void destroyInstance();
+
+	void setSerializer(Section section, Serializer fn);
+
+	/* Whole config as loaded/last scheduled, re-parsed on every call
+	 * (migration only). Caller releases. */
+	obs_data_t *snapshot() const;
+
+	/* The section's keys (e.g. {"vertical": {...}}) as loaded/last
+	 * serialized. Shared, do not modify; caller releases. */
+	obs_data_t *section(Section section) const;
+
+	/* Loose top-level values ("server_token", "server_url", ...) */
+	QString value(const char *key) const;
+	bool hasValue(const char *key) const;
+	void setValue(const char *key, const char *value);
+	void eraseValue(const char *key);
+
+	void markDirty(int sections);
+
+	/* Serialize the dirty sections in mask now and queue the write */
+	void flush(int mask = SECTION_ALL);
+
+	/* flush() and wait until the file is on disk */
+	void flushSync(int mask = SECTION_ALL);
+
+	int dirtySections() const { return dirty_; }
+
+private:
+	explicit RecastConfigStore(QObject *parent = nullptr);
+	~RecastConfigStore();
+
+	static RecastConfigStore *instance_;
+
+	struct SectionState {
+		const char *key;
+		Serializer serialize;
+		QByteArray json; /* members only, without the outer braces */
+		obs_data_t *data = nullptr; /* json, parsed */
+	};
+
+	SectionState sections_[4];
+	obs_data_t *values_ = nullptr;
+	int dirty_ = 0;
+	bool values_dirty_ = false;
+	QTimer *flush_timer_;
+
+	/* Writer: only the newest document is kept if writes back up */
+	QThreadPool *pool_;
+	QMutex write_mutex_;
+	QByteArray pending_json_;
+	QString pending_path_;
+	bool write_queued_ = false;
+
+	void load();
+	void scheduleFlush();
+	QByteArray assemble() const;
+	void writePending();
+};
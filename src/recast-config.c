@@ -29,49 +29,17 @@ char *recast_config_get_path(void)
 	return path.array; /* caller must bfree() */
 }
 
-static obs_data_t *load_root(void)
-{
-	char *path = recast_config_get_path();
-	if (!path)
-		return NULL;
-
-	obs_data_t *root = obs_data_create_from_json_file(path);
-	bfree(path);
-	return root;
-}
-
 /* ---- Server token ---- */
 
 char *recast_config_get_server_token(void)
 {
-	obs_data_t *root = load_root();
-	if (!root)
-		return bstrdup("");
-
-	const char *token = obs_data_get_string(root, "server_token");
-	char *result = bstrdup(token ? token : "");
-	obs_data_release(root);
-	return result;
+	return recast_config_get_value("server_token");
 }
 
 bool recast_config_set_server_token(const char *token)
 {
-	obs_data_t *root = load_root();
-	if (!root)
-		root = obs_data_create();
-
-	obs_data_set_string(root, "server_token", token ? token : "");
-
-	char *path = recast_config_get_path();
-	if (!path) {
-		obs_data_release(root);
-		return false;
-	}
-
-	bool ok = obs_data_save_json(root, path);
-	bfree(path);
-	obs_data_release(root);
-	return ok;
+	recast_config_set_value("server_token", token ? token : "");
+	return true;
 }
 
 /* ---- Scene model persistence ---- */
@@ -180,10 +148,27 @@ obs_data_t *recast_config_save_scene_model(
 			obs_data_set_string(scene_data, "linked_main_scene",
 					    e->linked_main_scene);
 
-		/* Scene items */
-		obs_data_array_t *items_arr = obs_data_array_create();
+		/* Crop-from-main window */
+		if (e->crop_w > 0.0f) {
+			obs_data_t *crop = obs_data_create();
+			obs_data_set_double(crop, "x", e->crop_x);
+			obs_data_set_double(crop, "y", e->crop_y);
+			obs_data_set_double(crop, "w", e->crop_w);
+			obs_data_set_obj(scene_data, "crop", crop);
+			obs_data_release(crop);
+		}
+
+		/* Scene items; a scene never shown keeps its loaded array */
+		obs_data_array_t *items_arr;
 
-		if (e->scene) {
+		if (e->pending_items) {
+			items_arr = e->pending_items;
+			obs_data_array_addref(items_arr);
+		} else {
+			items_arr = obs_data_array_create();
+		}
+
+		if (e->scene && !e->pending_items) {
 			struct save_items_ctx ctx;
 			ctx.items_arr = items_arr;
 			obs_scene_enum_items(e->scene, save_items_callback,
@@ -207,6 +192,70 @@ obs_data_t *recast_config_save_scene_model(
 	return d;
 }
 
+/* ---- Scene items ---- */
+
+static void load_scene_item(obs_scene_t *scene, obs_data_t *item_data)
+{
+	const char *src_name = obs_data_get_string(item_data, "source_name");
+	bool is_existing = obs_data_get_bool(item_data, "is_existing");
+
+	obs_source_t *src = NULL;
+
+	/* Try to find existing source first */
+	if (is_existing)
+		src = obs_get_source_by_name(src_name);
+
+	/* Fallback: create from saved type/settings */
+	if (!src) {
+		const char *src_type =
+			obs_data_get_string(item_data, "source_type");
+		obs_data_t *src_settings =
+			obs_data_get_obj(item_data, "source_settings");
+
+		blog(LOG_INFO,
+		     "[Recast] Creating source '%s' type='%s' "
+		     "(was_existing=%d)",
+		     src_name, src_type ? src_type : "(null)", is_existing);
+
+		if (src_type && *src_type)
+			src = obs_source_create(src_type, src_name,
+						src_settings, NULL);
+		obs_data_release(src_settings);
+	}
+
+	if (!src)
+		return;
+
+	obs_sceneitem_t *si = obs_scene_add(scene, src);
+	if (si) {
+		obs_sceneitem_set_visible(si, obs_data_get_bool(item_data,
+								"visible"));
+
+		struct vec2 pos;
+		pos.x = (float)obs_data_get_double(item_data, "pos_x");
+		pos.y = (float)obs_data_get_double(item_data, "pos_y");
+		obs_sceneitem_set_pos(si, &pos);
+
+		struct vec2 scale;
+		scale.x = (float)obs_data_get_double(item_data, "scale_x");
+		scale.y = (float)obs_data_get_double(item_data, "scale_y");
+		if (scale.x > 0.0f && scale.y > 0.0f)
+			obs_sceneitem_set_scale(si, &scale);
+
+		obs_sceneitem_set_rot(
+			si, (float)obs_data_get_double(item_data, "rotation"));
+
+		struct obs_sceneitem_crop crop;
+		crop.left = (int)obs_data_get_int(item_data, "crop_left");
+		crop.right = (int)obs_data_get_int(item_data, "crop_right");
+		crop.top = (int)obs_data_get_int(item_data, "crop_top");
+		crop.bottom = (int)obs_data_get_int(item_data, "crop_bottom");
+		obs_sceneitem_set_crop(si, &crop);
+	}
+
+	obs_source_release(src);
+}
+
 recast_scene_model_t *recast_config_load_scene_model(obs_data_t *data)
 {
 	if (!data)
@@ -233,8 +282,6 @@ recast_scene_model_t *recast_config_load_scene_model(obs_data_t *data)
 			continue;
 		}
 
-		obs_scene_t *scene = model->scenes[scene_idx].scene;
-
 		/* Load scene link */
 		const char *linked =
 			obs_data_get_string(scene_data, "linked_main_scene");
@@ -243,118 +290,21 @@ recast_scene_model_t *recast_config_load_scene_model(obs_data_t *data)
 						      linked);
 		}
 
-		/* Load scene items */
-		obs_data_array_t *items_arr =
-			obs_data_get_array(scene_data, "items");
-		if (items_arr) {
-			size_t item_count = obs_data_array_count(items_arr);
-			blog(LOG_INFO,
-			     "[Recast] Loading %zu items for scene '%s'",
-			     item_count, scene_name);
-			for (size_t j = 0; j < item_count; j++) {
-				obs_data_t *item_data =
-					obs_data_array_item(items_arr, j);
-
-				const char *src_name = obs_data_get_string(
-					item_data, "source_name");
-				bool is_existing = obs_data_get_bool(
-					item_data, "is_existing");
-
-				obs_source_t *src = NULL;
-
-				/* Try to find existing source first */
-				if (is_existing)
-					src = obs_get_source_by_name(src_name);
-
-				/* Fallback: create from saved type/settings */
-				if (!src) {
-					const char *src_type =
-						obs_data_get_string(
-							item_data,
-							"source_type");
-					obs_data_t *src_settings =
-						obs_data_get_obj(
-							item_data,
-							"source_settings");
-
-					blog(LOG_INFO,
-					     "[Recast] Creating source '%s' "
-					     "type='%s' (was_existing=%d)",
-					     src_name,
-					     src_type ? src_type : "(null)",
-					     is_existing);
-
-					if (src_type && *src_type) {
-						src = obs_source_create(
-							src_type, src_name,
-							src_settings, NULL);
-					}
-					obs_data_release(src_settings);
-				}
-
-				if (src) {
-					obs_sceneitem_t *si =
-						obs_scene_add(scene, src);
-
-					if (si) {
-						obs_sceneitem_set_visible(
-							si,
-							obs_data_get_bool(
-								item_data,
-								"visible"));
-
-						struct vec2 pos;
-						pos.x = (float)obs_data_get_double(
-							item_data, "pos_x");
-						pos.y = (float)obs_data_get_double(
-							item_data, "pos_y");
-						obs_sceneitem_set_pos(si, &pos);
-
-						struct vec2 scale;
-						scale.x = (float)obs_data_get_double(
-							item_data, "scale_x");
-						scale.y = (float)obs_data_get_double(
-							item_data, "scale_y");
-						if (scale.x > 0.0f &&
-						    scale.y > 0.0f)
-							obs_sceneitem_set_scale(
-								si, &scale);
-
-						float rot =
-							(float)obs_data_get_double(
-								item_data,
-								"rotation");
-						obs_sceneitem_set_rot(si, rot);
-
-						struct obs_sceneitem_crop crop;
-						crop.left =
-							(int)obs_data_get_int(
-								item_data,
-								"crop_left");
-						crop.right =
-							(int)obs_data_get_int(
-								item_data,
-								"crop_right");
-						crop.top =
-							(int)obs_data_get_int(
-								item_data,
-								"crop_top");
-						crop.bottom =
-							(int)obs_data_get_int(
-								item_data,
-								"crop_bottom");
-						obs_sceneitem_set_crop(si,
-								       &crop);
-					}
-
-					obs_source_release(src);
-				}
-
-				obs_data_release(item_data);
-			}
-			obs_data_array_release(items_arr);
+		obs_data_t *crop = obs_data_get_obj(scene_data, "crop");
+		if (crop) {
+			recast_scene_model_set_crop(
+				model, scene_idx,
+				(float)obs_data_get_double(crop, "x"),
+				(float)obs_data_get_double(crop, "y"),
+				(float)obs_data_get_double(crop, "w"));
+			obs_data_release(crop);
 		}
 
+		/* Items are instantiated on first use, see
+		 * recast_config_load_scene_items() */
+		model->scenes[scene_idx].pending_items =
+			obs_data_get_array(scene_data, "items");
+
 		obs_data_release(scene_data);
 	}
 
@@ -366,7 +316,31 @@ recast_scene_model_t *recast_config_load_scene_model(obs_data_t *data)
 		if (idx >= 0)
 			recast_scene_model_set_active(model, idx);
 	}
+	recast_config_load_scene_items(model, model->active_scene_idx);
 
 	obs_data_array_release(scenes_arr);
 	return model;
 }
+
+bool recast_config_load_scene_items(recast_scene_model_t *model, int idx)
+{
+	if (!model || idx < 0 || idx >= model->scene_count)
+		return false;
+
+	recast_scene_entry_t *e = &model->scenes[idx];
+	if (!e->pending_items)
+		return false;
+
+	size_t item_count = obs_data_array_count(e->pending_items);
+	blog(LOG_INFO, "[Recast] Loading %zu items for scene '%s'",
+	     item_count, e->name);
+	for (size_t j = 0; j < item_count; j++) {
+		obs_data_t *item_data = obs_data_array_item(e->pending_items, j);
+		load_scene_item(e->scene, item_data);
+		obs_data_release(item_data);
+	}
+
+	obs_data_array_release(e->pending_items);
+	e->pending_items = NULL;
+	return true;
+}
@@ -20,13 +20,19 @@ extern "C" {
  *   },
  *   "destinations": [
  *     { "id": "...", "name": "Twitch", "url": "rtmp://...", "key": "...",
- *       "canvas": "main", "autoStart": true, "autoStop": true }
+ *       "canvas": "main", "autoStart": true, "autoStop": true,
+ *       "videoEncoder": { "codec": "h264", "encoderId": "",
+ *                         "bitrate": 4000, "rateControl": "CBR",
+ *                         "keyintSec": 2 } }
  *   ],
  *   "server_token": ""
  * }
  *
  * Old format (v2) is detected by presence of "outputs" key with
  * "usePrivateScenes" and automatically migrated.
+ *
+ * Writes go through RecastConfigStore (recast-config-store.h), which
+ * batches them and saves the file off the UI thread.
  */
 
 /* Load the stored Recast server auth token (empty string if unset). Caller
@@ -39,6 +45,11 @@ bool recast_config_set_server_token(const char *token);
 /* Convenience: get full path to the config file. Caller must bfree(). */
 char *recast_config_get_path(void);
 
+/* Top-level string values held by the config store (UI thread). get
+ * returns "" if unset; caller must bfree(). set schedules a save. */
+char *recast_config_get_value(const char *key);
+void recast_config_set_value(const char *key, const char *value);
+
 /* Save a scene model's scenes + items into an obs_data_t object.
  * The returned obs_data_t must be released by the caller. */
 obs_data_t *recast_config_save_scene_model(
@@ -49,6 +60,12 @@ obs_data_t *recast_config_save_scene_model(
  * recast_scene_model_destroy(). */
 struct recast_scene_model *recast_config_load_scene_model(obs_data_t *data);
 
+/* Only the active scene's items are created by the loader; the others
+ * stay in scenes[idx].pending_items until this is called. Returns true
+ * if items were instantiated, false if the scene was already loaded. */
+bool recast_config_load_scene_items(struct recast_scene_model *model,
+				    int idx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,365 @@
+/*
+ * recast-emote-cache.cpp -- Emote/badge image loading and caching.
+ */
+
+#include "recast-emote-cache.h"
+#include "recast-auth.h"
+#include "recast-network.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QImageReader>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QUrlQuery>
+
+#include <limits>
+
+extern "C" {
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+}
+
+/* Emotes are drawn at text height; keep a 2x-4x margin for HiDPI */
+static const int MAX_DECODE_HEIGHT = 112;
+static const int DISK_MAX_AGE_DAYS = 30;
+static const qint64 RETRY_FAILED_MS = 60 * 1000; /* after network errors */
+
+static const char *TWITCH_BADGES_API = "https://api.twitch.tv/helix/chat/badges";
+
+RecastEmoteCache *RecastEmoteCache::instance_ = nullptr;
+
+/* ---- Lifecycle ---- */
+
+RecastEmoteCache::RecastEmoteCache(QObject *parent) : QObject(parent)
+{
+	pool_ = new QThreadPool(this);
+	pool_->setMaxThreadCount(2);
+
+	images_.setMaxCost(MAX_COST_BYTES);
+
+	char *profile_dir = obs_frontend_get_current_profile_path();
+	if (profile_dir) {
+		disk_dir_ = QString::fromUtf8(profile_dir) +
+			    QStringLiteral("/recast-emote-cache");
+		bfree(profile_dir);
+		if (!QDir().mkpath(disk_dir_)) {
+			blog(LOG_WARNING,
+			     "[Recast Chat] Cannot create emote cache dir %s",
+			     disk_dir_.toUtf8().constData());
+			disk_dir_.clear();
+		}
+	}
+
+	pruneDisk();
+}
+
+RecastEmoteCache::~RecastEmoteCache()
+{
+	pool_->clear();
+	pool_->waitForDone();
+}
+
+RecastEmoteCache *RecastEmoteCache::instance()
+{
+	if (!instance_)
+		instance_ = new RecastEmoteCache();
+	return instance_;
+}
+
+void RecastEmoteCache::destroyInstance()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+/* ---- URLs ---- */
+
+QUrl RecastEmoteCache::twitchBadgeUrl(const QString &badge) const
+{
+	auto it = channel_badges_.constFind(badge);
+	if (it != channel_badges_.constEnd())
+		return it.value();
+	return global_badges_.value(badge);
+}
+
+/* ---- Lookup ---- */
+
+QString RecastEmoteCache::diskPath(const QString &key) const
+{
+	if (disk_dir_.isEmpty())
+		return QString();
+
+	QByteArray hash = QCryptographicHash::hash(key.toUtf8(),
+						   QCryptographicHash::Sha1);
+	return disk_dir_ + QLatin1Char('/') +
+	       QString::fromLatin1(hash.toHex()) + QStringLiteral(".img");
+}
+
+const QPixmap *RecastEmoteCache::image(const QString &key, const QUrl &url,
+				       bool *pending)
+{
+	if (pending)
+		*pending = false;
+
+	if (const QPixmap *pm = images_.object(key))
+		return pm;
+	auto failed = failed_.constFind(key);
+	if (failed != failed_.constEnd()) {
+		if (QDateTime::currentMSecsSinceEpoch() < failed.value())
+			return nullptr;
+		failed_.erase(failed);
+	}
+	if (!url.isValid() && !in_flight_.contains(key))
+		return nullptr;
+
+	if (pending)
+		*pending = true;
+	if (in_flight_.contains(key))
+		return nullptr;
+	in_flight_.insert(key);
+
+	/* Disk first (on the pool); fall back to the network */
+	QString path = diskPath(key);
+	if (path.isEmpty()) {
+		download(key, url);
+		return nullptr;
+	}
+
+	pool_->start([this, key, url, path]() {
+		QFile file(path);
+		QByteArray data;
+		if (file.open(QIODevice::ReadOnly)) {
+			data = file.readAll();
+			file.close();
+			/* Keep recently used files out of the age prune */
+			if (file.open(QIODevice::ReadWrite)) {
+				file.setFileTime(QDateTime::currentDateTime(),
+						 QFileDevice::FileModificationTime);
+				file.close();
+			}
+		}
+
+		QImage img;
+		if (!data.isEmpty()) {
+			QBuffer buf(&data);
+			QImageReader reader(&buf);
+			img = reader.read();
+		}
+
+		if (img.isNull()) {
+			QMetaObject::invokeMethod(
+				this, [this, key, url]() { download(key, url); },
+				Qt::QueuedConnection);
+			return;
+		}
+
+		if (img.height() > MAX_DECODE_HEIGHT)
+			img = img.scaledToHeight(MAX_DECODE_HEIGHT,
+						 Qt::SmoothTransformation);
+		img = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+		QMetaObject::invokeMethod(
+			this, [this, key, img]() { finish(key, img); },
+			Qt::QueuedConnection);
+	});
+	return nullptr;
+}
+
+/* ---- Loading ---- */
+
+void RecastEmoteCache::download(const QString &key, const QUrl &url)
+{
+	QNetworkRequest req(url);
+	req.setTransferTimeout(15000);
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
+
+	connect(reply, &QNetworkReply::finished, this, [this, reply, key]() {
+		reply->deleteLater();
+		if (reply->error() != QNetworkReply::NoError) {
+			blog(LOG_DEBUG,
+			     "[Recast Chat] Emote %s failed to load: %s",
+			     key.toUtf8().constData(),
+			     reply->errorString().toUtf8().constData());
+			int status = reply->attribute(
+				QNetworkRequest::HttpStatusCodeAttribute).toInt();
+			finish(key, QImage(), status == 404 || status == 410);
+			return;
+		}
+		decode(key, reply->readAll(), diskPath(key));
+	});
+}
+
+void RecastEmoteCache::decode(const QString &key, const QByteArray &data,
+			      const QString &save_path)
+{
+	pool_->start([this, key, data, save_path]() {
+		QByteArray bytes = data;
+		QBuffer buf(&bytes);
+		QImageReader reader(&buf);
+		QImage img = reader.read();
+
+		if (!img.isNull()) {
+			/* Cache the original bytes; the decode is redone per run */
+			if (!save_path.isEmpty()) {
+				QSaveFile file(save_path);
+				if (file.open(QIODevice::WriteOnly)) {
+					file.write(data);
+					file.commit();
+				}
+			}
+
+			if (img.height() > MAX_DECODE_HEIGHT)
+				img = img.scaledToHeight(
+					MAX_DECODE_HEIGHT,
+					Qt::SmoothTransformation);
+			img = img.convertToFormat(
+				QImage::Format_ARGB32_Premultiplied);
+		}
+
+		QMetaObject::invokeMethod(
+			this, [this, key, img]() { finish(key, img); },
+			Qt::QueuedConnection);
+	});
+}
+
+void RecastEmoteCache::finish(const QString &key, const QImage &img,
+			      bool permanent)
+{
+	in_flight_.remove(key);
+
+	if (img.isNull()) {
+		qint64 retry_at =
+			permanent ? std::numeric_limits<qint64>::max()
+				  : QDateTime::currentMSecsSinceEpoch() +
+					    RETRY_FAILED_MS;
+		failed_.insert(key, retry_at);
+		return;
+	}
+
+	auto *pm = new QPixmap(QPixmap::fromImage(img));
+	int cost = qMax(1, pm->width() * pm->height() * 4);
+	images_.insert(key, pm, cost);
+	emit imageReady(key);
+}
+
+void RecastEmoteCache::pruneDisk()
+{
+	if (disk_dir_.isEmpty())
+		return;
+
+	QString dir = disk_dir_;
+	pool_->start([dir]() {
+		QDateTime cutoff =
+			QDateTime::currentDateTime().addDays(-DISK_MAX_AGE_DAYS);
+		QDirIterator it(dir, {QStringLiteral("*.img")}, QDir::Files);
+		while (it.hasNext()) {
+			it.next();
+			if (it.fileInfo().lastModified() < cutoff)
+				QFile::remove(it.filePath());
+		}
+	});
+}
+
+/* ---- Twitch badge sets ---- */
+
+void RecastEmoteCache::loadTwitchBadges(const QString &room_id)
+{
+	if (!global_badges_loaded_) {
+		global_badges_loaded_ = true;
+		fetchBadgeSet(QUrl(QString::fromUtf8(TWITCH_BADGES_API) +
+				   QStringLiteral("/global")),
+			      QString());
+	}
+
+	if (room_id.isEmpty() || room_id == badge_room_)
+		return;
+
+	badge_room_ = room_id;
+	channel_badges_.clear();
+
+	QUrl url(QString::fromUtf8(TWITCH_BADGES_API));
+	QUrlQuery query;
+	query.addQueryItem(QStringLiteral("broadcaster_id"), room_id);
+	url.setQuery(query);
+	fetchBadgeSet(url, room_id);
+}
+
+void RecastEmoteCache::fetchBadgeSet(const QUrl &url, const QString &room_id)
+{
+	RecastAuthManager::instance()->withAccessToken(
+		QStringLiteral("twitch"), this,
+		[this, url, room_id](const QString &token) {
+			requestBadgeSet(url, room_id, token);
+		});
+}
+
+void RecastEmoteCache::requestBadgeSet(const QUrl &url, const QString &room_id,
+				       const QString &token)
+{
+	auto *auth = RecastAuthManager::instance();
+	QString client_id = auth->clientId(QStringLiteral("twitch"));
+	if (token.isEmpty() || client_id.isEmpty()) {
+		if (room_id.isEmpty())
+			global_badges_loaded_ = false;
+		return;
+	}
+
+	QNetworkRequest req(url);
+	req.setTransferTimeout(15000);
+	req.setRawHeader("Authorization", ("Bearer " + token).toUtf8());
+	req.setRawHeader("Client-Id", client_id.toUtf8());
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
+
+	connect(reply, &QNetworkReply::finished, this, [this, reply, room_id]() {
+		reply->deleteLater();
+		if (reply->error() != QNetworkReply::NoError) {
+			blog(LOG_WARNING,
+			     "[Recast Chat] Failed to fetch Twitch badges: %s",
+			     reply->errorString().toUtf8().constData());
+			RecastAuthManager::instance()->handleUnauthorized(
+				QStringLiteral("twitch"), reply);
+			if (room_id.isEmpty())
+				global_badges_loaded_ = false;
+			return;
+		}
+
+		/* Channel switched while the request was out */
+		if (!room_id.isEmpty() && room_id != badge_room_)
+			return;
+
+		QHash<QString, QUrl> &out =
+			room_id.isEmpty() ? global_badges_ : channel_badges_;
+
+		/* data: [ { set_id, versions: [ { id, image_url_2x } ] } ] */
+		QJsonArray sets = QJsonDocument::fromJson(reply->readAll())
+					  .object()
+					  .value(QStringLiteral("data"))
+					  .toArray();
+		for (const QJsonValue &set_val : sets) {
+			QJsonObject set = set_val.toObject();
+			QString set_id =
+				set.value(QStringLiteral("set_id")).toString();
+			QJsonArray versions =
+				set.value(QStringLiteral("versions")).toArray();
+			for (const QJsonValue &ver_val : versions) {
+				QJsonObject ver = ver_val.toObject();
+				out.insert(set_id + QLatin1Char('/') +
+						   ver.value(QStringLiteral("id"))
+							   .toString(),
+					   QUrl(ver.value(QStringLiteral(
+								  "image_url_2x"))
+							.toString()));
+			}
+		}
+
+		blog(LOG_INFO, "[Recast Chat] Loaded %d Twitch %s badges",
+		     (int)out.size(), room_id.isEmpty() ? "global" : "channel");
+	});
+}
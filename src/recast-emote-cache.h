@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QNetworkReply>
+#include <QPixmap>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QUrl>
+
+/*
+ * RecastEmoteCache -- Emote and badge images for the chat dock.
+ *
+ * Images are keyed by a platform-qualified id ("twitch:25",
+ * "kick:37226", "twitch-badge:subscriber/12"). A miss starts one load
+ * per key no matter how many rows ask for it: the worker pool first
+ * tries the on-disk copy under <profile>/recast-emote-cache, otherwise
+ * the image is downloaded through the cache's network manager, written
+ * to disk and decoded on the pool. Finished images are uploaded to a
+ * QPixmap on the UI thread and kept in an LRU bounded by MAX_COST_BYTES;
+ * imageReady() tells the views to relayout rows that were waiting.
+ *
+ * Twitch badge URLs are resolved from the Helix badge sets, fetched
+ * once globally and once per channel (room-id).
+ *
+ * UI thread only.
+ */
+class RecastEmoteCache : public QObject {
+	Q_OBJECT
+
+public:
+	static RecastEmoteCache *instance();
+	static void destroyInstance();
+
+	/* The cached image, or nullptr while it is loading (*pending set)
+	 * or after it failed to load (*pending cleared). A network error
+	 * is retried on a later call after a backoff; a 404 or an image
+	 * that does not decode is not. */
+	const QPixmap *image(const QString &key, const QUrl &url,
+			     bool *pending = nullptr);
+
+	/* Badge image URL for a Twitch "set/version", empty if unknown */
+	QUrl twitchBadgeUrl(const QString &badge) const;
+	void loadTwitchBadges(const QString &room_id);
+
+signals:
+	void imageReady(const QString &key);
+
+private:
+	explicit RecastEmoteCache(QObject *parent = nullptr);
+	~RecastEmoteCache();
+
+	static RecastEmoteCache *instance_;
+
+	static const int MAX_COST_BYTES = 32 * 1024 * 1024;
+
+	QThreadPool *pool_;
+	QString disk_dir_;
+
+	QCache<QString, QPixmap> images_;
+	QSet<QString> in_flight_;
+	QHash<QString, qint64> failed_; /* key -> ms to retry at */
+
+	QHash<QString, QUrl> global_badges_;
+	QHash<QString, QUrl> channel_badges_;
+	QString badge_room_;
+	bool global_badges_loaded_ = false;
+
+	QString diskPath(const QString &key) const;
+	void download(const QString &key, const QUrl &url);
+	void decode(const QString &key, const QByteArray &data,
+		    const QString &save_path);
+	void finish(const QString &key, const QImage &img,
+		    bool permanent = true);
+	void fetchBadgeSet(const QUrl &url, const QString &room_id);
+	void requestBadgeSet(const QUrl &url, const QString &room_id,
+			     const QString &token);
+	void pruneDisk();
+};
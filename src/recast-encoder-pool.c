@@ -0,0 +1,398 @@
+/*
+ * recast-encoder-pool.c -- Settings-keyed shared video encoders.
+ *
+ * Each pool entry owns one obs_encoder_t bound to a video pipeline and
+ * counts the destinations using it. Lookups are linear: a pool holds a
+ * handful of entries at most.
+ */
+
+#include "recast-encoder-pool.h"
+
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <string.h>
+
+struct pool_entry {
+	recast_encoder_settings_t key; /* encoder_id always resolved */
+	video_t *video;
+	obs_encoder_t *encoder;
+	int refs;
+	bool exclusive; /* one user, never handed out by acquire */
+};
+
+struct recast_encoder_pool {
+	char *name_prefix;
+	DARRAY(struct pool_entry) entries;
+	uint32_t serial;
+};
+
+/* ---- Settings ---- */
+
+static void copy_str(char *dst, size_t size, const char *src)
+{
+	if (!src)
+		src = "";
+	strncpy(dst, src, size - 1);
+	dst[size - 1] = 0;
+}
+
+void recast_encoder_settings_init(recast_encoder_settings_t *s)
+{
+	memset(s, 0, sizeof(*s));
+	copy_str(s->codec, sizeof(s->codec), "h264");
+	copy_str(s->rate_control, sizeof(s->rate_control), "CBR");
+	s->bitrate = 4000;
+	s->keyint_sec = 2;
+}
+
+void recast_encoder_settings_load(recast_encoder_settings_t *s,
+				  obs_data_t *data)
+{
+	recast_encoder_settings_init(s);
+	if (!data)
+		return;
+
+	const char *codec = obs_data_get_string(data, "codec");
+	if (codec && *codec)
+		copy_str(s->codec, sizeof(s->codec), codec);
+	copy_str(s->encoder_id, sizeof(s->encoder_id),
+		 obs_data_get_string(data, "encoderId"));
+	const char *rc = obs_data_get_string(data, "rateControl");
+	if (rc && *rc)
+		copy_str(s->rate_control, sizeof(s->rate_control), rc);
+
+	int bitrate = (int)obs_data_get_int(data, "bitrate");
+	if (bitrate > 0)
+		s->bitrate = bitrate;
+	int keyint = (int)obs_data_get_int(data, "keyintSec");
+	if (keyint > 0)
+		s->keyint_sec = keyint;
+
+	int sw = (int)obs_data_get_int(data, "scaledWidth");
+	int sh = (int)obs_data_get_int(data, "scaledHeight");
+	if (sw > 0 && sh > 0) {
+		s->scaled_width = sw;
+		s->scaled_height = sh;
+	}
+}
+
+void recast_encoder_settings_save(const recast_encoder_settings_t *s,
+				  obs_data_t *data)
+{
+	obs_data_set_string(data, "codec", s->codec);
+	obs_data_set_string(data, "encoderId", s->encoder_id);
+	obs_data_set_int(data, "bitrate", s->bitrate);
+	obs_data_set_string(data, "rateControl", s->rate_control);
+	obs_data_set_int(data, "keyintSec", s->keyint_sec);
+	obs_data_set_int(data, "scaledWidth", s->scaled_width);
+	obs_data_set_int(data, "scaledHeight", s->scaled_height);
+}
+
+/* ---- Encoder selection ---- */
+
+/* Preferred encoders per codec, best first. Hardware encoders only
+ * register when the GPU/driver supports them, so the first registered
+ * id in the list is usable. */
+static const char *h264_preference[] = {
+	"obs_nvenc_h264_tex",
+	"jim_nvenc",
+	"obs_nvenc_h264_cuda",
+	"obs_qsv11_v2",
+	"obs_qsv11",
+	"h264_texture_amf",
+	"amd_amf_h264",
+	"com.apple.videotoolbox.videoencoder.ave.avc",
+	"obs_x264",
+	NULL,
+};
+
+static const char *hevc_preference[] = {
+	"obs_nvenc_hevc_tex",
+	"jim_hevc_nvenc",
+	"obs_qsv11_hevc",
+	"h265_texture_amf",
+	"amd_amf_h265",
+	"com.apple.videotoolbox.videoencoder.ave.hevc",
+	NULL,
+};
+
+static const char *av1_preference[] = {
+	"obs_nvenc_av1_tex",
+	"jim_av1_nvenc",
+	"obs_qsv11_av1",
+	"av1_texture_amf",
+	"ffmpeg_svt_av1",
+	"ffmpeg_aom_av1",
+	NULL,
+};
+
+static bool encoder_usable(const char *id, const char *codec)
+{
+	const char *type_id;
+	for (size_t i = 0; obs_enum_encoder_types(i, &type_id); i++) {
+		if (strcmp(type_id, id) != 0)
+			continue;
+		if (obs_get_encoder_type(type_id) != OBS_ENCODER_VIDEO)
+			return false;
+		uint32_t caps = obs_get_encoder_caps(type_id);
+		if (caps & (OBS_ENCODER_CAP_DEPRECATED |
+			    OBS_ENCODER_CAP_INTERNAL))
+			return false;
+		const char *type_codec = obs_get_encoder_codec(type_id);
+		return type_codec && strcmp(type_codec, codec) == 0;
+	}
+	return false;
+}
+
+const char *recast_encoder_resolve_id(const recast_encoder_settings_t *s)
+{
+	if (!s)
+		return NULL;
+
+	if (*s->encoder_id) {
+		if (encoder_usable(s->encoder_id, s->codec))
+			return s->encoder_id;
+		blog(LOG_WARNING,
+		     "[Recast] Encoder '%s' unavailable, picking automatically",
+		     s->encoder_id);
+	}
+
+	const char **pref = h264_preference;
+	if (strcmp(s->codec, "hevc") == 0)
+		pref = hevc_preference;
+	else if (strcmp(s->codec, "av1") == 0)
+		pref = av1_preference;
+
+	for (; *pref; pref++) {
+		if (encoder_usable(*pref, s->codec))
+			return *pref;
+	}
+
+	/* Nothing from the list -- take any registered encoder */
+	const char *type_id;
+	for (size_t i = 0; obs_enum_encoder_types(i, &type_id); i++) {
+		if (encoder_usable(type_id, s->codec))
+			return type_id;
+	}
+	return NULL;
+}
+
+/* ---- Pool ---- */
+
+recast_encoder_pool_t *recast_encoder_pool_create(const char *name_prefix)
+{
+	recast_encoder_pool_t *pool = bzalloc(sizeof(recast_encoder_pool_t));
+	pool->name_prefix = bstrdup(name_prefix ? name_prefix : "recast_venc");
+	da_init(pool->entries);
+	return pool;
+}
+
+void recast_encoder_pool_destroy(recast_encoder_pool_t *pool)
+{
+	if (!pool)
+		return;
+
+	for (size_t i = 0; i < pool->entries.num; i++) {
+		struct pool_entry *e = &pool->entries.array[i];
+		if (e->refs > 0)
+			blog(LOG_WARNING,
+			     "[Recast] Destroying encoder '%s' with %d refs",
+			     obs_encoder_get_name(e->encoder), e->refs);
+		obs_encoder_release(e->encoder);
+	}
+	da_free(pool->entries);
+	bfree(pool->name_prefix);
+	bfree(pool);
+}
+
+bool recast_encoder_settings_equal(const recast_encoder_settings_t *a,
+				   const recast_encoder_settings_t *b)
+{
+	return strcmp(a->codec, b->codec) == 0 &&
+	       strcmp(a->encoder_id, b->encoder_id) == 0 &&
+	       a->bitrate == b->bitrate &&
+	       strcmp(a->rate_control, b->rate_control) == 0 &&
+	       a->keyint_sec == b->keyint_sec &&
+	       a->scaled_width == b->scaled_width &&
+	       a->scaled_height == b->scaled_height &&
+	       (a->fps_divisor > 1 ? a->fps_divisor : 1) ==
+		       (b->fps_divisor > 1 ? b->fps_divisor : 1);
+}
+
+static obs_encoder_t *create_encoder(recast_encoder_pool_t *pool,
+				     video_t *video,
+				     const recast_encoder_settings_t *key)
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_int(settings, "bitrate", key->bitrate);
+	obs_data_set_string(settings, "rate_control", key->rate_control);
+	obs_data_set_int(settings, "keyint_sec", key->keyint_sec);
+
+	struct dstr name = {0};
+	dstr_printf(&name, "%s_%u", pool->name_prefix, ++pool->serial);
+
+	obs_encoder_t *enc = obs_video_encoder_create(
+		key->encoder_id, name.array, settings, NULL);
+	obs_data_release(settings);
+
+	if (enc) {
+		obs_encoder_set_video(enc, video);
+		if (key->scaled_width > 0 && key->scaled_height > 0)
+			obs_encoder_set_scaled_size(
+				enc, (uint32_t)key->scaled_width,
+				(uint32_t)key->scaled_height);
+#if RECAST_HAVE_FPS_DIVISOR
+		if (key->fps_divisor > 1 &&
+		    !obs_encoder_set_frame_rate_divisor(
+			    enc, (uint32_t)key->fps_divisor))
+			blog(LOG_WARNING,
+			     "[Recast] Encoder '%s' rejected frame rate "
+			     "divisor %d",
+			     name.array, key->fps_divisor);
+#endif
+		blog(LOG_INFO,
+		     "[Recast] Created encoder '%s' (%s, %d kbps %s, "
+		     "keyint %ds, scaled %dx%d, 1/%d fps)",
+		     name.array, key->encoder_id, key->bitrate,
+		     key->rate_control, key->keyint_sec, key->scaled_width,
+		     key->scaled_height,
+		     key->fps_divisor > 1 ? key->fps_divisor : 1);
+	} else {
+		blog(LOG_ERROR, "[Recast] Failed to create encoder '%s' (%s)",
+		     name.array, key->encoder_id);
+	}
+
+	dstr_free(&name);
+	return enc;
+}
+
+obs_encoder_t *recast_encoder_pool_acquire(recast_encoder_pool_t *pool,
+					   video_t *video,
+					   const recast_encoder_settings_t *s)
+{
+	if (!pool || !video || !s)
+		return NULL;
+
+	const char *id = recast_encoder_resolve_id(s);
+	if (!id) {
+		blog(LOG_ERROR, "[Recast] No usable %s encoder", s->codec);
+		return NULL;
+	}
+
+	/* Key on the resolved id so "auto" and an explicit pick of the
+	 * same encoder share one instance. */
+	recast_encoder_settings_t key = *s;
+	copy_str(key.encoder_id, sizeof(key.encoder_id), id);
+
+	for (size_t i = 0; i < pool->entries.num; i++) {
+		struct pool_entry *e = &pool->entries.array[i];
+		if (!e->exclusive && e->video == video &&
+		    recast_encoder_settings_equal(&e->key, &key)) {
+			e->refs++;
+			return e->encoder;
+		}
+	}
+
+	obs_encoder_t *enc = create_encoder(pool, video, &key);
+	if (!enc)
+		return NULL;
+
+	struct pool_entry *e = da_push_back_new(pool->entries);
+	e->key = key;
+	e->video = video;
+	e->encoder = enc;
+	e->refs = 1;
+	return enc;
+}
+
+obs_encoder_t *
+recast_encoder_pool_acquire_exclusive(recast_encoder_pool_t *pool,
+				      video_t *video,
+				      const recast_encoder_settings_t *s)
+{
+	if (!pool || !video || !s)
+		return NULL;
+
+	const char *id = recast_encoder_resolve_id(s);
+	if (!id) {
+		blog(LOG_ERROR, "[Recast] No usable %s encoder", s->codec);
+		return NULL;
+	}
+
+	recast_encoder_settings_t key = *s;
+	copy_str(key.encoder_id, sizeof(key.encoder_id), id);
+
+	obs_encoder_t *enc = create_encoder(pool, video, &key);
+	if (!enc)
+		return NULL;
+
+	struct pool_entry *e = da_push_back_new(pool->entries);
+	e->key = key;
+	e->video = video;
+	e->encoder = enc;
+	e->refs = 1;
+	e->exclusive = true;
+	return enc;
+}
+
+bool recast_encoder_pool_set_bitrate(recast_encoder_pool_t *pool,
+				     obs_encoder_t *encoder, int kbps)
+{
+	if (!pool || !encoder || kbps <= 0)
+		return false;
+
+	for (size_t i = 0; i < pool->entries.num; i++) {
+		struct pool_entry *e = &pool->entries.array[i];
+		if (e->encoder != encoder)
+			continue;
+
+		/* A shared encoder would change every destination on it */
+		if (!e->exclusive)
+			return false;
+		if (e->key.bitrate == kbps)
+			return true;
+
+		obs_data_t *settings = obs_data_create();
+		obs_data_set_int(settings, "bitrate", kbps);
+		obs_encoder_update(encoder, settings);
+		obs_data_release(settings);
+
+		e->key.bitrate = kbps;
+		return true;
+	}
+	return false;
+}
+
+bool recast_encoder_pool_release(recast_encoder_pool_t *pool,
+				 obs_encoder_t *encoder)
+{
+	if (!pool || !encoder)
+		return false;
+
+	for (size_t i = 0; i < pool->entries.num; i++) {
+		struct pool_entry *e = &pool->entries.array[i];
+		if (e->encoder != encoder)
+			continue;
+
+		if (--e->refs <= 0) {
+			blog(LOG_INFO,
+			     "[Recast] Released encoder '%s' (no more refs)",
+			     obs_encoder_get_name(e->encoder));
+			obs_encoder_release(e->encoder);
+			da_erase(pool->entries, i);
+		}
+		return true;
+	}
+	return false;
+}
+
+int recast_encoder_pool_active_refs(const recast_encoder_pool_t *pool)
+{
+	if (!pool)
+		return 0;
+
+	int refs = 0;
+	for (size_t i = 0; i < pool->entries.num; i++)
+		refs += pool->entries.array[i].refs;
+	return refs;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <obs-module.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Encoder pool -- shared video encoders keyed by their settings.
+ *
+ * Destinations that ask for identical settings (codec, encoder id,
+ * bitrate, rate control, keyframe interval, scaled size, frame rate
+ * divisor) on the same video pipeline
+ * get the same obs_encoder_t back, ref-counted. An empty encoder_id
+ * means "auto": the best available hardware encoder for the codec,
+ * falling back to x264 / software.
+ */
+
+/* Encoder frame rate divisors need libobs 30.1 */
+#if LIBOBS_API_MAJOR_VER > 30 || \
+	(LIBOBS_API_MAJOR_VER == 30 && LIBOBS_API_MINOR_VER >= 1)
+#define RECAST_HAVE_FPS_DIVISOR 1
+#else
+#define RECAST_HAVE_FPS_DIVISOR 0
+#endif
+
+typedef struct recast_encoder_settings {
+	char codec[16];        /* "h264", "hevc", "av1" */
+	char encoder_id[64];   /* "" = auto (hardware first) */
+	int bitrate;           /* kbps */
+	char rate_control[16]; /* "CBR", "VBR" */
+	int keyint_sec;
+	int scaled_width;      /* 0 = pipeline size */
+	int scaled_height;
+	int fps_divisor;       /* 0/1 = every frame; set by the canvas,
+				* not persisted */
+} recast_encoder_settings_t;
+
+typedef struct recast_encoder_pool recast_encoder_pool_t;
+
+/* Fill with defaults (h264, auto, 4000 kbps CBR, 2 s keyframes). */
+void recast_encoder_settings_init(recast_encoder_settings_t *s);
+
+/* Read/write the settings as an obs_data_t object. Missing keys keep
+ * their defaults on load. */
+void recast_encoder_settings_load(recast_encoder_settings_t *s,
+				  obs_data_t *data);
+void recast_encoder_settings_save(const recast_encoder_settings_t *s,
+				  obs_data_t *data);
+
+bool recast_encoder_settings_equal(const recast_encoder_settings_t *a,
+				   const recast_encoder_settings_t *b);
+
+/* Resolve the concrete encoder type id for these settings (picks a
+ * hardware encoder when encoder_id is empty). NULL if none usable. */
+const char *recast_encoder_resolve_id(const recast_encoder_settings_t *s);
+
+recast_encoder_pool_t *recast_encoder_pool_create(const char *name_prefix);
+void recast_encoder_pool_destroy(recast_encoder_pool_t *pool);
+
+/* Get (or create) the encoder for these settings on the given video
+ * pipeline and take a reference. NULL on failure. */
+obs_encoder_t *recast_encoder_pool_acquire(recast_encoder_pool_t *pool,
+					   video_t *video,
+					   const recast_encoder_settings_t *s);
+
+/* Create an encoder for a single user; it is never shared, so its
+ * bitrate may be changed with set_bitrate. Release as usual. */
+obs_encoder_t *
+recast_encoder_pool_acquire_exclusive(recast_encoder_pool_t *pool,
+				      video_t *video,
+				      const recast_encoder_settings_t *s);
+
+/* Change the bitrate of an exclusive encoder in place (live). Returns
+ * false for shared or unknown encoders. */
+bool recast_encoder_pool_set_bitrate(recast_encoder_pool_t *pool,
+				     obs_encoder_t *encoder, int kbps);
+
+/* Drop a reference taken by acquire. The encoder is released when its
+ * last reference goes away. Returns false if the encoder is not ours. */
+bool recast_encoder_pool_release(recast_encoder_pool_t *pool,
+				 obs_encoder_t *encoder);
+
+/* Total references held across all pooled encoders. */
+int recast_encoder_pool_active_refs(const recast_encoder_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,470 @@
+/*
+ * recast-event-journal.cpp -- Persistent, deduplicating event log.
+ *
+ * File layout (little endian):
+ *
+ *   "RCEJ" u32 version
+ *   record*:
+ *     u32 payload size   u32 FNV-1a of the payload
+ *     payload:
+ *       i64 timestamp ms   u64 id hash   i64 value (micro units)
+ *       i32 amount   u8 type   u8 platform   u8 flags   u8 reserved
+ *       6 x (u16 length + UTF-8): id, username, display name,
+ *                                 message, tier, currency
+ */
+
+#include "recast-event-journal.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+static const char JOURNAL_MAGIC[4] = {'R', 'C', 'E', 'J'};
+static const quint32 JOURNAL_VERSION = 1;
+static const qint64 FILE_HEADER_SIZE = 8;
+static const qint64 RECORD_PREFIX_SIZE = 8;
+static const qint64 PAYLOAD_FIXED_SIZE = 32;
+static const quint32 MAX_PAYLOAD_SIZE = 1024 * 1024;
+
+enum JournalFlags : quint8 {
+	FLAG_ANONYMOUS = 1 << 0,
+	FLAG_STREAM_START = 1 << 1,
+};
+
+/* ---- Encoding helpers ---- */
+
+static quint32 fnv1a32(const uchar *data, qint64 size)
+{
+	quint32 h = 2166136261u;
+	for (qint64 i = 0; i < size; i++) {
+		h ^= data[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static quint64 id_hash(const RecastPlatformEvent &event)
+{
+	QByteArray key = event.platform.toUtf8() + '\n' + event.id.toUtf8();
+	quint64 h = 14695981039346656037ull;
+	for (char c : key) {
+		h ^= (uchar)c;
+		h *= 1099511628211ull;
+	}
+	return h ? h : 1; /* 0 means "no id" */
+}
+
+static quint8 platform_code(const QString &platform)
+{
+	if (platform == QStringLiteral("twitch"))
+		return 0;
+	if (platform == QStringLiteral("youtube"))
+		return 1;
+	if (platform == QStringLiteral("kick"))
+		return 2;
+	return 255;
+}
+
+static QString platform_name(quint8 code)
+{
+	switch (code) {
+	case 0:
+		return QStringLiteral("twitch");
+	case 1:
+		return QStringLiteral("youtube");
+	case 2:
+		return QStringLiteral("kick");
+	default:
+		return QString();
+	}
+}
+
+template<typename T> static void put(QByteArray &out, T value)
+{
+	T le = qToLittleEndian(value);
+	out.append(reinterpret_cast<const char *>(&le), sizeof(le));
+}
+
+template<typename T> static T get(const uchar *p)
+{
+	return qFromLittleEndian<T>(p);
+}
+
+static void put_u8(QByteArray &out, quint8 value)
+{
+	out.append((char)value);
+}
+
+static void put_string(QByteArray &out, const QString &s)
+{
+	QByteArray utf8 = s.toUtf8();
+	if (utf8.size() > 0xffff)
+		utf8.truncate(0xffff);
+	put<quint16>(out, (quint16)utf8.size());
+	out.append(utf8);
+}
+
+/* Reads one string, advancing p; false if it runs past end */
+static bool get_string(const uchar *&p, const uchar *end, QString *s)
+{
+	if (end - p < 2)
+		return false;
+	quint16 len = get<quint16>(p);
+	p += 2;
+	if (end - p < len)
+		return false;
+	if (s)
+		*s = QString::fromUtf8(reinterpret_cast<const char *>(p), len);
+	p += len;
+	return true;
+}
+
+static bool decode_record(const uchar *payload, quint32 size,
+			  RecastPlatformEvent *event)
+{
+	const uchar *p = payload;
+	const uchar *end = payload + size;
+
+	event->timestamp = get<qint64>(p);
+	event->monetaryValue = get<qint64>(p + 16) / 1e6;
+	event->amount = get<qint32>(p + 24);
+	event->type = p[28] < EVENT_UNKNOWN ? (RecastEventType)p[28]
+					     : EVENT_UNKNOWN;
+	event->platform = platform_name(p[29]);
+	event->isAnonymous = (p[30] & FLAG_ANONYMOUS) != 0;
+	p += PAYLOAD_FIXED_SIZE;
+
+	return get_string(p, end, &event->id) &&
+	       get_string(p, end, &event->username) &&
+	       get_string(p, end, &event->displayName) &&
+	       get_string(p, end, &event->message) &&
+	       get_string(p, end, &event->tier) &&
+	       get_string(p, end, &event->currency);
+}
+
+/* ---- Lifecycle ---- */
+
+RecastEventJournal::RecastEventJournal() {}
+
+RecastEventJournal::~RecastEventJournal()
+{
+	close();
+}
+
+bool RecastEventJournal::open(const QString &path)
+{
+	close();
+
+	file_.setFileName(path);
+	if (!file_.open(QIODevice::ReadWrite)) {
+		blog(LOG_WARNING, "[Recast Events] Cannot open journal %s: %s",
+		     path.toUtf8().constData(),
+		     file_.errorString().toUtf8().constData());
+		return false;
+	}
+
+	qint64 size = file_.size();
+	uchar *map = size > 0 ? file_.map(0, size) : nullptr;
+
+	/* Some filesystems cannot be mapped; read the file instead */
+	QByteArray contents;
+	const uchar *data = map;
+	if (!map && size > 0) {
+		contents = file_.readAll();
+		size = contents.size();
+		data = reinterpret_cast<const uchar *>(contents.constData());
+	}
+
+	if (size < FILE_HEADER_SIZE || memcmp(data, JOURNAL_MAGIC, 4) != 0 ||
+	    get<quint32>(data + 4) != JOURNAL_VERSION) {
+		if (size > 0)
+			blog(LOG_WARNING,
+			     "[Recast Events] Journal %s is not readable, "
+			     "starting a new one",
+			     path.toUtf8().constData());
+		if (map)
+			file_.unmap(map);
+
+		QByteArray header(JOURNAL_MAGIC, 4);
+		put<quint32>(header, JOURNAL_VERSION);
+		file_.resize(0);
+		file_.seek(0);
+		file_.write(header);
+		file_.flush();
+		return true;
+	}
+
+	qint64 valid_end = FILE_HEADER_SIZE;
+	std::vector<qint64> offsets;
+	scan(data, size, &valid_end, &offsets);
+
+	/* Decode only the replay window; the index covers the rest */
+	for (size_t i = offsets.size(); i-- > 0 &&
+					replay_.size() < (size_t)REPLAY_EVENTS;) {
+		const uchar *rec = data + offsets[i];
+		if (rec[RECORD_PREFIX_SIZE + 30] & FLAG_STREAM_START)
+			continue;
+
+		RecastPlatformEvent event;
+		if (decode_record(rec + RECORD_PREFIX_SIZE, get<quint32>(rec),
+				  &event))
+			replay_.push_back(std::move(event));
+	}
+	std::reverse(replay_.begin(), replay_.end());
+
+	bool compacted = false;
+	if (valid_end > MAX_FILE_BYTES && offsets.size() > (size_t)KEEP_RECORDS)
+		compacted = compact(data, map, offsets, valid_end);
+
+	if (!compacted) {
+		if (map)
+			file_.unmap(map);
+		if (valid_end < size) {
+			blog(LOG_WARNING,
+			     "[Recast Events] Dropping %lld bytes of torn "
+			     "journal tail",
+			     (long long)(size - valid_end));
+			file_.resize(valid_end);
+		}
+	}
+
+	file_.seek(file_.size());
+
+	blog(LOG_INFO, "[Recast Events] Journal opened: %d records, %d replayed",
+	     (int)index_.size(), (int)replay_.size());
+	return true;
+}
+
+void RecastEventJournal::close()
+{
+	if (file_.isOpen())
+		file_.close();
+	index_.clear();
+	releaseReplay();
+	stream_totals_ = Totals();
+	seen_.clear();
+	seen_order_.clear();
+}
+
+/* ---- Scanning ---- */
+
+void RecastEventJournal::scan(const uchar *data, qint64 size,
+			      qint64 *valid_end, std::vector<qint64> *offsets)
+{
+	qint64 pos = FILE_HEADER_SIZE;
+
+	while (size - pos >= RECORD_PREFIX_SIZE) {
+		quint32 payload_size = get<quint32>(data + pos);
+		quint32 checksum = get<quint32>(data + pos + 4);
+		const uchar *payload = data + pos + RECORD_PREFIX_SIZE;
+
+		if (payload_size < PAYLOAD_FIXED_SIZE ||
+		    payload_size > MAX_PAYLOAD_SIZE ||
+		    payload_size > size - pos - RECORD_PREFIX_SIZE ||
+		    fnv1a32(payload, payload_size) != checksum)
+			break;
+
+		IndexEntry e;
+		e.timestamp = get<qint64>(payload);
+		e.value = get<qint64>(payload + 16) / 1e6;
+		e.amount = get<qint32>(payload + 24);
+		e.type = payload[28];
+		e.flags = payload[30];
+		index_.push_back(e);
+		offsets->push_back(pos);
+
+		quint64 h = get<quint64>(payload + 8);
+		if (h)
+			remember(h);
+		account(e);
+
+		pos += RECORD_PREFIX_SIZE + payload_size;
+	}
+
+	*valid_end = pos;
+}
+
+bool RecastEventJournal::compact(const uchar *data, uchar *map,
+				 const std::vector<qint64> &offsets,
+				 qint64 valid_end)
+{
+	size_t first = offsets.size() - KEEP_RECORDS;
+	qint64 from = offsets[first];
+
+	QSaveFile out(file_.fileName());
+	if (!out.open(QIODevice::WriteOnly))
+		return false;
+
+	QByteArray header(JOURNAL_MAGIC, 4);
+	put<quint32>(header, JOURNAL_VERSION);
+	out.write(header);
+	out.write(reinterpret_cast<const char *>(data + from),
+		  valid_end - from);
+
+	/* The rename cannot replace a file we still have mapped/open */
+	QString path = file_.fileName();
+	if (map)
+		file_.unmap(map);
+	file_.close();
+
+	bool ok = out.commit();
+	if (ok) {
+		index_.erase(index_.begin(), index_.begin() + first);
+		blog(LOG_INFO, "[Recast Events] Journal compacted to %d records",
+		     KEEP_RECORDS);
+	} else {
+		blog(LOG_WARNING, "[Recast Events] Journal compaction failed");
+	}
+
+	file_.setFileName(path);
+	if (!file_.open(QIODevice::ReadWrite))
+		blog(LOG_WARNING, "[Recast Events] Cannot reopen journal %s",
+		     path.toUtf8().constData());
+	else if (!ok)
+		file_.resize(valid_end);
+	return true;
+}
+
+/* ---- Dedup and totals ---- */
+
+void RecastEventJournal::remember(quint64 h)
+{
+	if (seen_.contains(h))
+		return;
+
+	seen_.insert(h);
+	seen_order_.push_back(h);
+	if (seen_order_.size() > (size_t)DEDUP_CAPACITY) {
+		seen_.remove(seen_order_.front());
+		seen_order_.pop_front();
+	}
+}
+
+static void add_to(RecastEventJournal::Totals &t, quint8 type, qint32 amount,
+		   double value)
+{
+	t.events++;
+	t.value += value;
+
+	switch (type) {
+	case EVENT_FOLLOW:
+		t.follows++;
+		break;
+	case EVENT_SUBSCRIBE:
+	case EVENT_RESUB:
+		t.subs++;
+		break;
+	case EVENT_GIFT_SUB:
+		t.subs += qMax(1, (int)amount);
+		break;
+	case EVENT_BITS:
+		t.bits += amount;
+		break;
+	default:
+		break;
+	}
+}
+
+void RecastEventJournal::account(const IndexEntry &e)
+{
+	if (e.flags & FLAG_STREAM_START) {
+		stream_totals_ = Totals();
+		return;
+	}
+	add_to(stream_totals_, e.type, e.amount, e.value);
+}
+
+RecastEventJournal::Totals RecastEventJournal::totals(qint64 from_ms,
+						      qint64 to_ms) const
+{
+	/* Records are appended in arrival order, so the index is sorted
+	 * by timestamp */
+	auto first = std::lower_bound(
+		index_.begin(), index_.end(), from_ms,
+		[](const IndexEntry &e, qint64 t) { return e.timestamp < t; });
+
+	Totals t;
+	for (auto it = first; it != index_.end() && it->timestamp < to_ms;
+	     ++it) {
+		if (!(it->flags & FLAG_STREAM_START))
+			add_to(t, it->type, it->amount, it->value);
+	}
+	return t;
+}
+
+/* ---- Appending ---- */
+
+bool RecastEventJournal::writeRecord(const RecastPlatformEvent &event,
+				     quint64 h, quint8 flags)
+{
+	QByteArray payload;
+	payload.reserve(PAYLOAD_FIXED_SIZE + 64 + event.message.size() * 3);
+	put<qint64>(payload, event.timestamp);
+	put<quint64>(payload, h);
+	put<qint64>(payload, (qint64)(event.monetaryValue * 1e6));
+	put<qint32>(payload, event.amount);
+	put_u8(payload, (quint8)event.type);
+	put_u8(payload, platform_code(event.platform));
+	put_u8(payload, flags);
+	put_u8(payload, 0);
+	put_string(payload, event.id);
+	put_string(payload, event.username);
+	put_string(payload, event.displayName);
+	put_string(payload, event.message);
+	put_string(payload, event.tier);
+	put_string(payload, event.currency);
+
+	QByteArray record;
+	record.reserve(RECORD_PREFIX_SIZE + payload.size());
+	put<quint32>(record, (quint32)payload.size());
+	put<quint32>(record,
+		     fnv1a32(reinterpret_cast<const uchar *>(payload.constData()),
+			     payload.size()));
+	record.append(payload);
+
+	IndexEntry e;
+	e.timestamp = event.timestamp;
+	e.amount = event.amount;
+	e.type = (quint8)event.type;
+	e.flags = flags;
+	e.value = event.monetaryValue;
+	index_.push_back(e);
+	account(e);
+
+	if (!file_.isOpen())
+		return false;
+
+	if (file_.write(record) != record.size() || !file_.flush()) {
+		blog(LOG_WARNING, "[Recast Events] Journal write failed: %s",
+		     file_.errorString().toUtf8().constData());
+		return false;
+	}
+	return true;
+}
+
+bool RecastEventJournal::append(const RecastPlatformEvent &event)
+{
+	quint64 h = 0;
+	if (!event.id.isEmpty()) {
+		h = id_hash(event);
+		if (seen_.contains(h))
+			return false;
+		remember(h);
+	}
+
+	writeRecord(event, h, event.isAnonymous ? FLAG_ANONYMOUS : 0);
+	return true;
+}
+
+void RecastEventJournal::markStreamStart(qint64 timestamp)
+{
+	RecastPlatformEvent marker;
+	marker.timestamp = timestamp;
+	writeRecord(marker, 0, FLAG_STREAM_START);
+}
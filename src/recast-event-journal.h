@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QFile>
+#include <QSet>
+#include <QString>
+
+#include <deque>
+#include <vector>
+
+#include "recast-feed-parse.h"
+
+/*
+ * RecastEventJournal -- Append-only binary log of platform events.
+ *
+ * Every event the feed shows is appended to <profile>/recast-events.journal
+ * as one compact, checksummed record. On open the file is memory-mapped
+ * and scanned once: a torn tail from a crash is truncated away, the last
+ * few hundred events are kept for replay into the dock, and a small
+ * per-record index (time, type, amount, value) is built so totals over a
+ * time range never touch the file again.
+ *
+ * Events carrying a platform message id are deduplicated on append
+ * against a bounded set of recent ids (EventSub reconnects and poller
+ * restarts deliver the same message twice). A marker record is written
+ * when a stream starts; streamTotals() is kept up to date from there.
+ *
+ * Once the file grows past MAX_FILE_BYTES it is rewritten at open time
+ * with only the newest KEEP_RECORDS records. UI thread only.
+ */
+class RecastEventJournal {
+public:
+	struct Totals {
+		int events = 0;
+		int follows = 0;
+		int subs = 0;  /* new, resubs and gifted */
+		int bits = 0;
+		double value = 0.0; /* monetary value, mixed currencies */
+	};
+
+	RecastEventJournal();
+	~RecastEventJournal();
+
+	RecastEventJournal(const RecastEventJournal &) = delete;
+	RecastEventJournal &operator=(const RecastEventJournal &) = delete;
+
+	/* Open (or create) the journal and scan it */
+	bool open(const QString &path);
+	void close();
+
+	/* False for a duplicate id; the event should then be ignored */
+	bool append(const RecastPlatformEvent &event);
+
+	void markStreamStart(qint64 timestamp);
+
+	/* Newest last, at most the count passed to open's replay window */
+	const std::vector<RecastPlatformEvent> &replay() const
+	{
+		return replay_;
+	}
+	void releaseReplay() { std::vector<RecastPlatformEvent>().swap(replay_); }
+
+	Totals streamTotals() const { return stream_totals_; }
+	Totals totals(qint64 from_ms, qint64 to_ms) const;
+
+	static const int REPLAY_EVENTS = 200;
+
+private:
+	static const qint64 MAX_FILE_BYTES = 8 * 1024 * 1024;
+	static const int KEEP_RECORDS = 5000;
+	static const int DEDUP_CAPACITY = 4096;
+
+	/* Decoded record header, kept per record in memory */
+	struct IndexEntry {
+		qint64 timestamp;
+		qint32 amount;
+		quint8 type;
+		quint8 flags;
+		double value;
+	};
+
+	QFile file_;
+	std::vector<IndexEntry> index_;
+	std::vector<RecastPlatformEvent> replay_;
+	Totals stream_totals_;
+
+	QSet<quint64> seen_;
+	std::deque<quint64> seen_order_;
+
+	void scan(const uchar *data, qint64 size, qint64 *valid_end,
+		  std::vector<qint64> *offsets);
+	bool compact(const uchar *data, uchar *map,
+		     const std::vector<qint64> &offsets, qint64 valid_end);
+	void remember(quint64 id_hash);
+	void account(const IndexEntry &e);
+	bool writeRecord(const RecastPlatformEvent &event, quint64 id_hash,
+			 quint8 flags);
+};
@@ -0,0 +1,434 @@
+/*
+ * recast-events-view.cpp -- Model/view events feed.
+ *
+ * Replaces the per-event QFrame cards: events live in a newest-first
+ * ring buffer model and a delegate paints each visible card from cached
+ * text, so adding an event costs the same at 10 or 200 rows.
+ */
+
+#include "recast-events-view.h"
+#include "recast-platform-icons.h"
+
+#include <QAbstractItemView>
+#include <QDateTime>
+#include <QPainter>
+#include <QStyle>
+#include <QtMath>
+
+static const int CARD_BORDER = 3;
+static const int CARD_PAD_H = 8;
+static const int CARD_PAD_V = 4;
+static const int CARD_SPACING = 4;
+static const int LINE_SPACING = 2;
+static const int ICON_SIZE = 16;
+static const int ICON_GAP = 6;
+
+static const QColor TIME_COLOR(0x88, 0x88, 0x88);
+static const QColor VALUE_COLOR(0xFF, 0xD7, 0x00);
+static const QColor HOVER_COLOR(255, 255, 255, 15);
+
+/* ====================================================================
+ * RecastEventsModel
+ * ==================================================================== */
+
+RecastEventsModel::RecastEventsModel(int capacity, QObject *parent)
+	: QAbstractListModel(parent), capacity_(capacity > 0 ? capacity : 1)
+{
+	ring_.resize(capacity_);
+}
+
+int RecastEventsModel::rowCount(const QModelIndex &parent) const
+{
+	return parent.isValid() ? 0 : count_;
+}
+
+QVariant RecastEventsModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() < 0 || index.row() >= count_)
+		return QVariant();
+
+	const RecastPlatformEvent &event = eventAt(index.row());
+	if (role == Qt::DisplayRole)
+		return QStringLiteral("%1: %2").arg(
+			RecastEventsDelegate::eventTypeLabel(event.type),
+			event.displayName.isEmpty() ? event.username
+						    : event.displayName);
+	if (role == Qt::ToolTipRole)
+		return event.platform;
+	return QVariant();
+}
+
+void RecastEventsModel::dropOldest(int n)
+{
+	if (n <= 0)
+		return;
+
+	beginRemoveRows(QModelIndex(), count_ - n, count_ - 1);
+	for (int i = count_ - n; i < count_; i++) {
+		Row &r = ring_[slot(i)];
+		r.event = RecastPlatformEvent();
+		r.layout = RowLayout();
+	}
+	count_ -= n;
+	endRemoveRows();
+}
+
+void RecastEventsModel::prependEvents(
+	const std::vector<RecastPlatformEvent> &events)
+{
+	if (events.empty())
+		return;
+
+	/* Only the newest capacity_ events can survive the batch */
+	int n = (int)events.size();
+	int first = n > capacity_ ? n - capacity_ : 0;
+	n -= first;
+
+	dropOldest(count_ + n - capacity_);
+
+	/* Newest event is the last in the batch and lands on row 0 */
+	beginInsertRows(QModelIndex(), 0, n - 1);
+	for (int i = first; i < first + n; i++) {
+		head_ = (head_ + capacity_ - 1) % capacity_;
+		Row &r = ring_[head_];
+		r.event = events[i];
+		r.layout = RowLayout();
+	}
+	count_ += n;
+	endInsertRows();
+}
+
+void RecastEventsModel::clear()
+{
+	beginResetModel();
+	for (Row &r : ring_) {
+		r.event = RecastPlatformEvent();
+		r.layout = RowLayout();
+	}
+	head_ = 0;
+	count_ = 0;
+	endResetModel();
+}
+
+const RecastPlatformEvent &RecastEventsModel::eventAt(int row) const
+{
+	return ring_[slot(row)].event;
+}
+
+RecastEventsModel::RowLayout &RecastEventsModel::layoutAt(int row) const
+{
+	return ring_[slot(row)].layout;
+}
+
+/* ====================================================================
+ * RecastEventsDelegate
+ * ==================================================================== */
+
+RecastEventsDelegate::RecastEventsDelegate(RecastEventsModel *model,
+					   QObject *parent)
+	: QStyledItemDelegate(parent), model_(model)
+{
+}
+
+static QString escape_html(const QString &text)
+{
+	QString out = text;
+	out.replace('&', "&amp;");
+	out.replace('<', "&lt;");
+	out.replace('>', "&gt;");
+	out.replace('"', "&quot;");
+	return out;
+}
+
+static QString tier_name(const QString &tier)
+{
+	if (tier == "1000")
+		return QStringLiteral("Tier 1");
+	if (tier == "2000")
+		return QStringLiteral("Tier 2");
+	if (tier == "3000")
+		return QStringLiteral("Tier 3");
+	if (!tier.isEmpty())
+		return tier;
+	return QStringLiteral("Tier 1");
+}
+
+QString RecastEventsDelegate::eventDescription(const RecastPlatformEvent &event)
+{
+	QString name = escape_html(
+		event.displayName.isEmpty()
+			? event.username : event.displayName);
+
+	switch (event.type) {
+	case EVENT_FOLLOW:
+		return QString("<b>%1</b> followed!").arg(name);
+
+	case EVENT_SUBSCRIBE:
+		return QString("<b>%1</b> subscribed at %2!")
+			.arg(name, tier_name(event.tier));
+
+	case EVENT_GIFT_SUB:
+		return QString("<b>%1</b> gifted %2 %3 subs!")
+			.arg(name).arg(event.amount).arg(tier_name(event.tier));
+
+	case EVENT_RESUB:
+		return QString("<b>%1</b> resubscribed for %2 months!")
+			.arg(name).arg(event.amount);
+
+	case EVENT_BITS:
+		return QString("<b>%1</b> cheered %2 bits!")
+			.arg(name).arg(event.amount);
+
+	case EVENT_SUPER_CHAT: {
+		QString currency = event.currency.isEmpty()
+			? QStringLiteral("$") : event.currency;
+		return QString("<b>%1</b> sent a Super Chat: %2%3!")
+			.arg(name, currency)
+			.arg(event.monetaryValue, 0, 'f', 2);
+	}
+
+	case EVENT_SUPER_STICKER: {
+		QString currency = event.currency.isEmpty()
+			? QStringLiteral("$") : event.currency;
+		return QString("<b>%1</b> sent a Super Sticker: %2%3!")
+			.arg(name, currency)
+			.arg(event.monetaryValue, 0, 'f', 2);
+	}
+
+	case EVENT_MEMBER:
+		return QString("<b>%1</b> became a member!")
+			.arg(name);
+
+	case EVENT_MEMBER_MILESTONE:
+		return QString("<b>%1</b> has been a member for %2 months!")
+			.arg(name).arg(event.amount);
+
+	case EVENT_MEMBER_GIFT:
+		return QString("<b>%1</b> gifted %2 memberships!")
+			.arg(name).arg(event.amount);
+
+	case EVENT_RAID:
+		return QString("<b>%1</b> raided with %2 viewers!")
+			.arg(name).arg(event.amount);
+
+	case EVENT_CHANNEL_POINTS:
+		return QString("<b>%1</b> redeemed %2!")
+			.arg(name, escape_html(event.message));
+
+	case EVENT_HYPE_TRAIN:
+		return QString("Hype Train level %1!")
+			.arg(event.amount);
+
+	case EVENT_POLL:
+		return QString("Poll: %1")
+			.arg(escape_html(event.message));
+
+	case EVENT_UNKNOWN:
+	default:
+		return QString("<b>%1</b> triggered an event")
+			.arg(name);
+	}
+}
+
+QString RecastEventsDelegate::eventTypeLabel(RecastEventType type)
+{
+	switch (type) {
+	case EVENT_FOLLOW:           return QStringLiteral("NEW FOLLOW");
+	case EVENT_SUBSCRIBE:        return QStringLiteral("SUBSCRIPTION");
+	case EVENT_GIFT_SUB:         return QStringLiteral("GIFT SUBS");
+	case EVENT_RESUB:            return QStringLiteral("RESUB");
+	case EVENT_BITS:             return QStringLiteral("BITS");
+	case EVENT_SUPER_CHAT:       return QStringLiteral("SUPER CHAT");
+	case EVENT_SUPER_STICKER:    return QStringLiteral("SUPER STICKER");
+	case EVENT_MEMBER:           return QStringLiteral("NEW MEMBER");
+	case EVENT_MEMBER_MILESTONE: return QStringLiteral("MILESTONE");
+	case EVENT_MEMBER_GIFT:      return QStringLiteral("GIFT MEMBERS");
+	case EVENT_RAID:             return QStringLiteral("RAID");
+	case EVENT_CHANNEL_POINTS:   return QStringLiteral("REDEMPTION");
+	case EVENT_HYPE_TRAIN:       return QStringLiteral("HYPE TRAIN");
+	case EVENT_POLL:             return QStringLiteral("POLL");
+	case EVENT_UNKNOWN:
+	default:                     return QStringLiteral("EVENT");
+	}
+}
+
+QColor RecastEventsDelegate::eventTypeColor(RecastEventType type)
+{
+	switch (type) {
+	case EVENT_FOLLOW:           return QColor(0x4C, 0xAF, 0x50); /* green */
+	case EVENT_SUBSCRIBE:        return QColor(0x9C, 0x27, 0xB0); /* purple */
+	case EVENT_GIFT_SUB:         return QColor(0xAB, 0x47, 0xBC); /* light purple */
+	case EVENT_RESUB:            return QColor(0x7B, 0x1F, 0xA2); /* dark purple */
+	case EVENT_BITS:             return QColor(0xFF, 0x98, 0x00); /* orange */
+	case EVENT_SUPER_CHAT:       return QColor(0xFF, 0xEB, 0x3B); /* yellow */
+	case EVENT_SUPER_STICKER:    return QColor(0xFD, 0xD8, 0x35); /* amber */
+	case EVENT_MEMBER:           return QColor(0x4C, 0xAF, 0x50); /* green */
+	case EVENT_MEMBER_MILESTONE: return QColor(0x66, 0xBB, 0x6A); /* light green */
+	case EVENT_MEMBER_GIFT:      return QColor(0xAB, 0x47, 0xBC); /* light purple */
+	case EVENT_RAID:             return QColor(0xF4, 0x43, 0x36); /* red */
+	case EVENT_CHANNEL_POINTS:   return QColor(0x21, 0x96, 0xF3); /* blue */
+	case EVENT_HYPE_TRAIN:       return QColor(0xE9, 0x1E, 0x63); /* pink */
+	case EVENT_POLL:             return QColor(0x00, 0xBC, 0xD4); /* cyan */
+	case EVENT_UNKNOWN:
+	default:                     return QColor(0x99, 0x99, 0x99); /* gray */
+	}
+}
+
+/* Card fonts mirror the pixel sizes the QLabel stylesheets used */
+static QFont px_font(const QFont &base, int px, bool bold)
+{
+	QFont f = base;
+	f.setPixelSize(px);
+	f.setBold(bold);
+	return f;
+}
+
+static QFont header_font(const QFont &base) { return px_font(base, 11, true); }
+static QFont time_font(const QFont &base) { return px_font(base, 10, false); }
+static QFont desc_font(const QFont &base) { return px_font(base, 12, false); }
+static QFont value_font(const QFont &base) { return px_font(base, 12, true); }
+
+static int header_height(const QFont &base)
+{
+	return qMax(ICON_SIZE, QFontMetrics(header_font(base)).height());
+}
+
+QPixmap RecastEventsDelegate::platformPixmap(const QString &platform) const
+{
+	return recast_platform_pixmap(platform, ICON_SIZE);
+}
+
+RecastEventsModel::RowLayout &
+RecastEventsDelegate::ensureLayout(int row, const QFont &font, int width) const
+{
+	RecastEventsModel::RowLayout &cache = model_->layoutAt(row);
+	if (cache.width == width)
+		return cache;
+
+	const RecastPlatformEvent &event = model_->eventAt(row);
+	int text_width = qMax(1, width - CARD_BORDER - 2 * CARD_PAD_H);
+
+	/* Width-independent pieces are only built the first time */
+	if (cache.width < 0) {
+		cache.description = QStaticText(eventDescription(event));
+		cache.description.setTextFormat(Qt::RichText);
+		QTextOption opt;
+		opt.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+		cache.description.setTextOption(opt);
+
+		cache.time_text = QDateTime::fromMSecsSinceEpoch(
+					  event.timestamp)
+					  .toString("hh:mm:ss");
+
+		if (event.monetaryValue > 0.0) {
+			if (!event.currency.isEmpty())
+				cache.value_text =
+					QString("%1 %2")
+						.arg(event.monetaryValue, 0,
+						     'f', 2)
+						.arg(event.currency);
+			else
+				cache.value_text =
+					QString("$%1").arg(event.monetaryValue,
+							   0, 'f', 2);
+		}
+	}
+
+	QFont dfont = desc_font(font);
+	cache.description.setTextWidth(text_width);
+	cache.description.prepare(QTransform(), dfont);
+
+	int h = CARD_PAD_V + header_height(font) + LINE_SPACING +
+		qCeil(cache.description.size().height());
+	if (!cache.value_text.isEmpty())
+		h += LINE_SPACING + QFontMetrics(value_font(font)).height();
+	h += CARD_PAD_V + CARD_SPACING;
+
+	cache.width = width;
+	cache.height = h;
+	return cache;
+}
+
+/* QListView does not pass a row rect to sizeHint(); rows span the
+ * viewport, so size against its width. */
+static int row_width(const QStyleOptionViewItem &option)
+{
+	auto *view = qobject_cast<const QAbstractItemView *>(option.widget);
+	return view ? view->viewport()->width() : option.rect.width();
+}
+
+QSize RecastEventsDelegate::sizeHint(const QStyleOptionViewItem &option,
+				     const QModelIndex &index) const
+{
+	int width = row_width(option);
+	if (width <= 0)
+		return QSize(0, header_height(option.font) + 2 * CARD_PAD_V +
+					CARD_SPACING);
+
+	RecastEventsModel::RowLayout &cache =
+		ensureLayout(index.row(), option.font, width);
+	return QSize(width, cache.height);
+}
+
+void RecastEventsDelegate::paint(QPainter *painter,
+				 const QStyleOptionViewItem &option,
+				 const QModelIndex &index) const
+{
+	const RecastPlatformEvent &event = model_->eventAt(index.row());
+	RecastEventsModel::RowLayout &cache =
+		ensureLayout(index.row(), option.font, row_width(option));
+	const QColor type_color = eventTypeColor(event.type);
+
+	QRect card = option.rect.adjusted(0, 0, 0, -CARD_SPACING);
+
+	painter->save();
+
+	if (option.state & QStyle::State_MouseOver)
+		painter->fillRect(card, HOVER_COLOR);
+	painter->fillRect(QRect(card.left(), card.top(), CARD_BORDER,
+				card.height()),
+			  type_color);
+
+	int x = card.left() + CARD_BORDER + CARD_PAD_H;
+	int right = card.right() - CARD_PAD_H;
+	int y = card.top() + CARD_PAD_V;
+	int top_h = header_height(option.font);
+
+	/* Top row: platform icon, type label, timestamp */
+	QPixmap icon = platformPixmap(event.platform);
+	painter->drawPixmap(x, y + (top_h - ICON_SIZE) / 2, icon);
+
+	QRect label_rect(x + ICON_SIZE + ICON_GAP, y,
+			 qMax(0, right - x - ICON_SIZE - ICON_GAP), top_h);
+	painter->setFont(time_font(option.font));
+	painter->setPen(TIME_COLOR);
+	painter->drawText(label_rect, Qt::AlignRight | Qt::AlignVCenter,
+			  cache.time_text);
+
+	painter->setFont(header_font(option.font));
+	painter->setPen(type_color);
+	painter->drawText(label_rect, Qt::AlignLeft | Qt::AlignVCenter,
+			  eventTypeLabel(event.type));
+
+	y += top_h + LINE_SPACING;
+
+	/* Description */
+	painter->setFont(desc_font(option.font));
+	painter->setPen(option.palette.color(QPalette::Text));
+	painter->drawStaticText(x, y, cache.description);
+	y += qCeil(cache.description.size().height());
+
+	/* Monetary value if applicable */
+	if (!cache.value_text.isEmpty()) {
+		y += LINE_SPACING;
+		QFont vfont = value_font(option.font);
+		painter->setFont(vfont);
+		painter->setPen(VALUE_COLOR);
+		painter->drawText(QRect(x, y, qMax(0, right - x),
+					QFontMetrics(vfont).height()),
+				  Qt::AlignLeft | Qt::AlignVCenter,
+				  cache.value_text);
+	}
+
+	painter->restore();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include <QStaticText>
+#include <QPixmap>
+#include <QHash>
+#include <QColor>
+
+#include <vector>
+
+#include "recast-feed-parse.h"
+
+/*
+ * RecastEventsModel -- Fixed-capacity ring buffer of platform events,
+ * newest first.
+ *
+ * Row 0 is the newest event. Prepending is O(1) per event; once full,
+ * the oldest rows drop off the end in the same step. Each row carries
+ * the delegate's cached text so it is freed together with the event.
+ */
+
+class RecastEventsModel : public QAbstractListModel {
+	Q_OBJECT
+
+public:
+	/* Cached, pre-laid-out text for one row at a given width */
+	struct RowLayout {
+		int width = -1;
+		int height = 0;
+		QStaticText description;
+		QString time_text;
+		QString value_text;
+	};
+
+	explicit RecastEventsModel(int capacity, QObject *parent = nullptr);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role) const override;
+
+	/* Batch in arrival order; the last item becomes row 0 */
+	void prependEvents(const std::vector<RecastPlatformEvent> &events);
+	void clear();
+
+	const RecastPlatformEvent &eventAt(int row) const;
+	RowLayout &layoutAt(int row) const;
+
+private:
+	struct Row {
+		RecastPlatformEvent event;
+		mutable RowLayout layout;
+	};
+
+	std::vector<Row> ring_;
+	int capacity_;
+	int head_ = 0;  /* slot of row 0 (newest) */
+	int count_ = 0;
+
+	int slot(int row) const { return (head_ + row) % capacity_; }
+	void dropOldest(int n);
+};
+
+/*
+ * RecastEventsDelegate -- Paints event cards.
+ *
+ * Draws the same card the feed used to build from QFrame/QLabel trees:
+ * coloured left border, platform icon, type label, timestamp, rich-text
+ * description and an optional monetary value.
+ */
+
+class RecastEventsDelegate : public QStyledItemDelegate {
+	Q_OBJECT
+
+public:
+	explicit RecastEventsDelegate(RecastEventsModel *model,
+				      QObject *parent = nullptr);
+
+	void paint(QPainter *painter, const QStyleOptionViewItem &option,
+		   const QModelIndex &index) const override;
+	QSize sizeHint(const QStyleOptionViewItem &option,
+		       const QModelIndex &index) const override;
+
+	static QString eventDescription(const RecastPlatformEvent &event);
+	static QString eventTypeLabel(RecastEventType type);
+	static QColor eventTypeColor(RecastEventType type);
+
+private:
+	RecastEventsModel *model_;
+
+	RecastEventsModel::RowLayout &ensureLayout(int row, const QFont &font,
+						   int width) const;
+	QPixmap platformPixmap(const QString &platform) const;
+};
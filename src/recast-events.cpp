@@ -6,19 +6,26 @@
  */
 
 #include "recast-events.h"
+#include "recast-feed-parse.h"
+#include "recast-events-view.h"
 #include "recast-auth.h"
+#include "recast-youtube-livechat.h"
+#include "recast-kick-hub.h"
+#include "recast-network.h"
 #include "recast-platform-icons.h"
+#include "recast-event-journal.h"
+#include "recast-perf.h"
 
 #include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QScrollBar>
-#include <QStyle>
+#include <QStringList>
 #include <QUrlQuery>
 
 extern "C" {
 #include <obs-module.h>
+#include <obs-frontend-api.h>
 }
 
 /* ====================================================================
@@ -35,7 +42,6 @@ RecastTwitchEvents::RecastTwitchEvents(QObject *parent)
 {
 	ws_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest,
 			     this);
-	net_mgr_ = new QNetworkAccessManager(this);
 
 	reconnect_timer_ = new QTimer(this);
 	reconnect_timer_->setSingleShot(true);
@@ -145,7 +151,11 @@ void RecastTwitchEvents::onKeepaliveTimeout()
 
 void RecastTwitchEvents::onTextMessageReceived(const QString &raw)
 {
-	QJsonDocument doc = QJsonDocument::fromJson(raw.toUtf8());
+	QJsonDocument doc;
+	{
+		RECAST_PERF_SCOPE(RECAST_PERF_JSON_PARSE);
+		doc = QJsonDocument::fromJson(raw.toUtf8());
+	}
 	if (!doc.isObject())
 		return;
 
@@ -278,19 +288,47 @@ void RecastTwitchEvents::onTextMessageReceived(const QString &raw)
 		QJsonObject event_data = payload.value("event").toObject();
 
 		RecastPlatformEvent evt =
-			parseNotification(sub_type, event_data);
-		if (evt.type != EVENT_UNKNOWN)
-			emit eventReceived(evt);
+			recast_parse_eventsub_event(sub_type, event_data);
+		if (evt.type == EVENT_UNKNOWN) {
+			blog(LOG_DEBUG,
+			     "[Recast Events] Unknown Twitch event type: %s",
+			     sub_type.toUtf8().constData());
+			return;
+		}
+
+		/* Redelivered after a reconnect with the same id */
+		evt.id = metadata.value("message_id").toString();
+		emit eventReceived(evt);
 	}
 }
 
+/* Subscriptions created together share one token refresh, if any */
 void RecastTwitchEvents::createSubscription(const QString &type,
 					    const QString &version,
-					    const QJsonObject &condition)
+					    const QJsonObject &condition,
+					    bool retry_auth)
+{
+	QString session = session_id_;
+	RecastAuthManager::instance()->withAccessToken(
+		"twitch", this,
+		[this, type, version, condition, session,
+		 retry_auth](const QString &access_token) {
+			/* Reconnected while waiting: the new session
+			 * subscribes for itself */
+			if (session != session_id_)
+				return;
+			sendSubscription(type, version, condition,
+					 access_token, retry_auth);
+		});
+}
+
+void RecastTwitchEvents::sendSubscription(const QString &type,
+					  const QString &version,
+					  const QJsonObject &condition,
+					  const QString &access_token,
+					  bool retry_auth)
 {
-	auto *auth = RecastAuthManager::instance();
-	QString access_token = auth->accessToken("twitch");
-	QString client_id = auth->clientId("twitch");
+	QString client_id = RecastAuthManager::instance()->clientId("twitch");
 
 	QJsonObject body;
 	body["type"] = type;
@@ -310,11 +348,19 @@ void RecastTwitchEvents::createSubscription(const QString &type,
 			 ("Bearer " + access_token).toUtf8());
 	req.setRawHeader("Client-Id", client_id.toUtf8());
 
-	QNetworkReply *reply =
-		net_mgr_->post(req, QJsonDocument(body).toJson());
+	QNetworkReply *reply = RecastNetwork::manager()->post(
+		req, QJsonDocument(body).toJson());
 
-	connect(reply, &QNetworkReply::finished, this, [reply, type]() {
+	connect(reply, &QNetworkReply::finished, this,
+		[this, reply, type, version, condition, retry_auth]() {
 		reply->deleteLater();
+		if (reply->error() != QNetworkReply::NoError && retry_auth &&
+		    RecastAuthManager::instance()->handleUnauthorized("twitch",
+								      reply)) {
+			/* Once more with the refreshed token */
+			createSubscription(type, version, condition, false);
+			return;
+		}
 		if (reply->error() != QNetworkReply::NoError) {
 			blog(LOG_WARNING,
 			     "[Recast Events] Failed to create Twitch "
@@ -395,132 +441,13 @@ void RecastTwitchEvents::createAllSubscriptions()
 	     user_id.toUtf8().constData());
 }
 
-RecastPlatformEvent RecastTwitchEvents::parseNotification(
-	const QString &sub_type, const QJsonObject &event_data)
-{
-	RecastPlatformEvent evt;
-	evt.platform = QStringLiteral("twitch");
-	evt.timestamp = QDateTime::currentMSecsSinceEpoch();
-
-	if (sub_type == "channel.follow") {
-		evt.type = EVENT_FOLLOW;
-		evt.username = event_data.value("user_login").toString();
-		evt.displayName = event_data.value("user_name").toString();
-
-	} else if (sub_type == "channel.subscribe") {
-		evt.type = EVENT_SUBSCRIBE;
-		evt.username = event_data.value("user_login").toString();
-		evt.displayName = event_data.value("user_name").toString();
-		evt.tier = event_data.value("tier").toString();
-		evt.isAnonymous = event_data.value("is_gift").toBool();
-
-	} else if (sub_type == "channel.subscription.gift") {
-		evt.type = EVENT_GIFT_SUB;
-		evt.username = event_data.value("user_login").toString();
-		evt.displayName = event_data.value("user_name").toString();
-		evt.amount = event_data.value("total").toInt();
-		evt.tier = event_data.value("tier").toString();
-		evt.isAnonymous = event_data.value("is_anonymous").toBool();
-		if (evt.isAnonymous) {
-			evt.username = "anonymous";
-			evt.displayName = "Anonymous";
-		}
-
-	} else if (sub_type == "channel.subscription.message") {
-		evt.type = EVENT_RESUB;
-		evt.username = event_data.value("user_login").toString();
-		evt.displayName = event_data.value("user_name").toString();
-		evt.amount =
-			event_data.value("cumulative_months").toInt();
-		evt.tier = event_data.value("tier").toString();
-		QJsonObject msg_obj =
-			event_data.value("message").toObject();
-		evt.message = msg_obj.value("text").toString();
-
-	} else if (sub_type == "channel.cheer") {
-		evt.type = EVENT_BITS;
-		evt.username = event_data.value("user_login").toString();
-		evt.displayName = event_data.value("user_name").toString();
-		evt.amount = event_data.value("bits").toInt();
-		evt.message = event_data.value("message").toString();
-		evt.monetaryValue = evt.amount * 0.01;
-		evt.currency = QStringLiteral("USD");
-		evt.isAnonymous =
-			event_data.value("is_anonymous").toBool();
-		if (evt.isAnonymous) {
-			evt.username = "anonymous";
-			evt.displayName = "Anonymous";
-		}
-
-	} else if (sub_type == "channel.raid") {
-		evt.type = EVENT_RAID;
-		evt.username =
-			event_data.value("from_broadcaster_user_login")
-				.toString();
-		evt.displayName =
-			event_data.value("from_broadcaster_user_name")
-				.toString();
-		evt.amount = event_data.value("viewers").toInt();
-
-	} else if (sub_type ==
-		   "channel.channel_points_custom_reward_redemption.add") {
-		evt.type = EVENT_CHANNEL_POINTS;
-		evt.username = event_data.value("user_login").toString();
-		evt.displayName = event_data.value("user_name").toString();
-		QJsonObject reward =
-			event_data.value("reward").toObject();
-		evt.message = reward.value("title").toString();
-		evt.amount = reward.value("cost").toInt();
-		QString user_input =
-			event_data.value("user_input").toString();
-		if (!user_input.isEmpty())
-			evt.message += " - " + user_input;
-
-	} else if (sub_type == "channel.hype_train.begin" ||
-		   sub_type == "channel.hype_train.progress") {
-		evt.type = EVENT_HYPE_TRAIN;
-		evt.amount = event_data.value("level").toInt();
-		evt.displayName = QStringLiteral("Hype Train");
-		int total = event_data.value("total").toInt();
-		int goal = event_data.value("goal").toInt();
-		evt.message = QString("Level %1 - %2/%3")
-			.arg(evt.amount).arg(total).arg(goal);
-
-	} else if (sub_type == "channel.hype_train.end") {
-		evt.type = EVENT_HYPE_TRAIN;
-		evt.amount = event_data.value("level").toInt();
-		evt.displayName = QStringLiteral("Hype Train");
-		int total = event_data.value("total").toInt();
-		evt.message = QString("Ended at Level %1 (Total: %2)")
-			.arg(evt.amount).arg(total);
-
-	} else {
-		evt.type = EVENT_UNKNOWN;
-		blog(LOG_DEBUG,
-		     "[Recast Events] Unknown Twitch event type: %s",
-		     sub_type.toUtf8().constData());
-	}
-
-	return evt;
-}
-
 /* ====================================================================
- * RecastYouTubeEvents -- YouTube Live Events via polling
+ * RecastYouTubeEvents -- YouTube Live Events via the shared poller
  * ==================================================================== */
 
 RecastYouTubeEvents::RecastYouTubeEvents(QObject *parent)
 	: RecastEventProvider(parent)
 {
-	net_ = new QNetworkAccessManager(this);
-
-	poll_timer_ = new QTimer(this);
-	connect(poll_timer_, &QTimer::timeout,
-		this, &RecastYouTubeEvents::onPollTimer);
-
-	reconnect_timer_ = new QTimer(this);
-	reconnect_timer_->setSingleShot(true);
-	connect(reconnect_timer_, &QTimer::timeout,
-		this, &RecastYouTubeEvents::onReconnectTimer);
 }
 
 RecastYouTubeEvents::~RecastYouTubeEvents()
@@ -530,7 +457,7 @@ RecastYouTubeEvents::~RecastYouTubeEvents()
 
 void RecastYouTubeEvents::connectToEvents()
 {
-	if (connected_)
+	if (subscribed_)
 		return;
 
 	auto *auth = RecastAuthManager::instance();
@@ -542,20 +469,28 @@ void RecastYouTubeEvents::connectToEvents()
 	}
 
 	blog(LOG_INFO, "[Recast Events] Connecting to YouTube events...");
-	fetchLiveChatId();
+
+	auto *poller = RecastYouTubeLiveChat::instance();
+	connect(poller, &RecastYouTubeLiveChat::connectionStateChanged,
+		this, &RecastYouTubeEvents::onPollerStateChanged);
+	connect(poller, &RecastYouTubeLiveChat::eventItems,
+		this, &RecastYouTubeEvents::onEventItems);
+	subscribed_ = true;
+	poller->subscribe(this);
+
+	onPollerStateChanged(poller->isConnected());
 }
 
 void RecastYouTubeEvents::disconnect()
 {
-	poll_timer_->stop();
-	reconnect_timer_->stop();
-	live_chat_id_.clear();
-	next_page_token_.clear();
-
-	if (connected_) {
-		connected_ = false;
-		emit connectionStateChanged(false);
+	if (subscribed_) {
+		subscribed_ = false;
+		auto *poller = RecastYouTubeLiveChat::instance();
+		QObject::disconnect(poller, nullptr, this, nullptr);
+		poller->unsubscribe(this);
 	}
+
+	onPollerStateChanged(false);
 }
 
 bool RecastYouTubeEvents::isConnected() const
@@ -563,254 +498,33 @@ bool RecastYouTubeEvents::isConnected() const
 	return connected_;
 }
 
-void RecastYouTubeEvents::fetchLiveChatId()
+void RecastYouTubeEvents::onPollerStateChanged(bool connected)
 {
-	auto *auth = RecastAuthManager::instance();
-	QString access_token = auth->accessToken("youtube");
-
-	QUrl url("https://www.googleapis.com/youtube/v3/liveBroadcasts");
-	QUrlQuery query;
-	query.addQueryItem("part", "snippet");
-	query.addQueryItem("broadcastStatus", "active");
-	query.addQueryItem("broadcastType", "all");
-	url.setQuery(query);
-
-	QNetworkRequest req(url);
-	req.setTransferTimeout(15000);
-	req.setRawHeader("Authorization",
-			 ("Bearer " + access_token).toUtf8());
-
-	QNetworkReply *reply = net_->get(req);
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-		reply->deleteLater();
-
-		if (reply->error() != QNetworkReply::NoError) {
-			blog(LOG_WARNING,
-			     "[Recast Events] YouTube broadcast fetch "
-			     "failed: %s",
-			     reply->errorString().toUtf8().constData());
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		QJsonDocument doc =
-			QJsonDocument::fromJson(reply->readAll());
-		QJsonArray items =
-			doc.object().value("items").toArray();
-
-		if (items.isEmpty()) {
-			blog(LOG_INFO,
-			     "[Recast Events] No active YouTube "
-			     "broadcast found, retrying...");
-			reconnect_timer_->start(15000);
-			return;
-		}
-
-		QJsonObject snippet =
-			items.first().toObject()
-				.value("snippet").toObject();
-		live_chat_id_ =
-			snippet.value("liveChatId").toString();
-
-		if (live_chat_id_.isEmpty()) {
-			blog(LOG_WARNING,
-			     "[Recast Events] YouTube liveChatId is empty");
-			reconnect_timer_->start(15000);
-			return;
-		}
-
-		blog(LOG_INFO,
-		     "[Recast Events] YouTube liveChatId: %s",
-		     live_chat_id_.toUtf8().constData());
-
-		connected_ = true;
-		emit connectionStateChanged(true);
-		poll_timer_->start(poll_interval_ms_);
-	});
-}
-
-void RecastYouTubeEvents::onPollTimer()
-{
-	if (live_chat_id_.isEmpty())
-		return;
-	pollMessages();
-}
-
-void RecastYouTubeEvents::onReconnectTimer()
-{
-	auto *auth = RecastAuthManager::instance();
-	if (!auth->isAuthenticated("youtube"))
+	connected = connected && subscribed_;
+	if (connected_ == connected)
 		return;
 
-	blog(LOG_INFO,
-	     "[Recast Events] Attempting YouTube events reconnect");
-	fetchLiveChatId();
-}
-
-void RecastYouTubeEvents::pollMessages()
-{
-	auto *auth = RecastAuthManager::instance();
-	QString access_token = auth->accessToken("youtube");
-
-	QUrl url("https://www.googleapis.com/youtube/v3/liveChat/messages");
-	QUrlQuery query;
-	query.addQueryItem("liveChatId", live_chat_id_);
-	query.addQueryItem("part", "snippet,authorDetails");
-	if (!next_page_token_.isEmpty())
-		query.addQueryItem("pageToken", next_page_token_);
-	url.setQuery(query);
-
-	QNetworkRequest req(url);
-	req.setTransferTimeout(15000);
-	req.setRawHeader("Authorization",
-			 ("Bearer " + access_token).toUtf8());
-
-	QNetworkReply *reply = net_->get(req);
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-		reply->deleteLater();
-
-		if (reply->error() != QNetworkReply::NoError) {
-			blog(LOG_WARNING,
-			     "[Recast Events] YouTube event poll "
-			     "failed: %s",
-			     reply->errorString().toUtf8().constData());
-
-			int code = reply->attribute(
-				QNetworkRequest::HttpStatusCodeAttribute)
-				.toInt();
-			if (code == 403 || code == 404) {
-				/* Chat ended or forbidden */
-				disconnect();
-				reconnect_timer_->start(15000);
-			}
-			return;
-		}
-
-		QJsonDocument doc =
-			QJsonDocument::fromJson(reply->readAll());
-		QJsonObject root = doc.object();
-
-		next_page_token_ =
-			root.value("nextPageToken").toString();
-		int interval_ms =
-			root.value("pollingIntervalMillis").toInt(5000);
-		poll_interval_ms_ = qMax(interval_ms, 2000);
-		poll_timer_->setInterval(poll_interval_ms_);
-
-		QJsonArray items = root.value("items").toArray();
-		for (const QJsonValue &val : items) {
-			QJsonObject item = val.toObject();
-			RecastPlatformEvent evt = parseEventItem(item);
-			if (evt.type != EVENT_UNKNOWN)
-				emit eventReceived(evt);
-		}
-	});
+	connected_ = connected;
+	emit connectionStateChanged(connected);
 }
 
-RecastPlatformEvent RecastYouTubeEvents::parseEventItem(
-	const QJsonObject &item)
+void RecastYouTubeEvents::onEventItems(const QJsonArray &items)
 {
-	RecastPlatformEvent evt;
-	evt.platform = QStringLiteral("youtube");
-	evt.timestamp = QDateTime::currentMSecsSinceEpoch();
-
-	QJsonObject snippet = item.value("snippet").toObject();
-	QJsonObject author = item.value("authorDetails").toObject();
-	QString msg_type = snippet.value("type").toString();
-
-	evt.username = author.value("channelId").toString();
-	evt.displayName = author.value("displayName").toString();
-
-	if (msg_type == "superChatEvent") {
-		evt.type = EVENT_SUPER_CHAT;
-		QJsonObject details =
-			snippet.value("superChatDetails").toObject();
-		qint64 micros =
-			details.value("amountMicros").toVariant()
-				.toLongLong();
-		evt.monetaryValue = micros / 1000000.0;
-		evt.currency = details.value("currency").toString();
-		evt.message = details.value("userComment").toString();
-
-	} else if (msg_type == "superStickerEvent") {
-		evt.type = EVENT_SUPER_STICKER;
-		QJsonObject details =
-			snippet.value("superStickerDetails").toObject();
-		qint64 micros =
-			details.value("amountMicros").toVariant()
-				.toLongLong();
-		evt.monetaryValue = micros / 1000000.0;
-		evt.currency = details.value("currency").toString();
-
-	} else if (msg_type == "newSponsorEvent") {
-		evt.type = EVENT_MEMBER;
-		QJsonObject details =
-			snippet.value("newSponsorDetails").toObject();
-		evt.tier = details.value("memberLevelName").toString();
-
-	} else if (msg_type == "memberMilestoneChatEvent") {
-		evt.type = EVENT_MEMBER_MILESTONE;
-		QJsonObject details =
-			snippet.value("memberMilestoneChatDetails")
-				.toObject();
-		evt.amount = details.value("memberMonth").toInt();
-		evt.message =
-			details.value("userComment").toString();
-		evt.tier = details.value("memberLevelName").toString();
-
-	} else if (msg_type == "membershipGiftingEvent") {
-		evt.type = EVENT_MEMBER_GIFT;
-		QJsonObject details =
-			snippet.value("membershipGiftingDetails")
-				.toObject();
-		evt.amount =
-			details.value("giftMembershipsCount").toInt();
-		evt.tier = details.value("memberLevelName").toString();
-
-	} else if (msg_type == "giftMembershipReceivedEvent") {
-		/* Received gift -- treat as member event */
-		evt.type = EVENT_MEMBER;
-		QJsonObject details =
-			snippet.value("giftMembershipReceivedDetails")
-				.toObject();
-		evt.tier = details.value("memberLevelName").toString();
-		evt.message = QString("Gift from %1")
-			.arg(details.value("gifterChannelId").toString());
-
-	} else {
-		/* Not an event type we care about (regular text, etc.) */
-		evt.type = EVENT_UNKNOWN;
+	for (const QJsonValue &val : items) {
+		RecastPlatformEvent evt =
+			recast_parse_youtube_event(val.toObject());
+		if (evt.type != EVENT_UNKNOWN)
+			emit eventReceived(evt);
 	}
-
-	return evt;
 }
 
 /* ====================================================================
- * RecastKickEvents -- Kick Events via Pusher WebSocket
+ * RecastKickEvents -- Kick Events via the shared Pusher hub
  * ==================================================================== */
 
-static const char *KICK_PUSHER_URL =
-	"wss://ws-us2.pusher.com/app/"
-	"32cbd69e4b950bf97679?protocol=7&client=js&version=7.6.0&flash=false";
-
 RecastKickEvents::RecastKickEvents(QObject *parent)
 	: RecastEventProvider(parent)
 {
-	ws_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest,
-			     this);
-	net_ = new QNetworkAccessManager(this);
-
-	reconnect_timer_ = new QTimer(this);
-	reconnect_timer_->setSingleShot(true);
-	connect(reconnect_timer_, &QTimer::timeout,
-		this, &RecastKickEvents::onReconnectTimer);
-
-	connect(ws_, &QWebSocket::connected,
-		this, &RecastKickEvents::onConnected);
-	connect(ws_, &QWebSocket::disconnected,
-		this, &RecastKickEvents::onDisconnected);
-	connect(ws_, &QWebSocket::textMessageReceived,
-		this, &RecastKickEvents::onTextMessageReceived);
 }
 
 RecastKickEvents::~RecastKickEvents()
@@ -831,30 +545,40 @@ void RecastKickEvents::connectToEvents()
 
 void RecastKickEvents::connectToEvents(const QString &channelSlug)
 {
-	if (connected_)
+	if (connected_ && channelSlug.toLower() == channel_slug_)
 		return;
 
-	channel_slug_ = channelSlug;
+	channel_slug_ = channelSlug.toLower();
 	blog(LOG_INFO,
 	     "[Recast Events] Connecting to Kick events for '%s'...",
 	     channel_slug_.toUtf8().constData());
 
-	fetchChannelInfo();
+	/* Channel events, plus the chatroom for sub/follow events */
+	auto *hub = RecastKickHub::instance();
+	if (!subscribed_) {
+		connect(hub, &RecastKickHub::connectionStateChanged,
+			this, &RecastKickEvents::onHubStateChanged);
+		connect(hub, &RecastKickHub::pusherEvent,
+			this, &RecastKickEvents::onPusherEvent);
+		subscribed_ = true;
+	}
+	hub->subscribe(this, channel_slug_,
+		       RecastKickHub::TOPIC_CHANNEL |
+			       RecastKickHub::TOPIC_CHATROOM);
+
+	onHubStateChanged(hub->isConnected());
 }
 
 void RecastKickEvents::disconnect()
 {
-	reconnect_timer_->stop();
-	channel_id_ = 0;
-	chatroom_id_ = 0;
-
-	if (ws_->state() != QAbstractSocket::UnconnectedState)
-		ws_->close();
-
-	if (connected_) {
-		connected_ = false;
-		emit connectionStateChanged(false);
+	if (subscribed_) {
+		subscribed_ = false;
+		auto *hub = RecastKickHub::instance();
+		QObject::disconnect(hub, nullptr, this, nullptr);
+		hub->unsubscribe(this);
 	}
+
+	onHubStateChanged(false);
 }
 
 bool RecastKickEvents::isConnected() const
@@ -862,217 +586,26 @@ bool RecastKickEvents::isConnected() const
 	return connected_;
 }
 
-void RecastKickEvents::fetchChannelInfo()
-{
-	QUrl api_url(QString("https://kick.com/api/v2/channels/%1")
-		.arg(channel_slug_));
-
-	QNetworkRequest req(api_url);
-	req.setTransferTimeout(15000);
-	req.setRawHeader("Accept", "application/json");
-
-	QNetworkReply *reply = net_->get(req);
-	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-		reply->deleteLater();
-
-		if (reply->error() != QNetworkReply::NoError) {
-			blog(LOG_WARNING,
-			     "[Recast Events] Kick channel info fetch "
-			     "failed: %s",
-			     reply->errorString().toUtf8().constData());
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		QJsonDocument doc =
-			QJsonDocument::fromJson(reply->readAll());
-		QJsonObject root = doc.object();
-
-		channel_id_ = root.value("id").toInt();
-		chatroom_id_ =
-			root.value("chatroom").toObject()
-				.value("id").toInt();
-
-		if (channel_id_ == 0) {
-			blog(LOG_WARNING,
-			     "[Recast Events] Kick channel ID not found "
-			     "for '%s'",
-			     channel_slug_.toUtf8().constData());
-			reconnect_timer_->start(5000);
-			return;
-		}
-
-		blog(LOG_INFO,
-		     "[Recast Events] Kick channel=%d chatroom=%d",
-		     channel_id_, chatroom_id_);
-
-		connectPusher();
-	});
-}
-
-void RecastKickEvents::connectPusher()
-{
-	blog(LOG_INFO, "[Recast Events] Connecting to Kick Pusher...");
-	ws_->open(QUrl(QString::fromUtf8(KICK_PUSHER_URL)));
-}
-
-void RecastKickEvents::onConnected()
+void RecastKickEvents::onHubStateChanged(bool connected)
 {
-	blog(LOG_INFO, "[Recast Events] Kick Pusher connected");
-	connected_ = true;
-	emit connectionStateChanged(true);
-	subscribeToChannels();
-}
-
-void RecastKickEvents::onDisconnected()
-{
-	blog(LOG_WARNING, "[Recast Events] Kick Pusher disconnected");
-
-	if (connected_) {
-		connected_ = false;
-		emit connectionStateChanged(false);
-	}
-
-	if (!reconnect_timer_->isActive())
-		reconnect_timer_->start(5000);
-}
-
-void RecastKickEvents::onReconnectTimer()
-{
-	if (channel_slug_.isEmpty())
+	connected = connected && subscribed_;
+	if (connected_ == connected)
 		return;
 
-	blog(LOG_INFO,
-	     "[Recast Events] Attempting Kick events reconnect");
-
-	if (channel_id_ == 0)
-		fetchChannelInfo();
-	else
-		connectPusher();
-}
-
-void RecastKickEvents::subscribeToChannels()
-{
-	/* Subscribe to channel events */
-	if (channel_id_ > 0) {
-		QJsonObject sub;
-		sub["event"] = QStringLiteral("pusher:subscribe");
-		QJsonObject sub_data;
-		sub_data["auth"] = QString();
-		sub_data["channel"] = QString("channel.%1")
-			.arg(channel_id_);
-		sub["data"] = sub_data;
-		ws_->sendTextMessage(
-			QString::fromUtf8(
-				QJsonDocument(sub).toJson(
-					QJsonDocument::Compact)));
-
-		blog(LOG_INFO,
-		     "[Recast Events] Subscribed to Kick channel.%d",
-		     channel_id_);
-	}
-
-	/* Subscribe to chatroom events (for sub/follow events) */
-	if (chatroom_id_ > 0) {
-		QJsonObject sub;
-		sub["event"] = QStringLiteral("pusher:subscribe");
-		QJsonObject sub_data;
-		sub_data["auth"] = QString();
-		sub_data["channel"] = QString("chatrooms.%1.v2")
-			.arg(chatroom_id_);
-		sub["data"] = sub_data;
-		ws_->sendTextMessage(
-			QString::fromUtf8(
-				QJsonDocument(sub).toJson(
-					QJsonDocument::Compact)));
-
-		blog(LOG_INFO,
-		     "[Recast Events] Subscribed to Kick chatrooms.%d.v2",
-		     chatroom_id_);
-	}
+	connected_ = connected;
+	emit connectionStateChanged(connected);
 }
 
-void RecastKickEvents::onTextMessageReceived(const QString &raw)
+void RecastKickEvents::onPusherEvent(const QString &event,
+				     const QJsonObject &data, int topic)
 {
-	QJsonDocument doc = QJsonDocument::fromJson(raw.toUtf8());
-	if (!doc.isObject())
-		return;
+	Q_UNUSED(topic);
 
-	QJsonObject root = doc.object();
-	QString event_name = root.value("event").toString();
-	QString data_str = root.value("data").toString();
-
-	/* Pusher internal events */
-	if (event_name.startsWith("pusher:"))
+	RecastPlatformEvent evt = recast_parse_kick_event(event, data);
+	if (evt.type == EVENT_UNKNOWN)
 		return;
 
-	/* Parse the data string as JSON */
-	QJsonDocument data_doc =
-		QJsonDocument::fromJson(data_str.toUtf8());
-	QJsonObject data;
-	if (data_doc.isObject())
-		data = data_doc.object();
-
-	RecastPlatformEvent evt = parseKickEvent(event_name, data);
-	if (evt.type != EVENT_UNKNOWN)
-		emit eventReceived(evt);
-}
-
-RecastPlatformEvent RecastKickEvents::parseKickEvent(
-	const QString &event_name, const QJsonObject &data)
-{
-	RecastPlatformEvent evt;
-	evt.platform = QStringLiteral("kick");
-	evt.timestamp = QDateTime::currentMSecsSinceEpoch();
-
-	if (event_name == "App\\Events\\SubscriptionEvent") {
-		evt.type = EVENT_SUBSCRIBE;
-		evt.username =
-			data.value("username").toString();
-		evt.displayName = evt.username;
-		evt.amount = data.value("months").toInt(1);
-
-	} else if (event_name ==
-		   "App\\Events\\GiftedSubscriptionsEvent") {
-		evt.type = EVENT_GIFT_SUB;
-		evt.username =
-			data.value("gifter_username").toString();
-		evt.displayName = evt.username;
-		QJsonArray gifted =
-			data.value("gifted_usernames").toArray();
-		evt.amount = gifted.size();
-		if (evt.amount == 0)
-			evt.amount = data.value("gifted_count").toInt(1);
-
-	} else if (event_name ==
-		   "App\\Events\\LuckyUsersWhoGotGiftSubscriptionsEvent") {
-		/* Recipients of gift subs -- skip to avoid duplicates,
-		 * the GiftedSubscriptionsEvent covers the gifter */
-		evt.type = EVENT_UNKNOWN;
-
-	} else if (event_name == "App\\Events\\FollowersUpdated") {
-		evt.type = EVENT_FOLLOW;
-		/* FollowersUpdated gives a count, not individual user info */
-		evt.username = data.value("username").toString();
-		evt.displayName = evt.username;
-		if (evt.username.isEmpty()) {
-			evt.displayName = QStringLiteral("Someone");
-			evt.username = QStringLiteral("unknown");
-		}
-
-	} else if (event_name ==
-		   "App\\Events\\GiftsLeaderboardUpdated") {
-		/* Leaderboard update, not a discrete event */
-		evt.type = EVENT_UNKNOWN;
-
-	} else {
-		evt.type = EVENT_UNKNOWN;
-		blog(LOG_DEBUG,
-		     "[Recast Events] Unknown Kick event: %s",
-		     event_name.toUtf8().constData());
-	}
-
-	return evt;
+	emit eventReceived(evt);
 }
 
 /* ====================================================================
@@ -1092,19 +625,12 @@ RecastEventsDock::RecastEventsDock(QWidget *parent)
 	indicators_layout_->setContentsMargins(4, 2, 4, 2);
 	indicators_layout_->setSpacing(8);
 	indicators_layout_->addStretch();
-	main_layout->addWidget(indicators_widget_);
 
-	/* Scroll area for events */
-	scroll_area_ = new QScrollArea;
-	scroll_area_->setWidgetResizable(true);
-	scroll_area_->setHorizontalScrollBarPolicy(
-		Qt::ScrollBarAlwaysOff);
-
-	events_container_ = new QWidget;
-	events_layout_ = new QVBoxLayout(events_container_);
-	events_layout_->setAlignment(Qt::AlignTop);
-	events_layout_->setContentsMargins(4, 4, 4, 4);
-	events_layout_->setSpacing(4);
+	/* Running totals for the current stream, from the journal */
+	totals_label_ = new QLabel;
+	totals_label_->setStyleSheet("color: #999; font-size: 11px;");
+	indicators_layout_->addWidget(totals_label_);
+	main_layout->addWidget(indicators_widget_);
 
 	/* Empty state label */
 	empty_label_ = new QLabel(
@@ -1114,13 +640,84 @@ RecastEventsDock::RecastEventsDock(QWidget *parent)
 	empty_label_->setWordWrap(true);
 	empty_label_->setStyleSheet(
 		"color: #999; font-style: italic; padding: 24px;");
-	events_layout_->addWidget(empty_label_);
+	main_layout->addWidget(empty_label_);
+
+	/* ---- Events feed (ring buffer model + painted cards) ---- */
+	events_model_ = new RecastEventsModel(MAX_EVENTS, this);
+	events_delegate_ = new RecastEventsDelegate(events_model_, this);
+
+	events_view_ = new QListView;
+	events_view_->setModel(events_model_);
+	events_view_->setItemDelegate(events_delegate_);
+	events_view_->setSelectionMode(QAbstractItemView::NoSelection);
+	events_view_->setFocusPolicy(Qt::NoFocus);
+	events_view_->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+	events_view_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+	events_view_->setResizeMode(QListView::Adjust);
+	events_view_->setUniformItemSizes(false);
+	events_view_->setMouseTracking(true);
+	events_view_->viewport()->setAttribute(Qt::WA_Hover);
+	events_view_->setFrameShape(QFrame::NoFrame);
+	events_view_->setStyleSheet(
+		"QListView { background: transparent; padding: 4px; }");
+	events_view_->setVisible(false);
+	main_layout->addWidget(events_view_, 1);
+
+	pending_ = std::make_unique<RecastBatchQueue<RecastPlatformEvent>>(
+		this, FLUSH_INTERVAL_MS, MAX_EVENTS,
+		[this](std::vector<RecastPlatformEvent> &batch) {
+			flushEvents(batch);
+		});
+
+	/* Replay the tail of the journal so the feed survives restarts */
+	journal_ = std::make_unique<RecastEventJournal>();
+	char *profile_dir = obs_frontend_get_current_profile_path();
+	if (profile_dir) {
+		journal_->open(QString::fromUtf8(profile_dir) +
+			       QStringLiteral("/recast-events.journal"));
+		bfree(profile_dir);
+	}
+	if (!journal_->replay().empty()) {
+		empty_label_->setVisible(false);
+		events_view_->setVisible(true);
+		events_model_->prependEvents(journal_->replay());
+	}
+	journal_->releaseReplay();
+	updateTotals();
+}
+
+RecastEventsDock::~RecastEventsDock()
+{
+	pending_->clear();
+}
 
-	scroll_area_->setWidget(events_container_);
-	main_layout->addWidget(scroll_area_);
+void RecastEventsDock::markStreamStart()
+{
+	journal_->markStreamStart(QDateTime::currentMSecsSinceEpoch());
+	updateTotals();
 }
 
-RecastEventsDock::~RecastEventsDock() {}
+void RecastEventsDock::updateTotals()
+{
+	RecastEventJournal::Totals t = journal_->streamTotals();
+	if (!t.events) {
+		totals_label_->clear();
+		return;
+	}
+
+	QStringList parts;
+	if (t.follows)
+		parts << QString("%1 follows").arg(t.follows);
+	if (t.subs)
+		parts << QString("%1 subs").arg(t.subs);
+	if (t.bits)
+		parts << QString("%1 bits").arg(t.bits);
+	if (t.value > 0.0)
+		parts << QString::number(t.value, 'f', 2);
+	totals_label_->setText(parts.join(QStringLiteral(" \u00b7 ")));
+	totals_label_->setToolTip(
+		QString("This stream: %1 events").arg(t.events));
+}
 
 void RecastEventsDock::addProvider(RecastEventProvider *provider)
 {
@@ -1138,8 +735,7 @@ void RecastEventsDock::addProvider(RecastEventProvider *provider)
 	auto *label = new QLabel;
 	label->setFixedSize(16, 16);
 	QString plat = provider->platform();
-	QIcon icon = recast_platform_icon(plat);
-	label->setPixmap(icon.pixmap(16, 16));
+	label->setPixmap(recast_platform_pixmap(plat, 16));
 	label->setToolTip(QString("%1: disconnected").arg(plat));
 	label->setStyleSheet("opacity: 0.4;");
 
@@ -1172,43 +768,28 @@ void RecastEventsDock::removeProvider(RecastEventProvider *provider)
 
 void RecastEventsDock::onEventReceived(const RecastPlatformEvent &event)
 {
-	QFrame *card = createEventCard(event);
-
-	/* Hide empty label */
-	empty_label_->setVisible(false);
-
-	/* Insert at top (newest first) */
-	events_layout_->insertWidget(0, card);
-	event_count_++;
-
-	/* Remove oldest if over limit */
-	while (event_count_ > MAX_EVENTS) {
-		int last_idx = events_layout_->count() - 1;
-		/* Skip the empty label if it's the last widget */
-		QLayoutItem *item = events_layout_->itemAt(last_idx);
-		if (item && item->widget() &&
-		    item->widget() != empty_label_) {
-			QWidget *w = item->widget();
-			events_layout_->removeWidget(w);
-			w->deleteLater();
-			event_count_--;
-		} else if (last_idx > 1) {
-			item = events_layout_->itemAt(last_idx - 1);
-			if (item && item->widget()) {
-				QWidget *w = item->widget();
-				events_layout_->removeWidget(w);
-				w->deleteLater();
-				event_count_--;
-			}
-		} else {
-			break;
-		}
+	RECAST_PERF_SCOPE(RECAST_PERF_EVENT_INGEST);
+
+	/* Journaled on arrival; duplicates never reach the feed */
+	if (journal_->append(event))
+		pending_->push(event);
+}
+
+void RecastEventsDock::flushEvents(std::vector<RecastPlatformEvent> &batch)
+{
+	/* Swap the empty label for the feed on the first event */
+	if (!empty_label_->isHidden()) {
+		empty_label_->setVisible(false);
+		events_view_->setVisible(true);
 	}
 
+	/* Newest first; the model trims the oldest rows in the same step */
+	events_model_->prependEvents(batch);
+
 	/* Scroll to top to show newest event */
-	QScrollBar *sb = scroll_area_->verticalScrollBar();
-	if (sb)
-		sb->setValue(sb->minimum());
+	events_view_->scrollToTop();
+
+	updateTotals();
 }
 
 void RecastEventsDock::onConnectionStateChanged(bool connected)
@@ -1239,229 +820,3 @@ void RecastEventsDock::updateIndicator(RecastEventProvider *provider,
 		label->setStyleSheet("opacity: 0.4;");
 	}
 }
-
-QFrame *RecastEventsDock::createEventCard(const RecastPlatformEvent &event)
-{
-	auto *card = new QFrame;
-	card->setFrameShape(QFrame::StyledPanel);
-
-	QString border_color = eventTypeColor(event.type);
-	card->setStyleSheet(
-		QString("QFrame { border-left: 3px solid %1; "
-			"background: transparent; padding: 4px; }"
-			"QFrame:hover { background: rgba(255,255,255,15); }")
-			.arg(border_color));
-
-	auto *layout = new QVBoxLayout(card);
-	layout->setContentsMargins(8, 4, 8, 4);
-	layout->setSpacing(2);
-
-	/* Top row: platform icon + event type label */
-	auto *top_row = new QHBoxLayout;
-	top_row->setSpacing(6);
-
-	/* Platform icon */
-	auto *platform_icon = new QLabel;
-	platform_icon->setFixedSize(16, 16);
-	QIcon icon = recast_platform_icon(event.platform);
-	platform_icon->setPixmap(icon.pixmap(16, 16));
-	top_row->addWidget(platform_icon);
-
-	/* Event type label */
-	auto *type_label = new QLabel(eventTypeLabel(event.type));
-	type_label->setStyleSheet(
-		QString("color: %1; font-weight: bold; font-size: 11px;")
-			.arg(border_color));
-	top_row->addWidget(type_label);
-
-	top_row->addStretch();
-
-	/* Timestamp */
-	QDateTime dt = QDateTime::fromMSecsSinceEpoch(event.timestamp);
-	auto *time_label = new QLabel(dt.toString("hh:mm:ss"));
-	time_label->setStyleSheet("color: #888; font-size: 10px;");
-	top_row->addWidget(time_label);
-
-	layout->addLayout(top_row);
-
-	/* Description text */
-	auto *desc_label = new QLabel(eventDescription(event));
-	desc_label->setWordWrap(true);
-	desc_label->setStyleSheet("font-size: 12px;");
-	layout->addWidget(desc_label);
-
-	/* Monetary value if applicable */
-	if (event.monetaryValue > 0.0) {
-		QString value_text;
-		if (!event.currency.isEmpty())
-			value_text = QString("%1 %2")
-				.arg(event.monetaryValue, 0, 'f', 2)
-				.arg(event.currency);
-		else
-			value_text = QString("$%1")
-				.arg(event.monetaryValue, 0, 'f', 2);
-
-		auto *value_label = new QLabel(value_text);
-		value_label->setStyleSheet(
-			"color: #FFD700; font-weight: bold; font-size: 12px;");
-		layout->addWidget(value_label);
-	}
-
-	return card;
-}
-
-QString RecastEventsDock::eventDescription(
-	const RecastPlatformEvent &event) const
-{
-	QString name = escapeHtml(
-		event.displayName.isEmpty()
-			? event.username : event.displayName);
-
-	switch (event.type) {
-	case EVENT_FOLLOW:
-		return QString("<b>%1</b> followed!").arg(name);
-
-	case EVENT_SUBSCRIBE: {
-		QString tier_str;
-		if (event.tier == "1000")
-			tier_str = "Tier 1";
-		else if (event.tier == "2000")
-			tier_str = "Tier 2";
-		else if (event.tier == "3000")
-			tier_str = "Tier 3";
-		else if (!event.tier.isEmpty())
-			tier_str = event.tier;
-		else
-			tier_str = "Tier 1";
-		return QString("<b>%1</b> subscribed at %2!")
-			.arg(name, tier_str);
-	}
-
-	case EVENT_GIFT_SUB: {
-		QString tier_str;
-		if (event.tier == "1000")
-			tier_str = "Tier 1";
-		else if (event.tier == "2000")
-			tier_str = "Tier 2";
-		else if (event.tier == "3000")
-			tier_str = "Tier 3";
-		else if (!event.tier.isEmpty())
-			tier_str = event.tier;
-		else
-			tier_str = "Tier 1";
-		return QString("<b>%1</b> gifted %2 %3 subs!")
-			.arg(name).arg(event.amount).arg(tier_str);
-	}
-
-	case EVENT_RESUB:
-		return QString("<b>%1</b> resubscribed for %2 months!")
-			.arg(name).arg(event.amount);
-
-	case EVENT_BITS:
-		return QString("<b>%1</b> cheered %2 bits!")
-			.arg(name).arg(event.amount);
-
-	case EVENT_SUPER_CHAT: {
-		QString currency = event.currency.isEmpty()
-			? QStringLiteral("$") : event.currency;
-		return QString("<b>%1</b> sent a Super Chat: %2%3!")
-			.arg(name, currency)
-			.arg(event.monetaryValue, 0, 'f', 2);
-	}
-
-	case EVENT_SUPER_STICKER: {
-		QString currency = event.currency.isEmpty()
-			? QStringLiteral("$") : event.currency;
-		return QString("<b>%1</b> sent a Super Sticker: %2%3!")
-			.arg(name, currency)
-			.arg(event.monetaryValue, 0, 'f', 2);
-	}
-
-	case EVENT_MEMBER:
-		return QString("<b>%1</b> became a member!")
-			.arg(name);
-
-	case EVENT_MEMBER_MILESTONE:
-		return QString("<b>%1</b> has been a member for %2 months!")
-			.arg(name).arg(event.amount);
-
-	case EVENT_MEMBER_GIFT:
-		return QString("<b>%1</b> gifted %2 memberships!")
-			.arg(name).arg(event.amount);
-
-	case EVENT_RAID:
-		return QString("<b>%1</b> raided with %2 viewers!")
-			.arg(name).arg(event.amount);
-
-	case EVENT_CHANNEL_POINTS:
-		return QString("<b>%1</b> redeemed %2!")
-			.arg(name, escapeHtml(event.message));
-
-	case EVENT_HYPE_TRAIN:
-		return QString("Hype Train level %1!")
-			.arg(event.amount);
-
-	case EVENT_POLL:
-		return QString("Poll: %1")
-			.arg(escapeHtml(event.message));
-
-	case EVENT_UNKNOWN:
-	default:
-		return QString("<b>%1</b> triggered an event")
-			.arg(name);
-	}
-}
-
-QString RecastEventsDock::eventTypeLabel(RecastEventType type) const
-{
-	switch (type) {
-	case EVENT_FOLLOW:           return QStringLiteral("NEW FOLLOW");
-	case EVENT_SUBSCRIBE:        return QStringLiteral("SUBSCRIPTION");
-	case EVENT_GIFT_SUB:         return QStringLiteral("GIFT SUBS");
-	case EVENT_RESUB:            return QStringLiteral("RESUB");
-	case EVENT_BITS:             return QStringLiteral("BITS");
-	case EVENT_SUPER_CHAT:       return QStringLiteral("SUPER CHAT");
-	case EVENT_SUPER_STICKER:    return QStringLiteral("SUPER STICKER");
-	case EVENT_MEMBER:           return QStringLiteral("NEW MEMBER");
-	case EVENT_MEMBER_MILESTONE: return QStringLiteral("MILESTONE");
-	case EVENT_MEMBER_GIFT:      return QStringLiteral("GIFT MEMBERS");
-	case EVENT_RAID:             return QStringLiteral("RAID");
-	case EVENT_CHANNEL_POINTS:   return QStringLiteral("REDEMPTION");
-	case EVENT_HYPE_TRAIN:       return QStringLiteral("HYPE TRAIN");
-	case EVENT_POLL:             return QStringLiteral("POLL");
-	case EVENT_UNKNOWN:
-	default:                     return QStringLiteral("EVENT");
-	}
-}
-
-QString RecastEventsDock::eventTypeColor(RecastEventType type) const
-{
-	switch (type) {
-	case EVENT_FOLLOW:           return QStringLiteral("#4CAF50"); /* green */
-	case EVENT_SUBSCRIBE:        return QStringLiteral("#9C27B0"); /* purple */
-	case EVENT_GIFT_SUB:         return QStringLiteral("#AB47BC"); /* light purple */
-	case EVENT_RESUB:            return QStringLiteral("#7B1FA2"); /* dark purple */
-	case EVENT_BITS:             return QStringLiteral("#FF9800"); /* orange */
-	case EVENT_SUPER_CHAT:       return QStringLiteral("#FFEB3B"); /* yellow */
-	case EVENT_SUPER_STICKER:    return QStringLiteral("#FDD835"); /* amber */
-	case EVENT_MEMBER:           return QStringLiteral("#4CAF50"); /* green */
-	case EVENT_MEMBER_MILESTONE: return QStringLiteral("#66BB6A"); /* light green */
-	case EVENT_MEMBER_GIFT:      return QStringLiteral("#AB47BC"); /* light purple */
-	case EVENT_RAID:             return QStringLiteral("#F44336"); /* red */
-	case EVENT_CHANNEL_POINTS:   return QStringLiteral("#2196F3"); /* blue */
-	case EVENT_HYPE_TRAIN:       return QStringLiteral("#E91E63"); /* pink */
-	case EVENT_POLL:             return QStringLiteral("#00BCD4"); /* cyan */
-	case EVENT_UNKNOWN:
-	default:                     return QStringLiteral("#999999"); /* gray */
-	}
-}
-
-QString RecastEventsDock::escapeHtml(const QString &text)
-{
-	QString out = text;
-	out.replace('&', "&amp;");
-	out.replace('<', "&lt;");
-	out.replace('>', "&gt;");
-	out.replace('"', "&quot;");
-	return out;
-}
@@ -2,63 +2,33 @@
 
 #include <QObject>
 #include <QWidget>
-#include <QScrollArea>
+#include <QListView>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
-#include <QFrame>
 #include <QWebSocket>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QTimer>
 #include <QString>
+#include <QJsonArray>
 #include <QJsonObject>
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#include "recast-feed-parse.h"
+#include "recast-ui-batch.h"
+
 extern "C" {
 #include <obs.h>
 }
 
-/* ---- Event types shared by all platforms ---- */
-
-enum RecastEventType {
-	EVENT_FOLLOW,
-	EVENT_SUBSCRIBE,
-	EVENT_GIFT_SUB,
-	EVENT_RESUB,
-	EVENT_BITS,
-	EVENT_SUPER_CHAT,
-	EVENT_SUPER_STICKER,
-	EVENT_MEMBER,
-	EVENT_MEMBER_MILESTONE,
-	EVENT_MEMBER_GIFT,
-	EVENT_RAID,
-	EVENT_CHANNEL_POINTS,
-	EVENT_HYPE_TRAIN,
-	EVENT_POLL,
-	EVENT_UNKNOWN,
-};
-
-/* ---- Platform event data ---- */
-
-struct RecastPlatformEvent {
-	RecastEventType type = EVENT_UNKNOWN;
-	QString platform;       /* twitch, youtube, kick */
-	QString username;       /* who triggered it */
-	QString displayName;
-	QString message;        /* optional text */
-	int amount = 0;         /* bits, months, viewers, gift count, etc. */
-	QString tier;           /* sub tier: "1000"/"2000"/"3000" for Twitch; level name for YouTube */
-	double monetaryValue = 0.0; /* USD value for super chats, bits value, etc. */
-	QString currency;       /* ISO currency code */
-	bool isAnonymous = false;
-	qint64 timestamp = 0;
-};
-
 /* ---- Abstract event provider ---- */
 
+/* Like chat providers, these run on the network thread. */
+
 class RecastEventProvider : public QObject {
 	Q_OBJECT
 
@@ -101,20 +71,21 @@ private slots:
 private:
 	QWebSocket *ws_ = nullptr;
 	QWebSocket *reconnect_ws_ = nullptr;
-	QNetworkAccessManager *net_mgr_ = nullptr;
 	QTimer *reconnect_timer_ = nullptr;
 	QTimer *keepalive_timer_ = nullptr;
 	QString session_id_;
-	bool connected_ = false;
+	std::atomic<bool> connected_{false};
 
 	void createSubscription(const QString &type, const QString &version,
-				const QJsonObject &condition);
+				const QJsonObject &condition,
+				bool retry_auth = true);
+	void sendSubscription(const QString &type, const QString &version,
+			      const QJsonObject &condition,
+			      const QString &access_token, bool retry_auth);
 	void createAllSubscriptions();
-	RecastPlatformEvent parseNotification(const QString &sub_type,
-					      const QJsonObject &event_data);
 };
 
-/* ---- YouTube Live Events via polling ---- */
+/* ---- YouTube Live Events via the shared liveChat poller ---- */
 
 class RecastYouTubeEvents : public RecastEventProvider {
 	Q_OBJECT
@@ -128,25 +99,16 @@ public:
 	bool isConnected() const override;
 	QString platform() const override { return QStringLiteral("youtube"); }
 
-private slots:
-	void onPollTimer();
-	void onReconnectTimer();
-
 private:
-	QNetworkAccessManager *net_ = nullptr;
-	QTimer *poll_timer_ = nullptr;
-	QTimer *reconnect_timer_ = nullptr;
-	QString live_chat_id_;
-	QString next_page_token_;
-	int poll_interval_ms_ = 5000;
-	bool connected_ = false;
-
-	void fetchLiveChatId();
-	void pollMessages();
-	RecastPlatformEvent parseEventItem(const QJsonObject &item);
+	/* Polling is shared with the chat dock (RecastYouTubeLiveChat) */
+	bool subscribed_ = false;
+	std::atomic<bool> connected_{false};
+
+	void onPollerStateChanged(bool connected);
+	void onEventItems(const QJsonArray &items);
 };
 
-/* ---- Kick Events via Pusher WebSocket ---- */
+/* ---- Kick Events via the shared Pusher connection ---- */
 
 class RecastKickEvents : public RecastEventProvider {
 	Q_OBJECT
@@ -161,30 +123,24 @@ public:
 	bool isConnected() const override;
 	QString platform() const override { return QStringLiteral("kick"); }
 
-private slots:
-	void onConnected();
-	void onDisconnected();
-	void onTextMessageReceived(const QString &raw);
-	void onReconnectTimer();
-
 private:
-	QWebSocket *ws_ = nullptr;
-	QNetworkAccessManager *net_ = nullptr;
-	QTimer *reconnect_timer_ = nullptr;
+	/* Socket and channel lookup are shared with the chat dock
+	 * (RecastKickHub) */
 	QString channel_slug_;
-	int channel_id_ = 0;
-	int chatroom_id_ = 0;
-	bool connected_ = false;
-
-	void fetchChannelInfo();
-	void connectPusher();
-	void subscribeToChannels();
-	RecastPlatformEvent parseKickEvent(const QString &event_name,
-					   const QJsonObject &data);
+	bool subscribed_ = false;
+	std::atomic<bool> connected_{false};
+
+	void onHubStateChanged(bool connected);
+	void onPusherEvent(const QString &event, const QJsonObject &data,
+			   int topic);
 };
 
 /* ---- Unified events feed dock ---- */
 
+class RecastEventsModel;
+class RecastEventsDelegate;
+class RecastEventJournal;
+
 class RecastEventsDock : public QWidget {
 	Q_OBJECT
 
@@ -195,28 +151,36 @@ public:
 	void addProvider(RecastEventProvider *provider);
 	void removeProvider(RecastEventProvider *provider);
 
+	/* Starts a new "this stream" range in the journal */
+	void markStreamStart();
+
+	RecastEventJournal *journal() const { return journal_.get(); }
+
 private slots:
 	void onEventReceived(const RecastPlatformEvent &event);
 	void onConnectionStateChanged(bool connected);
 
 private:
-	QScrollArea *scroll_area_ = nullptr;
-	QVBoxLayout *events_layout_ = nullptr;
-	QWidget *events_container_ = nullptr;
+	QListView *events_view_ = nullptr;
+	RecastEventsModel *events_model_ = nullptr;
+	RecastEventsDelegate *events_delegate_ = nullptr;
 	QLabel *empty_label_ = nullptr;
+	QLabel *totals_label_ = nullptr;
 	QHBoxLayout *indicators_layout_ = nullptr;
 	QWidget *indicators_widget_ = nullptr;
 
 	std::vector<RecastEventProvider *> providers_;
 	QMap<RecastEventProvider *, QLabel *> indicator_labels_;
-	int event_count_ = 0;
+
+	/* Arrivals are coalesced and flushed once per UI tick */
+	std::unique_ptr<RecastBatchQueue<RecastPlatformEvent>> pending_;
+
+	std::unique_ptr<RecastEventJournal> journal_;
 
 	static const int MAX_EVENTS = 200;
+	static const int FLUSH_INTERVAL_MS = 33;
 
-	QFrame *createEventCard(const RecastPlatformEvent &event);
-	QString eventDescription(const RecastPlatformEvent &event) const;
-	QString eventTypeLabel(RecastEventType type) const;
-	QString eventTypeColor(RecastEventType type) const;
+	void flushEvents(std::vector<RecastPlatformEvent> &batch);
 	void updateIndicator(RecastEventProvider *provider, bool connected);
-	static QString escapeHtml(const QString &text);
+	void updateTotals();
 };
@@ -0,0 +1,557 @@
+/*
+ * recast-feed-parse.cpp -- Chat and event parsing for all platforms.
+ */
+
+#include "recast-feed-parse.h"
+#include "recast-irc.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QStringView>
+#include <QVariant>
+
+#include <algorithm>
+#include <vector>
+
+/* ====================================================================
+ * Image URLs
+ * ==================================================================== */
+
+QUrl recast_twitch_emote_url(const QString &id)
+{
+	return QUrl(QStringLiteral(
+		"https://static-cdn.jtvnw.net/emoticons/v2/%1/default/dark/2.0")
+			    .arg(id));
+}
+
+QUrl recast_kick_emote_url(const QString &id)
+{
+	return QUrl(QStringLiteral("https://files.kick.com/emotes/%1/fullsize")
+			    .arg(id));
+}
+
+/* ====================================================================
+ * Emote parsing
+ * ==================================================================== */
+
+/*
+ * Twitch "emotes" tag: "25:0-4,12-16/1902:6-10". Ranges are inclusive
+ * and count code points, so they are mapped onto UTF-16 offsets.
+ */
+static QList<RecastChatEmote> parse_twitch_emotes(QStringView spec,
+						  const QString &text)
+{
+	QList<RecastChatEmote> out;
+	if (spec.isEmpty())
+		return out;
+
+	std::vector<int> offsets; /* code point -> UTF-16 offset */
+	offsets.reserve(text.size() + 1);
+	for (int i = 0; i < text.size(); i++) {
+		offsets.push_back(i);
+		if (text[i].isHighSurrogate() && i + 1 < text.size())
+			i++;
+	}
+	offsets.push_back(text.size());
+	const int code_points = (int)offsets.size() - 1;
+
+	for (QStringView emote : spec.split(u'/')) {
+		qsizetype colon = emote.indexOf(u':');
+		if (colon <= 0)
+			continue;
+		QString id = emote.first(colon).toString();
+
+		for (QStringView range : emote.sliced(colon + 1).split(u',')) {
+			qsizetype dash = range.indexOf(u'-');
+			if (dash <= 0)
+				continue;
+			bool ok1, ok2;
+			int first = range.first(dash).toInt(&ok1);
+			int last = range.sliced(dash + 1).toInt(&ok2);
+			if (!ok1 || !ok2 || first < 0 || last < first ||
+			    last >= code_points)
+				continue;
+
+			RecastChatEmote e;
+			e.start = offsets[first];
+			e.length = offsets[last + 1] - e.start;
+			e.key = QStringLiteral("twitch:") + id;
+			e.url = recast_twitch_emote_url(id);
+			out.append(e);
+		}
+	}
+
+	std::sort(out.begin(), out.end(),
+		  [](const RecastChatEmote &a, const RecastChatEmote &b) {
+			  return a.start < b.start;
+		  });
+
+	/* Drop overlaps from malformed tags */
+	QList<RecastChatEmote> clean;
+	int end = 0;
+	for (const RecastChatEmote &e : out) {
+		if (e.start < end)
+			continue;
+		clean.append(e);
+		end = e.start + e.length;
+	}
+	return clean;
+}
+
+/* Kick inlines emotes as "[emote:37226:KEKW]"; replace each token with
+ * its name and record the span */
+static QList<RecastChatEmote> parse_kick_emotes(QString *text)
+{
+	static const QRegularExpression re(
+		QStringLiteral("\\[emote:(\\d+):([^\\]]*)\\]"));
+
+	QList<RecastChatEmote> out;
+	if (!text->contains(QStringLiteral("[emote:")))
+		return out;
+
+	QString result;
+	result.reserve(text->size());
+	qsizetype pos = 0;
+
+	QRegularExpressionMatchIterator it = re.globalMatch(*text);
+	while (it.hasNext()) {
+		QRegularExpressionMatch m = it.next();
+		result += QStringView(*text).sliced(pos,
+						    m.capturedStart() - pos);
+
+		QString id = m.captured(1);
+		QString name = m.captured(2);
+		if (name.isEmpty())
+			name = QStringLiteral("emote");
+
+		RecastChatEmote e;
+		e.start = (int)result.size();
+		e.length = (int)name.size();
+		e.key = QStringLiteral("kick:") + id;
+		e.url = recast_kick_emote_url(id);
+		out.append(e);
+
+		result += name;
+		pos = m.capturedEnd();
+	}
+	result += QStringView(*text).sliced(pos);
+
+	*text = result;
+	return out;
+}
+
+/* ====================================================================
+ * Chat
+ * ==================================================================== */
+
+RecastChatMessage recast_parse_twitch_privmsg(const RecastIrcMessage &irc)
+{
+	RecastChatMessage msg;
+	msg.platform = QStringLiteral("twitch");
+	msg.message = irc.trailing.toString();
+	msg.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+	/* Username from prefix (user!user@user.tmi.twitch.tv) */
+	if (irc.prefix.contains(u'!'))
+		msg.username = irc.nick().toString();
+
+	/* IRCv3 tags: semicolon-separated key=value pairs */
+	RecastIrcTagIterator tags(irc.tags);
+	QStringView key, value;
+	QStringView emotes;
+	while (tags.next(&key, &value)) {
+		if (key == u"display-name") {
+			msg.displayName = value.toString();
+		} else if (key == u"color") {
+			if (!value.isEmpty())
+				msg.nameColor = QColor(value.toString());
+		} else if (key == u"mod") {
+			msg.isMod = (value == u"1");
+		} else if (key == u"subscriber") {
+			msg.isSub = (value == u"1");
+		} else if (key == u"badges") {
+			if (value.contains(u"broadcaster"))
+				msg.isOwner = true;
+			for (QStringView badge : value.split(u','))
+				if (!badge.isEmpty())
+					msg.badges.append(badge.toString());
+		} else if (key == u"emotes") {
+			emotes = value;
+		}
+	}
+
+	msg.emotes = parse_twitch_emotes(emotes, msg.message);
+
+	/* Fallback: use username if display-name was empty */
+	if (msg.displayName.isEmpty())
+		msg.displayName = msg.username;
+
+	/* Default color if none was set */
+	if (!msg.nameColor.isValid())
+		msg.nameColor = QColor(145, 70, 255);
+
+	return msg;
+}
+
+bool recast_parse_youtube_chat(const QJsonObject &item, RecastChatMessage *msg)
+{
+	QJsonObject snippet = item.value(
+		QStringLiteral("snippet")).toObject();
+	QJsonObject author = item.value(
+		QStringLiteral("authorDetails")).toObject();
+
+	/* Only handle text messages */
+	QString type = snippet.value(
+		QStringLiteral("type")).toString();
+	if (type != QStringLiteral("textMessageEvent"))
+		return false;
+
+	*msg = RecastChatMessage();
+	msg->platform = QStringLiteral("youtube");
+	msg->displayName = author.value(
+		QStringLiteral("displayName")).toString();
+	msg->username = author.value(
+		QStringLiteral("channelId")).toString();
+	msg->message = snippet.value(
+		QStringLiteral("textMessageDetails"))
+		.toObject()
+		.value(QStringLiteral("messageText"))
+		.toString();
+	msg->timestamp = QDateTime::currentMSecsSinceEpoch();
+
+	/* Assign color based on role */
+	bool isOwner = author.value(
+		QStringLiteral("isChatOwner"))
+		.toBool();
+	bool isMod = author.value(
+		QStringLiteral("isChatModerator"))
+		.toBool();
+	bool isMember = author.value(
+		QStringLiteral("isChatSponsor"))
+		.toBool();
+
+	msg->isOwner = isOwner;
+	msg->isMod = isMod;
+	msg->isSub = isMember;
+
+	if (isOwner)
+		msg->nameColor = QColor(255, 0, 0);
+	else if (isMod)
+		msg->nameColor = QColor(90, 90, 255);
+	else if (isMember)
+		msg->nameColor = QColor(44, 166, 63);
+	else
+		msg->nameColor = QColor(255, 0, 0);
+
+	return true;
+}
+
+RecastChatMessage recast_parse_kick_chat(const QJsonObject &root)
+{
+	/*
+	 * Event data (already decoded by the hub) contains:
+	 *   id, chatroom_id, content, created_at,
+	 *   sender { id, username, slug, identity { color, badges [] } }
+	 */
+	RecastChatMessage msg;
+	msg.platform = QStringLiteral("kick");
+	msg.message = root.value(QStringLiteral("content")).toString();
+	msg.emotes = parse_kick_emotes(&msg.message);
+	msg.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+	QJsonObject sender = root.value(
+		QStringLiteral("sender")).toObject();
+	msg.username = sender.value(
+		QStringLiteral("slug")).toString();
+	msg.displayName = sender.value(
+		QStringLiteral("username")).toString();
+
+	/* Identity provides color and badges */
+	QJsonObject identity = sender.value(
+		QStringLiteral("identity")).toObject();
+	QString color = identity.value(
+		QStringLiteral("color")).toString();
+	if (!color.isEmpty()) {
+		if (!color.startsWith('#'))
+			color.prepend('#');
+		msg.nameColor = QColor(color);
+	}
+	if (!msg.nameColor.isValid())
+		msg.nameColor = QColor(83, 252, 24);
+
+	/* Check badges for moderator / broadcaster / subscriber */
+	QJsonArray badges = identity.value(
+		QStringLiteral("badges")).toArray();
+	for (const QJsonValue &badge_val : badges) {
+		QJsonObject badge = badge_val.toObject();
+		QString badge_type = badge.value(
+			QStringLiteral("type")).toString();
+		if (badge_type == QStringLiteral("moderator"))
+			msg.isMod = true;
+		else if (badge_type == QStringLiteral("broadcaster"))
+			msg.isOwner = true;
+		else if (badge_type == QStringLiteral("subscriber"))
+			msg.isSub = true;
+	}
+
+	return msg;
+}
+
+/* ====================================================================
+ * Events
+ * ==================================================================== */
+
+RecastPlatformEvent recast_parse_eventsub_event(const QString &sub_type,
+						const QJsonObject &event_data)
+{
+	RecastPlatformEvent evt;
+	evt.platform = QStringLiteral("twitch");
+	evt.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+	if (sub_type == "channel.follow") {
+		evt.type = EVENT_FOLLOW;
+		evt.username = event_data.value("user_login").toString();
+		evt.displayName = event_data.value("user_name").toString();
+
+	} else if (sub_type == "channel.subscribe") {
+		evt.type = EVENT_SUBSCRIBE;
+		evt.username = event_data.value("user_login").toString();
+		evt.displayName = event_data.value("user_name").toString();
+		evt.tier = event_data.value("tier").toString();
+		evt.isAnonymous = event_data.value("is_gift").toBool();
+
+	} else if (sub_type == "channel.subscription.gift") {
+		evt.type = EVENT_GIFT_SUB;
+		evt.username = event_data.value("user_login").toString();
+		evt.displayName = event_data.value("user_name").toString();
+		evt.amount = event_data.value("total").toInt();
+		evt.tier = event_data.value("tier").toString();
+		evt.isAnonymous = event_data.value("is_anonymous").toBool();
+		if (evt.isAnonymous) {
+			evt.username = "anonymous";
+			evt.displayName = "Anonymous";
+		}
+
+	} else if (sub_type == "channel.subscription.message") {
+		evt.type = EVENT_RESUB;
+		evt.username = event_data.value("user_login").toString();
+		evt.displayName = event_data.value("user_name").toString();
+		evt.amount =
+			event_data.value("cumulative_months").toInt();
+		evt.tier = event_data.value("tier").toString();
+		QJsonObject msg_obj =
+			event_data.value("message").toObject();
+		evt.message = msg_obj.value("text").toString();
+
+	} else if (sub_type == "channel.cheer") {
+		evt.type = EVENT_BITS;
+		evt.username = event_data.value("user_login").toString();
+		evt.displayName = event_data.value("user_name").toString();
+		evt.amount = event_data.value("bits").toInt();
+		evt.message = event_data.value("message").toString();
+		evt.monetaryValue = evt.amount * 0.01;
+		evt.currency = QStringLiteral("USD");
+		evt.isAnonymous =
+			event_data.value("is_anonymous").toBool();
+		if (evt.isAnonymous) {
+			evt.username = "anonymous";
+			evt.displayName = "Anonymous";
+		}
+
+	} else if (sub_type == "channel.raid") {
+		evt.type = EVENT_RAID;
+		evt.username =
+			event_data.value("from_broadcaster_user_login")
+				.toString();
+		evt.displayName =
+			event_data.value("from_broadcaster_user_name")
+				.toString();
+		evt.amount = event_data.value("viewers").toInt();
+
+	} else if (sub_type ==
+		   "channel.channel_points_custom_reward_redemption.add") {
+		evt.type = EVENT_CHANNEL_POINTS;
+		evt.username = event_data.value("user_login").toString();
+		evt.displayName = event_data.value("user_name").toString();
+		QJsonObject reward =
+			event_data.value("reward").toObject();
+		evt.message = reward.value("title").toString();
+		evt.amount = reward.value("cost").toInt();
+		QString user_input =
+			event_data.value("user_input").toString();
+		if (!user_input.isEmpty())
+			evt.message += " - " + user_input;
+
+	} else if (sub_type == "channel.hype_train.begin" ||
+		   sub_type == "channel.hype_train.progress") {
+		evt.type = EVENT_HYPE_TRAIN;
+		evt.amount = event_data.value("level").toInt();
+		evt.displayName = QStringLiteral("Hype Train");
+		int total = event_data.value("total").toInt();
+		int goal = event_data.value("goal").toInt();
+		evt.message = QString("Level %1 - %2/%3")
+			.arg(evt.amount).arg(total).arg(goal);
+
+	} else if (sub_type == "channel.hype_train.end") {
+		evt.type = EVENT_HYPE_TRAIN;
+		evt.amount = event_data.value("level").toInt();
+		evt.displayName = QStringLiteral("Hype Train");
+		int total = event_data.value("total").toInt();
+		evt.message = QString("Ended at Level %1 (Total: %2)")
+			.arg(evt.amount).arg(total);
+
+	} else {
+		evt.type = EVENT_UNKNOWN;
+	}
+
+	return evt;
+}
+
+RecastPlatformEvent recast_parse_youtube_event(const QJsonObject &item)
+{
+	RecastPlatformEvent evt;
+	evt.platform = QStringLiteral("youtube");
+	evt.id = item.value("id").toString();
+	evt.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+	QJsonObject snippet = item.value("snippet").toObject();
+	QJsonObject author = item.value("authorDetails").toObject();
+	QString msg_type = snippet.value("type").toString();
+
+	evt.username = author.value("channelId").toString();
+	evt.displayName = author.value("displayName").toString();
+
+	if (msg_type == "superChatEvent") {
+		evt.type = EVENT_SUPER_CHAT;
+		QJsonObject details =
+			snippet.value("superChatDetails").toObject();
+		qint64 micros =
+			details.value("amountMicros").toVariant()
+				.toLongLong();
+		evt.monetaryValue = micros / 1000000.0;
+		evt.currency = details.value("currency").toString();
+		evt.message = details.value("userComment").toString();
+
+	} else if (msg_type == "superStickerEvent") {
+		evt.type = EVENT_SUPER_STICKER;
+		QJsonObject details =
+			snippet.value("superStickerDetails").toObject();
+		qint64 micros =
+			details.value("amountMicros").toVariant()
+				.toLongLong();
+		evt.monetaryValue = micros / 1000000.0;
+		evt.currency = details.value("currency").toString();
+
+	} else if (msg_type == "newSponsorEvent") {
+		evt.type = EVENT_MEMBER;
+		QJsonObject details =
+			snippet.value("newSponsorDetails").toObject();
+		evt.tier = details.value("memberLevelName").toString();
+
+	} else if (msg_type == "memberMilestoneChatEvent") {
+		evt.type = EVENT_MEMBER_MILESTONE;
+		QJsonObject details =
+			snippet.value("memberMilestoneChatDetails")
+				.toObject();
+		evt.amount = details.value("memberMonth").toInt();
+		evt.message =
+			details.value("userComment").toString();
+		evt.tier = details.value("memberLevelName").toString();
+
+	} else if (msg_type == "membershipGiftingEvent") {
+		evt.type = EVENT_MEMBER_GIFT;
+		QJsonObject details =
+			snippet.value("membershipGiftingDetails")
+				.toObject();
+		evt.amount =
+			details.value("giftMembershipsCount").toInt();
+		evt.tier = details.value("memberLevelName").toString();
+
+	} else if (msg_type == "giftMembershipReceivedEvent") {
+		/* Received gift -- treat as member event */
+		evt.type = EVENT_MEMBER;
+		QJsonObject details =
+			snippet.value("giftMembershipReceivedDetails")
+				.toObject();
+		evt.tier = details.value("memberLevelName").toString();
+		evt.message = QString("Gift from %1")
+			.arg(details.value("gifterChannelId").toString());
+
+	} else {
+		/* Not an event type we care about (regular text, etc.) */
+		evt.type = EVENT_UNKNOWN;
+	}
+
+	return evt;
+}
+
+RecastPlatformEvent recast_parse_kick_event(const QString &event_name,
+					    const QJsonObject &data)
+{
+	RecastPlatformEvent evt;
+	evt.platform = QStringLiteral("kick");
+	evt.timestamp = QDateTime::currentMSecsSinceEpoch();
+
+	if (event_name == "App\\Events\\SubscriptionEvent") {
+		evt.type = EVENT_SUBSCRIBE;
+		evt.username =
+			data.value("username").toString();
+		evt.displayName = evt.username;
+		evt.amount = data.value("months").toInt(1);
+
+	} else if (event_name ==
+		   "App\\Events\\GiftedSubscriptionsEvent") {
+		evt.type = EVENT_GIFT_SUB;
+		evt.username =
+			data.value("gifter_username").toString();
+		evt.displayName = evt.username;
+		QJsonArray gifted =
+			data.value("gifted_usernames").toArray();
+		evt.amount = gifted.size();
+		if (evt.amount == 0)
+			evt.amount = data.value("gifted_count").toInt(1);
+
+	} else if (event_name ==
+		   "App\\Events\\LuckyUsersWhoGotGiftSubscriptionsEvent") {
+		/* Recipients of gift subs -- skip to avoid duplicates,
+		 * the GiftedSubscriptionsEvent covers the gifter */
+		evt.type = EVENT_UNKNOWN;
+
+	} else if (event_name == "App\\Events\\FollowersUpdated") {
+		evt.type = EVENT_FOLLOW;
+		/* FollowersUpdated gives a count, not individual user info */
+		evt.username = data.value("username").toString();
+		evt.displayName = evt.username;
+		if (evt.username.isEmpty()) {
+			evt.displayName = QStringLiteral("Someone");
+			evt.username = QStringLiteral("unknown");
+		}
+
+	} else if (event_name ==
+		   "App\\Events\\GiftsLeaderboardUpdated") {
+		/* Leaderboard update, not a discrete event */
+		evt.type = EVENT_UNKNOWN;
+
+	} else {
+		evt.type = EVENT_UNKNOWN;
+	}
+
+	if (evt.type == EVENT_UNKNOWN)
+		return evt;
+
+	/* Not every Kick event has an id; a resubscribe replays the same
+	 * payload, so its hash identifies it just as well */
+	evt.id = data.value("id").toVariant().toString();
+	if (evt.id.isEmpty())
+		evt.id = QString::fromLatin1(
+			QCryptographicHash::hash(
+				event_name.toUtf8() +
+					QJsonDocument(data).toJson(
+						QJsonDocument::Compact),
+				QCryptographicHash::Sha1)
+				.toHex());
+	return evt;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <QColor>
+#include <QJsonObject>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+struct RecastIrcMessage;
+
+/*
+ * Feed parsing -- platform wire formats to chat messages and events.
+ *
+ * The chat and events providers hand decoded frames to these functions
+ * and only deal with sockets, polling and signals themselves. Depends on
+ * QtCore/QtGui only, so the replay benchmark can drive the same parsers
+ * without OBS.
+ */
+
+/* ---- Chat message shared by all providers ---- */
+
+/* An image span of message: [start, start + length) in UTF-16 units,
+ * keyed for RecastEmoteCache */
+struct RecastChatEmote {
+	int start = 0;
+	int length = 0;
+	QString key;
+	QUrl url;
+};
+
+struct RecastChatMessage {
+	QString platform;    /* twitch, youtube, kick */
+	QString username;
+	QString displayName;
+	QString message;
+	QColor nameColor;
+	bool isMod = false;
+	bool isSub = false;
+	bool isOwner = false;
+	qint64 timestamp = 0;
+	QList<RecastChatEmote> emotes; /* sorted, non-overlapping */
+	QStringList badges;            /* Twitch "set/version" */
+};
+
+Q_DECLARE_METATYPE(RecastChatMessage)
+
+/* ---- Event types shared by all platforms ---- */
+
+enum RecastEventType {
+	EVENT_FOLLOW,
+	EVENT_SUBSCRIBE,
+	EVENT_GIFT_SUB,
+	EVENT_RESUB,
+	EVENT_BITS,
+	EVENT_SUPER_CHAT,
+	EVENT_SUPER_STICKER,
+	EVENT_MEMBER,
+	EVENT_MEMBER_MILESTONE,
+	EVENT_MEMBER_GIFT,
+	EVENT_RAID,
+	EVENT_CHANNEL_POINTS,
+	EVENT_HYPE_TRAIN,
+	EVENT_POLL,
+	EVENT_UNKNOWN,
+};
+
+/* ---- Platform event data ---- */
+
+struct RecastPlatformEvent {
+	RecastEventType type = EVENT_UNKNOWN;
+	QString id;             /* platform message id, for dedup */
+	QString platform;       /* twitch, youtube, kick */
+	QString username;       /* who triggered it */
+	QString displayName;
+	QString message;        /* optional text */
+	int amount = 0;         /* bits, months, viewers, gift count, etc. */
+	QString tier;           /* sub tier: "1000"/"2000"/"3000" for Twitch; level name for YouTube */
+	double monetaryValue = 0.0; /* USD value for super chats, bits value, etc. */
+	QString currency;       /* ISO currency code */
+	bool isAnonymous = false;
+	qint64 timestamp = 0;
+};
+
+Q_DECLARE_METATYPE(RecastPlatformEvent)
+
+/* ---- Image URLs ---- */
+
+QUrl recast_twitch_emote_url(const QString &id);
+QUrl recast_kick_emote_url(const QString &id);
+
+/* ---- Chat ---- */
+
+/* A PRIVMSG with trailing text, as tokenized by recast_irc_parse */
+RecastChatMessage recast_parse_twitch_privmsg(const RecastIrcMessage &irc);
+
+/* One liveChatMessages item; false unless it is a textMessageEvent */
+bool recast_parse_youtube_chat(const QJsonObject &item, RecastChatMessage *msg);
+
+/* The decoded data of a Kick App\Events\ChatMessageEvent */
+RecastChatMessage recast_parse_kick_chat(const QJsonObject &data);
+
+/* ---- Events ---- */
+
+/* The returned type is EVENT_UNKNOWN for anything the feed does not
+ * show. YouTube and Kick ids come from the item itself; an EventSub id
+ * lives in the message envelope and is left to the caller. */
+
+/* payload.event of an EventSub notification, by subscription type */
+RecastPlatformEvent recast_parse_eventsub_event(const QString &sub_type,
+						const QJsonObject &event);
+
+/* One liveChatMessages item (super chats, memberships, ...) */
+RecastPlatformEvent recast_parse_youtube_event(const QJsonObject &item);
+
+/* A decoded Pusher event from the channel or chatroom topic */
+RecastPlatformEvent recast_parse_kick_event(const QString &event_name,
+					    const QJsonObject &data);
@@ -0,0 +1,264 @@
+/*
+ * recast-hit-index.cpp -- Grid-bucketed hit-test cache for the preview.
+ */
+
+#include "recast-hit-index.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <graphics/vec3.h>
+}
+
+RecastHitIndex::~RecastHitIndex()
+{
+	setScene(nullptr);
+}
+
+void RecastHitIndex::setScene(obs_scene_t *scene)
+{
+	if (scene == scene_)
+		return;
+
+	disconnectScene();
+	clear();
+	obs_scene_release(scene_);
+	scene_ = obs_scene_get_ref(scene);
+	connectScene();
+
+	std::lock_guard<std::mutex> lock(pending_mutex_);
+	pending_rebuild_ = true;
+	pending_items_.clear();
+}
+
+void RecastHitIndex::setCanvasSize(int w, int h)
+{
+	if (w == canvas_w_ && h == canvas_h_)
+		return;
+	canvas_w_ = w;
+	canvas_h_ = h;
+
+	std::lock_guard<std::mutex> lock(pending_mutex_);
+	pending_rebuild_ = true;
+}
+
+/* ---- Scene signals ---- */
+
+void RecastHitIndex::connectScene()
+{
+	if (!scene_)
+		return;
+	signal_handler_t *sh =
+		obs_source_get_signal_handler(obs_scene_get_source(scene_));
+	signal_handler_connect(sh, "item_add", onItemsChanged, this);
+	signal_handler_connect(sh, "item_remove", onItemsChanged, this);
+	signal_handler_connect(sh, "reorder", onItemsChanged, this);
+	signal_handler_connect(sh, "refresh", onItemsChanged, this);
+	signal_handler_connect(sh, "item_transform", onItemTransform, this);
+}
+
+void RecastHitIndex::disconnectScene()
+{
+	if (!scene_)
+		return;
+	signal_handler_t *sh =
+		obs_source_get_signal_handler(obs_scene_get_source(scene_));
+	signal_handler_disconnect(sh, "item_add", onItemsChanged, this);
+	signal_handler_disconnect(sh, "item_remove", onItemsChanged, this);
+	signal_handler_disconnect(sh, "reorder", onItemsChanged, this);
+	signal_handler_disconnect(sh, "refresh", onItemsChanged, this);
+	signal_handler_disconnect(sh, "item_transform", onItemTransform,
+				  this);
+}
+
+void RecastHitIndex::onItemsChanged(void *param, calldata_t *)
+{
+	auto *self = static_cast<RecastHitIndex *>(param);
+	std::lock_guard<std::mutex> lock(self->pending_mutex_);
+	self->pending_rebuild_ = true;
+}
+
+void RecastHitIndex::onItemTransform(void *param, calldata_t *cd)
+{
+	auto *self = static_cast<RecastHitIndex *>(param);
+	auto *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+
+	/* Only matched against held refs later, never dereferenced here */
+	std::lock_guard<std::mutex> lock(self->pending_mutex_);
+	if (!self->pending_rebuild_ &&
+	    std::find(self->pending_items_.begin(), self->pending_items_.end(),
+		      item) == self->pending_items_.end())
+		self->pending_items_.push_back(item);
+}
+
+/* ---- Index maintenance ---- */
+
+void RecastHitIndex::clear()
+{
+	for (Entry &e : entries_)
+		obs_sceneitem_release(e.item);
+	entries_.clear();
+	slot_of_.clear();
+	for (std::vector<int> &cell : grid_)
+		cell.clear();
+}
+
+void RecastHitIndex::applyPending()
+{
+	bool rebuild_all;
+	std::vector<obs_sceneitem_t *> items;
+	{
+		/* No obs calls under this lock: the signals that take it can
+		 * be emitted with the scene mutex held */
+		std::lock_guard<std::mutex> lock(pending_mutex_);
+		rebuild_all = pending_rebuild_;
+		pending_rebuild_ = false;
+		items.swap(pending_items_);
+	}
+
+	if (rebuild_all) {
+		rebuild();
+		return;
+	}
+
+	for (obs_sceneitem_t *item : items) {
+		auto it = slot_of_.find(item);
+		if (it == slot_of_.end())
+			continue;
+		removeFromGrid(it->second);
+		measure(entries_[it->second]);
+		addToGrid(it->second);
+	}
+}
+
+static bool collect_items_cb(obs_scene_t *, obs_sceneitem_t *item,
+			     void *param)
+{
+	auto *items = static_cast<std::vector<obs_sceneitem_t *> *>(param);
+	obs_sceneitem_addref(item);
+	items->push_back(item);
+	return true;
+}
+
+void RecastHitIndex::rebuild()
+{
+	clear();
+	if (!scene_)
+		return;
+
+	std::vector<obs_sceneitem_t *> items;
+	obs_scene_enum_items(scene_, collect_items_cb, &items);
+
+	entries_.resize(items.size());
+	for (size_t i = 0; i < items.size(); i++) {
+		entries_[i].item = items[i];
+		slot_of_[items[i]] = (int)i;
+		measure(entries_[i]);
+		addToGrid((int)i);
+	}
+}
+
+void RecastHitIndex::measure(Entry &e) const
+{
+	e.c0 = 0;
+	e.c1 = -1;
+	e.r0 = 0;
+	e.r1 = -1;
+
+	obs_source_t *src = obs_sceneitem_get_source(e.item);
+	if (!src || obs_source_get_width(src) == 0 ||
+	    obs_source_get_height(src) == 0)
+		return;
+
+	/* The box transform maps the unit square onto the item's box */
+	struct matrix4 box;
+	obs_sceneitem_get_box_transform(e.item, &box);
+	matrix4_inv(&e.inv, &box);
+
+	static const float corners[4][2] = {{0, 0}, {1, 0}, {0, 1}, {1, 1}};
+	for (int i = 0; i < 4; i++) {
+		struct vec3 local, scene;
+		vec3_set(&local, corners[i][0], corners[i][1], 0.0f);
+		vec3_transform(&scene, &local, &box);
+		if (i == 0) {
+			e.x0 = e.x1 = scene.x;
+			e.y0 = e.y1 = scene.y;
+		} else {
+			e.x0 = std::min(e.x0, scene.x);
+			e.x1 = std::max(e.x1, scene.x);
+			e.y0 = std::min(e.y0, scene.y);
+			e.y1 = std::max(e.y1, scene.y);
+		}
+	}
+
+	e.c0 = cellFor(e.x0, canvas_w_);
+	e.c1 = cellFor(e.x1, canvas_w_);
+	e.r0 = cellFor(e.y0, canvas_h_);
+	e.r1 = cellFor(e.y1, canvas_h_);
+}
+
+/* Off-canvas coordinates fall into the border cells */
+int RecastHitIndex::cellFor(float v, int extent) const
+{
+	if (extent <= 0)
+		return 0;
+	int c = (int)std::floor(v * GRID_CELLS / (float)extent);
+	return std::clamp(c, 0, GRID_CELLS - 1);
+}
+
+void RecastHitIndex::addToGrid(int slot)
+{
+	const Entry &e = entries_[slot];
+	for (int r = e.r0; r <= e.r1; r++) {
+		for (int c = e.c0; c <= e.c1; c++) {
+			std::vector<int> &cell = grid_[r * GRID_CELLS + c];
+			cell.insert(std::lower_bound(cell.begin(), cell.end(),
+						     slot),
+				    slot);
+		}
+	}
+}
+
+void RecastHitIndex::removeFromGrid(int slot)
+{
+	const Entry &e = entries_[slot];
+	for (int r = e.r0; r <= e.r1; r++) {
+		for (int c = e.c0; c <= e.c1; c++) {
+			std::vector<int> &cell = grid_[r * GRID_CELLS + c];
+			auto it = std::lower_bound(cell.begin(), cell.end(),
+						   slot);
+			if (it != cell.end() && *it == slot)
+				cell.erase(it);
+		}
+	}
+}
+
+/* ---- Query ---- */
+
+obs_sceneitem_t *RecastHitIndex::hitTest(float x, float y)
+{
+	if (!scene_)
+		return nullptr;
+	applyPending();
+
+	const std::vector<int> &cell =
+		grid_[cellFor(y, canvas_h_) * GRID_CELLS +
+		      cellFor(x, canvas_w_)];
+
+	for (auto it = cell.rbegin(); it != cell.rend(); ++it) {
+		const Entry &e = entries_[*it];
+		if (x < e.x0 || x > e.x1 || y < e.y0 || y > e.y1)
+			continue;
+		if (!obs_sceneitem_visible(e.item))
+			continue;
+
+		struct vec3 scene, local;
+		vec3_set(&scene, x, y, 0.0f);
+		vec3_transform(&local, &scene, &e.inv);
+		if (local.x >= 0.0f && local.x <= 1.0f && local.y >= 0.0f &&
+		    local.y <= 1.0f)
+			return e.item;
+	}
+	return nullptr;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <obs.h>
+#include <graphics/matrix4.h>
+}
+
+/*
+ * RecastHitIndex -- Cached scene-space bounds for preview hit-testing.
+ *
+ * Keeps, for every item of one scene, the inverse box transform and the
+ * axis-aligned bounds of its (possibly rotated) box, bucketed into a
+ * coarse grid over the canvas. A hit test only looks at the items whose
+ * bounds overlap the clicked cell, topmost first.
+ *
+ * The scene's item_transform signal re-measures just that item (a drag
+ * touches one entry); item_add / item_remove / reorder / refresh
+ * rebuild the whole index lazily on the next query. Visibility is read
+ * at query time. Queries are UI thread only; the signals may arrive on
+ * any thread.
+ */
+class RecastHitIndex {
+public:
+	RecastHitIndex() = default;
+	~RecastHitIndex();
+
+	RecastHitIndex(const RecastHitIndex &) = delete;
+	RecastHitIndex &operator=(const RecastHitIndex &) = delete;
+
+	/* Holds a ref on scene while set. NULL clears. */
+	void setScene(obs_scene_t *scene);
+	void setCanvasSize(int w, int h);
+
+	/* Topmost visible item under the scene-space point, not addref'd */
+	obs_sceneitem_t *hitTest(float x, float y);
+
+private:
+	static const int GRID_CELLS = 16; /* per axis */
+
+	struct Entry {
+		obs_sceneitem_t *item; /* ref held */
+		struct matrix4 inv;    /* scene -> unit box */
+		float x0, y0, x1, y1;  /* scene-space bounds */
+		int c0, r0, c1, r1;    /* covered cells; c0 > c1 if none */
+	};
+
+	obs_scene_t *scene_ = nullptr;
+	int canvas_w_ = 0;
+	int canvas_h_ = 0;
+
+	std::vector<Entry> entries_; /* scene order, bottom first */
+	std::unordered_map<obs_sceneitem_t *, int> slot_of_;
+	std::vector<int> grid_[GRID_CELLS * GRID_CELLS]; /* ascending */
+
+	/* Pending invalidations from scene signals */
+	std::mutex pending_mutex_;
+	bool pending_rebuild_ = true;
+	std::vector<obs_sceneitem_t *> pending_items_;
+
+	void connectScene();
+	void disconnectScene();
+	void clear();
+	void applyPending();
+	void rebuild();
+	void measure(Entry &e) const;
+	void addToGrid(int slot);
+	void removeFromGrid(int slot);
+	int cellFor(float v, int extent) const;
+
+	static void onItemsChanged(void *param, calldata_t *cd);
+	static void onItemTransform(void *param, calldata_t *cd);
+};
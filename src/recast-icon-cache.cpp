@@ -0,0 +1,151 @@
+/*
+ * recast-icon-cache.cpp -- Shared cache of painted UI icons.
+ */
+
+#include "recast-icon-cache.h"
+
+#include <QGuiApplication>
+#include <QHash>
+#include <QPainter>
+#include <QPainterPath>
+#include <QtMath>
+
+struct IconKey {
+	int kind;
+	char16_t letter;
+	QRgb rgba;
+	int size;
+
+	bool operator==(const IconKey &o) const
+	{
+		return kind == o.kind && letter == o.letter &&
+		       rgba == o.rgba && size == o.size;
+	}
+};
+
+static size_t qHash(const IconKey &k, size_t seed = 0)
+{
+	return qHashMulti(seed, k.kind, k.letter, k.rgba, k.size);
+}
+
+static QHash<IconKey, QPixmap> icon_cache;
+static qreal icon_cache_dpr = 0.0;
+
+/* ---- Painters (logical coordinates, size x size) ---- */
+
+static void paint_letter(QPainter &p, QChar letter, int size, bool circle)
+{
+	p.setPen(Qt::NoPen);
+	if (circle)
+		p.drawEllipse(0, 0, size, size);
+	else
+		p.drawRoundedRect(0, 0, size, size, size * 0.1875,
+				  size * 0.1875);
+
+	p.setPen(Qt::white);
+	QFont f = p.font();
+	f.setPixelSize(qMax(1, circle ? size * 3 / 5 : size * 5 / 8));
+	f.setBold(true);
+	p.setFont(f);
+	p.drawText(QRect(0, 0, size, size), Qt::AlignCenter, QString(letter));
+}
+
+/* Eye and lock are drawn on a 16 unit grid */
+static void paint_eye(QPainter &p, const QColor &col, bool visible)
+{
+	/* Outline only; the pupil is the one filled part */
+	p.setPen(QPen(col, 1.5));
+	p.setBrush(Qt::NoBrush);
+
+	QPainterPath eye;
+	eye.moveTo(1, 8);
+	eye.cubicTo(4, 3, 12, 3, 15, 8);
+	eye.cubicTo(12, 13, 4, 13, 1, 8);
+	p.drawPath(eye);
+
+	if (visible) {
+		p.setBrush(col);
+		p.setPen(Qt::NoPen);
+		p.drawEllipse(QPointF(8, 8), 2.5, 2.5);
+	} else {
+		p.drawLine(3, 13, 13, 3);
+	}
+}
+
+static void paint_lock(QPainter &p, const QColor &col, bool locked)
+{
+	p.setPen(QPen(col, 1.5));
+
+	/* Body, then the shackle arch (raised when open) */
+	p.setBrush(locked ? col : Qt::transparent);
+	p.drawRoundedRect(3, 9, 10, 6, 1, 1);
+
+	p.setBrush(Qt::transparent);
+	if (locked)
+		p.drawArc(4, 3, 8, 10, 0, 180 * 16);
+	else
+		p.drawArc(5, 1, 8, 10, 0, 180 * 16);
+}
+
+static QPixmap render_icon(RecastIconKind kind, QChar letter,
+			   const QColor &color, int size, qreal dpr)
+{
+	QPixmap pm(qCeil(size * dpr), qCeil(size * dpr));
+	pm.setDevicePixelRatio(dpr);
+	pm.fill(Qt::transparent);
+
+	QPainter p(&pm);
+	p.setRenderHint(QPainter::Antialiasing, true);
+
+	switch (kind) {
+	case RECAST_ICON_CIRCLE:
+	case RECAST_ICON_BADGE:
+		p.setBrush(color);
+		paint_letter(p, letter, size, kind == RECAST_ICON_CIRCLE);
+		break;
+	case RECAST_ICON_VISIBLE:
+	case RECAST_ICON_HIDDEN:
+		p.scale(size / 16.0, size / 16.0);
+		paint_eye(p, color, kind == RECAST_ICON_VISIBLE);
+		break;
+	case RECAST_ICON_LOCKED:
+	case RECAST_ICON_UNLOCKED:
+		p.scale(size / 16.0, size / 16.0);
+		paint_lock(p, color, kind == RECAST_ICON_LOCKED);
+		break;
+	}
+
+	p.end();
+	return pm;
+}
+
+/* ---- Lookup ---- */
+
+QPixmap recast_cached_pixmap(RecastIconKind kind, QChar letter,
+			     const QColor &color, int size)
+{
+	qreal dpr = qApp ? qApp->devicePixelRatio() : 1.0;
+	if (dpr != icon_cache_dpr) {
+		icon_cache.clear();
+		icon_cache_dpr = dpr;
+	}
+
+	IconKey key = {kind, letter.unicode(), color.rgba(), size};
+	auto it = icon_cache.find(key);
+	if (it == icon_cache.end())
+		it = icon_cache.insert(
+			key, render_icon(kind, letter, color, size, dpr));
+	return it.value();
+}
+
+QIcon recast_cached_icon(RecastIconKind kind, QChar letter,
+			 const QColor &color, int size)
+{
+	return QIcon(recast_cached_pixmap(kind, letter, color, size));
+}
+
+void recast_icon_cache_invalidate(void)
+{
+	icon_cache.clear();
+	icon_cache_dpr = 0.0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QChar>
+#include <QColor>
+#include <QIcon>
+#include <QPixmap>
+
+/*
+ * Process-wide cache of the small painted icons (platform circles,
+ * source-type badges, eye and lock toggles).
+ *
+ * Pixmaps are painted on first use at the application's device pixel
+ * ratio and shared by every dock afterwards. Entries are keyed by
+ * (kind, letter, color, size, DPI scale); the cache drops everything
+ * when the DPI scale changes or on recast_icon_cache_invalidate()
+ * (theme change, shutdown). UI thread only.
+ */
+
+enum RecastIconKind {
+	RECAST_ICON_CIRCLE,   /* letter on a filled circle */
+	RECAST_ICON_BADGE,    /* letter on a rounded square */
+	RECAST_ICON_VISIBLE,  /* open eye, drawn in color */
+	RECAST_ICON_HIDDEN,   /* struck-through eye */
+	RECAST_ICON_LOCKED,   /* closed padlock */
+	RECAST_ICON_UNLOCKED, /* open padlock */
+};
+
+/* Logical size in px; the pixmap carries the device pixel ratio.
+ * Returned by value: a copy shares the cached pixel data. */
+QPixmap recast_cached_pixmap(RecastIconKind kind, QChar letter,
+			     const QColor &color, int size);
+
+QIcon recast_cached_icon(RecastIconKind kind, QChar letter,
+			 const QColor &color, int size);
+
+void recast_icon_cache_invalidate(void);
@@ -0,0 +1,81 @@
+/*
+ * recast-irc.cpp -- Zero-copy IRCv3 tokenizer.
+ */
+
+#include "recast-irc.h"
+
+/* Take the next space-delimited word off the front of rest */
+static QStringView take_word(QStringView &rest)
+{
+	qsizetype space = rest.indexOf(u' ');
+	QStringView word = space < 0 ? rest : rest.first(space);
+	rest = space < 0 ? QStringView() : rest.sliced(space + 1);
+
+	/* Tolerate repeated spaces between fields */
+	while (!rest.isEmpty() && rest.front() == u' ')
+		rest = rest.sliced(1);
+	return word;
+}
+
+bool recast_irc_parse(QStringView line, RecastIrcMessage *msg)
+{
+	*msg = RecastIrcMessage();
+	QStringView rest = line;
+
+	if (rest.startsWith(u'@')) {
+		msg->tags = take_word(rest).sliced(1);
+		if (rest.isEmpty())
+			return false;
+	}
+
+	if (rest.startsWith(u':')) {
+		msg->prefix = take_word(rest).sliced(1);
+		if (rest.isEmpty())
+			return false;
+	}
+
+	msg->command = take_word(rest);
+	if (msg->command.isEmpty())
+		return false;
+
+	/* Params run up to " :" (or a leading ':'), the rest is trailing */
+	if (rest.startsWith(u':')) {
+		msg->trailing = rest.sliced(1);
+		msg->has_trailing = true;
+		return true;
+	}
+
+	qsizetype colon = rest.indexOf(QStringView(u" :"));
+	if (colon >= 0) {
+		msg->params = rest.first(colon);
+		msg->trailing = rest.sliced(colon + 2);
+		msg->has_trailing = true;
+	} else {
+		msg->params = rest;
+	}
+	return true;
+}
+
+QStringView RecastIrcMessage::nick() const
+{
+	qsizetype excl = prefix.indexOf(u'!');
+	return excl < 0 ? prefix : prefix.first(excl);
+}
+
+bool RecastIrcTagIterator::next(QStringView *key, QStringView *value)
+{
+	while (!rest_.isEmpty()) {
+		qsizetype semi = rest_.indexOf(u';');
+		QStringView tag = semi < 0 ? rest_ : rest_.first(semi);
+		rest_ = semi < 0 ? QStringView() : rest_.sliced(semi + 1);
+
+		if (tag.isEmpty())
+			continue;
+
+		qsizetype eq = tag.indexOf(u'=');
+		*key = eq < 0 ? tag : tag.first(eq);
+		*value = eq < 0 ? QStringView() : tag.sliced(eq + 1);
+		return true;
+	}
+	return false;
+}
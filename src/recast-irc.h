@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QStringView>
+
+/*
+ * IRC tokenizer -- zero-copy parsing of IRCv3 lines.
+ *
+ * Every field is a view into the caller's line; nothing is allocated
+ * until the caller converts a view it actually needs. Views are only
+ * valid while the line they point into is alive.
+ *
+ *   @tags :prefix COMMAND params :trailing
+ *
+ * Depends on QtCore only, so it can be built into benchmarks without
+ * OBS.
+ */
+
+struct RecastIrcMessage {
+	QStringView tags;    /* without the leading '@' */
+	QStringView prefix;  /* without the leading ':' */
+	QStringView command;
+	QStringView params;  /* middle params, before the trailing */
+	QStringView trailing;
+	bool has_trailing = false;
+
+	/* Nick part of the prefix (nick!user@host) */
+	QStringView nick() const;
+};
+
+/* Split one line (no CR/LF). Returns false if the line has no command. */
+bool recast_irc_parse(QStringView line, RecastIrcMessage *msg);
+
+/*
+ * RecastIrcTagIterator -- Walks "k1=v1;k2=v2;..." tag strings.
+ *
+ * Tags without '=' yield an empty value. Values are returned as-is
+ * (IRCv3 escapes are not decoded).
+ */
+class RecastIrcTagIterator {
+public:
+	explicit RecastIrcTagIterator(QStringView tags) : rest_(tags) {}
+
+	bool next(QStringView *key, QStringView *value);
+
+private:
+	QStringView rest_;
+};
+
+/* Calls fn(line) for each non-empty CRLF/LF-separated line of a frame. */
+template<typename Fn> void recast_irc_for_each_line(QStringView frame, Fn fn)
+{
+	while (!frame.isEmpty()) {
+		qsizetype nl = frame.indexOf(u'\n');
+		QStringView line = nl < 0 ? frame : frame.first(nl);
+		frame = nl < 0 ? QStringView() : frame.sliced(nl + 1);
+
+		if (line.endsWith(u'\r'))
+			line.chop(1);
+		if (!line.isEmpty())
+			fn(line);
+	}
+}
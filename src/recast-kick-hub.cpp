@@ -0,0 +1,379 @@
+/*
+ * recast-kick-hub.cpp -- Shared Kick Pusher connection.
+ *
+ * One channel lookup and one Pusher WebSocket for the Kick chat and
+ * events providers, with events dispatched by name to both.
+ */
+
+#include "recast-kick-hub.h"
+#include "recast-network.h"
+#include "recast-perf.h"
+
+#include <QJsonDocument>
+#include <QNetworkRequest>
+#include <QUrl>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+static const char *KICK_PUSHER_URL =
+	"wss://ws-us2.pusher.com/app/"
+	"32cbd69e4b950bf97679?protocol=7&client=js&version=8.4.0-rc2&flash=false";
+
+static const int RECONNECT_DELAY_MS = 5000;
+
+RecastKickHub *RecastKickHub::instance_ = nullptr;
+QMutex RecastKickHub::instance_mutex_;
+
+RecastKickHub::RecastKickHub(QObject *parent) : QObject(parent)
+{
+	reconnect_timer_ = new QTimer(this);
+	reconnect_timer_->setSingleShot(true);
+	connect(reconnect_timer_, &QTimer::timeout,
+		this, &RecastKickHub::onReconnectTimer);
+
+	createSocket();
+}
+
+RecastKickHub::~RecastKickHub()
+{
+	stop();
+}
+
+RecastKickHub *RecastKickHub::instance()
+{
+	QMutexLocker lock(&instance_mutex_);
+	if (!instance_)
+		instance_ = new RecastKickHub();
+	return instance_;
+}
+
+void RecastKickHub::destroyInstance()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+void RecastKickHub::createSocket()
+{
+	ws_ = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest,
+			     this);
+
+	connect(ws_, &QWebSocket::connected,
+		this, &RecastKickHub::onConnected);
+	connect(ws_, &QWebSocket::disconnected,
+		this, &RecastKickHub::onDisconnected);
+	connect(ws_, &QWebSocket::textMessageReceived,
+		this, &RecastKickHub::onTextMessageReceived);
+}
+
+/* ---- Subscribers ---- */
+
+void RecastKickHub::subscribe(QObject *subscriber, const QString &slug,
+			      int topics)
+{
+	if (!subscriber || slug.isEmpty())
+		return;
+
+	QString lower = slug.toLower();
+	if (!subscribers_.contains(subscriber))
+		connect(subscriber, &QObject::destroyed, this,
+			[this](QObject *obj) { unsubscribe(obj); });
+	subscribers_[subscriber] = topics;
+
+	if (lower != channel_slug_) {
+		if (!channel_slug_.isEmpty())
+			blog(LOG_INFO,
+			     "[Recast Kick] Switching channel '%s' -> '%s'",
+			     channel_slug_.toUtf8().constData(),
+			     lower.toUtf8().constData());
+		stop();
+		channel_slug_ = lower;
+		start();
+		return;
+	}
+
+	if (established_)
+		syncSubscriptions();
+	else
+		start();
+}
+
+void RecastKickHub::unsubscribe(QObject *subscriber)
+{
+	if (!subscribers_.remove(subscriber))
+		return;
+
+	QObject::disconnect(subscriber, &QObject::destroyed, this, nullptr);
+
+	if (subscribers_.isEmpty()) {
+		stop();
+		channel_slug_.clear();
+	} else if (established_) {
+		syncSubscriptions();
+	}
+}
+
+int RecastKickHub::wantedTopics() const
+{
+	int topics = 0;
+	for (int t : subscribers_)
+		topics |= t;
+	return topics;
+}
+
+/* ---- Lifecycle ---- */
+
+void RecastKickHub::start()
+{
+	if (channel_slug_.isEmpty() || pending_reply_ ||
+	    reconnect_timer_->isActive() ||
+	    ws_->state() != QAbstractSocket::UnconnectedState)
+		return;
+
+	blog(LOG_INFO, "[Recast Kick] Connecting for channel '%s'",
+	     channel_slug_.toUtf8().constData());
+
+	if (channel_id_ == 0 && chatroom_id_ == 0)
+		fetchChannelInfo();
+	else
+		connectPusher();
+}
+
+void RecastKickHub::stop()
+{
+	reconnect_timer_->stop();
+
+	if (pending_reply_) {
+		QNetworkReply *reply = pending_reply_;
+		pending_reply_ = nullptr;
+		QObject::disconnect(reply, nullptr, this, nullptr);
+		reply->abort();
+		reply->deleteLater();
+	}
+
+	/* Drop the socket without letting its disconnected() schedule a
+	 * reconnect; a fresh one is ready for the next start(). */
+	if (ws_->state() != QAbstractSocket::UnconnectedState) {
+		QObject::disconnect(ws_, nullptr, this, nullptr);
+		ws_->abort();
+		ws_->deleteLater();
+		createSocket();
+	}
+
+	channel_id_ = 0;
+	chatroom_id_ = 0;
+	socket_topics_ = 0;
+	established_ = false;
+	setConnected(false);
+}
+
+void RecastKickHub::setConnected(bool connected)
+{
+	if (connected_ == connected)
+		return;
+	connected_ = connected;
+	emit connectionStateChanged(connected);
+}
+
+void RecastKickHub::scheduleReconnect()
+{
+	socket_topics_ = 0;
+	established_ = false;
+	setConnected(false);
+
+	if (!subscribers_.isEmpty() && !reconnect_timer_->isActive())
+		reconnect_timer_->start(RECONNECT_DELAY_MS);
+}
+
+void RecastKickHub::onReconnectTimer()
+{
+	if (subscribers_.isEmpty())
+		return;
+
+	blog(LOG_INFO, "[Recast Kick] Reconnecting...");
+	start();
+}
+
+/* ---- Channel lookup ---- */
+
+void RecastKickHub::fetchChannelInfo()
+{
+	QUrl url(QStringLiteral("https://kick.com/api/v2/channels/%1")
+			 .arg(channel_slug_));
+
+	QNetworkRequest req(url);
+	req.setTransferTimeout(15000);
+	req.setRawHeader("Accept", "application/json");
+
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
+	pending_reply_ = reply;
+
+	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+		reply->deleteLater();
+		pending_reply_ = nullptr;
+
+		if (reply->error() != QNetworkReply::NoError) {
+			blog(LOG_WARNING,
+			     "[Recast Kick] Channel info error: %s",
+			     reply->errorString().toUtf8().constData());
+			scheduleReconnect();
+			return;
+		}
+
+		QJsonObject root =
+			QJsonDocument::fromJson(reply->readAll()).object();
+
+		channel_id_ = root.value(QStringLiteral("id")).toInt(0);
+		chatroom_id_ = root.value(QStringLiteral("chatroom"))
+				       .toObject()
+				       .value(QStringLiteral("id"))
+				       .toInt(0);
+
+		if (channel_id_ == 0 && chatroom_id_ == 0) {
+			blog(LOG_WARNING,
+			     "[Recast Kick] Channel '%s' not found",
+			     channel_slug_.toUtf8().constData());
+			scheduleReconnect();
+			return;
+		}
+
+		blog(LOG_INFO, "[Recast Kick] '%s' channel=%d chatroom=%d",
+		     channel_slug_.toUtf8().constData(), channel_id_,
+		     chatroom_id_);
+
+		connectPusher();
+	});
+}
+
+/* ---- Pusher socket ---- */
+
+void RecastKickHub::connectPusher()
+{
+	ws_->open(QUrl(QString::fromUtf8(KICK_PUSHER_URL)));
+}
+
+void RecastKickHub::onConnected()
+{
+	blog(LOG_INFO, "[Recast Kick] Pusher WebSocket connected");
+	/* Wait for pusher:connection_established before subscribing */
+}
+
+void RecastKickHub::onDisconnected()
+{
+	blog(LOG_INFO, "[Recast Kick] Pusher WebSocket disconnected");
+	scheduleReconnect();
+}
+
+QString RecastKickHub::topicChannel(int topic) const
+{
+	if (topic == TOPIC_CHATROOM && chatroom_id_ > 0)
+		return QStringLiteral("chatrooms.%1.v2").arg(chatroom_id_);
+	if (topic == TOPIC_CHANNEL && channel_id_ > 0)
+		return QStringLiteral("channel.%1").arg(channel_id_);
+	return QString();
+}
+
+int RecastKickHub::channelTopic(const QString &channel) const
+{
+	if (channel.startsWith(QStringLiteral("chatrooms.")))
+		return TOPIC_CHATROOM;
+	if (channel.startsWith(QStringLiteral("channel.")))
+		return TOPIC_CHANNEL;
+	return 0;
+}
+
+void RecastKickHub::sendPusher(const QString &event, const QJsonObject &data)
+{
+	QJsonObject msg;
+	msg[QStringLiteral("event")] = event;
+	msg[QStringLiteral("data")] = data;
+	ws_->sendTextMessage(QString::fromUtf8(
+		QJsonDocument(msg).toJson(QJsonDocument::Compact)));
+}
+
+void RecastKickHub::syncSubscriptions()
+{
+	int wanted = wantedTopics();
+
+	for (int topic : {(int)TOPIC_CHATROOM, (int)TOPIC_CHANNEL}) {
+		bool want = (wanted & topic) != 0;
+		bool have = (socket_topics_ & topic) != 0;
+		if (want == have)
+			continue;
+
+		QString channel = topicChannel(topic);
+		if (channel.isEmpty())
+			continue;
+
+		QJsonObject data;
+		data[QStringLiteral("auth")] = QString();
+		data[QStringLiteral("channel")] = channel;
+		sendPusher(want ? QStringLiteral("pusher:subscribe")
+				: QStringLiteral("pusher:unsubscribe"),
+			   data);
+
+		if (want)
+			socket_topics_ |= topic;
+		else
+			socket_topics_ &= ~topic;
+
+		blog(LOG_INFO, "[Recast Kick] %s %s",
+		     want ? "Subscribed to" : "Unsubscribed from",
+		     channel.toUtf8().constData());
+	}
+}
+
+void RecastKickHub::onTextMessageReceived(const QString &raw)
+{
+	QJsonDocument doc;
+	{
+		RECAST_PERF_SCOPE(RECAST_PERF_JSON_PARSE);
+		doc = QJsonDocument::fromJson(raw.toUtf8());
+	}
+	if (!doc.isObject())
+		return;
+
+	QJsonObject root = doc.object();
+	QString event = root.value(QStringLiteral("event")).toString();
+
+	if (event == QStringLiteral("pusher:connection_established")) {
+		blog(LOG_INFO, "[Recast Kick] Pusher connection established");
+		established_ = true;
+		socket_topics_ = 0;
+		syncSubscriptions();
+		setConnected(true);
+		return;
+	}
+
+	if (event == QStringLiteral("pusher:ping")) {
+		/* Respond to Pusher keepalive ping */
+		sendPusher(QStringLiteral("pusher:pong"), QJsonObject());
+		return;
+	}
+
+	/* Other Pusher protocol events carry nothing for providers */
+	if (event.startsWith(QStringLiteral("pusher:")) ||
+	    event.startsWith(QStringLiteral("pusher_internal:")))
+		return;
+
+	/* The data field is a JSON-encoded string; decode it once here
+	 * for every subscriber. */
+	QJsonObject data;
+	QJsonValue data_val = root.value(QStringLiteral("data"));
+	if (data_val.isString()) {
+		RECAST_PERF_SCOPE(RECAST_PERF_JSON_PARSE);
+		QJsonDocument data_doc =
+			QJsonDocument::fromJson(data_val.toString().toUtf8());
+		if (data_doc.isObject())
+			data = data_doc.object();
+	} else {
+		data = data_val.toObject();
+	}
+
+	int topic = channelTopic(
+		root.value(QStringLiteral("channel")).toString());
+
+	emit pusherEvent(event, data, topic);
+}
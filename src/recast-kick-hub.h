@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QObject>
+#include <QWebSocket>
+#include <QNetworkReply>
+#include <QTimer>
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/*
+ * RecastKickHub -- Singleton Kick Pusher connection.
+ *
+ * Owns the one channel lookup and the one Pusher socket per channel.
+ * Providers subscribe with the topics they need (chatroom, channel);
+ * the hub subscribes to the union of those topics on the socket and
+ * dispatches every event once, with its data already decoded, through
+ * pusherEvent(). Reconnects are driven from one timer, so chat and
+ * events always come back together.
+ */
+class RecastKickHub : public QObject {
+	Q_OBJECT
+
+public:
+	enum Topic {
+		TOPIC_CHATROOM = 1 << 0, /* chatrooms.<id>.v2 */
+		TOPIC_CHANNEL = 1 << 1,  /* channel.<id> */
+	};
+
+	static RecastKickHub *instance();
+	static void destroyInstance();
+
+	/* (Re)subscribe with a topic mask. All subscribers share one
+	 * channel; subscribing with a different slug switches it. */
+	void subscribe(QObject *subscriber, const QString &slug, int topics);
+	void unsubscribe(QObject *subscriber);
+
+	bool isConnected() const { return connected_; }
+	QString channelSlug() const { return channel_slug_; }
+
+signals:
+	void connectionStateChanged(bool connected);
+	void pusherEvent(const QString &event, const QJsonObject &data,
+			 int topic);
+
+private slots:
+	void onConnected();
+	void onDisconnected();
+	void onTextMessageReceived(const QString &raw);
+	void onReconnectTimer();
+
+private:
+	explicit RecastKickHub(QObject *parent = nullptr);
+	~RecastKickHub();
+
+	static RecastKickHub *instance_;
+	static QMutex instance_mutex_;
+
+	QWebSocket *ws_ = nullptr;
+	QTimer *reconnect_timer_ = nullptr;
+	QNetworkReply *pending_reply_ = nullptr;
+	QMap<QObject *, int> subscribers_;
+	QString channel_slug_;
+	int channel_id_ = 0;
+	int chatroom_id_ = 0;
+	int socket_topics_ = 0; /* topics subscribed on the socket */
+	bool established_ = false;
+	bool connected_ = false;
+
+	void createSocket();
+	void start();
+	void stop();
+	void setConnected(bool connected);
+	void scheduleReconnect();
+
+	int wantedTopics() const;
+	QString topicChannel(int topic) const;
+	int channelTopic(const QString &channel) const;
+	void syncSubscriptions();
+	void sendPusher(const QString &event, const QJsonObject &data);
+
+	void fetchChannelInfo();
+	void connectPusher();
+};
@@ -6,8 +6,10 @@
  */
 
 #include "recast-multistream.h"
+#include "recast-network.h"
 #include "recast-platform-icons.h"
 #include "recast-vertical.h"
+#include "recast-perf.h"
 
 #include <QDialogButtonBox>
 #include <QFormLayout>
@@ -16,9 +18,14 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMessageBox>
+#include <QPainter>
+#include <QPainterPath>
 #include <QScrollArea>
+#include <QPointer>
 #include <QStyle>
 
+#include <cstdlib>
+
 extern "C" {
 #include <obs-module.h>
 #include <util/platform.h>
@@ -51,6 +58,272 @@ static obs_encoder_t *get_main_audio_encoder(void)
 	return enc;
 }
 
+/* Dedicated main-canvas encoders for ABR destinations; the shared
+ * main encoder cannot be steered per destination. */
+static recast_encoder_pool_t *main_encoder_pool = NULL;
+
+static void copy_setting(char *dst, size_t size, const char *src)
+{
+	if (!src || !*src)
+		return;
+	strncpy(dst, src, size - 1);
+	dst[size - 1] = 0;
+}
+
+/* Mirror the main stream encoder where possible so a dedicated encoder
+ * matches what the shared one would have sent. */
+static void main_encoder_settings(const recast_destination_t *d,
+				  recast_encoder_settings_t *out)
+{
+	*out = d->venc_settings;
+	out->scaled_width = 0;
+	out->scaled_height = 0;
+	out->fps_divisor = 0;
+
+	obs_encoder_t *main_enc = get_main_video_encoder();
+	if (!main_enc)
+		return;
+
+	copy_setting(out->codec, sizeof(out->codec),
+		     obs_encoder_get_codec(main_enc));
+	copy_setting(out->encoder_id, sizeof(out->encoder_id),
+		     obs_encoder_get_id(main_enc));
+
+	obs_data_t *settings = obs_encoder_get_settings(main_enc);
+	int bitrate = (int)obs_data_get_int(settings, "bitrate");
+	int keyint = (int)obs_data_get_int(settings, "keyint_sec");
+	if (bitrate > 0)
+		out->bitrate = bitrate;
+	if (keyint > 0)
+		out->keyint_sec = keyint;
+	copy_setting(out->rate_control, sizeof(out->rate_control),
+		     obs_data_get_string(settings, "rate_control"));
+	obs_data_release(settings);
+}
+
+/* Pick the video encoder for a start. Pooled encoders are kept in
+ * d->venc so stop can release them. */
+static obs_encoder_t *acquire_video_encoder(recast_destination_t *d)
+{
+	if (!d->abr.enabled) {
+		if (d->canvas_vertical) {
+			/* Pooled vertical encoder, shared with any
+			 * destination that uses the same settings */
+			d->venc = recast_vertical_acquire_encoder(
+				&d->venc_settings);
+			return d->venc;
+		}
+
+		/* Share the main encoder (zero overhead) */
+		return get_main_video_encoder();
+	}
+
+	/* ABR: an encoder of our own, starting inside the range */
+	recast_encoder_settings_t s;
+	if (d->canvas_vertical) {
+		s = d->venc_settings;
+	} else {
+		main_encoder_settings(d, &s);
+		if (!main_encoder_pool)
+			main_encoder_pool =
+				recast_encoder_pool_create("recast_main_venc");
+	}
+	recast_abr_reset(&d->abr_state, &d->abr, s.bitrate);
+	s.bitrate = d->abr_state.current_kbps;
+
+	d->venc = d->canvas_vertical
+			  ? recast_vertical_acquire_dedicated_encoder(&s)
+			  : recast_encoder_pool_acquire_exclusive(
+				    main_encoder_pool, obs_get_video(), &s);
+	return d->venc;
+}
+
+static void release_video_encoder(recast_destination_t *d)
+{
+	if (!d->venc)
+		return;
+
+	if (d->canvas_vertical)
+		recast_vertical_release_encoder(d->venc);
+	else
+		recast_encoder_pool_release(main_encoder_pool, d->venc);
+	d->venc = NULL;
+	d->abr_state.current_kbps = 0;
+}
+
+/* ---- Output signals ---- */
+
+static void output_started_cb(void *param, calldata_t *cd)
+{
+	UNUSED_PARAMETER(cd);
+	auto *d = static_cast<recast_destination_t *>(param);
+	if (d->output_cb)
+		d->output_cb(d->output_cb_param, d,
+			     RECAST_DEST_OUTPUT_STARTED, 0);
+}
+
+static void output_stopped_cb(void *param, calldata_t *cd)
+{
+	auto *d = static_cast<recast_destination_t *>(param);
+	int code = (int)calldata_int(cd, "code");
+	if (d->output_cb)
+		d->output_cb(d->output_cb_param, d,
+			     RECAST_DEST_OUTPUT_STOPPED, code);
+}
+
+static void output_reconnect_cb(void *param, calldata_t *cd)
+{
+	UNUSED_PARAMETER(cd);
+	auto *d = static_cast<recast_destination_t *>(param);
+	if (d->output_cb)
+		d->output_cb(d->output_cb_param, d,
+			     RECAST_DEST_OUTPUT_RECONNECT, 0);
+}
+
+static void output_reconnect_success_cb(void *param, calldata_t *cd)
+{
+	UNUSED_PARAMETER(cd);
+	auto *d = static_cast<recast_destination_t *>(param);
+	if (d->output_cb)
+		d->output_cb(d->output_cb_param, d,
+			     RECAST_DEST_OUTPUT_RECONNECT_SUCCESS, 0);
+}
+
+#if RECAST_HAVE_PACKET_CALLBACK
+/* Every packet the output is about to send: how long after its frame
+ * was composited it got here (encode plus interleave) */
+static void output_packet_cb(obs_output_t *output,
+			     struct encoder_packet *pkt,
+			     struct encoder_packet_time *pkt_time, void *param)
+{
+	UNUSED_PARAMETER(output);
+	UNUSED_PARAMETER(param);
+
+	if (!pkt_time || pkt->type != OBS_ENCODER_VIDEO)
+		return;
+	uint64_t now = os_gettime_ns();
+	recast_perf_record(RECAST_PERF_SEND_LAG,
+			   now > pkt_time->cts ? now - pkt_time->cts : 0);
+}
+#endif
+
+static void attach_output_signals(recast_destination_t *d)
+{
+	if (!d->output)
+		return;
+#if RECAST_HAVE_PACKET_CALLBACK
+	obs_output_add_packet_callback(d->output, output_packet_cb, d);
+#endif
+	signal_handler_t *sh = obs_output_get_signal_handler(d->output);
+	signal_handler_connect(sh, "start", output_started_cb, d);
+	signal_handler_connect(sh, "stop", output_stopped_cb, d);
+	signal_handler_connect(sh, "reconnect", output_reconnect_cb, d);
+	signal_handler_connect(sh, "reconnect_success",
+			       output_reconnect_success_cb, d);
+}
+
+static void detach_output_signals(recast_destination_t *d)
+{
+	if (!d->output)
+		return;
+#if RECAST_HAVE_PACKET_CALLBACK
+	obs_output_remove_packet_callback(d->output, output_packet_cb, d);
+#endif
+	signal_handler_t *sh = obs_output_get_signal_handler(d->output);
+	signal_handler_disconnect(sh, "start", output_started_cb, d);
+	signal_handler_disconnect(sh, "stop", output_stopped_cb, d);
+	signal_handler_disconnect(sh, "reconnect", output_reconnect_cb, d);
+	signal_handler_disconnect(sh, "reconnect_success",
+				  output_reconnect_success_cb, d);
+}
+
+/* ---- Reconnect policy ----
+ * OBS retries a dropped output itself a few times (encoders stay
+ * attached, the output reports reconnect / reconnect_success). If it
+ * gives up, the destination keeps its encoder refs and restarts the
+ * output on a jittered exponential backoff before declaring failure. */
+
+#define NATIVE_RETRY_COUNT 3
+#define RETRY_BASE_MS 1000
+#define RETRY_MAX_MS 30000
+#define RETRY_MAX_ATTEMPTS 8
+
+static void configure_reconnect(recast_destination_t *d)
+{
+	/* Spread the first native retry over 1-3 s so destinations that
+	 * drop together do not all hit the uplink at the same moment */
+	int retry_sec = 1 + rand() % 3;
+	obs_output_set_reconnect_settings(d->output, NATIVE_RETRY_COUNT,
+					  retry_sec);
+}
+
+uint32_t recast_destination_retry_delay_ms(const recast_destination_t *d)
+{
+	int attempt = d->retry_attempt > 0 ? d->retry_attempt - 1 : 0;
+	uint64_t delay = (uint64_t)RETRY_BASE_MS << (attempt < 16 ? attempt : 16);
+	if (delay > RETRY_MAX_MS)
+		delay = RETRY_MAX_MS;
+
+	/* Equal jitter: half fixed, half random */
+	uint64_t half = delay / 2;
+	return (uint32_t)(half + (uint64_t)rand() % (half + 1));
+}
+
+/* ---- Service / output ---- */
+
+static obs_data_t *service_settings(const recast_destination_t *d)
+{
+	obs_data_t *settings = obs_data_create();
+	char *server = recast_protocol_build_url(d->protocol, d->url,
+						 &d->transport);
+	obs_data_set_string(settings, "server", server);
+	bfree(server);
+	if (d->protocol == RECAST_PROTO_WHIP)
+		obs_data_set_string(settings, "bearer_token", d->key);
+	else
+		obs_data_set_string(settings, "key", d->key);
+	return settings;
+}
+
+static void create_service(recast_destination_t *d)
+{
+	const char *service_id = recast_protocol_service_id(d->protocol);
+	obs_data_t *settings = service_settings(d);
+
+	struct dstr svc_name = {0};
+	dstr_printf(&svc_name, "recast_svc_%s", d->name);
+	d->service = obs_service_create(service_id, svc_name.array, settings,
+					NULL);
+	dstr_free(&svc_name);
+	obs_data_release(settings);
+}
+
+static void create_output(recast_destination_t *d)
+{
+	const char *output_id = recast_protocol_output_id(d->protocol);
+	struct dstr out_name = {0};
+	dstr_printf(&out_name, "recast_out_%s", d->name);
+	d->output = obs_output_create(output_id, out_name.array, NULL, NULL);
+	dstr_free(&out_name);
+	attach_output_signals(d);
+}
+
+/* Services and outputs are only needed once a destination goes live;
+ * creating them for every saved destination made startup slow */
+static bool ensure_output(recast_destination_t *d)
+{
+	if (!d->service)
+		create_service(d);
+	if (d->service && !d->output)
+		create_output(d);
+	if (d->output && d->service)
+		return true;
+
+	blog(LOG_ERROR, "[Recast] Destination '%s': cannot create %s output",
+	     d->name, recast_protocol_name(d->protocol));
+	return false;
+}
+
 static char *generate_dest_id(const char *name)
 {
 	struct dstr id = {0};
@@ -74,35 +347,13 @@ recast_destination_t *recast_destination_create(const char *name,
 	d->auto_start = false;
 	d->auto_stop = false;
 	d->canvas_vertical = canvas_vertical;
+	recast_encoder_settings_init(&d->venc_settings);
+	recast_abr_config_init(&d->abr);
+	recast_transport_config_init(&d->transport);
+	d->connect_timeout_sec = 15;
 
 	d->protocol = recast_protocol_detect(url);
 
-	/* Create service */
-	const char *service_id = recast_protocol_service_id(d->protocol);
-	obs_data_t *svc_settings = obs_data_create();
-	if (d->protocol == RECAST_PROTO_WHIP) {
-		obs_data_set_string(svc_settings, "server", url);
-		obs_data_set_string(svc_settings, "bearer_token", key);
-	} else {
-		obs_data_set_string(svc_settings, "server", url);
-		obs_data_set_string(svc_settings, "key", key);
-	}
-
-	struct dstr svc_name = {0};
-	dstr_printf(&svc_name, "recast_svc_%s", name);
-	d->service = obs_service_create(
-		service_id, svc_name.array, svc_settings, NULL);
-	dstr_free(&svc_name);
-	obs_data_release(svc_settings);
-
-	/* Create output */
-	const char *output_id = recast_protocol_output_id(d->protocol);
-	struct dstr out_name = {0};
-	dstr_printf(&out_name, "recast_out_%s", name);
-	d->output = obs_output_create(
-		output_id, out_name.array, NULL, NULL);
-	dstr_free(&out_name);
-
 	blog(LOG_INFO,
 	     "[Recast] Created destination '%s' (canvas=%s, protocol=%s)",
 	     name, canvas_vertical ? "vertical" : "main",
@@ -116,9 +367,16 @@ void recast_destination_destroy(recast_destination_t *d)
 	if (!d)
 		return;
 
-	if (d->active)
-		recast_destination_stop(d);
+	/* The start worker still uses the output; end_start finishes */
+	if (d->start_pending) {
+		d->stop_requested = true;
+		d->destroy_requested = true;
+		return;
+	}
 
+	recast_destination_stop(d);
+
+	detach_output_signals(d);
 	if (d->output)
 		obs_output_release(d->output);
 	if (d->service)
@@ -131,81 +389,393 @@ void recast_destination_destroy(recast_destination_t *d)
 	bfree(d);
 }
 
-bool recast_destination_start(recast_destination_t *d)
+bool recast_destination_is_active(const recast_destination_t *d)
 {
-	if (!d || !d->output || !d->service)
-		return false;
-	if (d->active)
-		return true;
+	return d && (d->state == RECAST_DEST_CONNECTING ||
+		     d->state == RECAST_DEST_LIVE ||
+		     d->state == RECAST_DEST_RECONNECTING);
+}
 
-	obs_output_set_service(d->output, d->service);
+const char *recast_dest_state_name(recast_dest_state_t state)
+{
+	switch (state) {
+	case RECAST_DEST_IDLE:
+		return "idle";
+	case RECAST_DEST_CONNECTING:
+		return "connecting";
+	case RECAST_DEST_LIVE:
+		return "live";
+	case RECAST_DEST_RECONNECTING:
+		return "reconnecting";
+	case RECAST_DEST_FAILED:
+		return "failed";
+	}
+	return "unknown";
+}
+
+static void set_state(recast_destination_t *d, recast_dest_state_t state)
+{
+	if (d->state == state)
+		return;
+
+	blog(LOG_DEBUG, "[Recast] Destination '%s': %s -> %s", d->name,
+	     recast_dest_state_name(d->state), recast_dest_state_name(state));
+	if (d->state == RECAST_DEST_RECONNECTING && state == RECAST_DEST_LIVE)
+		d->recoveries++;
+	d->state = state;
+}
+
+/* Give up: drop the encoder refs kept for retries */
+static void fail(recast_destination_t *d)
+{
+	release_video_encoder(d);
+	d->start_time_ns = 0;
+	d->retry_attempt = 0;
+	set_state(d, RECAST_DEST_FAILED);
+}
 
-	obs_encoder_t *venc = NULL;
-	obs_encoder_t *aenc = get_main_audio_encoder();
+bool recast_destination_begin_start(recast_destination_t *d)
+{
+	static uint64_t next_serial = 0;
 
-	if (!aenc) {
-		blog(LOG_ERROR, "[Recast] No main audio encoder");
+	if (!d || d->start_pending || !ensure_output(d))
 		return false;
-	}
 
-	if (d->canvas_vertical) {
-		/* Use shared vertical encoder */
-		venc = recast_vertical_acquire_encoder();
-		if (!venc) {
-			blog(LOG_ERROR,
-			     "[Recast] Failed to acquire vertical encoder "
-			     "for '%s'", d->name);
+	/* A retry reuses the encoders still bound to the output */
+	bool retry = d->state == RECAST_DEST_RECONNECTING;
+
+	if (!retry) {
+		if (recast_destination_is_active(d))
+			return false;
+
+		obs_output_set_service(d->output, d->service);
+		configure_reconnect(d);
+
+		obs_encoder_t *aenc = get_main_audio_encoder();
+		if (!aenc) {
+			blog(LOG_ERROR, "[Recast] No main audio encoder");
+			set_state(d, RECAST_DEST_FAILED);
 			return false;
 		}
-	} else {
-		/* Share the main encoder (zero overhead) */
-		venc = get_main_video_encoder();
+
+		obs_encoder_t *venc = acquire_video_encoder(d);
 		if (!venc) {
-			blog(LOG_ERROR,
-			     "[Recast] No main video encoder "
-			     "(is main stream running?) for '%s'",
-			     d->name);
+			if (d->canvas_vertical || d->abr.enabled)
+				blog(LOG_ERROR,
+				     "[Recast] Failed to acquire %s encoder "
+				     "for '%s'",
+				     d->canvas_vertical ? "vertical"
+							: "dedicated",
+				     d->name);
+			else
+				blog(LOG_ERROR,
+				     "[Recast] No main video encoder "
+				     "(is main stream running?) for '%s'",
+				     d->name);
+			set_state(d, RECAST_DEST_FAILED);
 			return false;
 		}
+
+		obs_output_set_video_encoder(d->output, venc);
+		obs_output_set_audio_encoder(d->output, aenc, 0);
+
+		recast_stats_reset(&d->stats);
+		d->retry_attempt = 0;
+		d->recoveries = 0;
+		set_state(d, RECAST_DEST_CONNECTING);
+	}
+
+	d->start_pending = true;
+	d->start_result = false;
+	d->stop_requested = false;
+	d->abort_requested = false;
+	d->output_started = false;
+	d->stop_seen = false;
+	d->start_serial = ++next_serial;
+	return true;
+}
+
+bool recast_destination_end_start(recast_destination_t *d)
+{
+	if (!d || !d->start_pending)
+		return false;
+
+	d->start_pending = false;
+	bool retry = d->state == RECAST_DEST_RECONNECTING;
+
+	if (d->stop_requested) {
+		d->stop_requested = false;
+		if (d->start_result)
+			obs_output_stop(d->output);
+		release_video_encoder(d);
+		d->start_time_ns = 0;
+		d->retry_attempt = 0;
+		set_state(d, d->abort_requested ? RECAST_DEST_FAILED
+						: RECAST_DEST_IDLE);
+		return false;
 	}
 
-	obs_output_set_video_encoder(d->output, venc);
-	obs_output_set_audio_encoder(d->output, aenc, 0);
+	if (!d->start_result) {
+		blog(LOG_ERROR, "[Recast] Failed to %s destination '%s'",
+		     retry ? "restart" : "start", d->name);
+		if (retry && d->retry_attempt < RETRY_MAX_ATTEMPTS)
+			return true;
+		fail(d);
+		return false;
+	}
 
-	bool ok = obs_output_start(d->output);
-	if (ok) {
-		d->active = true;
+	if (!retry) {
 		d->start_time_ns = os_gettime_ns();
+		recast_stats_sample(&d->stats, d->output, d->start_time_ns);
 		blog(LOG_INFO, "[Recast] Started destination '%s' -> %s",
 		     d->name, d->url);
-	} else {
-		blog(LOG_ERROR, "[Recast] Failed to start destination '%s'",
-		     d->name);
-		if (d->canvas_vertical)
-			recast_vertical_release_encoder();
 	}
 
-	return ok;
+	/* Output signals may have arrived before the worker returned */
+	if (d->stop_seen) {
+		d->stop_seen = false;
+		return recast_destination_on_output_event(
+			d, RECAST_DEST_OUTPUT_STOPPED, d->stop_code);
+	}
+	if (d->output_started) {
+		d->retry_attempt = 0;
+		set_state(d, RECAST_DEST_LIVE);
+	}
+	return false;
+}
+
+bool recast_destination_on_output_event(recast_destination_t *d, int event,
+					int code)
+{
+	if (!d)
+		return false;
+
+	switch (event) {
+	case RECAST_DEST_OUTPUT_STARTED:
+		d->output_started = true;
+		if (!d->start_pending &&
+		    (d->state == RECAST_DEST_CONNECTING ||
+		     d->state == RECAST_DEST_RECONNECTING)) {
+			if (d->state == RECAST_DEST_RECONNECTING)
+				blog(LOG_INFO,
+				     "[Recast] Destination '%s' reconnected",
+				     d->name);
+			d->retry_attempt = 0;
+			set_state(d, RECAST_DEST_LIVE);
+		}
+		return false;
+
+	case RECAST_DEST_OUTPUT_RECONNECT:
+		/* OBS is retrying on its own; encoders stay attached */
+		if (d->state == RECAST_DEST_LIVE) {
+			blog(LOG_WARNING,
+			     "[Recast] Destination '%s' dropped, reconnecting",
+			     d->name);
+			set_state(d, RECAST_DEST_RECONNECTING);
+		}
+		return false;
+
+	case RECAST_DEST_OUTPUT_RECONNECT_SUCCESS:
+		if (d->state == RECAST_DEST_RECONNECTING) {
+			blog(LOG_INFO, "[Recast] Destination '%s' reconnected",
+			     d->name);
+			d->retry_attempt = 0;
+			set_state(d, RECAST_DEST_LIVE);
+		}
+		return false;
+
+	case RECAST_DEST_OUTPUT_STOPPED:
+		break;
+
+	default:
+		return false;
+	}
+
+	/* Stopped. Our own stop has already moved us to idle. */
+	d->output_started = false;
+	if (d->start_pending) {
+		d->stop_seen = true;
+		d->stop_code = code;
+		return false;
+	}
+	if (!recast_destination_is_active(d))
+		return false;
+
+	if (code == OBS_OUTPUT_SUCCESS) {
+		release_video_encoder(d);
+		d->start_time_ns = 0;
+		set_state(d, RECAST_DEST_IDLE);
+		return false;
+	}
+
+	/* A first connect that never came up is a failure, not a drop */
+	if (d->state == RECAST_DEST_CONNECTING) {
+		blog(LOG_WARNING,
+		     "[Recast] Destination '%s' failed to connect (code %d)",
+		     d->name, code);
+		fail(d);
+		return false;
+	}
+
+	if (d->retry_attempt >= RETRY_MAX_ATTEMPTS) {
+		blog(LOG_ERROR,
+		     "[Recast] Destination '%s' gave up after %d retries "
+		     "(code %d)",
+		     d->name, d->retry_attempt, code);
+		fail(d);
+		return false;
+	}
+
+	blog(LOG_WARNING, "[Recast] Destination '%s' stopped (code %d), "
+	     "retrying", d->name, code);
+	set_state(d, RECAST_DEST_RECONNECTING);
+	return true;
 }
 
 void recast_destination_stop(recast_destination_t *d)
 {
-	if (!d || !d->active)
+	if (!d)
+		return;
+
+	/* Cannot stop an output whose start has not returned yet */
+	if (d->start_pending) {
+		d->stop_requested = true;
+		return;
+	}
+
+	if (d->state == RECAST_DEST_FAILED)
+		set_state(d, RECAST_DEST_IDLE);
+	if (!recast_destination_is_active(d))
 		return;
 
 	obs_output_stop(d->output);
-	d->active = false;
 	d->start_time_ns = 0;
+	d->retry_attempt = 0;
+	set_state(d, RECAST_DEST_IDLE);
 
-	if (d->canvas_vertical)
-		recast_vertical_release_encoder();
+	release_video_encoder(d);
 
 	blog(LOG_INFO, "[Recast] Stopped destination '%s'", d->name);
 }
 
+void recast_destination_abort(recast_destination_t *d)
+{
+	if (!d)
+		return;
+
+	if (d->start_pending) {
+		d->stop_requested = true;
+		d->abort_requested = true;
+		return;
+	}
+
+	recast_destination_stop(d);
+	set_state(d, RECAST_DEST_FAILED);
+}
+
+bool recast_destination_set_connection(recast_destination_t *d,
+				       const char *url, const char *key)
+{
+	if (!d)
+		return false;
+
+	if (strcmp(d->url, url) == 0 && strcmp(d->key, key) == 0)
+		return false;
+
+	if (d->start_pending) {
+		blog(LOG_WARNING,
+		     "[Recast] Destination '%s' is starting, not updated",
+		     d->name);
+		return false;
+	}
+
+	recast_destination_stop(d);
+
+	bfree(d->url);
+	d->url = bstrdup(url);
+	bfree(d->key);
+	d->key = bstrdup(key);
+
+	/* Same protocol: the output pulls server/key from the service at
+	 * start, so updating the service is enough and the output (with
+	 * its signal handlers and buffers) survives the edit. Without a
+	 * service yet, the first start builds it from the new values. */
+	recast_protocol_t protocol = recast_protocol_detect(url);
+	if (protocol == d->protocol) {
+		if (d->service) {
+			obs_data_t *settings = service_settings(d);
+			obs_service_update(d->service, settings);
+			obs_data_release(settings);
+		}
+		return true;
+	}
+
+	blog(LOG_INFO, "[Recast] Destination '%s' protocol %s -> %s",
+	     d->name, recast_protocol_name(d->protocol),
+	     recast_protocol_name(protocol));
+
+	if (d->output) {
+		detach_output_signals(d);
+		obs_output_release(d->output);
+		d->output = nullptr;
+	}
+	if (d->service) {
+		obs_service_release(d->service);
+		d->service = nullptr;
+	}
+
+	d->protocol = protocol;
+	return true;
+}
+
+bool recast_destination_set_transport(recast_destination_t *d,
+				      const recast_transport_config_t *cfg)
+{
+	if (!d || !cfg || recast_transport_config_equal(&d->transport, cfg))
+		return false;
+
+	if (d->start_pending) {
+		blog(LOG_WARNING,
+		     "[Recast] Destination '%s' is starting, not updated",
+		     d->name);
+		return false;
+	}
+
+	recast_destination_stop(d);
+	d->transport = *cfg;
+
+	if (d->service) {
+		obs_data_t *settings = service_settings(d);
+		obs_service_update(d->service, settings);
+		obs_data_release(settings);
+	}
+	return true;
+}
+
+void recast_destination_tick_abr(recast_destination_t *d)
+{
+	if (!d || d->state != RECAST_DEST_LIVE || !d->venc || !d->abr.enabled)
+		return;
+
+	int from = d->abr_state.current_kbps;
+	int kbps = recast_abr_evaluate(&d->abr_state, &d->abr, &d->stats);
+	if (kbps <= 0)
+		return;
+
+	bool ok = d->canvas_vertical
+			  ? recast_vertical_set_encoder_bitrate(d->venc, kbps)
+			  : recast_encoder_pool_set_bitrate(main_encoder_pool,
+							    d->venc, kbps);
+	if (ok)
+		blog(LOG_INFO, "[Recast] ABR '%s': %d -> %d kbps", d->name,
+		     from, kbps);
+	else
+		d->abr_state.current_kbps = from;
+}
+
 uint64_t recast_destination_elapsed_sec(const recast_destination_t *d)
 {
-	if (!d || !d->active || d->start_time_ns == 0)
+	if (!recast_destination_is_active(d) || d->start_time_ns == 0)
 		return 0;
 	return (os_gettime_ns() - d->start_time_ns) / 1000000000ULL;
 }
@@ -216,9 +786,17 @@ uint64_t recast_destination_elapsed_sec(const recast_destination_t *d)
 
 RecastDestinationDialog::RecastDestinationDialog(
 	QWidget *parent, const QString &name, const QString &url,
-	const QString &key, bool canvas_vertical)
+	const QString &key, bool canvas_vertical,
+	const recast_encoder_settings_t *venc,
+	const recast_abr_config_t *abr, int connect_timeout_sec,
+	const recast_transport_config_t *transport)
 	: QDialog(parent)
 {
+	if (venc)
+		venc_ = *venc;
+	else
+		recast_encoder_settings_init(&venc_);
+
 	setWindowTitle(obs_module_text("Recast.Multistream.AddDest"));
 	setMinimumWidth(400);
 
@@ -250,6 +828,186 @@ RecastDestinationDialog::RecastDestinationDialog(
 	form->addRow(obs_module_text("Recast.Multistream.Canvas"),
 		     canvas_combo_);
 
+	/* Vertical encoder settings */
+	encoder_group_ = new QWidget;
+	auto *enc_form = new QFormLayout(encoder_group_);
+	enc_form->setContentsMargins(0, 0, 0, 0);
+
+	encoder_combo_ = new QComboBox;
+	encoder_combo_->addItem(
+		obs_module_text("Recast.Multistream.EncoderAuto"), QString());
+	const char *type_id;
+	for (size_t i = 0; obs_enum_encoder_types(i, &type_id); i++) {
+		if (obs_get_encoder_type(type_id) != OBS_ENCODER_VIDEO)
+			continue;
+		if (obs_get_encoder_caps(type_id) &
+		    (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL))
+			continue;
+		const char *codec = obs_get_encoder_codec(type_id);
+		if (!codec || strcmp(codec, venc_.codec) != 0)
+			continue;
+		encoder_combo_->addItem(
+			QString::fromUtf8(obs_encoder_get_display_name(type_id)),
+			QString::fromUtf8(type_id));
+	}
+	int enc_idx = encoder_combo_->findData(
+		QString::fromUtf8(venc_.encoder_id));
+	encoder_combo_->setCurrentIndex(enc_idx >= 0 ? enc_idx : 0);
+	enc_form->addRow(obs_module_text("Recast.Multistream.Encoder"),
+			 encoder_combo_);
+
+	bitrate_spin_ = new QSpinBox;
+	bitrate_spin_->setRange(500, 50000);
+	bitrate_spin_->setSingleStep(500);
+	bitrate_spin_->setSuffix(" kbps");
+	bitrate_spin_->setValue(venc_.bitrate);
+	enc_form->addRow(obs_module_text("Recast.Multistream.Bitrate"),
+			 bitrate_spin_);
+
+	rate_control_combo_ = new QComboBox;
+	rate_control_combo_->addItem("CBR");
+	rate_control_combo_->addItem("VBR");
+	int rc_idx = rate_control_combo_->findText(
+		QString::fromUtf8(venc_.rate_control));
+	rate_control_combo_->setCurrentIndex(rc_idx >= 0 ? rc_idx : 0);
+	enc_form->addRow(obs_module_text("Recast.Multistream.RateControl"),
+			 rate_control_combo_);
+
+	keyint_spin_ = new QSpinBox;
+	keyint_spin_->setRange(1, 10);
+	keyint_spin_->setSuffix(" s");
+	keyint_spin_->setValue(venc_.keyint_sec);
+	enc_form->addRow(obs_module_text("Recast.Multistream.Keyint"),
+			 keyint_spin_);
+
+	/* Optional per-destination downscale of the vertical output */
+	RecastVertical *vert = RecastVertical::instance();
+	int ow = vert->outputWidth();
+	int oh = vert->outputHeight();
+	scaled_size_combo_ = new QComboBox;
+	scaled_size_combo_->addItem(QString("%1x%2").arg(ow).arg(oh),
+				    QSize(0, 0));
+	const int fractions[][2] = {{2, 3}, {1, 2}};
+	for (const auto &f : fractions) {
+		QSize s((ow * f[0] / f[1]) & ~1, (oh * f[0] / f[1]) & ~1);
+		scaled_size_combo_->addItem(
+			QString("%1x%2").arg(s.width()).arg(s.height()), s);
+	}
+	if (venc_.scaled_width > 0 && venc_.scaled_height > 0) {
+		QSize cur(venc_.scaled_width, venc_.scaled_height);
+		int idx = scaled_size_combo_->findData(cur);
+		if (idx < 0) {
+			scaled_size_combo_->addItem(QString("%1x%2")
+							    .arg(cur.width())
+							    .arg(cur.height()),
+						    cur);
+			idx = scaled_size_combo_->count() - 1;
+		}
+		scaled_size_combo_->setCurrentIndex(idx);
+	}
+	enc_form->addRow(obs_module_text("Recast.Multistream.ScaledSize"),
+			 scaled_size_combo_);
+
+	form->addRow(encoder_group_);
+	encoder_group_->setVisible(canvas_vertical);
+
+	/* Adaptive bitrate */
+	recast_abr_config_t abr_cfg;
+	if (abr)
+		abr_cfg = *abr;
+	else
+		recast_abr_config_init(&abr_cfg);
+
+	abr_check_ = new QCheckBox(obs_module_text("Recast.Multistream.Abr"));
+	abr_check_->setToolTip(obs_module_text("Recast.Multistream.AbrTip"));
+	abr_check_->setChecked(abr_cfg.enabled);
+	form->addRow(abr_check_);
+
+	abr_floor_spin_ = new QSpinBox;
+	abr_floor_spin_->setRange(200, 50000);
+	abr_floor_spin_->setSingleStep(250);
+	abr_floor_spin_->setSuffix(" kbps");
+	abr_floor_spin_->setValue(abr_cfg.floor_kbps);
+	form->addRow(obs_module_text("Recast.Multistream.AbrFloor"),
+		     abr_floor_spin_);
+
+	abr_ceiling_spin_ = new QSpinBox;
+	abr_ceiling_spin_->setRange(200, 50000);
+	abr_ceiling_spin_->setSingleStep(250);
+	abr_ceiling_spin_->setSuffix(" kbps");
+	abr_ceiling_spin_->setValue(abr_cfg.ceiling_kbps);
+	form->addRow(obs_module_text("Recast.Multistream.AbrCeiling"),
+		     abr_ceiling_spin_);
+
+	abr_floor_spin_->setEnabled(abr_cfg.enabled);
+	abr_ceiling_spin_->setEnabled(abr_cfg.enabled);
+	connect(abr_check_, &QCheckBox::toggled, this, [this](bool on) {
+		abr_floor_spin_->setEnabled(on);
+		abr_ceiling_spin_->setEnabled(on);
+	});
+
+	timeout_spin_ = new QSpinBox;
+	timeout_spin_->setRange(3, 120);
+	timeout_spin_->setSuffix(" s");
+	timeout_spin_->setValue(connect_timeout_sec);
+	form->addRow(obs_module_text("Recast.Multistream.ConnectTimeout"),
+		     timeout_spin_);
+
+	/* SRT / RIST tuning; 0 keeps the output default */
+	recast_transport_config_t tcfg;
+	if (transport)
+		tcfg = *transport;
+	else
+		recast_transport_config_init(&tcfg);
+
+	auto make_spin = [](int max, int step, const char *suffix,
+			    int value) {
+		auto *spin = new QSpinBox;
+		spin->setRange(0, max);
+		spin->setSingleStep(step);
+		spin->setSuffix(suffix);
+		spin->setSpecialValueText(
+			obs_module_text("Recast.Multistream.Default"));
+		spin->setValue(value);
+		return spin;
+	};
+
+	srt_group_ = new QWidget;
+	auto *srt_form = new QFormLayout(srt_group_);
+	srt_form->setContentsMargins(0, 0, 0, 0);
+	srt_latency_spin_ = make_spin(10000, 20, " ms", tcfg.srt_latency_ms);
+	srt_latency_spin_->setToolTip(
+		obs_module_text("Recast.Multistream.SrtLatencyTip"));
+	srt_form->addRow(obs_module_text("Recast.Multistream.SrtLatency"),
+			 srt_latency_spin_);
+	srt_maxbw_spin_ = make_spin(200000, 500, " kbps", tcfg.srt_maxbw_kbps);
+	srt_form->addRow(obs_module_text("Recast.Multistream.SrtMaxBw"),
+			 srt_maxbw_spin_);
+	srt_overhead_spin_ = make_spin(100, 5, " %", tcfg.srt_overhead_pct);
+	srt_overhead_spin_->setToolTip(
+		obs_module_text("Recast.Multistream.SrtOverheadTip"));
+	srt_form->addRow(obs_module_text("Recast.Multistream.SrtOverhead"),
+			 srt_overhead_spin_);
+	form->addRow(srt_group_);
+
+	rist_group_ = new QWidget;
+	auto *rist_form = new QFormLayout(rist_group_);
+	rist_form->setContentsMargins(0, 0, 0, 0);
+	rist_buffer_spin_ = make_spin(30000, 100, " ms", tcfg.rist_buffer_ms);
+	rist_form->addRow(obs_module_text("Recast.Multistream.RistBuffer"),
+			  rist_buffer_spin_);
+	form->addRow(rist_group_);
+
+	connect(url_edit_, &QLineEdit::textChanged, this,
+		[this]() { updateTransportVisibility(); });
+	updateTransportVisibility();
+	connect(canvas_combo_, &QComboBox::currentIndexChanged, this,
+		[this]() {
+			encoder_group_->setVisible(
+				canvas_combo_->currentData().toBool());
+			adjustSize();
+		});
+
 	auto *buttons =
 		new QDialogButtonBox(QDialogButtonBox::Ok |
 				     QDialogButtonBox::Cancel);
@@ -271,14 +1029,121 @@ QString RecastDestinationDialog::getUrl() const
 	return url_edit_->text();
 }
 
-QString RecastDestinationDialog::getKey() const
-{
-	return key_edit_->text();
-}
+QString RecastDestinationDialog::getKey() const
+{
+	return key_edit_->text();
+}
+
+void RecastDestinationDialog::updateTransportVisibility()
+{
+	QByteArray url = url_edit_->text().trimmed().toUtf8();
+	recast_protocol_t proto = recast_protocol_detect(url.constData());
+
+	srt_group_->setVisible(proto == RECAST_PROTO_SRT);
+	rist_group_->setVisible(proto == RECAST_PROTO_RIST);
+	adjustSize();
+}
+
+void RecastDestinationDialog::getTransportConfig(
+	recast_transport_config_t *out) const
+{
+	out->srt_latency_ms = srt_latency_spin_->value();
+	out->srt_maxbw_kbps = srt_maxbw_spin_->value();
+	out->srt_overhead_pct = srt_overhead_spin_->value();
+	out->rist_buffer_ms = rist_buffer_spin_->value();
+}
+
+bool RecastDestinationDialog::getCanvasVertical() const
+{
+	return canvas_combo_->currentData().toBool();
+}
+
+void RecastDestinationDialog::getEncoderSettings(
+	recast_encoder_settings_t *out) const
+{
+	*out = venc_;
+
+	QByteArray id = encoder_combo_->currentData().toString().toUtf8();
+	strncpy(out->encoder_id, id.constData(), sizeof(out->encoder_id) - 1);
+	out->encoder_id[sizeof(out->encoder_id) - 1] = 0;
+
+	QByteArray rc = rate_control_combo_->currentText().toUtf8();
+	strncpy(out->rate_control, rc.constData(),
+		sizeof(out->rate_control) - 1);
+	out->rate_control[sizeof(out->rate_control) - 1] = 0;
+
+	out->bitrate = bitrate_spin_->value();
+	out->keyint_sec = keyint_spin_->value();
+
+	QSize scaled = scaled_size_combo_->currentData().toSize();
+	out->scaled_width = scaled.width();
+	out->scaled_height = scaled.height();
+}
+
+int RecastDestinationDialog::getConnectTimeout() const
+{
+	return timeout_spin_->value();
+}
+
+void RecastDestinationDialog::getAbrConfig(recast_abr_config_t *out) const
+{
+	out->enabled = abr_check_->isChecked();
+	out->floor_kbps = abr_floor_spin_->value();
+	out->ceiling_kbps =
+		std::max(abr_ceiling_spin_->value(), out->floor_kbps);
+}
+
+/* ====================================================================
+ * RecastSparkline
+ * ==================================================================== */
+
+RecastSparkline::RecastSparkline(QWidget *parent) : QWidget(parent)
+{
+	setFixedSize(sizeHint());
+}
+
+void RecastSparkline::paintEvent(QPaintEvent *)
+{
+	if (!ring_ || ring_->count < 2)
+		return;
+
+	/* Scale to the peak of the visible window, oldest sample left */
+	size_t n = ring_->count;
+	float peak = 1.0f;
+	for (size_t age = 0; age < n; age++) {
+		float v = recast_stats_at(ring_, age)->ewma_kbps;
+		if (v > peak)
+			peak = v;
+	}
+
+	QPainter p(this);
+	p.setRenderHint(QPainter::Antialiasing);
+
+	const qreal w = width() - 1;
+	const qreal h = height() - 2;
+	const qreal step = w / (RECAST_STATS_SAMPLES - 1);
+	const qreal x0 = w - step * (qreal)(n - 1);
+
+	QPainterPath line;
+	for (size_t i = 0; i < n; i++) {
+		const recast_stats_sample_t *smp =
+			recast_stats_at(ring_, n - 1 - i);
+		qreal x = x0 + step * (qreal)i;
+		qreal y = 1 + h - h * smp->ewma_kbps / peak;
+
+		if (i == 0)
+			line.moveTo(x, y);
+		else
+			line.lineTo(x, y);
+
+		if (smp->drop_rate > 0.0f) {
+			p.setPen(QPen(QColor(0xef, 0x53, 0x50), 1));
+			p.drawLine(QPointF(x, 1 + h), QPointF(x, 1 + h * 0.5));
+		}
+	}
 
-bool RecastDestinationDialog::getCanvasVertical() const
-{
-	return canvas_combo_->currentData().toBool();
+	p.setPen(QPen(QColor(0x4c, 0xaf, 0x50), 1.25));
+	p.drawPath(line);
 }
 
 /* ====================================================================
@@ -287,7 +1152,7 @@ bool RecastDestinationDialog::getCanvasVertical() const
 
 RecastDestinationRow::RecastDestinationRow(recast_destination_t *dest,
 					   QWidget *parent)
-	: QFrame(parent), dest_(dest), last_bytes_(0)
+	: QFrame(parent), dest_(dest)
 {
 	setFrameShape(QFrame::StyledPanel);
 	setFrameShadow(QFrame::Raised);
@@ -307,8 +1172,8 @@ RecastDestinationRow::RecastDestinationRow(recast_destination_t *dest,
 	QString platform_id = recast_detect_platform(
 		QString::fromUtf8(dest->url));
 	if (!platform_id.isEmpty()) {
-		QIcon icon = recast_platform_icon(platform_id);
-		platform_icon_label_->setPixmap(icon.pixmap(20, 20));
+		platform_icon_label_->setPixmap(
+			recast_platform_pixmap(platform_id, 20));
 	}
 	top->addWidget(platform_icon_label_);
 
@@ -386,6 +1251,18 @@ RecastDestinationRow::RecastDestinationRow(recast_destination_t *dest,
 	dropped_label_->setVisible(false);
 	bottom->addWidget(dropped_label_);
 
+	/* Times the output recovered from a drop */
+	recovery_label_ = new QLabel;
+	recovery_label_->setStyleSheet("color: #FFB300; font-size: 12px;");
+	recovery_label_->setVisible(false);
+	bottom->addWidget(recovery_label_);
+
+	/* Smoothed bitrate history */
+	sparkline_ = new RecastSparkline;
+	sparkline_->setRing(&dest->stats);
+	sparkline_->setVisible(false);
+	bottom->addWidget(sparkline_);
+
 	bottom->addStretch();
 
 	/* Start/Stop button */
@@ -409,60 +1286,102 @@ RecastDestinationRow::~RecastDestinationRow() {}
 
 void RecastDestinationRow::refreshStatus()
 {
+	RECAST_PERF_SCOPE(RECAST_PERF_STATUS_REFRESH);
+
 	if (!dest_)
 		return;
 
-	if (dest_->active) {
-		uint64_t sec = recast_destination_elapsed_sec(dest_);
-		uint64_t h = sec / 3600;
-		uint64_t m = (sec % 3600) / 60;
-		uint64_t s = sec % 60;
+	DisplayState state = DISPLAY_STOPPED;
+	switch (dest_->state) {
+	case RECAST_DEST_CONNECTING:
+		state = DISPLAY_CONNECTING;
+		break;
+	case RECAST_DEST_LIVE:
+		state = DISPLAY_ACTIVE;
+		break;
+	case RECAST_DEST_RECONNECTING:
+		state = DISPLAY_RECONNECTING;
+		break;
+	case RECAST_DEST_FAILED:
+		state = DISPLAY_FAILED;
+		break;
+	case RECAST_DEST_IDLE:
+		break;
+	}
 
-		QString time_str;
-		if (h > 0)
-			time_str = QString("%1h %2m").arg(h).arg(m);
-		else
-			time_str = QString("%1m %2s").arg(m).arg(s);
+	if (state != shown_state_ ||
+	    (state == DISPLAY_RECONNECTING &&
+	     dest_->retry_attempt != shown_attempt_))
+		applyState(state);
+	if (state == DISPLAY_ACTIVE)
+		updateStats();
+}
 
-		status_label_->setText(
-			QString("<span style='color:#4CAF50;'>"
-				"\xe2\x97\x8f</span> %1").arg(time_str));
-		status_label_->setStyleSheet(
-			"color: #4CAF50; font-weight: bold;");
+void RecastDestinationRow::applyState(DisplayState state)
+{
+	shown_state_ = state;
+	shown_elapsed_ = UINT64_MAX;
+	shown_kbps_ = -1;
+	shown_dropped_ = -1;
+	shown_drop_pct10_ = -1;
+	shown_recoveries_ = -1;
+	shown_attempt_ = dest_->retry_attempt;
+
+	/* Settings cannot change under an output that is starting */
+	edit_btn_->setEnabled(state != DISPLAY_CONNECTING &&
+			      state != DISPLAY_RECONNECTING);
+
+	if (state == DISPLAY_ACTIVE || state == DISPLAY_CONNECTING ||
+	    state == DISPLAY_RECONNECTING) {
+		if (state == DISPLAY_CONNECTING) {
+			status_label_->setText(
+				QString("<span style='color:#FFB300;'>"
+					"\xe2\x97\x8f</span> %1")
+					.arg(obs_module_text(
+						"Recast.Status.Connecting")));
+			status_label_->setStyleSheet("color: #FFB300;");
+		} else if (state == DISPLAY_RECONNECTING) {
+			QString text = QString::fromUtf8(
+				obs_module_text("Recast.Status.Reconnecting"));
+			if (dest_->retry_attempt > 0)
+				text += QString(" (%1)").arg(
+					dest_->retry_attempt);
+			status_label_->setText(
+				QString("<span style='color:#FFB300;'>"
+					"\xe2\x97\x8f</span> %1")
+					.arg(text));
+			status_label_->setStyleSheet("color: #FFB300;");
+		} else {
+			status_label_->setStyleSheet(
+				"color: #4CAF50; font-weight: bold;");
+		}
 		toggle_btn_->setText(obs_module_text("Recast.Stop"));
 		toggle_btn_->setStyleSheet(
 			"QPushButton { background: #c62828; color: white; "
 			"border-radius: 3px; padding: 4px 8px; "
 			"font-weight: bold; }"
 			"QPushButton:hover { background: #e53935; }");
-
-		/* Bitrate: compute from byte delta over 1s interval */
-		if (dest_->output) {
-			uint64_t total =
-				obs_output_get_total_bytes(dest_->output);
-			uint64_t delta = total - last_bytes_;
-			last_bytes_ = total;
-			int kbps = (int)(delta * 8 / 1000);
-			bitrate_label_->setText(
-				QString("%1 kbps").arg(kbps));
-			bitrate_label_->setVisible(true);
-
-			/* Dropped frames */
-			int dropped = obs_output_get_frames_dropped(
-				dest_->output);
-			dropped_label_->setText(
-				QString("%1 dropped").arg(dropped));
-			dropped_label_->setStyleSheet(
-				dropped > 0
-					? "color: #ef5350; font-size: 12px;"
-					: "color: #999; font-size: 12px;");
-			dropped_label_->setVisible(true);
-		}
+		bool stats = state == DISPLAY_ACTIVE && dest_->output;
+		bitrate_label_->setVisible(stats);
+		dropped_label_->setVisible(stats);
+		recovery_label_->setVisible(stats && dest_->recoveries > 0);
+		sparkline_->setVisible(stats);
 	} else {
-		status_label_->setText(QString("<span style='color:#999;'>"
-			"\xe2\x97\x8f</span> %1")
-			.arg(obs_module_text("Recast.Status.Stopped")));
-		status_label_->setStyleSheet("color: #999;");
+		if (state == DISPLAY_FAILED) {
+			status_label_->setText(
+				QString("<span style='color:#ef5350;'>"
+					"\xe2\x97\x8f</span> %1")
+					.arg(obs_module_text(
+						"Recast.Status.Failed")));
+			status_label_->setStyleSheet("color: #ef5350;");
+		} else {
+			status_label_->setText(
+				QString("<span style='color:#999;'>"
+					"\xe2\x97\x8f</span> %1")
+					.arg(obs_module_text(
+						"Recast.Status.Stopped")));
+			status_label_->setStyleSheet("color: #999;");
+		}
 		toggle_btn_->setText(obs_module_text("Recast.Start"));
 		toggle_btn_->setStyleSheet(
 			"QPushButton { background: #2e7d32; color: white; "
@@ -473,8 +1392,82 @@ void RecastDestinationRow::refreshStatus()
 		/* Hide health stats when stopped */
 		bitrate_label_->setVisible(false);
 		dropped_label_->setVisible(false);
-		last_bytes_ = 0;
+		recovery_label_->setVisible(false);
+		sparkline_->setVisible(false);
+	}
+}
+
+void RecastDestinationRow::updateStats()
+{
+	uint64_t sec = recast_destination_elapsed_sec(dest_);
+	if (sec != shown_elapsed_) {
+		shown_elapsed_ = sec;
+
+		uint64_t h = sec / 3600;
+		uint64_t m = (sec % 3600) / 60;
+		uint64_t s = sec % 60;
+
+		QString time_str;
+		if (h > 0)
+			time_str = QString("%1h %2m").arg(h).arg(m);
+		else
+			time_str = QString("%1m %2s").arg(m).arg(s);
+
+		status_label_->setText(
+			QString("<span style='color:#4CAF50;'>"
+				"\xe2\x97\x8f</span> %1").arg(time_str));
+	}
+
+	if (!dest_->output)
+		return;
+
+	/* Counters come from the stats ring the dock samples each tick */
+	const recast_stats_ring_t *ring = &dest_->stats;
+
+	int kbps = recast_stats_ewma_kbps(ring);
+	if (kbps != shown_kbps_) {
+		shown_kbps_ = kbps;
+		bitrate_label_->setText(QString("%1 kbps").arg(kbps));
+	}
+
+	int dropped = recast_stats_frames_dropped(ring);
+	int pct10 = (int)(recast_stats_drop_rate(ring) * 1000.0f + 0.5f);
+	if (dropped != shown_dropped_ || pct10 != shown_drop_pct10_) {
+		/* Restyle only when crossing zero */
+		if (shown_dropped_ < 0 || (dropped > 0) != (shown_dropped_ > 0))
+			dropped_label_->setStyleSheet(
+				dropped > 0
+					? "color: #ef5350; font-size: 12px;"
+					: "color: #999; font-size: 12px;");
+		shown_dropped_ = dropped;
+		shown_drop_pct10_ = pct10;
+
+		if (pct10 > 0)
+			dropped_label_->setText(
+				QString("%1 dropped (%2%)")
+					.arg(dropped)
+					.arg(pct10 / 10.0, 0, 'f', 1));
+		else
+			dropped_label_->setText(
+				QString("%1 dropped").arg(dropped));
+	}
+
+	if ((int64_t)dest_->recoveries != shown_recoveries_) {
+		shown_recoveries_ = dest_->recoveries;
+		recovery_label_->setText(
+			QString("%1 recovered").arg(dest_->recoveries));
+		recovery_label_->setVisible(dest_->recoveries > 0);
 	}
+
+	sparkline_->update();
+	sparkline_->setToolTip(
+		QString("Bitrate: %1 kbps (now %2)\n"
+			"Congestion: %3%\n"
+			"Connect time: %4 ms")
+			.arg(kbps)
+			.arg(recast_stats_bitrate_kbps(ring))
+			.arg(qRound(recast_stats_congestion(ring) * 100.0f))
+			.arg(recast_stats_connect_time_ms(ring)));
 }
 
 void RecastDestinationRow::onToggleStream()
@@ -482,17 +1475,14 @@ void RecastDestinationRow::onToggleStream()
 	if (!dest_)
 		return;
 
-	if (dest_->active) {
+	if (recast_destination_is_active(dest_) || dest_->start_pending) {
 		recast_destination_stop(dest_);
+		refreshStatus();
+		emit activeChanged(this);
 	} else {
-		if (!recast_destination_start(dest_)) {
-			QMessageBox::warning(
-				this, obs_module_text("Recast.Error"),
-				obs_module_text(
-					"Recast.Multistream.StartFailed"));
-		}
+		/* The dock runs the start off the UI thread */
+		emit startRequested(this);
 	}
-	refreshStatus();
 }
 
 /* ====================================================================
@@ -578,14 +1568,15 @@ RecastMultistreamDock::RecastMultistreamDock(QWidget *parent)
 	/* Initial empty/button state */
 	updateButtonStates();
 
-	/* Network manager */
-	net_mgr_ = new QNetworkAccessManager(this);
+	/* obs_output_start can block on DNS/TLS/handshake; run each on
+	 * its own worker so destinations connect concurrently */
+	start_pool_ = new QThreadPool(this);
+	start_pool_->setMaxThreadCount(8);
 
-	/* Refresh timer */
+	/* Stats timer, runs only while a destination is live */
 	refresh_timer_ = new QTimer(this);
 	connect(refresh_timer_, &QTimer::timeout,
 		this, &RecastMultistreamDock::onRefreshTimer);
-	refresh_timer_->start(1000);
 
 	/* Register for main stream events */
 	obs_frontend_add_event_callback(onFrontendEvent, this);
@@ -596,13 +1587,25 @@ RecastMultistreamDock::~RecastMultistreamDock()
 	refresh_timer_->stop();
 	obs_frontend_remove_event_callback(onFrontendEvent, this);
 
+	/* Let in-flight starts return; their queued results die with us,
+	 * so finish them here */
+	start_pool_->waitForDone();
+
 	/* Stop and destroy all destinations */
 	for (auto *row : rows_) {
 		recast_destination_t *d = row->destination();
-		if (d)
-			recast_destination_destroy(d);
+		if (!d)
+			continue;
+		d->output_cb = nullptr;
+		recast_destination_end_start(d);
+		recast_destination_destroy(d);
 	}
 	rows_.clear();
+
+	if (main_encoder_pool) {
+		recast_encoder_pool_destroy(main_encoder_pool);
+		main_encoder_pool = NULL;
+	}
 }
 
 void RecastMultistreamDock::onAddDestination()
@@ -624,10 +1627,11 @@ void RecastMultistreamDock::onAddDestination()
 
 	/* Validate URL format */
 	if (!url.startsWith("rtmp://") && !url.startsWith("rtmps://")
-	    && !url.startsWith("srt://")) {
+	    && !url.startsWith("srt://") && !url.startsWith("rist://")) {
 		QMessageBox::warning(
 			this, obs_module_text("Recast.Error"),
-			"URL must start with rtmp://, rtmps://, or srt://");
+			"URL must start with rtmp://, rtmps://, srt:// or "
+			"rist://");
 		return;
 	}
 
@@ -636,6 +1640,13 @@ void RecastMultistreamDock::onAddDestination()
 		url.toUtf8().constData(),
 		key.toUtf8().constData(),
 		dlg.getCanvasVertical());
+	dlg.getEncoderSettings(&dest->venc_settings);
+	dlg.getAbrConfig(&dest->abr);
+	dest->connect_timeout_sec = dlg.getConnectTimeout();
+
+	recast_transport_config_t transport;
+	dlg.getTransportConfig(&transport);
+	recast_destination_set_transport(dest, &transport);
 
 	addRow(dest);
 	emit configChanged();
@@ -653,7 +1664,11 @@ void RecastMultistreamDock::onEditDestination(RecastDestinationRow *row)
 		QString::fromUtf8(d->name),
 		QString::fromUtf8(d->url),
 		QString::fromUtf8(d->key),
-		d->canvas_vertical);
+		d->canvas_vertical,
+		&d->venc_settings,
+		&d->abr,
+		d->connect_timeout_sec,
+		&d->transport);
 
 	if (dlg.exec() != QDialog::Accepted)
 		return;
@@ -669,53 +1684,47 @@ void RecastMultistreamDock::onEditDestination(RecastDestinationRow *row)
 		return;
 	}
 
-	/* Stop if active before changing settings */
-	bool was_active = d->active;
-	if (was_active)
+	/* A start may have begun while the dialog was open */
+	if (d->start_pending)
+		return;
+
+	/* Only connection and encoding changes need the output stopped */
+	recast_encoder_settings_t venc_settings = d->venc_settings;
+	recast_abr_config_t abr = d->abr;
+	dlg.getEncoderSettings(&venc_settings);
+	dlg.getAbrConfig(&abr);
+	bool canvas_vertical = dlg.getCanvasVertical();
+
+	if (canvas_vertical != d->canvas_vertical ||
+	    !recast_encoder_settings_equal(&venc_settings, &d->venc_settings) ||
+	    abr.enabled != d->abr.enabled ||
+	    abr.floor_kbps != d->abr.floor_kbps ||
+	    abr.ceiling_kbps != d->abr.ceiling_kbps)
 		recast_destination_stop(d);
 
 	/* Update fields */
 	bfree(d->name);
 	d->name = bstrdup(name.toUtf8().constData());
-	bfree(d->url);
-	d->url = bstrdup(url.toUtf8().constData());
-	bfree(d->key);
-	d->key = bstrdup(key.toUtf8().constData());
-	d->canvas_vertical = dlg.getCanvasVertical();
-	d->protocol = recast_protocol_detect(d->url);
+	d->canvas_vertical = canvas_vertical;
+	d->venc_settings = venc_settings;
+	d->abr = abr;
+	d->connect_timeout_sec = dlg.getConnectTimeout();
 
-	/* Recreate service with new settings */
-	if (d->service) {
-		obs_service_release(d->service);
-		d->service = nullptr;
-	}
-	const char *service_id = recast_protocol_service_id(d->protocol);
-	obs_data_t *svc_settings = obs_data_create();
-	if (d->protocol == RECAST_PROTO_WHIP) {
-		obs_data_set_string(svc_settings, "server", d->url);
-		obs_data_set_string(svc_settings, "bearer_token", d->key);
-	} else {
-		obs_data_set_string(svc_settings, "server", d->url);
-		obs_data_set_string(svc_settings, "key", d->key);
-	}
-	struct dstr svc_name = {0};
-	dstr_printf(&svc_name, "recast_svc_%s", d->name);
-	d->service = obs_service_create(
-		service_id, svc_name.array, svc_settings, NULL);
-	dstr_free(&svc_name);
-	obs_data_release(svc_settings);
+	/* Service/output are updated in place unless the protocol moved */
+	recast_destination_set_connection(d, url.toUtf8().constData(),
+					  key.toUtf8().constData());
 
-	/* Recreate output with new protocol */
-	if (d->output) {
-		obs_output_release(d->output);
-		d->output = nullptr;
-	}
-	const char *output_id = recast_protocol_output_id(d->protocol);
-	struct dstr out_name = {0};
-	dstr_printf(&out_name, "recast_out_%s", d->name);
-	d->output = obs_output_create(
-		output_id, out_name.array, NULL, NULL);
-	dstr_free(&out_name);
+	recast_transport_config_t transport;
+	dlg.getTransportConfig(&transport);
+	recast_destination_set_transport(d, &transport);
+
+	rebuildRow(row);
+	emit configChanged();
+}
+
+void RecastMultistreamDock::rebuildRow(RecastDestinationRow *row)
+{
+	recast_destination_t *d = row->destination();
 
 	/* Rebuild the row UI by removing and re-adding */
 	auto it = std::find(rows_.begin(), rows_.end(), row);
@@ -727,19 +1736,10 @@ void RecastMultistreamDock::onEditDestination(RecastDestinationRow *row)
 		row->deleteLater();
 
 		auto *new_row = new RecastDestinationRow(d, this);
-		connect(new_row, &RecastDestinationRow::deleteRequested,
-			this, &RecastMultistreamDock::onDeleteDestination);
-		connect(new_row, &RecastDestinationRow::editRequested,
-			this, &RecastMultistreamDock::onEditDestination);
-		connect(new_row, &RecastDestinationRow::autoChanged,
-			this, [this](RecastDestinationRow *) {
-				emit configChanged();
-			});
+		wireRow(new_row);
 		rows_layout_->insertWidget(pos, new_row);
 		rows_.insert(rows_.begin() + pos, new_row);
 	}
-
-	emit configChanged();
 }
 
 void RecastMultistreamDock::onDeleteDestination(RecastDestinationRow *row)
@@ -775,20 +1775,10 @@ void RecastMultistreamDock::onSyncServer()
 	server_input->setPlaceholderText(
 		"https://your-server.com/api/stream/status");
 	/* Load saved server URL from config if available */
-	char *config_path = recast_config_get_path();
-	if (config_path) {
-		obs_data_t *root =
-			obs_data_create_from_json_file(config_path);
-		if (root) {
-			const char *saved_url =
-				obs_data_get_string(root, "server_url");
-			if (saved_url && *saved_url)
-				server_input->setText(
-					QString::fromUtf8(saved_url));
-			obs_data_release(root);
-		}
-		bfree(config_path);
-	}
+	char *saved_url = recast_config_get_value("server_url");
+	if (saved_url && *saved_url)
+		server_input->setText(QString::fromUtf8(saved_url));
+	bfree(saved_url);
 	form->addRow("Server URL", server_input);
 
 	auto *token_input = new QLineEdit;
@@ -825,18 +1815,8 @@ void RecastMultistreamDock::onSyncServer()
 	recast_config_set_server_token(token_str.toUtf8().constData());
 
 	/* Save server URL to config */
-	config_path = recast_config_get_path();
-	if (config_path) {
-		obs_data_t *root =
-			obs_data_create_from_json_file(config_path);
-		if (!root)
-			root = obs_data_create();
-		obs_data_set_string(root, "server_url",
-			server_url.toUtf8().constData());
-		obs_data_save_json(root, config_path);
-		obs_data_release(root);
-		bfree(config_path);
-	}
+	recast_config_set_value("server_url",
+				server_url.toUtf8().constData());
 
 	/* Build request with token in Authorization header */
 	QNetworkRequest req{QUrl(server_url)};
@@ -844,7 +1824,7 @@ void RecastMultistreamDock::onSyncServer()
 	if (!token_str.isEmpty())
 		req.setRawHeader("Authorization",
 				 ("Bearer " + token_str).toUtf8());
-	QNetworkReply *reply = net_mgr_->get(req);
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
 	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
 		reply->deleteLater();
 
@@ -874,6 +1854,8 @@ void RecastMultistreamDock::onSyncServer()
 
 		QJsonArray platforms =
 			doc.object().value("platforms").toArray();
+		int added = 0;
+		int updated = 0;
 
 		for (const QJsonValue &val : platforms) {
 			QJsonObject p = val.toObject();
@@ -884,29 +1866,61 @@ void RecastMultistreamDock::onSyncServer()
 			if (name.isEmpty() || rtmp_url.isEmpty())
 				continue;
 
-			/* Check if we already have this destination */
-			bool exists = false;
+			/* Match by name first (the server owns it), then
+			 * by URL for destinations added before syncing */
+			QByteArray name_utf8 = name.toUtf8();
+			QByteArray url_utf8 = rtmp_url.toUtf8();
+			QByteArray key_utf8 = key.toUtf8();
+
+			RecastDestinationRow *match = nullptr;
 			for (auto *row : rows_) {
-				if (QString::fromUtf8(
-					    row->destination()->url) ==
-				    rtmp_url) {
-					exists = true;
+				if (strcmp(row->destination()->name,
+					   name_utf8.constData()) == 0) {
+					match = row;
 					break;
 				}
 			}
-			if (exists)
+			if (!match) {
+				for (auto *row : rows_) {
+					if (strcmp(row->destination()->url,
+						   url_utf8.constData()) == 0) {
+						match = row;
+						break;
+					}
+				}
+			}
+
+			if (!match) {
+				addRow(recast_destination_create(
+					name_utf8.constData(),
+					url_utf8.constData(),
+					key_utf8.constData(), false));
+				added++;
 				continue;
+			}
 
-			recast_destination_t *dest =
-				recast_destination_create(
-					name.toUtf8().constData(),
-					rtmp_url.toUtf8().constData(),
-					key.toUtf8().constData(),
-					false);
-			addRow(dest);
+			/* Leave unchanged destinations (and their outputs)
+			 * alone */
+			recast_destination_t *d = match->destination();
+			bool renamed = strcmp(d->name, name_utf8.constData()) != 0;
+			if (renamed) {
+				bfree(d->name);
+				d->name = bstrdup(name_utf8.constData());
+			}
+			bool moved = recast_destination_set_connection(
+				d, url_utf8.constData(), key_utf8.constData());
+			if (renamed || moved) {
+				rebuildRow(match);
+				updated++;
+			}
 		}
 
-		emit configChanged();
+		blog(LOG_INFO, "[Recast] Sync: %d added, %d updated", added,
+		     updated);
+		if (added > 0 || updated > 0) {
+			updateButtonStates();
+			emit configChanged();
+		}
 
 		QMessageBox::information(
 			this, obs_module_text("Recast.SyncServer"),
@@ -916,25 +1930,114 @@ void RecastMultistreamDock::onSyncServer()
 
 void RecastMultistreamDock::onRefreshTimer()
 {
-	for (auto *row : rows_)
+	uint64_t now = os_gettime_ns();
+	bool sampled = false;
+
+	for (auto *row : rows_) {
+		recast_destination_t *d = row->destination();
+		if (!d || d->state != RECAST_DEST_LIVE)
+			continue;
+		recast_stats_sample(&d->stats, d->output, now);
+		recast_destination_tick_abr(d);
 		row->refreshStatus();
-	updateButtonStates();
+		sampled = true;
+	}
+
+	if (sampled)
+		emit statsSampled();
+}
+
+QList<RecastDestinationHealth> RecastMultistreamDock::destinationHealth() const
+{
+	QList<RecastDestinationHealth> list;
+	list.reserve((qsizetype)rows_.size());
+
+	for (auto *row : rows_) {
+		const recast_destination_t *d = row->destination();
+		if (!d)
+			continue;
+
+		RecastDestinationHealth h;
+		h.id = QString::fromUtf8(d->id);
+		h.name = QString::fromUtf8(d->name);
+		h.active = recast_destination_is_active(d);
+		h.state = d->state;
+		if (const recast_stats_sample_t *s =
+			    recast_stats_at(&d->stats, 0))
+			h.latest = *s;
+		list.append(h);
+	}
+	return list;
+}
+
+const recast_stats_ring_t *
+RecastMultistreamDock::destinationStats(const QString &id) const
+{
+	QByteArray key = id.toUtf8();
+	for (auto *row : rows_) {
+		const recast_destination_t *d = row->destination();
+		if (d && strcmp(d->id, key.constData()) == 0)
+			return &d->stats;
+	}
+	return nullptr;
+}
+
+void RecastMultistreamDock::updateRefreshTimer()
+{
+	/* Nothing moves while every destination is stopped */
+	bool any_active = false;
+	for (auto *row : rows_) {
+		recast_destination_t *d = row->destination();
+		if (d && recast_destination_is_active(d)) {
+			any_active = true;
+			break;
+		}
+	}
+
+	if (any_active && !refresh_timer_->isActive())
+		refresh_timer_->start(1000);
+	else if (!any_active)
+		refresh_timer_->stop();
 }
 
 void RecastMultistreamDock::addRow(recast_destination_t *dest)
 {
+	dest->output_cb = outputEventCallback;
+	dest->output_cb_param = this;
+
 	auto *row = new RecastDestinationRow(dest, this);
+	wireRow(row);
+	rows_layout_->addWidget(row);
+	rows_.push_back(row);
+
+	empty_label_->setVisible(false);
+	updateButtonStates();
+}
+
+void RecastMultistreamDock::wireRow(RecastDestinationRow *row)
+{
 	connect(row, &RecastDestinationRow::deleteRequested,
 		this, &RecastMultistreamDock::onDeleteDestination);
 	connect(row, &RecastDestinationRow::editRequested,
 		this, &RecastMultistreamDock::onEditDestination);
 	connect(row, &RecastDestinationRow::autoChanged,
 		this, [this](RecastDestinationRow *) { emit configChanged(); });
-	rows_layout_->addWidget(row);
-	rows_.push_back(row);
+	connect(row, &RecastDestinationRow::activeChanged,
+		this, [this](RecastDestinationRow *) { updateButtonStates(); });
+	connect(row, &RecastDestinationRow::startRequested,
+		this, [this](RecastDestinationRow *r) {
+			startDestination(r, true);
+		});
+}
 
-	empty_label_->setVisible(false);
-	updateButtonStates();
+RecastDestinationRow *
+RecastMultistreamDock::rowFor(const recast_destination_t *dest) const
+{
+	for (auto *row : rows_) {
+		if (row->destination() == dest)
+			return row;
+	}
+	return nullptr;
 }
 
 void RecastMultistreamDock::removeRow(RecastDestinationRow *row)
@@ -957,10 +2060,161 @@ void RecastMultistreamDock::onStartAll()
 {
 	for (auto *row : rows_) {
 		recast_destination_t *d = row->destination();
-		if (d && !d->active)
-			recast_destination_start(d);
+		if (d && !recast_destination_is_active(d) &&
+		    !d->start_pending)
+			startDestination(row, false);
+	}
+	updateButtonStates();
+}
+
+/* ---- Non-blocking start ---- */
+
+void RecastMultistreamDock::startDestination(RecastDestinationRow *row,
+					     bool interactive)
+{
+	recast_destination_t *d = row->destination();
+	if (!d || d->start_pending)
+		return;
+
+	/* Only a reconnecting destination may be started while active */
+	bool retry = d->state == RECAST_DEST_RECONNECTING;
+	if (!retry && recast_destination_is_active(d))
+		return;
+
+	if (!recast_destination_begin_start(d)) {
 		row->refreshStatus();
+		if (interactive)
+			QMessageBox::warning(
+				this, obs_module_text("Recast.Error"),
+				obs_module_text(
+					"Recast.Multistream.StartFailed"));
+		return;
+	}
+
+	row->refreshStatus();
+	updateButtonStates();
+
+	/* The destination outlives the task: destroy is deferred while
+	 * start_pending, and the destructor waits for the pool. */
+	uint64_t serial = d->start_serial;
+	start_pool_->start([this, d, serial, interactive]() {
+		d->start_result = obs_output_start(d->output);
+		QMetaObject::invokeMethod(
+			this,
+			[this, d, serial, interactive]() {
+				onStartReturned(d, serial, interactive);
+			},
+			Qt::QueuedConnection);
+	});
+
+	/* Retries are bounded by the backoff instead */
+	if (retry)
+		return;
+
+	int timeout_ms = std::max(d->connect_timeout_sec, 1) * 1000;
+	QTimer::singleShot(timeout_ms, this, [this, d, serial]() {
+		onConnectTimeout(d, serial);
+	});
+}
+
+void RecastMultistreamDock::onStartReturned(recast_destination_t *d,
+					    uint64_t serial, bool interactive)
+{
+	if (d->start_serial != serial || !d->start_pending)
+		return;
+
+	bool retry = recast_destination_end_start(d);
+
+	if (d->destroy_requested) {
+		recast_destination_destroy(d);
+		return;
+	}
+
+	RecastDestinationRow *row = rowFor(d);
+	if (!row)
+		return;
+
+	if (retry) {
+		scheduleRetry(d);
+	} else if (d->state == RECAST_DEST_FAILED) {
+		if (interactive)
+			QMessageBox::warning(
+				this, obs_module_text("Recast.Error"),
+				obs_module_text(
+					"Recast.Multistream.StartFailed"));
 	}
+	row->refreshStatus();
+	updateButtonStates();
+}
+
+void RecastMultistreamDock::onConnectTimeout(recast_destination_t *d,
+					     uint64_t serial)
+{
+	/* d may be gone; only dereference it once a row vouches for it */
+	RecastDestinationRow *row = rowFor(d);
+	if (!row || d->start_serial != serial ||
+	    d->state != RECAST_DEST_CONNECTING)
+		return;
+
+	blog(LOG_WARNING,
+	     "[Recast] Destination '%s' did not connect within %d s",
+	     d->name, d->connect_timeout_sec);
+
+	recast_destination_abort(d);
+	row->refreshStatus();
+	updateButtonStates();
+}
+
+void RecastMultistreamDock::scheduleRetry(recast_destination_t *d)
+{
+	d->retry_attempt++;
+	uint32_t delay_ms = recast_destination_retry_delay_ms(d);
+
+	blog(LOG_INFO, "[Recast] Retrying '%s' in %u ms (attempt %d)",
+	     d->name, delay_ms, d->retry_attempt);
+
+	/* A stop or a fresh start bumps the serial and voids the retry */
+	uint64_t serial = d->start_serial;
+	QTimer::singleShot((int)delay_ms, this, [this, d, serial]() {
+		onRetryTimer(d, serial);
+	});
+}
+
+void RecastMultistreamDock::onRetryTimer(recast_destination_t *d,
+					 uint64_t serial)
+{
+	RecastDestinationRow *row = rowFor(d);
+	if (!row || d->start_serial != serial ||
+	    d->state != RECAST_DEST_RECONNECTING)
+		return;
+
+	startDestination(row, false);
+}
+
+void RecastMultistreamDock::outputEventCallback(void *param,
+						recast_destination_t *dest,
+						int event, int code)
+{
+	auto *dock = static_cast<RecastMultistreamDock *>(param);
+	QMetaObject::invokeMethod(
+		dock,
+		[dock, dest, event, code]() {
+			dock->onOutputEvent(dest, event, code);
+		},
+		Qt::QueuedConnection);
+}
+
+void RecastMultistreamDock::onOutputEvent(recast_destination_t *d, int event,
+					  int code)
+{
+	RecastDestinationRow *row = rowFor(d);
+	if (!row)
+		return;
+
+	if (recast_destination_on_output_event(d, event, code))
+		scheduleRetry(d);
+
+	row->refreshStatus();
 	updateButtonStates();
 }
 
@@ -968,7 +2222,8 @@ void RecastMultistreamDock::onStopAll()
 {
 	for (auto *row : rows_) {
 		recast_destination_t *d = row->destination();
-		if (d && d->active)
+		if (d && (recast_destination_is_active(d) ||
+			  d->start_pending))
 			recast_destination_stop(d);
 		row->refreshStatus();
 	}
@@ -982,12 +2237,15 @@ void RecastMultistreamDock::updateButtonStates()
 
 	for (auto *row : rows_) {
 		recast_destination_t *d = row->destination();
-		if (d && d->active)
+		if (d && (recast_destination_is_active(d) ||
+			  d->start_pending))
 			any_active = true;
 		else
 			any_stopped = true;
 	}
 
+	updateRefreshTimer();
+
 	bool has_rows = !rows_.empty();
 	start_all_btn_->setEnabled(has_rows && any_stopped);
 	stop_all_btn_->setEnabled(has_rows && any_active);
@@ -1012,22 +2270,23 @@ void RecastMultistreamDock::onMainStreamStarted()
 {
 	for (auto *row : rows_) {
 		recast_destination_t *d = row->destination();
-		if (d && d->auto_start && !d->active) {
-			if (recast_destination_start(d)) {
-				blog(LOG_INFO,
-				     "[Recast] Auto-started destination '%s'",
-				     d->name);
-			}
-			row->refreshStatus();
+		if (d && d->auto_start && !recast_destination_is_active(d) &&
+		    !d->start_pending) {
+			blog(LOG_INFO,
+			     "[Recast] Auto-starting destination '%s'",
+			     d->name);
+			startDestination(row, false);
 		}
 	}
+	updateButtonStates();
 }
 
 void RecastMultistreamDock::onMainStreamStopped()
 {
 	for (auto *row : rows_) {
 		recast_destination_t *d = row->destination();
-		if (d && d->auto_stop && d->active) {
+		if (d && d->auto_stop &&
+		    (recast_destination_is_active(d) || d->start_pending)) {
 			recast_destination_stop(d);
 			blog(LOG_INFO,
 			     "[Recast] Auto-stopped destination '%s'",
@@ -1035,6 +2294,7 @@ void RecastMultistreamDock::onMainStreamStopped()
 			row->refreshStatus();
 		}
 	}
+	updateButtonStates();
 }
 
 /* ---- Config persistence ---- */
@@ -1061,6 +2321,25 @@ void RecastMultistreamDock::loadDestinations(obs_data_array_t *arr)
 		dest->auto_start = obs_data_get_bool(item, "autoStart");
 		dest->auto_stop = obs_data_get_bool(item, "autoStop");
 
+		obs_data_t *venc = obs_data_get_obj(item, "videoEncoder");
+		recast_encoder_settings_load(&dest->venc_settings, venc);
+		obs_data_release(venc);
+
+		obs_data_t *abr = obs_data_get_obj(item, "abr");
+		recast_abr_config_load(&dest->abr, abr);
+		obs_data_release(abr);
+
+		obs_data_t *transport_data =
+			obs_data_get_obj(item, "transport");
+		recast_transport_config_t transport;
+		recast_transport_config_load(&transport, transport_data);
+		recast_destination_set_transport(dest, &transport);
+		obs_data_release(transport_data);
+
+		int timeout = (int)obs_data_get_int(item, "connectTimeoutSec");
+		if (timeout > 0)
+			dest->connect_timeout_sec = timeout;
+
 		/* Restore saved ID if present */
 		const char *saved_id = obs_data_get_string(item, "id");
 		if (saved_id && *saved_id) {
@@ -1089,6 +2368,23 @@ obs_data_array_t *RecastMultistreamDock::saveDestinations() const
 				    d->canvas_vertical ? "vertical" : "main");
 		obs_data_set_bool(item, "autoStart", d->auto_start);
 		obs_data_set_bool(item, "autoStop", d->auto_stop);
+		obs_data_set_int(item, "connectTimeoutSec",
+				 d->connect_timeout_sec);
+
+		obs_data_t *venc = obs_data_create();
+		recast_encoder_settings_save(&d->venc_settings, venc);
+		obs_data_set_obj(item, "videoEncoder", venc);
+		obs_data_release(venc);
+
+		obs_data_t *abr = obs_data_create();
+		recast_abr_config_save(&d->abr, abr);
+		obs_data_set_obj(item, "abr", abr);
+		obs_data_release(abr);
+
+		obs_data_t *transport = obs_data_create();
+		recast_transport_config_save(&d->transport, transport);
+		obs_data_set_obj(item, "transport", transport);
+		obs_data_release(transport);
 
 		obs_data_array_push_back(arr, item);
 		obs_data_release(item);
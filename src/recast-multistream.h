@@ -9,9 +9,11 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QDialog>
+#include <QSpinBox>
 #include <QTimer>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QList>
+#include <QThreadPool>
 
 #include <vector>
 
@@ -19,10 +21,46 @@ extern "C" {
 #include <obs.h>
 #include <obs-frontend-api.h>
 #include "recast-output.h"
+#include "recast-encoder-pool.h"
+#include "recast-stats.h"
+#include "recast-abr.h"
 }
 
 /* ---- Simplified destination target ---- */
 
+/* Output lifecycle events, reported from OBS threads */
+enum {
+	RECAST_DEST_OUTPUT_STARTED, /* connected, data flowing */
+	RECAST_DEST_OUTPUT_STOPPED, /* code is an OBS_OUTPUT_* status */
+	RECAST_DEST_OUTPUT_RECONNECT,         /* OBS native retry began */
+	RECAST_DEST_OUTPUT_RECONNECT_SUCCESS, /* native retry recovered */
+};
+
+/*
+ * Destination lifecycle:
+ *
+ *   IDLE -> CONNECTING -> LIVE <-> RECONNECTING
+ *              |                       |
+ *              +------> FAILED <-------+
+ *
+ * Stop returns any state to IDLE. RECONNECTING keeps the encoder refs
+ * so a dropped destination comes back without re-acquiring them.
+ */
+typedef enum {
+	RECAST_DEST_IDLE,
+	RECAST_DEST_CONNECTING,
+	RECAST_DEST_LIVE,
+	RECAST_DEST_RECONNECTING,
+	RECAST_DEST_FAILED,
+} recast_dest_state_t;
+
+const char *recast_dest_state_name(recast_dest_state_t state);
+
+struct recast_destination;
+typedef void (*recast_dest_output_cb)(void *param,
+				      struct recast_destination *dest,
+				      int event, int code);
+
 typedef struct recast_destination {
 	char *id;
 	char *name;
@@ -32,12 +70,46 @@ typedef struct recast_destination {
 	bool auto_stop;
 	bool canvas_vertical;  /* false = main, true = vertical */
 
+	/* Vertical encoder settings; destinations with equal settings
+	 * share one pooled encoder. Ignored for the main canvas. */
+	recast_encoder_settings_t venc_settings;
+	obs_encoder_t *venc; /* pooled encoder held while active */
+
+	/* Adaptive bitrate; needs a dedicated encoder, so when enabled the
+	 * destination never shares venc (or the main encoder). */
+	recast_abr_config_t abr;
+	recast_abr_state_t abr_state;
+
 	recast_protocol_t protocol;
-	obs_output_t *output;
-	obs_service_t *service;
+	recast_transport_config_t transport; /* SRT/RIST only */
+	obs_output_t *output;   /* NULL until the first start */
+	obs_service_t *service; /* created together with output */
 
-	bool active;
+	recast_dest_state_t state;
 	uint64_t start_time_ns;
+	int retry_attempt; /* plugin restarts since the last LIVE */
+	uint32_t recoveries; /* RECONNECTING -> LIVE since start */
+
+	/* Async start. obs_output_start runs on a worker between
+	 * begin_start and end_start (start_pending); the destination then
+	 * stays connecting until the output reports it started. */
+	bool start_pending;
+	bool start_result;      /* written by the start worker */
+	bool stop_requested;    /* stop/destroy arrived while pending */
+	bool destroy_requested;
+	bool abort_requested;   /* ...and should end in FAILED */
+	bool output_started;
+	bool stop_seen;         /* output stopped before end_start */
+	int stop_code;
+	uint64_t start_serial;
+	int connect_timeout_sec;
+
+	/* Output signal forwarding, set once before the first start */
+	recast_dest_output_cb output_cb;
+	void *output_cb_param;
+
+	/* Sampled by the dock while active, reset on start */
+	recast_stats_ring_t stats;
 } recast_destination_t;
 
 recast_destination_t *recast_destination_create(const char *name,
@@ -45,10 +117,48 @@ recast_destination_t *recast_destination_create(const char *name,
 						const char *key,
 						bool canvas_vertical);
 void recast_destination_destroy(recast_destination_t *dest);
-bool recast_destination_start(recast_destination_t *dest);
+
+/* Connecting, live or reconnecting (holding encoders) */
+bool recast_destination_is_active(const recast_destination_t *dest);
+
+/* Two-phase start (UI thread). begin_start creates the service and
+ * output on first use, binds encoders and fails if none are available;
+ * the caller then runs obs_output_start on any
+ * thread, stores the result in start_result, and calls end_start back
+ * on the UI thread. Destroy is deferred while a start is pending.
+ * Called in RECONNECTING, begin_start restarts with the held encoders.
+ * end_start returns true if a failed restart should be retried. */
+bool recast_destination_begin_start(recast_destination_t *dest);
+bool recast_destination_end_start(recast_destination_t *dest);
+
+/* Apply an output event (UI thread). Returns true if the output dropped
+ * and the caller should retry after recast_destination_retry_delay_ms. */
+bool recast_destination_on_output_event(recast_destination_t *dest,
+					int event, int code);
+
+/* Jittered exponential backoff for the current retry_attempt */
+uint32_t recast_destination_retry_delay_ms(const recast_destination_t *dest);
+
 void recast_destination_stop(recast_destination_t *dest);
+
+/* Stop and leave the destination FAILED (e.g. connect timeout) */
+void recast_destination_abort(recast_destination_t *dest);
+
+/* Change URL/key, stopping first if active. The service is updated in
+ * place; when the URL implies a different protocol, service and output
+ * are dropped and re-created on the next start. Returns false if
+ * nothing changed. */
+bool recast_destination_set_connection(recast_destination_t *dest,
+				       const char *url, const char *key);
+
+/* Change the SRT/RIST tuning, stopping first if active */
+bool recast_destination_set_transport(recast_destination_t *dest,
+				      const recast_transport_config_t *cfg);
 uint64_t recast_destination_elapsed_sec(const recast_destination_t *dest);
 
+/* Run one ABR step on the latest stats sample (called per stats tick). */
+void recast_destination_tick_abr(recast_destination_t *dest);
+
 /* ---- Add Destination Dialog ---- */
 
 class RecastDestinationDialog : public QDialog {
@@ -59,18 +169,75 @@ public:
 		const QString &name = QString(),
 		const QString &url = QString(),
 		const QString &key = QString(),
-		bool canvas_vertical = false);
+		bool canvas_vertical = false,
+		const recast_encoder_settings_t *venc = nullptr,
+		const recast_abr_config_t *abr = nullptr,
+		int connect_timeout_sec = 15,
+		const recast_transport_config_t *transport = nullptr);
 
 	QString getName() const;
 	QString getUrl() const;
 	QString getKey() const;
 	bool getCanvasVertical() const;
+	void getEncoderSettings(recast_encoder_settings_t *out) const;
+	void getAbrConfig(recast_abr_config_t *out) const;
+	int getConnectTimeout() const;
+	void getTransportConfig(recast_transport_config_t *out) const;
 
 private:
 	QLineEdit *name_edit_;
 	QLineEdit *url_edit_;
 	QLineEdit *key_edit_;
 	QComboBox *canvas_combo_;
+
+	/* Vertical encoder settings (shown for the vertical canvas) */
+	QWidget *encoder_group_;
+	QComboBox *encoder_combo_;
+	QSpinBox *bitrate_spin_;
+	QComboBox *rate_control_combo_;
+	QSpinBox *keyint_spin_;
+	QComboBox *scaled_size_combo_;
+	recast_encoder_settings_t venc_;
+
+	/* Adaptive bitrate */
+	QCheckBox *abr_check_;
+	QSpinBox *abr_floor_spin_;
+	QSpinBox *abr_ceiling_spin_;
+
+	QSpinBox *timeout_spin_;
+
+	/* SRT / RIST tuning (shown for matching URLs) */
+	QWidget *srt_group_;
+	QSpinBox *srt_latency_spin_;
+	QSpinBox *srt_maxbw_spin_;
+	QSpinBox *srt_overhead_spin_;
+	QWidget *rist_group_;
+	QSpinBox *rist_buffer_spin_;
+
+	void updateTransportVisibility();
+};
+
+/* ---- Health sparkline ---- */
+
+/*
+ * Paints the smoothed bitrate history of a stats ring as a line, with
+ * red ticks on intervals that dropped frames. Reads the ring in place;
+ * call update() after each sample.
+ */
+class RecastSparkline : public QWidget {
+	Q_OBJECT
+
+public:
+	explicit RecastSparkline(QWidget *parent = nullptr);
+
+	void setRing(const recast_stats_ring_t *ring) { ring_ = ring; }
+	QSize sizeHint() const override { return QSize(80, 18); }
+
+protected:
+	void paintEvent(QPaintEvent *event) override;
+
+private:
+	const recast_stats_ring_t *ring_ = nullptr;
 };
 
 /* ---- Destination Row Widget ---- */
@@ -84,12 +251,17 @@ public:
 	~RecastDestinationRow();
 
 	recast_destination_t *destination() const { return dest_; }
+
+	/* Restyle on state changes, then update any stat that moved.
+	 * Widgets are only touched when their value differs. */
 	void refreshStatus();
 
 signals:
 	void deleteRequested(RecastDestinationRow *row);
 	void editRequested(RecastDestinationRow *row);
 	void autoChanged(RecastDestinationRow *row);
+	void activeChanged(RecastDestinationRow *row);
+	void startRequested(RecastDestinationRow *row);
 
 private slots:
 	void onToggleStream();
@@ -102,11 +274,42 @@ private:
 	QLabel *canvas_label_;
 	QLabel *bitrate_label_;
 	QLabel *dropped_label_;
+	QLabel *recovery_label_;
+	RecastSparkline *sparkline_;
 	QPushButton *toggle_btn_;
 	QPushButton *edit_btn_;
 	QPushButton *delete_btn_;
 	QCheckBox *auto_check_;
-	uint64_t last_bytes_;
+
+	/* What the widgets currently show */
+	enum DisplayState {
+		DISPLAY_NONE,
+		DISPLAY_STOPPED,
+		DISPLAY_CONNECTING,
+		DISPLAY_ACTIVE,
+		DISPLAY_RECONNECTING,
+		DISPLAY_FAILED,
+	};
+	DisplayState shown_state_ = DISPLAY_NONE;
+	int shown_attempt_ = -1;
+	uint64_t shown_elapsed_ = UINT64_MAX;
+	int shown_kbps_ = -1;
+	int shown_dropped_ = -1;
+	int shown_drop_pct10_ = -1; /* drop rate in tenths of a percent */
+	int64_t shown_recoveries_ = -1;
+
+	void applyState(DisplayState state);
+	void updateStats();
+};
+
+/* ---- Destination health snapshot (for other docks) ---- */
+
+struct RecastDestinationHealth {
+	QString id;
+	QString name;
+	bool active = false;
+	recast_dest_state_t state = RECAST_DEST_IDLE;
+	recast_stats_sample_t latest = {};
 };
 
 /* ---- Multistream Dock ---- */
@@ -122,9 +325,17 @@ public:
 	void loadDestinations(obs_data_array_t *arr);
 	obs_data_array_t *saveDestinations() const;
 
+	/* Telemetry queries. The ring pointer stays valid until the
+	 * destination is removed; read it on the UI thread only. */
+	QList<RecastDestinationHealth> destinationHealth() const;
+	const recast_stats_ring_t *destinationStats(const QString &id) const;
+
 signals:
 	void configChanged();
 
+	/* Emitted after each stats tick that sampled any destination */
+	void statsSampled();
+
 private slots:
 	void onAddDestination();
 	void onEditDestination(RecastDestinationRow *row);
@@ -137,15 +348,33 @@ private slots:
 private:
 	QVBoxLayout *rows_layout_;
 	QTimer *refresh_timer_;
-	QNetworkAccessManager *net_mgr_;
 	std::vector<RecastDestinationRow *> rows_;
 	QPushButton *start_all_btn_;
 	QPushButton *stop_all_btn_;
 	QLabel *empty_label_;
 
+	/* Runs the blocking obs_output_start calls, one per destination */
+	QThreadPool *start_pool_;
+
 	void addRow(recast_destination_t *dest);
+	void wireRow(RecastDestinationRow *row);
 	void removeRow(RecastDestinationRow *row);
+	void rebuildRow(RecastDestinationRow *row);
+	RecastDestinationRow *rowFor(const recast_destination_t *dest) const;
+
+	/* Non-blocking start; progress is reported to the row */
+	void startDestination(RecastDestinationRow *row, bool interactive);
+	void onStartReturned(recast_destination_t *dest, uint64_t serial,
+			     bool interactive);
+	void onConnectTimeout(recast_destination_t *dest, uint64_t serial);
+	void scheduleRetry(recast_destination_t *dest);
+	void onRetryTimer(recast_destination_t *dest, uint64_t serial);
+	void onOutputEvent(recast_destination_t *dest, int event, int code);
+	static void outputEventCallback(void *param,
+					recast_destination_t *dest, int event,
+					int code);
 	void updateButtonStates();
+	void updateRefreshTimer();
 
 	/* Auto start/stop with main OBS stream */
 	void onMainStreamStarted();
@@ -0,0 +1,155 @@
+/*
+ * recast-network.cpp -- Worker thread for chat and event network I/O.
+ */
+
+#include "recast-network.h"
+
+#include <QSslConfiguration>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+QThread *RecastNetwork::thread_ = nullptr;
+QObject *RecastNetwork::context_ = nullptr;
+QMutex RecastNetwork::mutex_;
+QNetworkAccessManager *RecastNetwork::ui_manager_ = nullptr;
+QNetworkAccessManager *RecastNetwork::worker_manager_ = nullptr;
+
+QThread *RecastNetwork::thread()
+{
+	QMutexLocker lock(&mutex_);
+	if (!thread_) {
+		thread_ = new QThread();
+		thread_->setObjectName(QStringLiteral("recast-network"));
+
+		context_ = new QObject();
+		context_->moveToThread(thread_);
+
+		thread_->start();
+		blog(LOG_INFO, "[Recast] Network thread started");
+	}
+	return thread_;
+}
+
+void RecastNetwork::adopt(QObject *obj)
+{
+	if (obj)
+		obj->moveToThread(thread());
+}
+
+void RecastNetwork::post(QObject *target, std::function<void()> fn)
+{
+	if (target)
+		QMetaObject::invokeMethod(target, std::move(fn),
+					  Qt::QueuedConnection);
+}
+
+void RecastNetwork::runBlocking(const std::function<void()> &fn)
+{
+	QObject *context;
+	{
+		QMutexLocker lock(&mutex_);
+		context = thread_ ? context_ : nullptr;
+	}
+
+	if (!context || QThread::currentThread() == context->thread()) {
+		fn();
+		return;
+	}
+
+	QMetaObject::invokeMethod(context, fn, Qt::BlockingQueuedConnection);
+}
+
+QNetworkAccessManager *RecastNetwork::manager()
+{
+	QMutexLocker lock(&mutex_);
+	if (thread_ && QThread::currentThread() == thread_) {
+		if (!worker_manager_)
+			worker_manager_ = new QNetworkAccessManager();
+		return worker_manager_;
+	}
+
+	if (!ui_manager_)
+		ui_manager_ = new QNetworkAccessManager();
+	return ui_manager_;
+}
+
+void RecastNetwork::preconnect(const QString &host)
+{
+	thread();
+
+	QObject *context;
+	{
+		QMutexLocker lock(&mutex_);
+		context = context_;
+	}
+
+	QMetaObject::invokeMethod(
+		context,
+		[host]() {
+#if QT_CONFIG(ssl)
+			QSslConfiguration conf =
+				QSslConfiguration::defaultConfiguration();
+			conf.setAllowedNextProtocols(
+				{QSslConfiguration::ALPNProtocolHTTP2,
+				 QSslConfiguration::NextProtocolHttp1_1});
+			manager()->connectToHostEncrypted(host, 443, conf);
+#else
+			Q_UNUSED(host);
+#endif
+		},
+		Qt::QueuedConnection);
+}
+
+void RecastNetwork::shutdown()
+{
+	/* Its replies and sockets belong to the worker; delete them there */
+	runBlocking([]() {
+		QNetworkAccessManager *mgr;
+		{
+			QMutexLocker lock(&mutex_);
+			mgr = worker_manager_;
+			worker_manager_ = nullptr;
+		}
+		delete mgr;
+	});
+
+	/* Not under mutex_: objects torn down on the worker while it
+	 * exits may still call manager() or thread() */
+	QThread *thread;
+	{
+		QMutexLocker lock(&mutex_);
+		thread = thread_;
+	}
+	if (!thread)
+		return;
+
+	thread->quit();
+	thread->wait();
+
+	QObject *context;
+	QNetworkAccessManager *mgr;
+	{
+		QMutexLocker lock(&mutex_);
+		context = context_;
+		mgr = worker_manager_; /* re-created during teardown */
+		context_ = nullptr;
+		thread_ = nullptr;
+		worker_manager_ = nullptr;
+	}
+
+	/* The loop has exited, so these can go from here */
+	delete mgr;
+	delete context;
+	delete thread;
+
+	blog(LOG_INFO, "[Recast] Network thread stopped");
+}
+
+void RecastNetwork::releaseManager()
+{
+	QMutexLocker lock(&mutex_);
+	delete ui_manager_;
+	ui_manager_ = nullptr;
+}
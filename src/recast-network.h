@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QNetworkAccessManager>
+
+#include <functional>
+
+/*
+ * RecastNetwork -- Worker thread for chat and event network I/O.
+ *
+ * The chat/event providers and the connections they share
+ * (RecastYouTubeLiveChat, RecastKickHub) live on this thread, so socket
+ * reads, JSON decoding and message parsing never run on the OBS UI
+ * thread. Only finished RecastChatMessage / RecastPlatformEvent structs
+ * cross back to the docks, through queued signals.
+ *
+ * Objects on the worker are driven from the UI with post(); never call
+ * their methods directly from another thread.
+ *
+ * HTTP goes through manager(): one QNetworkAccessManager per thread
+ * (the UI and the worker), so requests to the same host share one
+ * connection pool and TLS session, and HTTPS requests multiplex over
+ * HTTP/2 where the server supports it (Qt 6 default).
+ */
+class RecastNetwork {
+public:
+	/* The worker thread, started on first use. */
+	static QThread *thread();
+
+	/* Move a parentless object (and its children) onto the worker. */
+	static void adopt(QObject *obj);
+
+	/* Queue fn to run on target's thread; dropped if target dies. */
+	static void post(QObject *target, std::function<void()> fn);
+
+	/* Run fn on the worker and wait for it to return. Runs inline
+	 * when called from the worker or after shutdown(). */
+	static void runBlocking(const std::function<void()> &fn);
+
+	/* Shared manager of the calling thread, the UI or the worker. Do
+	 * not cache it in objects that change threads. */
+	static QNetworkAccessManager *manager();
+
+	/* Open a TLS connection to host on the worker's manager ahead of
+	 * the first request, offering HTTP/2. */
+	static void preconnect(const QString &host);
+
+	/* Stop the worker and delete its manager. Objects still on it
+	 * must be gone already. */
+	static void shutdown();
+
+	/* Delete the UI thread's manager, after its last user is gone */
+	static void releaseManager();
+
+private:
+	static QThread *thread_;
+	static QObject *context_; /* invokeMethod target on the worker */
+	static QMutex mutex_;
+
+	static QNetworkAccessManager *ui_manager_;
+	static QNetworkAccessManager *worker_manager_; /* worker only */
+};
@@ -0,0 +1,197 @@
+/*
+ * recast-perf-dock.cpp -- Per-subsystem timing dock with CSV export.
+ */
+
+#include "recast-perf-dock.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QTextStream>
+#include <QVBoxLayout>
+
+#include <cstring>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+static QString format_us(uint64_t ns)
+{
+	return QString::number(ns / 1000.0, 'f', ns < 100000 ? 1 : 0);
+}
+
+RecastPerfDock::RecastPerfDock(QWidget *parent) : QWidget(parent)
+{
+	auto *layout = new QVBoxLayout(this);
+	layout->setContentsMargins(4, 4, 4, 4);
+	layout->setSpacing(4);
+
+	frames_label_ = new QLabel;
+	frames_label_->setWordWrap(true);
+	frames_label_->setStyleSheet("color: #999; font-size: 11px;");
+	layout->addWidget(frames_label_);
+
+	table_ = new QTableWidget(RECAST_PERF_SLOT_COUNT, 6);
+	table_->setHorizontalHeaderLabels({
+		obs_module_text("Recast.Perf.Subsystem"),
+		obs_module_text("Recast.Perf.Calls"),
+		obs_module_text("Recast.Perf.Mean"),
+		obs_module_text("Recast.Perf.P50"),
+		obs_module_text("Recast.Perf.P99"),
+		obs_module_text("Recast.Perf.Max"),
+	});
+	table_->verticalHeader()->setVisible(false);
+	table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table_->setSelectionMode(QAbstractItemView::NoSelection);
+	table_->setFocusPolicy(Qt::NoFocus);
+	table_->horizontalHeader()->setSectionResizeMode(
+		0, QHeaderView::Stretch);
+	for (int c = 1; c < 6; c++)
+		table_->horizontalHeader()->setSectionResizeMode(
+			c, QHeaderView::ResizeToContents);
+
+	for (int s = 0; s < RECAST_PERF_SLOT_COUNT; s++) {
+		/* Drop the "recast: " prefix the profiler log needs */
+		QString name = QString::fromUtf8(
+			recast_perf_slot_name((enum recast_perf_slot)s));
+		name = name.mid(name.indexOf(QLatin1Char(' ')) + 1);
+		table_->setItem(s, 0, new QTableWidgetItem(name));
+		for (int c = 1; c < 6; c++) {
+			auto *item = new QTableWidgetItem;
+			item->setTextAlignment(Qt::AlignRight |
+					       Qt::AlignVCenter);
+			table_->setItem(s, c, item);
+		}
+	}
+	layout->addWidget(table_, 1);
+
+	auto *buttons = new QHBoxLayout;
+	buttons->addStretch();
+	export_btn_ = new QPushButton(obs_module_text("Recast.Perf.Export"));
+	connect(export_btn_, &QPushButton::clicked, this,
+		&RecastPerfDock::exportCsv);
+	buttons->addWidget(export_btn_);
+	layout->addLayout(buttons);
+
+	/* Baselines, so the first sample is one interval, not since load */
+	recast_perf_snapshot(prev_);
+	prev_lagged_ = obs_get_lagged_frames();
+	prev_rendered_ = obs_get_total_frames();
+	video_t *video = obs_get_video();
+	prev_skipped_ = video ? video_output_get_skipped_frames(video) : 0;
+	prev_encoded_ = video ? video_output_get_total_frames(video) : 0;
+
+	timer_ = new QTimer(this);
+	connect(timer_, &QTimer::timeout, this, &RecastPerfDock::sample);
+	timer_->start(SAMPLE_INTERVAL_MS);
+}
+
+void RecastPerfDock::sample()
+{
+	recast_perf_hist_t cur[RECAST_PERF_SLOT_COUNT];
+	recast_perf_snapshot(cur);
+
+	Sample s;
+	s.time_ms = QDateTime::currentMSecsSinceEpoch();
+	for (int i = 0; i < RECAST_PERF_SLOT_COUNT; i++)
+		recast_perf_summarize(&cur[i], &prev_[i], &s.slots[i]);
+	memcpy(prev_, cur, sizeof(prev_));
+
+	uint32_t lagged = obs_get_lagged_frames();
+	uint32_t rendered = obs_get_total_frames();
+	video_t *video = obs_get_video();
+	uint32_t skipped = video ? video_output_get_skipped_frames(video) : 0;
+	uint32_t encoded = video ? video_output_get_total_frames(video) : 0;
+	s.render_lagged = lagged - prev_lagged_;
+	s.render_total = rendered - prev_rendered_;
+	s.encode_skipped = skipped - prev_skipped_;
+	s.encode_total = encoded - prev_encoded_;
+	prev_lagged_ = lagged;
+	prev_rendered_ = rendered;
+	prev_skipped_ = skipped;
+	prev_encoded_ = encoded;
+
+	history_.push_back(s);
+	while (history_.size() > (size_t)HISTORY_SECONDS)
+		history_.pop_front();
+
+	if (isVisible())
+		updateTable(s);
+}
+
+void RecastPerfDock::updateTable(const Sample &s)
+{
+	frames_label_->setText(
+		QString::fromUtf8(obs_module_text("Recast.Perf.Frames"))
+			.arg(s.render_lagged)
+			.arg(s.render_total)
+			.arg(s.encode_skipped)
+			.arg(s.encode_total));
+
+	for (int i = 0; i < RECAST_PERF_SLOT_COUNT; i++) {
+		const recast_perf_summary_t &p = s.slots[i];
+		table_->item(i, 1)->setText(QString::number(p.count));
+		table_->item(i, 2)->setText(p.count ? format_us(p.mean_ns)
+						    : QString());
+		table_->item(i, 3)->setText(p.count ? format_us(p.p50_ns)
+						    : QString());
+		table_->item(i, 4)->setText(p.count ? format_us(p.p99_ns)
+						    : QString());
+		table_->item(i, 5)->setText(p.max_ns ? format_us(p.max_ns)
+						     : QString());
+	}
+}
+
+void RecastPerfDock::exportCsv()
+{
+	QString path = QFileDialog::getSaveFileName(
+		this, obs_module_text("Recast.Perf.Export"),
+		QStringLiteral("recast-stats-%1.csv")
+			.arg(QDateTime::currentDateTime().toString(
+				QStringLiteral("yyyyMMdd-HHmmss"))),
+		QStringLiteral("CSV (*.csv)"));
+	if (path.isEmpty())
+		return;
+
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+		       QIODevice::Text)) {
+		QMessageBox::warning(this,
+				     obs_module_text("Recast.Perf.Export"),
+				     file.errorString());
+		return;
+	}
+
+	/* One row per second; per slot: calls, p50 and p99 in us */
+	QTextStream out(&file);
+	out << "time,render_lagged,render_total,encode_skipped,encode_total";
+	for (int i = 0; i < RECAST_PERF_SLOT_COUNT; i++) {
+		QString name = QString::fromUtf8(
+			recast_perf_slot_name((enum recast_perf_slot)i));
+		name = name.mid(name.indexOf(QLatin1Char(' ')) + 1)
+			       .replace(QLatin1Char(' '), QLatin1Char('_'));
+		out << ',' << name << "_calls," << name << "_p50_us," << name
+		    << "_p99_us";
+	}
+	out << '\n';
+
+	for (const Sample &s : history_) {
+		out << QDateTime::fromMSecsSinceEpoch(s.time_ms).toString(
+			       Qt::ISODateWithMs)
+		    << ',' << s.render_lagged << ',' << s.render_total << ','
+		    << s.encode_skipped << ',' << s.encode_total;
+		for (int i = 0; i < RECAST_PERF_SLOT_COUNT; i++) {
+			const recast_perf_summary_t &p = s.slots[i];
+			out << ',' << p.count << ',' << p.p50_ns / 1000.0 << ','
+			    << p.p99_ns / 1000.0;
+		}
+		out << '\n';
+	}
+
+	blog(LOG_INFO, "[Recast] Exported %d stats samples to %s",
+	     (int)history_.size(), path.toUtf8().constData());
+}
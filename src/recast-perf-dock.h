@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QWidget>
+
+#include <deque>
+
+#include "recast-perf.h"
+
+/*
+ * RecastPerfDock -- "Recast Stats": what the plugin costs per subsystem.
+ *
+ * Once a second the per-thread histograms are summed and diffed against
+ * the previous snapshot, giving calls, mean, p50 and p99 for that
+ * second next to OBS's own rendering-lag and skipped-frame counters.
+ * The last HISTORY_SECONDS of those samples are kept even while the
+ * dock is hidden, so a frame drop during a show can be lined up with
+ * the subsystem that spiked; Export writes them as CSV.
+ */
+class RecastPerfDock : public QWidget {
+	Q_OBJECT
+
+public:
+	explicit RecastPerfDock(QWidget *parent = nullptr);
+
+private:
+	struct Sample {
+		qint64 time_ms = 0;
+		recast_perf_summary_t slots[RECAST_PERF_SLOT_COUNT] = {};
+		uint32_t render_lagged = 0;
+		uint32_t render_total = 0;
+		uint32_t encode_skipped = 0;
+		uint32_t encode_total = 0;
+	};
+
+	static const int SAMPLE_INTERVAL_MS = 1000;
+	static const int HISTORY_SECONDS = 3600;
+
+	QLabel *frames_label_;
+	QTableWidget *table_;
+	QPushButton *export_btn_;
+	QTimer *timer_;
+
+	recast_perf_hist_t prev_[RECAST_PERF_SLOT_COUNT];
+	uint32_t prev_lagged_ = 0;
+	uint32_t prev_rendered_ = 0;
+	uint32_t prev_skipped_ = 0;
+	uint32_t prev_encoded_ = 0;
+
+	std::deque<Sample> history_;
+
+	void sample();
+	void updateTable(const Sample &s);
+	void exportCsv();
+};
@@ -0,0 +1,199 @@
+/*
+ * recast-perf.cpp -- Lock-free per-thread latency histograms.
+ */
+
+#include "recast-perf.h"
+
+#include <atomic>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const char *slot_names[RECAST_PERF_SLOT_COUNT] = {
+	"recast: preview draw",
+	"recast: selection overlay",
+	"recast: vertical render",
+	"recast: send lag",
+	"recast: chat append",
+	"recast: event ingest",
+	"recast: irc parse",
+	"recast: json parse",
+	"recast: config save",
+	"recast: status refresh",
+};
+
+/* One per live recording thread. Only the owning thread writes; blocks
+ * are pushed onto a lock-free list and never freed. When a thread exits
+ * its block is released, counts and all, for the next new thread to
+ * claim, so threads that come and go (output and encoder threads are
+ * re-created on every start) do not grow the list. */
+struct thread_block {
+	std::atomic<uint64_t> count[RECAST_PERF_SLOT_COUNT];
+	std::atomic<uint64_t> sum_ns[RECAST_PERF_SLOT_COUNT];
+	std::atomic<uint64_t> max_ns[RECAST_PERF_SLOT_COUNT];
+	std::atomic<uint64_t> buckets[RECAST_PERF_SLOT_COUNT]
+				     [RECAST_PERF_BUCKETS];
+	std::atomic<bool> in_use;
+	thread_block *next;
+};
+
+static std::atomic<thread_block *> blocks{nullptr};
+
+/* Hands the block back when its thread exits */
+struct block_owner {
+	thread_block *block = nullptr;
+
+	~block_owner()
+	{
+		if (block)
+			block->in_use.store(false, std::memory_order_release);
+	}
+};
+
+static thread_local block_owner own;
+
+static thread_block *get_block()
+{
+	if (own.block)
+		return own.block;
+
+	/* Adopt the block of a thread that has exited */
+	for (thread_block *b = blocks.load(std::memory_order_acquire); b;
+	     b = b->next) {
+		bool expected = false;
+		if (b->in_use.compare_exchange_strong(
+			    expected, true, std::memory_order_acquire,
+			    std::memory_order_relaxed)) {
+			own.block = b;
+			return b;
+		}
+	}
+
+	/* Value-initialized: every counter starts at zero */
+	thread_block *b = new thread_block{};
+	b->in_use.store(true, std::memory_order_relaxed);
+	b->next = blocks.load(std::memory_order_relaxed);
+	while (!blocks.compare_exchange_weak(b->next, b,
+					     std::memory_order_release,
+					     std::memory_order_relaxed))
+		;
+	own.block = b;
+	return b;
+}
+
+/* ---- Buckets: quarter octaves, bucket 0 holds everything < 320 ns ---- */
+
+static inline int msb64(uint64_t v)
+{
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanReverse64(&idx, v);
+	return (int)idx;
+#else
+	return 63 - __builtin_clzll(v);
+#endif
+}
+
+static inline int bucket_of(uint64_t ns)
+{
+	if (ns < 256)
+		return 0;
+	int msb = msb64(ns);
+	int b = (msb - 8) * 4 + (int)((ns >> (msb - 2)) & 3);
+	return b < RECAST_PERF_BUCKETS ? b : RECAST_PERF_BUCKETS - 1;
+}
+
+/* Middle of the bucket's range */
+static uint64_t bucket_value(int b)
+{
+	int msb = b / 4 + 8;
+	uint64_t lo = (uint64_t)(4 + b % 4) << (msb - 2);
+	uint64_t width = (uint64_t)1 << (msb - 2);
+	return lo + width / 2;
+}
+
+/* ---- API ---- */
+
+const char *recast_perf_slot_name(enum recast_perf_slot slot)
+{
+	return slot >= 0 && slot < RECAST_PERF_SLOT_COUNT ? slot_names[slot]
+							   : "recast: ?";
+}
+
+void recast_perf_record(enum recast_perf_slot slot, uint64_t ns)
+{
+	if (slot < 0 || slot >= RECAST_PERF_SLOT_COUNT)
+		return;
+
+	thread_block *b = get_block();
+	b->count[slot].fetch_add(1, std::memory_order_relaxed);
+	b->sum_ns[slot].fetch_add(ns, std::memory_order_relaxed);
+	b->buckets[slot][bucket_of(ns)].fetch_add(1,
+						  std::memory_order_relaxed);
+
+	/* Single writer, so a plain compare is enough */
+	if (ns > b->max_ns[slot].load(std::memory_order_relaxed))
+		b->max_ns[slot].store(ns, std::memory_order_relaxed);
+}
+
+void recast_perf_snapshot(recast_perf_hist_t out[RECAST_PERF_SLOT_COUNT])
+{
+	memset(out, 0, sizeof(recast_perf_hist_t) * RECAST_PERF_SLOT_COUNT);
+
+	for (thread_block *b = blocks.load(std::memory_order_acquire); b;
+	     b = b->next) {
+		for (int s = 0; s < RECAST_PERF_SLOT_COUNT; s++) {
+			recast_perf_hist_t *h = &out[s];
+			h->count +=
+				b->count[s].load(std::memory_order_relaxed);
+			h->sum_ns +=
+				b->sum_ns[s].load(std::memory_order_relaxed);
+			uint64_t m = b->max_ns[s].load(std::memory_order_relaxed);
+			if (m > h->max_ns)
+				h->max_ns = m;
+			for (int i = 0; i < RECAST_PERF_BUCKETS; i++)
+				h->buckets[i] += b->buckets[s][i].load(
+					std::memory_order_relaxed);
+		}
+	}
+}
+
+static uint64_t percentile(const uint64_t *buckets, uint64_t count, double q)
+{
+	uint64_t rank = (uint64_t)(q * (double)(count - 1)) + 1;
+	uint64_t seen = 0;
+	for (int i = 0; i < RECAST_PERF_BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen >= rank)
+			return bucket_value(i);
+	}
+	return bucket_value(RECAST_PERF_BUCKETS - 1);
+}
+
+void recast_perf_summarize(const recast_perf_hist_t *cur,
+			   const recast_perf_hist_t *prev,
+			   recast_perf_summary_t *out)
+{
+	memset(out, 0, sizeof(*out));
+	out->max_ns = cur->max_ns;
+
+	/* Counters are read without a barrier between them, so a bucket
+	 * can run one sample ahead of count; trust the buckets */
+	uint64_t buckets[RECAST_PERF_BUCKETS];
+	uint64_t count = 0;
+	for (int i = 0; i < RECAST_PERF_BUCKETS; i++) {
+		uint64_t p = prev ? prev->buckets[i] : 0;
+		buckets[i] = cur->buckets[i] >= p ? cur->buckets[i] - p : 0;
+		count += buckets[i];
+	}
+	if (!count)
+		return;
+
+	uint64_t sum = cur->sum_ns - (prev ? prev->sum_ns : 0);
+	out->count = count;
+	out->mean_ns = sum / count;
+	out->p50_ns = percentile(buckets, count, 0.50);
+	out->p99_ns = percentile(buckets, count, 0.99);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <obs-module.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Hot-path timing -- per-subsystem latency histograms.
+ *
+ * Each instrumented call site records its duration into a histogram
+ * slot. Writers only touch a block owned by their own thread (relaxed
+ * atomic adds, no locks, no sharing); readers sum the blocks of all
+ * threads. Buckets are quarter octaves from 256 ns up, so percentiles
+ * are accurate to about 19%.
+ *
+ * RECAST_PERF_SCOPE additionally opens a libobs profiler scope with the
+ * slot's name, so the same sections show up in OBS's own profiler log.
+ */
+
+enum recast_perf_slot {
+	RECAST_PERF_PREVIEW_DRAW,     /* preview DrawCallback */
+	RECAST_PERF_SELECTION_DRAW,   /* DrawSelectionOverlay */
+	RECAST_PERF_VERTICAL_RENDER,  /* composite of the vertical canvas */
+	RECAST_PERF_SEND_LAG,         /* frame composite -> output packet */
+	RECAST_PERF_CHAT_APPEND,      /* chat batch into the model */
+	RECAST_PERF_EVENT_INGEST,     /* events dock journal + queue */
+	RECAST_PERF_IRC_PARSE,        /* Twitch IRC line */
+	RECAST_PERF_JSON_PARSE,       /* network JSON documents */
+	RECAST_PERF_CONFIG_SAVE,      /* config serialize */
+	RECAST_PERF_STATUS_REFRESH,   /* multistream row status */
+	RECAST_PERF_SLOT_COUNT,
+};
+
+#define RECAST_PERF_BUCKETS 128
+
+/* Output packet callbacks (with frame timing) need libobs 31 */
+#if LIBOBS_API_MAJOR_VER >= 31
+#define RECAST_HAVE_PACKET_CALLBACK 1
+#else
+#define RECAST_HAVE_PACKET_CALLBACK 0
+#endif
+
+typedef struct recast_perf_hist {
+	uint64_t count;
+	uint64_t sum_ns;
+	uint64_t max_ns;
+	uint64_t buckets[RECAST_PERF_BUCKETS];
+} recast_perf_hist_t;
+
+typedef struct recast_perf_summary {
+	uint64_t count;
+	uint64_t mean_ns;
+	uint64_t p50_ns;
+	uint64_t p99_ns;
+	uint64_t max_ns;
+} recast_perf_summary_t;
+
+const char *recast_perf_slot_name(enum recast_perf_slot slot);
+
+void recast_perf_record(enum recast_perf_slot slot, uint64_t ns);
+
+/* Totals since load for every slot, summed across threads */
+void recast_perf_snapshot(recast_perf_hist_t out[RECAST_PERF_SLOT_COUNT]);
+
+/* Summary of cur - prev (prev may be NULL). max_ns is the all-time
+ * maximum; a histogram cannot give a windowed one. */
+void recast_perf_summarize(const recast_perf_hist_t *cur,
+			   const recast_perf_hist_t *prev,
+			   recast_perf_summary_t *out);
+
+#ifdef __cplusplus
+}
+
+class RecastPerfScope {
+public:
+	explicit RecastPerfScope(enum recast_perf_slot slot)
+		: slot_(slot), name_(recast_perf_slot_name(slot))
+	{
+		profile_start(name_);
+		start_ns_ = os_gettime_ns();
+	}
+
+	~RecastPerfScope()
+	{
+		recast_perf_record(slot_, os_gettime_ns() - start_ns_);
+		profile_end(name_);
+	}
+
+	RecastPerfScope(const RecastPerfScope &) = delete;
+	RecastPerfScope &operator=(const RecastPerfScope &) = delete;
+
+private:
+	enum recast_perf_slot slot_;
+	const char *name_;
+	uint64_t start_ns_;
+};
+
+#define RECAST_PERF_CONCAT2(a, b) a##b
+#define RECAST_PERF_CONCAT(a, b) RECAST_PERF_CONCAT2(a, b)
+#define RECAST_PERF_SCOPE(slot) \
+	RecastPerfScope RECAST_PERF_CONCAT(recast_perf_scope_, __LINE__)(slot)
+#endif
@@ -3,13 +3,13 @@
  *
  * Detects streaming platform from URL hostname and generates colored
  * circle icons with the platform's initial letter (no external PNGs needed).
+ * The icons themselves come from the shared icon cache.
  */
 
 #include "recast-platform-icons.h"
+#include "recast-icon-cache.h"
 
 #include <QColor>
-#include <QPainter>
-#include <QPixmap>
 #include <QUrl>
 
 struct PlatformDef {
@@ -59,38 +59,23 @@ QString recast_detect_platform(const QString &url)
 
 QIcon recast_letter_icon(QChar letter, const QColor &bg_color)
 {
-	int size = 20;
-	QPixmap pm(size, size);
-	pm.fill(Qt::transparent);
-
-	QPainter painter(&pm);
-	painter.setRenderHint(QPainter::Antialiasing, true);
-
-	/* Draw filled circle */
-	painter.setBrush(bg_color);
-	painter.setPen(Qt::NoPen);
-	painter.drawEllipse(0, 0, size, size);
-
-	/* Draw letter */
-	painter.setPen(Qt::white);
-	QFont font = painter.font();
-	font.setPixelSize(12);
-	font.setBold(true);
-	painter.setFont(font);
-	painter.drawText(QRect(0, 0, size, size), Qt::AlignCenter,
-			 QString(letter));
-
-	painter.end();
-	return QIcon(pm);
+	return recast_cached_icon(RECAST_ICON_CIRCLE, letter, bg_color, 20);
 }
 
-QIcon recast_platform_icon(const QString &platform_id)
+QPixmap recast_platform_pixmap(const QString &platform_id, int size)
 {
 	for (const PlatformDef *p = platforms; p->hostname_contains; p++) {
-		if (QString::fromUtf8(p->platform_id) == platform_id)
-			return recast_letter_icon(p->letter, p->color);
+		if (platform_id == QLatin1String(p->platform_id))
+			return recast_cached_pixmap(RECAST_ICON_CIRCLE,
+						    p->letter, p->color, size);
 	}
 
 	/* Unknown platform: gray circle with '?' */
-	return recast_letter_icon('?', QColor(128, 128, 128));
+	return recast_cached_pixmap(RECAST_ICON_CIRCLE, '?',
+				    QColor(128, 128, 128), size);
+}
+
+QIcon recast_platform_icon(const QString &platform_id)
+{
+	return QIcon(recast_platform_pixmap(platform_id, 20));
 }
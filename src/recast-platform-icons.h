@@ -9,5 +9,8 @@ QString recast_detect_platform(const QString &url);
 /* Get an icon for a detected platform ID */
 QIcon recast_platform_icon(const QString &platform_id);
 
+/* Same icon painted at size px, from the shared icon cache */
+QPixmap recast_platform_pixmap(const QString &platform_id, int size);
+
 /* Get a colored circle icon with a letter (fallback) */
 QIcon recast_letter_icon(QChar letter, const QColor &bg_color);
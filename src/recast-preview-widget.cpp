@@ -3,15 +3,23 @@
  *
  * Interactive drag/resize, selection overlay, draw callback with safe refs.
  * Standalone widget used by the vertical preview dock.
+ *
+ * When a canvas texture source is set, the preview draws the texture the
+ * vertical view already composited this frame and only renders the
+ * selection overlay itself. The scene is rendered directly while an item
+ * is being dragged so the image and handles stay in lockstep.
  */
 
 #include "recast-preview-widget.h"
+#include "recast-perf.h"
 
 #include <QAction>
 #include <QKeyEvent>
 #include <QMenu>
 #include <QMessageBox>
 #include <QMouseEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QWindow>
 
 #include <cmath>
@@ -315,6 +323,16 @@ void RecastPreviewWidget::SetScene(obs_source_t *scene, int w, int h)
 	}
 	canvas_width = w;
 	canvas_height = h;
+	hit_index.setCanvasSize(w, h);
+}
+
+void RecastPreviewWidget::SetCanvasTextureSource(RecastCanvasTextureFunc func,
+						 void *param)
+{
+	obs_enter_graphics();
+	canvas_texture_func = func;
+	canvas_texture_param = param;
+	obs_leave_graphics();
 }
 
 void RecastPreviewWidget::ClearScene()
@@ -330,11 +348,13 @@ void RecastPreviewWidget::ClearScene()
 		selected_item = nullptr;
 	}
 	interactive_scene = nullptr;
+	hit_index.setScene(nullptr);
 }
 
 void RecastPreviewWidget::SetInteractiveScene(obs_scene_t *scene)
 {
 	interactive_scene = scene;
+	hit_index.setScene(scene);
 	if (selected_item) {
 		obs_sceneitem_release(selected_item);
 		selected_item = nullptr;
@@ -345,6 +365,7 @@ void RecastPreviewWidget::SetInteractiveScene(obs_scene_t *scene)
 void RecastPreviewWidget::ClearInteractiveScene()
 {
 	interactive_scene = nullptr;
+	hit_index.setScene(nullptr);
 	if (selected_item) {
 		obs_sceneitem_release(selected_item);
 		selected_item = nullptr;
@@ -419,60 +440,12 @@ void RecastPreviewWidget::GetItemRect(obs_sceneitem_t *item,
 
 /* ---- Hit testing ---- */
 
-struct hit_test_ctx {
-	float mx, my;
-	obs_sceneitem_t *result;
-};
-
-static bool hit_test_cb(obs_scene_t *, obs_sceneitem_t *item, void *param)
-{
-	auto *ctx = static_cast<struct hit_test_ctx *>(param);
-
-	if (!obs_sceneitem_visible(item))
-		return true;
-
-	obs_source_t *src = obs_sceneitem_get_source(item);
-	if (!src)
-		return true;
-	float cx = (float)obs_source_get_width(src);
-	float cy = (float)obs_source_get_height(src);
-	if (cx <= 0 || cy <= 0)
-		return true;
-
-	/* Use box transform + inverse for accurate hit test */
-	struct matrix4 box_transform;
-	obs_sceneitem_get_box_transform(item, &box_transform);
-
-	struct matrix4 inv;
-	matrix4_inv(&inv, &box_transform);
-
-	struct vec3 scene_pt;
-	vec3_set(&scene_pt, ctx->mx, ctx->my, 0.0f);
-
-	struct vec3 local_pt;
-	vec3_transform(&local_pt, &scene_pt, &inv);
-
-	if (local_pt.x >= 0.0f && local_pt.x <= cx &&
-	    local_pt.y >= 0.0f && local_pt.y <= cy) {
-		ctx->result = item;
-	}
-
-	return true; /* continue to find topmost */
-}
-
 obs_sceneitem_t *RecastPreviewWidget::HitTestItems(float scene_x,
 						    float scene_y)
 {
 	if (!interactive_scene)
 		return nullptr;
-
-	struct hit_test_ctx ctx;
-	ctx.mx = scene_x;
-	ctx.my = scene_y;
-	ctx.result = nullptr;
-
-	obs_scene_enum_items(interactive_scene, hit_test_cb, &ctx);
-	return ctx.result;
+	return hit_index.hitTest(scene_x, scene_y);
 }
 
 int RecastPreviewWidget::HitTestHandles(float scene_x, float scene_y)
@@ -1138,6 +1111,8 @@ void RecastPreviewWidget::keyPressEvent(QKeyEvent *event)
 
 void RecastPreviewWidget::DrawSelectionOverlay(RecastPreviewWidget *widget)
 {
+	RECAST_PERF_SCOPE(RECAST_PERF_SELECTION_DRAW);
+
 	obs_sceneitem_t *item = widget->selected_item;
 	if (!item)
 		return;
@@ -1242,8 +1217,44 @@ void RecastPreviewWidget::resizeEvent(QResizeEvent *)
 	}
 }
 
+void RecastPreviewWidget::showEvent(QShowEvent *event)
+{
+	QWidget::showEvent(event);
+	if (display)
+		obs_display_set_enabled(display, true);
+	emit visibilityChanged(true);
+}
+
+void RecastPreviewWidget::hideEvent(QHideEvent *event)
+{
+	QWidget::hideEvent(event);
+	if (display)
+		obs_display_set_enabled(display, false);
+	emit visibilityChanged(false);
+}
+
+void RecastPreviewWidget::DrawCanvasTexture(gs_texture_t *tex, int cw, int ch)
+{
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(true);
+
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture_srgb(image, tex);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprite(tex, 0, (uint32_t)cw, (uint32_t)ch);
+	gs_blend_state_pop();
+
+	gs_enable_framebuffer_srgb(previous);
+}
+
 void RecastPreviewWidget::DrawCallback(void *param, uint32_t cx, uint32_t cy)
 {
+	RECAST_PERF_SCOPE(RECAST_PERF_PREVIEW_DRAW);
+
 	auto *widget = static_cast<RecastPreviewWidget *>(param);
 	if (!widget->scene_source || widget->canvas_width <= 0 ||
 	    widget->canvas_height <= 0)
@@ -1288,7 +1299,19 @@ void RecastPreviewWidget::DrawCallback(void *param, uint32_t cx, uint32_t cy)
 		gs_render_stop(GS_TRISTRIP);
 	}
 
-	obs_source_video_render(src);
+	/* Prefer the texture the vertical view already composited this
+	 * frame. While dragging, render directly: the view rendered before
+	 * this frame's transform change, the overlay renders after it. */
+	gs_texture_t *tex = nullptr;
+	if (widget->canvas_texture_func && !widget->dragging)
+		tex = widget->canvas_texture_func(
+			widget->canvas_texture_param);
+
+	if (tex)
+		DrawCanvasTexture(tex, widget->canvas_width,
+				  widget->canvas_height);
+	else
+		obs_source_video_render(src);
 
 	/* Draw selection overlay if interactive */
 	if (widget->interactive_scene && widget->selected_item)
@@ -2,12 +2,19 @@
 
 #include <QWidget>
 
+#include "recast-hit-index.h"
+
 extern "C" {
 #include <obs.h>
 }
 
 class QMenu;
 
+/* Returns the already-composited canvas texture for the current frame
+ * (called on the graphics thread), or NULL to fall back to rendering
+ * the scene directly. */
+typedef gs_texture_t *(*RecastCanvasTextureFunc)(void *param);
+
 /* Handle indices for resize anchors */
 enum RecastHandle {
 	HANDLE_NONE = -1,
@@ -27,6 +34,11 @@ public:
 	void SetScene(obs_source_t *scene, int w, int h);
 	void ClearScene();
 
+	/* Draw a pre-composited canvas texture instead of rendering the
+	 * scene again. Pass NULL to always render the scene directly. */
+	void SetCanvasTextureSource(RecastCanvasTextureFunc func,
+				    void *param);
+
 	/* Enable interactive editing for a scene */
 	void SetInteractiveScene(obs_scene_t *scene);
 	void ClearInteractiveScene();
@@ -52,9 +64,14 @@ signals:
 	void itemSelected(obs_sceneitem_t *item);
 	void itemTransformed();
 
+	/* Shown/hidden, including minimize and dock tab switches */
+	void visibilityChanged(bool visible);
+
 protected:
 	void paintEvent(QPaintEvent *event) override;
 	void resizeEvent(QResizeEvent *event) override;
+	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
 	void mousePressEvent(QMouseEvent *event) override;
 	void mouseMoveEvent(QMouseEvent *event) override;
 	void mouseDoubleClickEvent(QMouseEvent *event) override;
@@ -67,6 +84,10 @@ private:
 	int canvas_width = 0;
 	int canvas_height = 0;
 
+	/* Composited canvas texture source (optional) */
+	RecastCanvasTextureFunc canvas_texture_func = nullptr;
+	void *canvas_texture_param = nullptr;
+
 	/* Interactive editing state */
 	obs_scene_t *interactive_scene = nullptr;
 	obs_sceneitem_t *selected_item = nullptr;
@@ -77,6 +98,9 @@ private:
 	float item_start_scale_x = 0, item_start_scale_y = 0;
 	float item_start_width = 0, item_start_height = 0;
 
+	/* Cached item bounds of interactive_scene for hit tests */
+	RecastHitIndex hit_index;
+
 	void CreateDisplay();
 	QPointF WidgetToScene(QPoint widget_pos);
 	obs_sceneitem_t *HitTestItems(float scene_x, float scene_y);
@@ -87,5 +111,6 @@ private:
 	void ShowContextMenu(QPoint widget_pos);
 
 	static void DrawCallback(void *param, uint32_t cx, uint32_t cy);
+	static void DrawCanvasTexture(gs_texture_t *tex, int cw, int ch);
 	static void DrawSelectionOverlay(RecastPreviewWidget *widget);
 };
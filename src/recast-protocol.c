@@ -7,6 +7,8 @@
 
 #include "recast-protocol.h"
 
+#include <util/dstr.h>
+
 #include <string.h>
 #include <ctype.h>
 
@@ -88,3 +90,88 @@ const char *recast_protocol_name(recast_protocol_t proto)
 		return "Unknown";
 	}
 }
+
+/* ---- Transport tuning ---- */
+
+void recast_transport_config_init(recast_transport_config_t *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+}
+
+void recast_transport_config_load(recast_transport_config_t *cfg,
+				  obs_data_t *data)
+{
+	recast_transport_config_init(cfg);
+	if (!data)
+		return;
+
+	cfg->srt_latency_ms = (int)obs_data_get_int(data, "srtLatencyMs");
+	cfg->srt_maxbw_kbps = (int)obs_data_get_int(data, "srtMaxBwKbps");
+	cfg->srt_overhead_pct = (int)obs_data_get_int(data, "srtOverheadPct");
+	cfg->rist_buffer_ms = (int)obs_data_get_int(data, "ristBufferMs");
+}
+
+void recast_transport_config_save(const recast_transport_config_t *cfg,
+				  obs_data_t *data)
+{
+	obs_data_set_int(data, "srtLatencyMs", cfg->srt_latency_ms);
+	obs_data_set_int(data, "srtMaxBwKbps", cfg->srt_maxbw_kbps);
+	obs_data_set_int(data, "srtOverheadPct", cfg->srt_overhead_pct);
+	obs_data_set_int(data, "ristBufferMs", cfg->rist_buffer_ms);
+}
+
+bool recast_transport_config_equal(const recast_transport_config_t *a,
+				   const recast_transport_config_t *b)
+{
+	return a->srt_latency_ms == b->srt_latency_ms &&
+	       a->srt_maxbw_kbps == b->srt_maxbw_kbps &&
+	       a->srt_overhead_pct == b->srt_overhead_pct &&
+	       a->rist_buffer_ms == b->rist_buffer_ms;
+}
+
+static bool has_param(const char *url, const char *key)
+{
+	const char *query = strchr(url, '?');
+	size_t len = strlen(key);
+
+	while (query) {
+		query++;
+		if (strncmp(query, key, len) == 0 && query[len] == '=')
+			return true;
+		query = strchr(query, '&');
+	}
+	return false;
+}
+
+static void add_param(struct dstr *url, const char *key, long long value)
+{
+	if (value <= 0 || has_param(url->array, key))
+		return;
+
+	dstr_catf(url, "%c%s=%lld", strchr(url->array, '?') ? '&' : '?',
+		  key, value);
+}
+
+char *recast_protocol_build_url(recast_protocol_t proto, const char *url,
+				const recast_transport_config_t *cfg)
+{
+	struct dstr out = {0};
+	dstr_copy(&out, url);
+	if (dstr_is_empty(&out))
+		return bstrdup("");
+	if (!cfg)
+		return out.array;
+
+	/* Units follow the output's URL options: SRT latency in
+	 * microseconds and maxbw in bytes/s; RIST buffer in ms. */
+	if (proto == RECAST_PROTO_SRT) {
+		add_param(&out, "latency",
+			  (long long)cfg->srt_latency_ms * 1000);
+		add_param(&out, "maxbw",
+			  (long long)cfg->srt_maxbw_kbps * 1000 / 8);
+		add_param(&out, "oheadbw", cfg->srt_overhead_pct);
+	} else if (proto == RECAST_PROTO_RIST) {
+		add_param(&out, "buffer", cfg->rist_buffer_ms);
+	}
+	return out.array;
+}
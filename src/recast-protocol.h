@@ -27,6 +27,29 @@ const char *recast_protocol_service_id(recast_protocol_t proto);
 /* Get human-readable protocol name */
 const char *recast_protocol_name(recast_protocol_t proto);
 
+/* ---- SRT / RIST transport tuning ----
+ * Zero leaves the output's default. Stored per destination and folded
+ * into the URL query the mpegts output parses. */
+typedef struct recast_transport_config {
+	int srt_latency_ms;   /* receiver buffer / retransmit window */
+	int srt_maxbw_kbps;   /* send rate cap incl. retransmits */
+	int srt_overhead_pct; /* retransmit headroom over input rate */
+	int rist_buffer_ms;   /* RIST recovery buffer */
+} recast_transport_config_t;
+
+void recast_transport_config_init(recast_transport_config_t *cfg);
+void recast_transport_config_load(recast_transport_config_t *cfg,
+				  obs_data_t *data);
+void recast_transport_config_save(const recast_transport_config_t *cfg,
+				  obs_data_t *data);
+bool recast_transport_config_equal(const recast_transport_config_t *a,
+				   const recast_transport_config_t *b);
+
+/* URL with the tuning for proto appended as query parameters. Keys the
+ * URL already sets are left alone. Free with bfree(). */
+char *recast_protocol_build_url(recast_protocol_t proto, const char *url,
+				const recast_transport_config_t *cfg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,11 +9,95 @@
 
 #include <util/dstr.h>
 
+#define MIN_SCENE_CAPACITY 8
+#define MIN_INDEX_CAPACITY 16
+
+/* ---- Hash indexes ---- */
+
+static uint32_t hash_str(const char *str)
+{
+	/* FNV-1a */
+	uint32_t h = 2166136261u;
+	while (*str) {
+		h ^= (uint8_t)*str++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static const char *entry_key(const recast_scene_entry_t *e, bool linked)
+{
+	return linked ? e->linked_main_scene : e->name;
+}
+
+static void index_insert(recast_scene_model_t *model, int *index, int idx,
+			 bool linked)
+{
+	const char *key = entry_key(&model->scenes[idx], linked);
+	if (!key)
+		return;
+
+	uint32_t mask = (uint32_t)model->index_capacity - 1;
+	for (uint32_t i = hash_str(key) & mask;; i = (i + 1) & mask) {
+		if (!index[i]) {
+			index[i] = idx + 1;
+			return;
+		}
+		if (strcmp(entry_key(&model->scenes[index[i] - 1], linked),
+			   key) == 0)
+			return; /* keep the lower index */
+	}
+}
+
+static int index_find(const recast_scene_model_t *model, const int *index,
+		      const char *key, bool linked)
+{
+	if (!index)
+		return -1;
+
+	uint32_t mask = (uint32_t)model->index_capacity - 1;
+	for (uint32_t i = hash_str(key) & mask; index[i];
+	     i = (i + 1) & mask) {
+		int idx = index[i] - 1;
+		if (strcmp(entry_key(&model->scenes[idx], linked), key) == 0)
+			return idx;
+	}
+	return -1;
+}
+
+static void reindex(recast_scene_model_t *model)
+{
+	/* Keep the load factor at or below 1/2 */
+	int cap = model->index_capacity ? model->index_capacity
+					: MIN_INDEX_CAPACITY;
+	while (cap < model->scene_count * 2)
+		cap *= 2;
+
+	if (cap != model->index_capacity) {
+		bfree(model->name_index);
+		bfree(model->link_index);
+		model->name_index = bzalloc(sizeof(int) * cap);
+		model->link_index = bzalloc(sizeof(int) * cap);
+		model->index_capacity = cap;
+	} else {
+		memset(model->name_index, 0, sizeof(int) * cap);
+		memset(model->link_index, 0, sizeof(int) * cap);
+	}
+
+	for (int i = 0; i < model->scene_count; i++) {
+		index_insert(model, model->name_index, i, false);
+		index_insert(model, model->link_index, i, true);
+	}
+}
+
+/* ---- Model ---- */
+
 recast_scene_model_t *recast_scene_model_create(void)
 {
 	recast_scene_model_t *model =
 		bzalloc(sizeof(recast_scene_model_t));
 	model->active_scene_idx = -1;
+	reindex(model);
 	return model;
 }
 
@@ -35,8 +119,13 @@ void recast_scene_model_destroy(recast_scene_model_t *model)
 		e->name = NULL;
 		bfree(e->linked_main_scene);
 		e->linked_main_scene = NULL;
+		obs_data_array_release(e->pending_items);
+		e->pending_items = NULL;
 	}
 
+	bfree(model->scenes);
+	bfree(model->name_index);
+	bfree(model->link_index);
 	bfree(model);
 }
 
@@ -45,20 +134,30 @@ int recast_scene_model_add_scene(recast_scene_model_t *model,
 {
 	if (!model || !name || !*name)
 		return -1;
-	if (model->scene_count >= RECAST_MAX_SCENES)
-		return -1;
 
 	/* Create a private scene (invisible to main OBS UI) */
 	obs_scene_t *scene = obs_scene_create_private(name);
 	if (!scene)
 		return -1;
 
+	if (model->scene_count == model->scene_capacity) {
+		int cap = model->scene_capacity ? model->scene_capacity * 2
+						: MIN_SCENE_CAPACITY;
+		model->scenes = brealloc(model->scenes,
+					 sizeof(recast_scene_entry_t) * cap);
+		memset(model->scenes + model->scene_capacity, 0,
+		       sizeof(recast_scene_entry_t) *
+			       (cap - model->scene_capacity));
+		model->scene_capacity = cap;
+	}
+
 	int idx = model->scene_count;
 	recast_scene_entry_t *e = &model->scenes[idx];
 	e->name = bstrdup(name);
 	e->scene = scene;
 	e->scene_source = obs_scene_get_source(scene);
 	model->scene_count++;
+	reindex(model);
 
 	/* If this is the first scene, make it active */
 	if (model->active_scene_idx < 0)
@@ -83,6 +182,8 @@ bool recast_scene_model_remove_scene(recast_scene_model_t *model, int idx)
 	e->name = NULL;
 	bfree(e->linked_main_scene);
 	e->linked_main_scene = NULL;
+	obs_data_array_release(e->pending_items);
+	e->pending_items = NULL;
 
 	/* Shift remaining entries down */
 	for (int i = idx; i < model->scene_count - 1; i++)
@@ -93,6 +194,7 @@ bool recast_scene_model_remove_scene(recast_scene_model_t *model, int idx)
 	/* Clear the last slot */
 	memset(&model->scenes[model->scene_count], 0,
 	       sizeof(recast_scene_entry_t));
+	reindex(model);
 
 	/* Adjust active index */
 	if (model->scene_count == 0) {
@@ -118,6 +220,7 @@ bool recast_scene_model_rename_scene(recast_scene_model_t *model, int idx,
 	recast_scene_entry_t *e = &model->scenes[idx];
 	bfree(e->name);
 	e->name = bstrdup(new_name);
+	reindex(model);
 
 	return true;
 }
@@ -155,12 +258,7 @@ int recast_scene_model_find(const recast_scene_model_t *model,
 	if (!model || !name)
 		return -1;
 
-	for (int i = 0; i < model->scene_count; i++) {
-		if (model->scenes[i].name &&
-		    strcmp(model->scenes[i].name, name) == 0)
-			return i;
-	}
-	return -1;
+	return index_find(model, model->name_index, name, false);
 }
 
 void recast_scene_model_link_scene(recast_scene_model_t *model, int idx,
@@ -174,6 +272,19 @@ void recast_scene_model_link_scene(recast_scene_model_t *model, int idx,
 	e->linked_main_scene = main_scene_name && *main_scene_name
 				       ? bstrdup(main_scene_name)
 				       : NULL;
+	reindex(model);
+}
+
+void recast_scene_model_set_crop(recast_scene_model_t *model, int idx,
+				 float x, float y, float w)
+{
+	if (!model || idx < 0 || idx >= model->scene_count)
+		return;
+
+	recast_scene_entry_t *e = &model->scenes[idx];
+	e->crop_w = w > 0.0f ? w : 0.0f;
+	e->crop_x = e->crop_w > 0.0f ? x : 0.0f;
+	e->crop_y = e->crop_w > 0.0f ? y : 0.0f;
 }
 
 int recast_scene_model_find_linked(const recast_scene_model_t *model,
@@ -182,11 +293,5 @@ int recast_scene_model_find_linked(const recast_scene_model_t *model,
 	if (!model || !main_scene_name)
 		return -1;
 
-	for (int i = 0; i < model->scene_count; i++) {
-		if (model->scenes[i].linked_main_scene &&
-		    strcmp(model->scenes[i].linked_main_scene,
-			   main_scene_name) == 0)
-			return i;
-	}
-	return -1;
+	return index_find(model, model->link_index, main_scene_name, true);
 }
@@ -6,19 +6,33 @@
 extern "C" {
 #endif
 
-#define RECAST_MAX_SCENES 32
-
 typedef struct recast_scene_entry {
 	char *name;
 	obs_scene_t *scene;         /* obs_scene_create_private() */
 	obs_source_t *scene_source; /* obs_scene_get_source(scene), not addref'd */
 	char *linked_main_scene;    /* NULL = no link, else main scene name */
+
+	/* Crop-from-main window (main canvas px) while this scene is
+	 * active; crop_w <= 0 = full height, centered */
+	float crop_x, crop_y, crop_w;
+
+	/* Saved items not yet added to scene (lazy load), else NULL */
+	obs_data_array_t *pending_items;
 } recast_scene_entry_t;
 
 typedef struct recast_scene_model {
-	recast_scene_entry_t scenes[RECAST_MAX_SCENES];
+	recast_scene_entry_t *scenes; /* grows as needed; scene_count used */
 	int scene_count;
+	int scene_capacity;
 	int active_scene_idx;
+
+	/* Open-addressed hash indexes over scenes[].name and
+	 * scenes[].linked_main_scene. A slot holds entry index + 1 (0 =
+	 * empty); on duplicates the lowest index wins. Rebuilt whenever
+	 * entries are added, removed, renamed or relinked. */
+	int *name_index;
+	int *link_index;
+	int index_capacity; /* power of two */
 } recast_scene_model_t;
 
 /* Create / destroy the model */
@@ -57,6 +71,11 @@ int recast_scene_model_find(const recast_scene_model_t *model,
 void recast_scene_model_link_scene(recast_scene_model_t *model, int idx,
 				   const char *main_scene_name);
 
+/* Set the crop-from-main window for a scene. w <= 0 resets to the
+ * centered full-height crop. */
+void recast_scene_model_set_crop(recast_scene_model_t *model, int idx,
+				 float x, float y, float w);
+
 /* Find a scene linked to a given main scene name. Returns index or -1. */
 int recast_scene_model_find_linked(const recast_scene_model_t *model,
 				   const char *main_scene_name);
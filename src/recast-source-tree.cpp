@@ -6,6 +6,7 @@
  */
 
 #include "recast-source-tree.h"
+#include "recast-icon-cache.h"
 
 #include <QColor>
 #include <QDrag>
@@ -14,9 +15,6 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QMouseEvent>
-#include <QPainter>
-#include <QPainterPath>
-#include <QPixmap>
 
 #include <algorithm>
 
@@ -25,91 +23,27 @@ extern "C" {
 #include <obs-frontend-api.h>
 }
 
-/* ---- Icon generation helpers ---- */
+/* ---- Icons (shared cache) ---- */
 
 static QIcon generate_type_icon(QChar letter, const QColor &bg)
 {
-	int sz = 16;
-	QPixmap pm(sz, sz);
-	pm.fill(Qt::transparent);
-
-	QPainter p(&pm);
-	p.setRenderHint(QPainter::Antialiasing, true);
-	p.setBrush(bg);
-	p.setPen(Qt::NoPen);
-	p.drawRoundedRect(0, 0, sz, sz, 3, 3);
-
-	p.setPen(Qt::white);
-	QFont f = p.font();
-	f.setPixelSize(10);
-	f.setBold(true);
-	p.setFont(f);
-	p.drawText(QRect(0, 0, sz, sz), Qt::AlignCenter, QString(letter));
-	p.end();
-
-	return QIcon(pm);
+	return recast_cached_icon(RECAST_ICON_BADGE, letter, bg, 16);
 }
 
 static QIcon generate_visibility_icon(bool visible)
 {
-	int sz = 16;
-	QPixmap pm(sz, sz);
-	pm.fill(Qt::transparent);
-
-	QPainter p(&pm);
-	p.setRenderHint(QPainter::Antialiasing, true);
-
 	QColor col = visible ? QColor(200, 200, 200) : QColor(90, 90, 90);
-	p.setPen(QPen(col, 1.5));
-
-	/* Eye outline (almond shape) */
-	QPainterPath eye;
-	eye.moveTo(1, 8);
-	eye.cubicTo(4, 3, 12, 3, 15, 8);
-	eye.cubicTo(12, 13, 4, 13, 1, 8);
-	p.drawPath(eye);
-
-	if (visible) {
-		/* Pupil */
-		p.setBrush(col);
-		p.setPen(Qt::NoPen);
-		p.drawEllipse(QPointF(8, 8), 2.5, 2.5);
-	} else {
-		/* Strike-through line */
-		p.setPen(QPen(col, 1.5));
-		p.drawLine(3, 13, 13, 3);
-	}
-
-	p.end();
-	return QIcon(pm);
+	return recast_cached_icon(visible ? RECAST_ICON_VISIBLE
+					  : RECAST_ICON_HIDDEN,
+				  QChar(), col, 16);
 }
 
 static QIcon generate_lock_icon(bool locked)
 {
-	int sz = 16;
-	QPixmap pm(sz, sz);
-	pm.fill(Qt::transparent);
-
-	QPainter p(&pm);
-	p.setRenderHint(QPainter::Antialiasing, true);
-
 	QColor col = locked ? QColor(200, 200, 200) : QColor(90, 90, 90);
-	p.setPen(QPen(col, 1.5));
-
-	/* Lock body */
-	p.setBrush(locked ? col : Qt::transparent);
-	p.drawRoundedRect(3, 9, 10, 6, 1, 1);
-
-	/* Shackle arch */
-	p.setBrush(Qt::transparent);
-	if (locked) {
-		p.drawArc(4, 3, 8, 10, 0, 180 * 16);
-	} else {
-		p.drawArc(5, 1, 8, 10, 0, 180 * 16);
-	}
-
-	p.end();
-	return QIcon(pm);
+	return recast_cached_icon(locked ? RECAST_ICON_LOCKED
+					 : RECAST_ICON_UNLOCKED,
+				  QChar(), col, 16);
 }
 
 /* ====================================================================
@@ -223,13 +157,18 @@ void SourceTreeItem::update()
 			QString::fromUtf8(name ? name : "(unnamed)"));
 	}
 
+	/* The button's checked state always matches its icon */
 	bool vis = obs_sceneitem_visible(item_);
-	vis_btn_->setChecked(vis);
-	vis_btn_->setIcon(generate_visibility_icon(vis));
+	if (vis_btn_->isChecked() != vis) {
+		vis_btn_->setChecked(vis);
+		vis_btn_->setIcon(generate_visibility_icon(vis));
+	}
 
 	bool locked = obs_sceneitem_locked(item_);
-	lock_btn_->setChecked(locked);
-	lock_btn_->setIcon(generate_lock_icon(locked));
+	if (lock_btn_->isChecked() != locked) {
+		lock_btn_->setChecked(locked);
+		lock_btn_->setIcon(generate_lock_icon(locked));
+	}
 }
 
 QIcon SourceTreeItem::getSourceTypeIcon(obs_source_t *source)
@@ -344,37 +283,155 @@ SourceTreeModel::SourceTreeModel(QObject *parent)
 {
 }
 
-struct enum_reverse_ctx {
-	std::vector<obs_sceneitem_t *> *items;
-};
+SourceTreeModel::~SourceTreeModel()
+{
+	disconnectScene();
+	clearItems();
+	obs_scene_release(scene_);
+}
 
-static bool enum_reverse_cb(obs_scene_t *, obs_sceneitem_t *item, void *param)
+/* Items in scene order, addref'd; the caller releases them */
+static bool enum_items_cb(obs_scene_t *, obs_sceneitem_t *item, void *param)
 {
-	auto *ctx = static_cast<struct enum_reverse_ctx *>(param);
-	ctx->items->push_back(item);
+	auto *items = static_cast<std::vector<obs_sceneitem_t *> *>(param);
+	obs_sceneitem_addref(item);
+	items->push_back(item);
 	return true;
 }
 
-void SourceTreeModel::populate()
+static std::vector<obs_sceneitem_t *> scene_items_topmost_first(
+	obs_scene_t *scene)
 {
+	std::vector<obs_sceneitem_t *> items;
+	if (scene) {
+		obs_scene_enum_items(scene, enum_items_cb, &items);
+		std::reverse(items.begin(), items.end());
+	}
+	return items;
+}
+
+void SourceTreeModel::clearItems()
+{
+	for (obs_sceneitem_t *item : items_)
+		obs_sceneitem_release(item);
 	items_.clear();
+}
+
+void SourceTreeModel::setScene(obs_scene_t *scene)
+{
+	if (scene == scene_)
+		return;
+
+	beginResetModel();
+	disconnectScene();
+	clearItems();
+	obs_scene_release(scene_);
+	scene_ = obs_scene_get_ref(scene);
+	items_ = scene_items_topmost_first(scene_);
+	connectScene();
+	endResetModel();
+}
+
+void SourceTreeModel::sync()
+{
+	sync_queued_ = false;
+	std::vector<obs_sceneitem_t *> next = scene_items_topmost_first(scene_);
+
+	/* Rows whose item left the scene */
+	for (int i = (int)items_.size() - 1; i >= 0; i--) {
+		if (std::find(next.begin(), next.end(), items_[i]) != next.end())
+			continue;
+		beginRemoveRows(QModelIndex(), i, i);
+		obs_sceneitem_release(items_[i]);
+		items_.erase(items_.begin() + i);
+		endRemoveRows();
+	}
+
+	/* Then walk the new order, moving or inserting into place */
+	for (int i = 0; i < (int)next.size(); i++) {
+		obs_sceneitem_t *item = next[i];
+		if (i < (int)items_.size() && items_[i] == item) {
+			obs_sceneitem_release(item);
+			continue;
+		}
+
+		auto it = std::find(items_.begin() + i, items_.end(), item);
+		if (it != items_.end()) {
+			int from = (int)(it - items_.begin());
+			beginMoveRows(QModelIndex(), from, from, QModelIndex(),
+				      i);
+			std::rotate(items_.begin() + i, it, it + 1);
+			endMoveRows();
+			obs_sceneitem_release(item);
+		} else {
+			beginInsertRows(QModelIndex(), i, i);
+			items_.insert(items_.begin() + i, item);
+			endInsertRows();
+		}
+	}
+}
+
+/* ---- Scene signals ---- */
+
+void SourceTreeModel::connectScene()
+{
 	if (!scene_)
 		return;
+	signal_handler_t *sh =
+		obs_source_get_signal_handler(obs_scene_get_source(scene_));
+	signal_handler_connect(sh, "item_add", onSceneItemsChanged, this);
+	signal_handler_connect(sh, "item_remove", onSceneItemsChanged, this);
+	signal_handler_connect(sh, "reorder", onSceneItemsChanged, this);
+	signal_handler_connect(sh, "refresh", onSceneItemsChanged, this);
+	signal_handler_connect(sh, "item_visible", onSceneItemState, this);
+	signal_handler_connect(sh, "item_locked", onSceneItemState, this);
+}
 
-	struct enum_reverse_ctx ctx;
-	ctx.items = &items_;
-	obs_scene_enum_items(scene_, enum_reverse_cb, &ctx);
+void SourceTreeModel::disconnectScene()
+{
+	if (!scene_)
+		return;
+	signal_handler_t *sh =
+		obs_source_get_signal_handler(obs_scene_get_source(scene_));
+	signal_handler_disconnect(sh, "item_add", onSceneItemsChanged, this);
+	signal_handler_disconnect(sh, "item_remove", onSceneItemsChanged,
+				  this);
+	signal_handler_disconnect(sh, "reorder", onSceneItemsChanged, this);
+	signal_handler_disconnect(sh, "refresh", onSceneItemsChanged, this);
+	signal_handler_disconnect(sh, "item_visible", onSceneItemState, this);
+	signal_handler_disconnect(sh, "item_locked", onSceneItemState, this);
+}
+
+/* Bursts (a group ungrouped, a scene duplicated) coalesce into one
+ * sync on the UI thread */
+void SourceTreeModel::queueSync()
+{
+	if (sync_queued_.exchange(true))
+		return;
+	QMetaObject::invokeMethod(
+		this, [this]() { sync(); }, Qt::QueuedConnection);
+}
 
-	/* Reverse so topmost item is first in the list */
-	std::reverse(items_.begin(), items_.end());
+void SourceTreeModel::itemChanged(obs_sceneitem_t *item)
+{
+	/* Only compared against held refs, never dereferenced */
+	int row = findItem(item);
+	if (row >= 0)
+		emit dataChanged(index(row), index(row));
 }
 
-void SourceTreeModel::setScene(obs_scene_t *scene)
+void SourceTreeModel::onSceneItemsChanged(void *param, calldata_t *)
 {
-	beginResetModel();
-	scene_ = scene;
-	populate();
-	endResetModel();
+	static_cast<SourceTreeModel *>(param)->queueSync();
+}
+
+void SourceTreeModel::onSceneItemState(void *param, calldata_t *cd)
+{
+	auto *self = static_cast<SourceTreeModel *>(param);
+	auto *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+	QMetaObject::invokeMethod(
+		self, [self, item]() { self->itemChanged(item); },
+		Qt::QueuedConnection);
 }
 
 obs_sceneitem_t *SourceTreeModel::itemAt(int row) const
@@ -493,10 +550,7 @@ bool SourceTreeModel::dropMimeData(const QMimeData *data,
 
 	obs_sceneitem_t *item = items_[from_row];
 	obs_sceneitem_set_order_position(item, scene_pos);
-
-	beginResetModel();
-	populate();
-	endResetModel();
+	sync();
 
 	emit orderChanged();
 	return true;
@@ -522,26 +576,54 @@ SourceTree::SourceTree(QWidget *parent) : QListView(parent)
 		this, &SourceTree::onSelectionChanged);
 	connect(model_, &SourceTreeModel::orderChanged,
 		this, &SourceTree::onOrderChanged);
+	connect(model_, &QAbstractItemModel::rowsInserted,
+		this, &SourceTree::onRowsInserted);
+	connect(model_, &QAbstractItemModel::dataChanged,
+		this, &SourceTree::onDataChanged);
 }
 
 SourceTree::~SourceTree() {}
 
 void SourceTree::setScene(obs_scene_t *scene)
 {
+	if (scene == model_->scene())
+		return;
 	model_->setScene(scene);
-	setupItemWidgets();
+	setupItemWidgets(0, model_->rowCount() - 1);
 }
 
 void SourceTree::refreshItems()
 {
-	obs_scene_t *scene = model_->scene();
-	model_->setScene(scene);
-	setupItemWidgets();
+	/* Rows follow the scene; existing widgets only pick up state
+	 * (a rename from the properties dialog, for instance) */
+	model_->sync();
+	for (int i = 0; i < model_->rowCount(); i++) {
+		auto *widget = static_cast<SourceTreeItem *>(
+			indexWidget(model_->index(i)));
+		if (widget)
+			widget->update();
+	}
 }
 
-void SourceTree::setupItemWidgets()
+void SourceTree::onRowsInserted(const QModelIndex &, int first, int last)
 {
-	for (int i = 0; i < model_->rowCount(); i++) {
+	setupItemWidgets(first, last);
+}
+
+void SourceTree::onDataChanged(const QModelIndex &top_left,
+			       const QModelIndex &bottom_right)
+{
+	for (int i = top_left.row(); i <= bottom_right.row(); i++) {
+		auto *widget = static_cast<SourceTreeItem *>(
+			indexWidget(model_->index(i)));
+		if (widget)
+			widget->update();
+	}
+}
+
+void SourceTree::setupItemWidgets(int first, int last)
+{
+	for (int i = first; i <= last; i++) {
 		QModelIndex index = model_->index(i);
 		obs_sceneitem_t *item = model_->itemAt(i);
 		if (!item)
@@ -671,6 +753,5 @@ void SourceTree::onItemRenamed(obs_sceneitem_t *item, const QString &name)
 
 void SourceTree::onOrderChanged()
 {
-	setupItemWidgets();
 	emit sourcesModified();
 }
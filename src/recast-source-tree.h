@@ -8,6 +8,7 @@
 #include <QPushButton>
 #include <QStyledItemDelegate>
 
+#include <atomic>
 #include <vector>
 
 extern "C" {
@@ -56,17 +57,27 @@ private:
 	void cancelRename();
 };
 
-/* ---- Source tree model ---- */
+/* ---- Source tree model ----
+ *
+ * Rows are the scene's items, topmost first. The model holds refs on
+ * the scene and its listed items and follows the scene's item_add /
+ * item_remove / reorder / item_visible / item_locked signals, turning
+ * them into row inserts, moves, removes and dataChanged so the view
+ * keeps its row widgets. Only setScene() resets. */
 
 class SourceTreeModel : public QAbstractListModel {
 	Q_OBJECT
 
 public:
 	explicit SourceTreeModel(QObject *parent = nullptr);
+	~SourceTreeModel();
 
 	void setScene(obs_scene_t *scene);
 	obs_scene_t *scene() const { return scene_; }
 
+	/* Re-read the scene's item order and apply the difference */
+	void sync();
+
 	obs_sceneitem_t *itemAt(int row) const;
 	int findItem(obs_sceneitem_t *item) const;
 
@@ -90,8 +101,17 @@ signals:
 private:
 	obs_scene_t *scene_ = nullptr;
 	std::vector<obs_sceneitem_t *> items_;
+	std::atomic<bool> sync_queued_{false};
+
+	void clearItems();
+	void connectScene();
+	void disconnectScene();
+	void queueSync();
+	void itemChanged(obs_sceneitem_t *item);
 
-	void populate();
+	/* Scene signal callbacks (any thread) */
+	static void onSceneItemsChanged(void *param, calldata_t *cd);
+	static void onSceneItemState(void *param, calldata_t *cd);
 };
 
 /* ---- Source tree list view ---- */
@@ -124,9 +144,12 @@ private slots:
 	void onItemLockToggled(obs_sceneitem_t *item, bool locked);
 	void onItemRenamed(obs_sceneitem_t *item, const QString &name);
 	void onOrderChanged();
+	void onRowsInserted(const QModelIndex &parent, int first, int last);
+	void onDataChanged(const QModelIndex &top_left,
+			   const QModelIndex &bottom_right);
 
 private:
 	SourceTreeModel *model_;
 
-	void setupItemWidgets();
+	void setupItemWidgets(int first, int last);
 };
@@ -0,0 +1,149 @@
+/*
+ * recast-stats.c -- Fixed-size output telemetry ring.
+ */
+
+#include "recast-stats.h"
+
+#include <math.h>
+#include <string.h>
+
+void recast_stats_reset(recast_stats_ring_t *ring)
+{
+	memset(ring, 0, sizeof(*ring));
+}
+
+static void derive(recast_stats_sample_t *s,
+		   const recast_stats_sample_t *prev)
+{
+	if (!prev || s->ts_ns <= prev->ts_ns) {
+		s->kbps = 0;
+		s->ewma_kbps = 0.0f;
+		s->drop_rate = 0.0f;
+		return;
+	}
+
+	uint64_t elapsed_ns = s->ts_ns - prev->ts_ns;
+
+	/* Counters restart if the output was restarted underneath us */
+	uint64_t bytes = s->total_bytes >= prev->total_bytes
+				 ? s->total_bytes - prev->total_bytes
+				 : s->total_bytes;
+
+	/* bits / ms == kbps */
+	s->kbps = (int)(bytes * 8 * 1000000ULL / elapsed_ns);
+
+	/* Time-aware EWMA so an irregular tick does not skew it; the
+	 * first interval seeds it. */
+	if (prev->ewma_kbps <= 0.0f) {
+		s->ewma_kbps = (float)s->kbps;
+	} else {
+		double dt = (double)elapsed_ns / 1000000000.0;
+		double alpha = 1.0 - exp(-dt / RECAST_STATS_EWMA_TAU_SEC);
+		s->ewma_kbps = (float)(prev->ewma_kbps +
+				       alpha * (s->kbps - prev->ewma_kbps));
+	}
+
+	/* Same ratio as the OBS stats dock, per interval */
+	int dropped = s->frames_dropped - prev->frames_dropped;
+	int frames = s->total_frames - prev->total_frames;
+	s->drop_rate = (dropped > 0 && frames > 0)
+			       ? (float)dropped / (float)frames
+			       : 0.0f;
+}
+
+void recast_stats_sample(recast_stats_ring_t *ring, obs_output_t *output,
+			 uint64_t now_ns)
+{
+	if (!output)
+		return;
+
+	const recast_stats_sample_t *prev = recast_stats_at(ring, 0);
+
+	recast_stats_sample_t *s = &ring->samples[ring->head];
+	s->ts_ns = now_ns;
+	s->total_bytes = obs_output_get_total_bytes(output);
+	s->frames_dropped = obs_output_get_frames_dropped(output);
+	s->total_frames = obs_output_get_total_frames(output);
+	s->congestion = obs_output_get_congestion(output);
+	s->connect_time_ms = obs_output_get_connect_time_ms(output);
+	derive(s, prev);
+
+	ring->head = (ring->head + 1) % RECAST_STATS_SAMPLES;
+	if (ring->count < RECAST_STATS_SAMPLES)
+		ring->count++;
+}
+
+const recast_stats_sample_t *
+recast_stats_at(const recast_stats_ring_t *ring, size_t age)
+{
+	if (age >= ring->count)
+		return NULL;
+
+	size_t idx = (ring->head + RECAST_STATS_SAMPLES - 1 - age) %
+		     RECAST_STATS_SAMPLES;
+	return &ring->samples[idx];
+}
+
+/* ---- Readers ---- */
+
+int recast_stats_bitrate_kbps(const recast_stats_ring_t *ring)
+{
+	const recast_stats_sample_t *cur = recast_stats_at(ring, 0);
+	return cur ? cur->kbps : 0;
+}
+
+int recast_stats_ewma_kbps(const recast_stats_ring_t *ring)
+{
+	const recast_stats_sample_t *cur = recast_stats_at(ring, 0);
+	return cur ? (int)lroundf(cur->ewma_kbps) : 0;
+}
+
+int recast_stats_frames_dropped(const recast_stats_ring_t *ring)
+{
+	const recast_stats_sample_t *cur = recast_stats_at(ring, 0);
+	return cur ? cur->frames_dropped : 0;
+}
+
+float recast_stats_drop_rate(const recast_stats_ring_t *ring)
+{
+	const recast_stats_sample_t *cur = recast_stats_at(ring, 0);
+	return cur ? cur->drop_rate : 0.0f;
+}
+
+float recast_stats_congestion(const recast_stats_ring_t *ring)
+{
+	const recast_stats_sample_t *cur = recast_stats_at(ring, 0);
+	return cur ? cur->congestion : 0.0f;
+}
+
+int recast_stats_connect_time_ms(const recast_stats_ring_t *ring)
+{
+	const recast_stats_sample_t *cur = recast_stats_at(ring, 0);
+	return cur ? cur->connect_time_ms : 0;
+}
+
+float recast_stats_peak_drop_rate(const recast_stats_ring_t *ring,
+				  size_t window)
+{
+	float peak = 0.0f;
+	const recast_stats_sample_t *s;
+	for (size_t age = 0; age < window && (s = recast_stats_at(ring, age));
+	     age++) {
+		if (s->drop_rate > peak)
+			peak = s->drop_rate;
+	}
+	return peak;
+}
+
+float recast_stats_peak_congestion(const recast_stats_ring_t *ring,
+				   size_t window)
+{
+	float peak = 0.0f;
+	const recast_stats_sample_t *s;
+	for (size_t age = 0; age < window && (s = recast_stats_at(ring, age));
+	     age++) {
+		if (s->congestion > peak)
+			peak = s->congestion;
+	}
+	return peak;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <obs-module.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Output telemetry ring -- fixed-size health history per output.
+ *
+ * The multistream dock samples each live destination once per tick.
+ * Each sample stores the raw counters plus the values derived from the
+ * previous sample (interval bitrate, its EWMA, interval drop rate), so
+ * readers get a ready-made time series with no further bookkeeping.
+ * Plain memory, no allocation: embed one ring per destination.
+ */
+
+#define RECAST_STATS_SAMPLES 64
+
+/* Time constant of the smoothed bitrate */
+#define RECAST_STATS_EWMA_TAU_SEC 5.0
+
+typedef struct recast_stats_sample {
+	uint64_t ts_ns;
+
+	/* Raw output counters */
+	uint64_t total_bytes;
+	int frames_dropped;
+	int total_frames;
+	float congestion;    /* 0..1, obs_output_get_congestion */
+	int connect_time_ms; /* obs_output_get_connect_time_ms */
+
+	/* Derived from the previous sample */
+	int kbps;          /* bitrate over the interval */
+	float ewma_kbps;   /* smoothed bitrate */
+	float drop_rate;   /* dropped / total frames over the interval */
+} recast_stats_sample_t;
+
+typedef struct recast_stats_ring {
+	recast_stats_sample_t samples[RECAST_STATS_SAMPLES];
+	size_t head;  /* slot the next sample goes into */
+	size_t count; /* valid samples, up to RECAST_STATS_SAMPLES */
+} recast_stats_ring_t;
+
+void recast_stats_reset(recast_stats_ring_t *ring);
+
+/* Read the output's counters into the next slot. */
+void recast_stats_sample(recast_stats_ring_t *ring, obs_output_t *output,
+			 uint64_t now_ns);
+
+/* Sample by age, 0 = newest. NULL past the stored history. */
+const recast_stats_sample_t *
+recast_stats_at(const recast_stats_ring_t *ring, size_t age);
+
+/* Convenience readers for the newest sample; 0 when empty. */
+int recast_stats_bitrate_kbps(const recast_stats_ring_t *ring);
+int recast_stats_ewma_kbps(const recast_stats_ring_t *ring);
+int recast_stats_frames_dropped(const recast_stats_ring_t *ring);
+float recast_stats_drop_rate(const recast_stats_ring_t *ring);
+float recast_stats_congestion(const recast_stats_ring_t *ring);
+int recast_stats_connect_time_ms(const recast_stats_ring_t *ring);
+
+/* Highest drop rate / congestion over the last `window` samples. */
+float recast_stats_peak_drop_rate(const recast_stats_ring_t *ring,
+				  size_t window);
+float recast_stats_peak_congestion(const recast_stats_ring_t *ring,
+				   size_t window);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+/*
+ * RecastBatchQueue -- Coalesces arrivals into one UI update per tick.
+ *
+ * push() queues an item and arms a single-shot timer; when it fires, the
+ * flush callback receives everything queued since the last flush. At most
+ * max_pending items are kept (oldest dropped first), so the work done per
+ * flush is bounded no matter how fast items arrive.
+ */
+
+template<typename T> class RecastBatchQueue {
+public:
+	using FlushFunc = std::function<void(std::vector<T> &batch)>;
+
+	RecastBatchQueue(QObject *owner, int interval_ms, size_t max_pending,
+			 FlushFunc flush)
+		: max_pending_(max_pending ? max_pending : 1),
+		  flush_(std::move(flush))
+	{
+		timer_ = new QTimer(owner);
+		timer_->setSingleShot(true);
+		timer_->setTimerType(Qt::PreciseTimer);
+		timer_->setInterval(interval_ms);
+		QObject::connect(timer_, &QTimer::timeout, owner,
+				 [this]() { flush(); });
+	}
+
+	RecastBatchQueue(const RecastBatchQueue &) = delete;
+	RecastBatchQueue &operator=(const RecastBatchQueue &) = delete;
+
+	void push(const T &item)
+	{
+		pending_.push_back(item);
+		if (pending_.size() > max_pending_)
+			pending_.pop_front();
+		if (!timer_->isActive())
+			timer_->start();
+	}
+
+	/* Deliver whatever is queued right now */
+	void flush()
+	{
+		timer_->stop();
+		if (pending_.empty())
+			return;
+
+		std::vector<T> batch(std::make_move_iterator(pending_.begin()),
+				     std::make_move_iterator(pending_.end()));
+		pending_.clear();
+		flush_(batch);
+	}
+
+	void clear()
+	{
+		timer_->stop();
+		pending_.clear();
+	}
+
+	size_t pendingCount() const { return pending_.size(); }
+
+private:
+	QTimer *timer_;
+	size_t max_pending_;
+	FlushFunc flush_;
+	std::deque<T> pending_;
+};
@@ -3,6 +3,10 @@
  *
  * Creates all 4 docks on OBS_FRONTEND_EVENT_FINISHED_LOADING,
  * wires signals between them, and handles config load/save.
+ *
+ * Startup is staged so OBS finishes loading sooner: docks and config
+ * first, then the dock layout once the event loop runs, then the
+ * chat/event providers. Each stage logs its time.
  */
 
 #include "recast-ui.h"
@@ -15,6 +19,13 @@
 #include "recast-auth.h"
 #include "recast-chat.h"
 #include "recast-events.h"
+#include "recast-youtube-livechat.h"
+#include "recast-kick-hub.h"
+#include "recast-network.h"
+#include "recast-config-store.h"
+#include "recast-icon-cache.h"
+#include "recast-emote-cache.h"
+#include "recast-perf-dock.h"
 
 #include <QDockWidget>
 #include <QMainWindow>
@@ -24,6 +35,7 @@
 extern "C" {
 #include <obs-frontend-api.h>
 #include <obs-module.h>
+#include <util/platform.h>
 #include "recast-config.h"
 }
 
@@ -35,6 +47,7 @@ static RecastVerticalSourcesDock *sources_dock = nullptr;
 static RecastMultistreamDock *multistream_dock = nullptr;
 static RecastChatDock *chat_dock = nullptr;
 static RecastEventsDock *events_dock = nullptr;
+static RecastPerfDock *perf_dock = nullptr;
 
 /* Chat and event providers */
 static RecastTwitchChat *twitch_chat = nullptr;
@@ -44,6 +57,44 @@ static RecastTwitchEvents *twitch_events = nullptr;
 static RecastYouTubeEvents *youtube_events = nullptr;
 static RecastKickEvents *kick_events = nullptr;
 
+/* ---- Provider control ----
+ * Providers live on the network thread, so calls are posted to it. */
+
+static void connect_twitch_chat(const QString &user)
+{
+	RecastNetwork::post(twitch_chat, [p = twitch_chat, user]() {
+		p->connectToChat(user);
+	});
+}
+
+static void connect_youtube_chat()
+{
+	RecastNetwork::post(youtube_chat, [p = youtube_chat]() {
+		p->connectToChat(QString());
+	});
+}
+
+static void connect_events(RecastEventProvider *provider)
+{
+	RecastNetwork::post(provider, [provider]() {
+		provider->connectToEvents();
+	});
+}
+
+static void disconnect_chat(RecastChatProvider *provider)
+{
+	RecastNetwork::post(provider, [provider]() {
+		provider->disconnect();
+	});
+}
+
+static void disconnect_events(RecastEventProvider *provider)
+{
+	RecastNetwork::post(provider, [provider]() {
+		provider->disconnect();
+	});
+}
+
 /* ---- Dock helpers ---- */
 
 static QDockWidget *findParentDock(QWidget *w)
@@ -74,84 +125,77 @@ static dock_entry dock_map[] = {
 
 /* ---- Config persistence ---- */
 
-static void save_all_config()
+static void save_main_window_state(obs_data_t *part)
 {
-	if (!multistream_dock)
-		return;
-
-	/* Build root JSON */
-	obs_data_t *root = obs_data_create();
-
-	/* Save vertical canvas config */
-	RecastVertical *v = RecastVertical::instance();
-	obs_data_t *vertical_data = v->saveToConfig();
-	if (vertical_data) {
-		obs_data_set_obj(root, "vertical", vertical_data);
-		obs_data_release(vertical_data);
-	}
-
-	/* Save destinations */
-	obs_data_array_t *dests = multistream_dock->saveDestinations();
-	if (dests) {
-		obs_data_set_array(root, "destinations", dests);
-		obs_data_array_release(dests);
-	}
-
-	/* Preserve server token */
-	char *token = recast_config_get_server_token();
-	obs_data_set_string(root, "server_token", token ? token : "");
-	bfree(token);
-
-	/* Save auth tokens */
-	RecastAuthManager *auth = RecastAuthManager::instance();
-	if (auth) {
-		obs_data_t *auth_data = auth->saveToConfig();
-		if (auth_data) {
-			obs_data_set_obj(root, "auth", auth_data);
-			obs_data_release(auth_data);
-		}
-	}
-
-	/* Save main window state (captures all dock positions/sizes).
-	 * Guard against accessing already-destroyed widgets on shutdown. */
+	/* Guard against accessing already-destroyed widgets on shutdown */
 	try {
 		QMainWindow *mw = qobject_cast<QMainWindow *>(
 			static_cast<QWidget *>(
 				obs_frontend_get_main_window()));
 		if (mw) {
 			QByteArray state = mw->saveState();
-			obs_data_set_string(root, "mainwindow_state",
+			obs_data_set_string(part, "mainwindow_state",
 					    state.toBase64().constData());
 		}
 	} catch (...) {
 		/* Widgets may be partially destroyed during shutdown */
 	}
+}
 
-	/* Write to disk */
-	char *path = recast_config_get_path();
-	if (path) {
-		obs_data_save_json(root, path);
-		blog(LOG_INFO, "[Recast] Config saved to %s", path);
-		bfree(path);
-	}
+/* Each section is only re-serialized after it was marked dirty */
+static void register_config_sections()
+{
+	RecastConfigStore *store = RecastConfigStore::instance();
+
+	store->setSerializer(RecastConfigStore::SECTION_VERTICAL,
+			     [](obs_data_t *part) {
+		obs_data_t *vertical_data =
+			RecastVertical::instance()->saveToConfig();
+		if (vertical_data) {
+			obs_data_set_obj(part, "vertical", vertical_data);
+			obs_data_release(vertical_data);
+		}
+	});
 
-	obs_data_release(root);
+	store->setSerializer(RecastConfigStore::SECTION_DESTINATIONS,
+			     [](obs_data_t *part) {
+		if (!multistream_dock)
+			return;
+		obs_data_array_t *dests = multistream_dock->saveDestinations();
+		if (dests) {
+			obs_data_set_array(part, "destinations", dests);
+			obs_data_array_release(dests);
+		}
+	});
+
+	store->setSerializer(RecastConfigStore::SECTION_AUTH,
+			     [](obs_data_t *part) {
+		RecastAuthManager *auth = RecastAuthManager::instance();
+		obs_data_t *auth_data = auth ? auth->saveToConfig() : nullptr;
+		if (auth_data) {
+			obs_data_set_obj(part, "auth", auth_data);
+			obs_data_release(auth_data);
+		}
+	});
+
+	store->setSerializer(RecastConfigStore::SECTION_WINDOW,
+			     save_main_window_state);
 }
 
-static void load_all_config()
+static void mark_config_dirty(int sections)
 {
-	char *path = recast_config_get_path();
-	if (!path)
-		return;
+	RecastConfigStore::instance()->markDirty(sections);
+}
 
-	obs_data_t *root = obs_data_create_from_json_file(path);
-	bfree(path);
+/* Old (v2) config: the whole file is re-read once and rewritten */
+static void migrate_old_config()
+{
+	obs_data_t *root = RecastConfigStore::instance()->snapshot();
 	if (!root)
 		return;
 
 	RecastVertical *v = RecastVertical::instance();
 
-	/* Check for old format and migrate */
 	obs_data_array_t *old_outputs = obs_data_get_array(root, "outputs");
 	if (old_outputs) {
 		/* Migration: old format detected */
@@ -258,82 +302,171 @@ static void load_all_config()
 		blog(LOG_INFO, "[Recast] Config migration complete");
 
 		/* Save in new format */
-		obs_data_release(root);
-		save_all_config();
+		RecastConfigStore *store = RecastConfigStore::instance();
+		store->eraseValue("outputs");
+		store->markDirty(RecastConfigStore::SECTION_ALL);
+		store->flush();
+	}
+
+	obs_data_release(root);
+}
+
+/* Sections come straight from the store's parse of the file */
+static void load_all_config()
+{
+	RecastConfigStore *store = RecastConfigStore::instance();
+
+	/* Check for old format and migrate */
+	if (store->hasValue("outputs")) {
+		migrate_old_config();
 		return;
 	}
 
-	/* New format */
-	obs_data_t *vertical_data = obs_data_get_obj(root, "vertical");
+	obs_data_t *part = store->section(RecastConfigStore::SECTION_VERTICAL);
+	obs_data_t *vertical_data = obs_data_get_obj(part, "vertical");
 	if (vertical_data) {
-		v->loadFromConfig(vertical_data);
+		RecastVertical::instance()->loadFromConfig(vertical_data);
 		obs_data_release(vertical_data);
 	}
+	obs_data_release(part);
 
-	obs_data_array_t *dests = obs_data_get_array(root, "destinations");
-	if (dests && multistream_dock) {
+	part = store->section(RecastConfigStore::SECTION_DESTINATIONS);
+	obs_data_array_t *dests = obs_data_get_array(part, "destinations");
+	if (dests && multistream_dock)
 		multistream_dock->loadDestinations(dests);
-		obs_data_array_release(dests);
-	}
+	obs_data_array_release(dests);
+	obs_data_release(part);
 
 	/* Load auth tokens */
-	obs_data_t *auth_data = obs_data_get_obj(root, "auth");
+	part = store->section(RecastConfigStore::SECTION_AUTH);
+	obs_data_t *auth_data = obs_data_get_obj(part, "auth");
 	if (auth_data) {
 		RecastAuthManager *auth = RecastAuthManager::instance();
 		if (auth)
 			auth->loadFromConfig(auth_data);
 		obs_data_release(auth_data);
 	}
-
-	obs_data_release(root);
+	obs_data_release(part);
 }
 
-/* ---- Dock-geometry-only save (safe during shutdown) ---- */
+/* ---- Startup ---- */
 
-static void save_dock_geometry_only()
+/* Logs the time since *start_ns and restarts it for the next stage */
+static void log_stage(const char *stage, uint64_t *start_ns)
 {
-	/* Read existing config so we preserve scene/destination data */
-	char *path = recast_config_get_path();
-	if (!path)
-		return;
+	uint64_t now = os_gettime_ns();
+	blog(LOG_INFO, "[Recast] Startup: %s took %.1f ms", stage,
+	     (double)(now - *start_ns) / 1000000.0);
+	*start_ns = now;
+}
 
-	obs_data_t *root = obs_data_create_from_json_file(path);
-	if (!root) {
-		/* No existing config — nothing to preserve */
-		bfree(path);
+/* Providers are created once OBS is up and connect in the background;
+ * nothing before them depends on the network */
+static void create_providers()
+{
+	if (!chat_dock || !events_dock || twitch_chat)
 		return;
-	}
 
-	/* Update main window state (captures all dock positions/sizes) */
-	try {
-		QMainWindow *mw = qobject_cast<QMainWindow *>(
-			static_cast<QWidget *>(
-				obs_frontend_get_main_window()));
-		if (mw) {
-			QByteArray state = mw->saveState();
-			obs_data_set_string(root, "mainwindow_state",
-					    state.toBase64().constData());
+	uint64_t t = os_gettime_ns();
+
+	/* Create chat providers (network thread, deleted in destroy) */
+	twitch_chat = new RecastTwitchChat();
+	youtube_chat = new RecastYouTubeChat();
+	kick_chat = new RecastKickChat();
+	RecastNetwork::adopt(twitch_chat);
+	RecastNetwork::adopt(youtube_chat);
+	RecastNetwork::adopt(kick_chat);
+	chat_dock->addProvider(twitch_chat);
+	chat_dock->addProvider(youtube_chat);
+	chat_dock->addProvider(kick_chat);
+
+	/* Create event providers */
+	twitch_events = new RecastTwitchEvents();
+	youtube_events = new RecastYouTubeEvents();
+	kick_events = new RecastKickEvents();
+	RecastNetwork::adopt(twitch_events);
+	RecastNetwork::adopt(youtube_events);
+	RecastNetwork::adopt(kick_events);
+	events_dock->addProvider(twitch_events);
+	events_dock->addProvider(youtube_events);
+	events_dock->addProvider(kick_events);
+
+	/* Wire auth state changes to auto-connect chat/events */
+	RecastAuthManager *auth = RecastAuthManager::instance();
+	QObject::connect(auth, &RecastAuthManager::authStateChanged,
+		[](const QString &platform, bool authenticated) {
+			if (authenticated) {
+				RecastAuthManager *a =
+					RecastAuthManager::instance();
+				if (platform == "twitch") {
+					QString user = a->userName("twitch");
+					if (!user.isEmpty())
+						connect_twitch_chat(user);
+					connect_events(twitch_events);
+				} else if (platform == "youtube") {
+					connect_youtube_chat();
+					connect_events(youtube_events);
+				}
+			} else {
+				if (platform == "twitch") {
+					disconnect_chat(twitch_chat);
+					disconnect_events(twitch_events);
+				} else if (platform == "youtube") {
+					disconnect_chat(youtube_chat);
+					disconnect_events(youtube_events);
+				}
+			}
+		});
+
+	/* Warm the API connections the auto-connect below will use */
+	if (auth->isAuthenticated("twitch"))
+		RecastNetwork::preconnect(QStringLiteral("api.twitch.tv"));
+	if (auth->isAuthenticated("youtube"))
+		RecastNetwork::preconnect(QStringLiteral("www.googleapis.com"));
+
+	/* Auto-connect to authenticated platforms on startup */
+	QTimer::singleShot(2000, [=]() {
+		RecastAuthManager *a = RecastAuthManager::instance();
+		if (a->isAuthenticated("twitch")) {
+			QString user = a->userName("twitch");
+			if (!user.isEmpty())
+				connect_twitch_chat(user);
+			connect_events(twitch_events);
 		}
-	} catch (...) {
-		/* Widgets may be partially destroyed during shutdown */
-	}
+		if (a->isAuthenticated("youtube")) {
+			connect_youtube_chat();
+			connect_events(youtube_events);
+		}
+	});
 
-	obs_data_save_json(root, path);
-	blog(LOG_INFO, "[Recast] Dock geometry saved to %s", path);
-	bfree(path);
-	obs_data_release(root);
+	log_stage("providers", &t);
 }
 
 /* ---- Frontend event: save before exit ---- */
 
 static void on_frontend_event(enum obs_frontend_event event, void *)
 {
-	if (event == OBS_FRONTEND_EVENT_EXIT) {
-		/* Only save dock geometry on exit.
-		 * Scene data is saved during normal operation via signals.
+	RecastConfigStore *store = RecastConfigStore::instance();
+
+	if (event == OBS_FRONTEND_EVENT_SCRIPTING_SHUTDOWN) {
+		/* First event of OBS shutdown; scenes are still intact, so
+		 * write out anything still waiting in the debounce window */
+		store->flushSync();
+	} else if (event == OBS_FRONTEND_EVENT_EXIT) {
+		/* Only dock geometry (and non-scene sections) on exit.
 		 * By EXIT time OBS has already torn down private scene
-		 * contents, so a full save would overwrite items with []. */
-		save_dock_geometry_only();
+		 * contents, so a vertical save would overwrite items with
+		 * []. Dropping the serializer freezes the section at its
+		 * last saved state. */
+		store->setSerializer(RecastConfigStore::SECTION_VERTICAL,
+				     nullptr);
+		store->markDirty(RecastConfigStore::SECTION_WINDOW);
+		store->flushSync();
+	} else if (event == OBS_FRONTEND_EVENT_THEME_CHANGED) {
+		recast_icon_cache_invalidate();
+	} else if (event == OBS_FRONTEND_EVENT_STREAMING_STARTED) {
+		if (events_dock)
+			events_dock->markStreamStart();
 	}
 }
 
@@ -346,6 +479,8 @@ void recast_ui_create(void)
 
 	QWidget *main_window =
 		static_cast<QWidget *>(obs_frontend_get_main_window());
+	uint64_t total = os_gettime_ns();
+	uint64_t t = total;
 
 	/* Initialize the vertical canvas singleton */
 	RecastVertical *v = RecastVertical::instance();
@@ -353,6 +488,9 @@ void recast_ui_create(void)
 	/* Initialize auth manager */
 	RecastAuthManager::instance();
 
+	/* Created here so providers on the network thread only read it */
+	RecastEmoteCache::instance();
+
 	/* Create all 6 docks */
 	preview_dock = new RecastVerticalPreviewDock(main_window);
 	scenes_dock = new RecastVerticalScenesDock(main_window);
@@ -360,28 +498,23 @@ void recast_ui_create(void)
 	multistream_dock = new RecastMultistreamDock(main_window);
 	chat_dock = new RecastChatDock(main_window);
 	events_dock = new RecastEventsDock(main_window);
+	perf_dock = new RecastPerfDock(main_window);
 
-	/* Create chat providers */
-	twitch_chat = new RecastTwitchChat(chat_dock);
-	youtube_chat = new RecastYouTubeChat(chat_dock);
-	kick_chat = new RecastKickChat(chat_dock);
-	chat_dock->addProvider(twitch_chat);
-	chat_dock->addProvider(youtube_chat);
-	chat_dock->addProvider(kick_chat);
+	/* Messages and events are handed to the docks by queued signal */
+	qRegisterMetaType<RecastChatMessage>();
+	qRegisterMetaType<RecastPlatformEvent>();
+	log_stage("docks", &t);
 
-	/* Create event providers */
-	twitch_events = new RecastTwitchEvents(events_dock);
-	youtube_events = new RecastYouTubeEvents(events_dock);
-	kick_events = new RecastKickEvents(events_dock);
-	events_dock->addProvider(twitch_events);
-	events_dock->addProvider(youtube_events);
-	events_dock->addProvider(kick_events);
-
-	/* Load config (populates scenes + destinations) */
+	/* Load config (populates scenes + destinations). Only the active
+	 * vertical scene gets its sources now, and destinations create
+	 * their outputs on first start. */
+	register_config_sections();
 	load_all_config();
+	log_stage("config", &t);
 
 	/* Initialize the vertical video pipeline (after config load) */
 	v->initialize();
+	log_stage("vertical canvas", &t);
 
 	/* Refresh docks with loaded data */
 	scenes_dock->refresh();
@@ -433,20 +566,29 @@ void recast_ui_create(void)
 			 &RecastVerticalSourcesDock::refreshTree);
 
 	/* Config save triggers */
-	QObject::connect(pw, &RecastPreviewWidget::itemTransformed,
-			 [](){ save_all_config(); });
+	QObject::connect(pw, &RecastPreviewWidget::itemTransformed, []() {
+		mark_config_dirty(RecastConfigStore::SECTION_VERTICAL);
+	});
 
 	QObject::connect(scenes_dock,
-			 &RecastVerticalScenesDock::scenesModified,
-			 [](){ save_all_config(); });
+			 &RecastVerticalScenesDock::scenesModified, []() {
+		mark_config_dirty(RecastConfigStore::SECTION_VERTICAL);
+	});
 
 	QObject::connect(sources_dock,
-			 &RecastVerticalSourcesDock::sourcesModified,
-			 [](){ save_all_config(); });
+			 &RecastVerticalSourcesDock::sourcesModified, []() {
+		mark_config_dirty(RecastConfigStore::SECTION_VERTICAL);
+	});
 
 	QObject::connect(multistream_dock,
-			 &RecastMultistreamDock::configChanged,
-			 [](){ save_all_config(); });
+			 &RecastMultistreamDock::configChanged, []() {
+		mark_config_dirty(RecastConfigStore::SECTION_DESTINATIONS);
+	});
+
+	QObject::connect(RecastAuthManager::instance(),
+			 &RecastAuthManager::authStateChanged, []() {
+		mark_config_dirty(RecastConfigStore::SECTION_AUTH);
+	});
 
 	/* Save dock state when OBS exits (while widgets are still alive) */
 	obs_frontend_add_event_callback(on_frontend_event, nullptr);
@@ -482,17 +624,21 @@ void recast_ui_create(void)
 		obs_module_text("Recast.Events.DockTitle"),
 		events_dock);
 
+	/* Diagnostics; not in dock_map, so it stays hidden until opened */
+	obs_frontend_add_dock_by_id(
+		"RecastPerfDock",
+		obs_module_text("Recast.Perf.DockTitle"),
+		perf_dock);
+
 	/* Restore dock positions and force visible.
 	 * OBS does not persist plugin dock state, so we manage it ourselves.
 	 * Deferred so OBS has finished parenting the dock widgets. */
 	QTimer::singleShot(0, [=]() {
-		/* Read saved config */
-		char *cfg_path = recast_config_get_path();
-		obs_data_t *cfg = nullptr;
-		if (cfg_path) {
-			cfg = obs_data_create_from_json_file(cfg_path);
-			bfree(cfg_path);
-		}
+		uint64_t st = os_gettime_ns();
+
+		/* Saved dock layout, as parsed at load */
+		obs_data_t *cfg = RecastConfigStore::instance()->section(
+			RecastConfigStore::SECTION_WINDOW);
 
 		QMainWindow *mw = qobject_cast<QMainWindow *>(
 			static_cast<QWidget *>(
@@ -521,77 +667,49 @@ void recast_ui_create(void)
 
 		if (cfg)
 			obs_data_release(cfg);
-	});
+		log_stage("dock layout", &st);
 
-	/* Wire auth state changes to auto-connect chat/events */
-	RecastAuthManager *auth = RecastAuthManager::instance();
-	QObject::connect(auth, &RecastAuthManager::authStateChanged,
-		[](const QString &platform, bool authenticated) {
-			if (authenticated) {
-				RecastAuthManager *a =
-					RecastAuthManager::instance();
-				if (platform == "twitch") {
-					QString user = a->userName("twitch");
-					if (twitch_chat && !user.isEmpty())
-						twitch_chat->connectToChat(user);
-					if (twitch_events)
-						twitch_events->connectToEvents();
-				} else if (platform == "youtube") {
-					if (youtube_chat)
-						youtube_chat->connectToChat(
-							QString());
-					if (youtube_events)
-						youtube_events->connectToEvents();
-				}
-			} else {
-				if (platform == "twitch") {
-					if (twitch_chat)
-						twitch_chat->disconnect();
-					if (twitch_events)
-						twitch_events->disconnect();
-				} else if (platform == "youtube") {
-					if (youtube_chat)
-						youtube_chat->disconnect();
-					if (youtube_events)
-						youtube_events->disconnect();
-				}
-			}
-		});
-
-	/* Auto-connect to authenticated platforms on startup */
-	QTimer::singleShot(2000, [=]() {
-		RecastAuthManager *a = RecastAuthManager::instance();
-		if (a->isAuthenticated("twitch")) {
-			QString user = a->userName("twitch");
-			if (twitch_chat && !user.isEmpty())
-				twitch_chat->connectToChat(user);
-			if (twitch_events)
-				twitch_events->connectToEvents();
-		}
-		if (a->isAuthenticated("youtube")) {
-			if (youtube_chat)
-				youtube_chat->connectToChat(QString());
-			if (youtube_events)
-				youtube_events->connectToEvents();
-		}
+		/* Next event loop pass, after OBS has shown its window */
+		QTimer::singleShot(0, create_providers);
 	});
 
-	blog(LOG_INFO, "[Recast] All 6 docks created and wired");
+	log_stage("wiring", &t);
+	blog(LOG_INFO,
+	     "[Recast] All 6 docks created and wired in %.1f ms; providers "
+	     "deferred",
+	     (double)(os_gettime_ns() - total) / 1000000.0);
 }
 
 void recast_ui_destroy(void)
 {
 	/* Dock state was already saved by the EXIT event callback.
-	 * Do NOT call save_all_config() here — dock widgets may
+	 * Do NOT flush the config store here — dock widgets may
 	 * already be destroyed by OBS at this point. */
 
-	/* Disconnect chat/event providers */
-	if (twitch_chat) twitch_chat->disconnect();
-	if (youtube_chat) youtube_chat->disconnect();
-	if (kick_chat) kick_chat->disconnect();
-	if (twitch_events) twitch_events->disconnect();
-	if (youtube_events) youtube_events->disconnect();
-	if (kick_events) kick_events->disconnect();
+	/* Disconnect and delete the chat/event providers and the
+	 * connections they share, on the thread that owns their sockets */
+	RecastNetwork::runBlocking([]() {
+		RecastChatProvider *chats[] = {twitch_chat, youtube_chat,
+					       kick_chat};
+		RecastEventProvider *events[] = {twitch_events, youtube_events,
+						 kick_events};
+		for (RecastChatProvider *p : chats) {
+			if (p) {
+				p->disconnect();
+				delete p;
+			}
+		}
+		for (RecastEventProvider *p : events) {
+			if (p) {
+				p->disconnect();
+				delete p;
+			}
+		}
+
+		RecastYouTubeLiveChat::destroyInstance();
+		RecastKickHub::destroyInstance();
+	});
+	RecastNetwork::shutdown();
 
 	/* OBS manages dock widget lifecycle, clear our references */
 	preview_dock = nullptr;
@@ -600,8 +718,9 @@ void recast_ui_destroy(void)
 	multistream_dock = nullptr;
 	chat_dock = nullptr;
 	events_dock = nullptr;
+	perf_dock = nullptr;
 
-	/* Clear provider references (owned by docks, deleted by Qt) */
+	/* Clear provider references (deleted above) */
 	twitch_chat = nullptr;
 	youtube_chat = nullptr;
 	kick_chat = nullptr;
@@ -612,8 +731,20 @@ void recast_ui_destroy(void)
 	/* Destroy the vertical canvas singleton */
 	RecastVertical::destroyInstance();
 
+	/* Cancels queued decodes and waits for running ones */
+	RecastEmoteCache::destroyInstance();
+
 	/* Destroy auth manager singleton */
 	RecastAuthManager::destroyInstance();
 
+	/* Last UI-thread HTTP user is gone */
+	RecastNetwork::releaseManager();
+
+	/* Waits for a write still in flight */
+	RecastConfigStore::destroyInstance();
+
+	/* Pixmaps must go before the QApplication does */
+	recast_icon_cache_invalidate();
+
 	blog(LOG_INFO, "[Recast] UI destroyed");
 }
@@ -25,6 +25,14 @@ RecastVerticalPreviewDock::RecastVerticalPreviewDock(QWidget *parent)
 
 	/* Get initial canvas size from vertical controller */
 	RecastVertical *v = RecastVertical::instance();
+
+	/* Draw the view's composited canvas rather than re-rendering */
+	preview_->SetCanvasTextureSource(RecastVertical::canvasTextureCallback,
+					 v);
+
+	/* The preview is a consumer of the vertical view while visible */
+	connect(preview_, &RecastPreviewWidget::visibilityChanged, v,
+		&RecastVertical::setPreviewVisible);
 	canvas_w_ = v->canvasWidth();
 	canvas_h_ = v->canvasHeight();
 
@@ -33,6 +41,7 @@ RecastVerticalPreviewDock::RecastVerticalPreviewDock(QWidget *parent)
 
 RecastVerticalPreviewDock::~RecastVerticalPreviewDock()
 {
+	preview_->SetCanvasTextureSource(nullptr, nullptr);
 	preview_->ClearScene();
 }
 
@@ -3,12 +3,15 @@
  *
  * Provides a list of private scenes for the vertical canvas,
  * with add/remove/rename/link controls matching native OBS look.
+ * The context menu also opens the canvas output settings.
  */
 
 #include "recast-vertical-scenes.h"
 #include "recast-vertical.h"
 
 #include <QAction>
+#include <QDialogButtonBox>
+#include <QFormLayout>
 #include <QHBoxLayout>
 #include <QInputDialog>
 #include <QMenu>
@@ -223,6 +226,12 @@ void RecastVerticalScenesDock::onContextMenu(const QPoint &pos)
 			bfree(main_scenes);
 		}
 
+		/* Crop window used in crop-from-main mode */
+		QAction *crop_action = menu.addAction(
+			obs_module_text("Recast.Vertical.CropRegion"));
+		connect(crop_action, &QAction::triggered, this,
+			[this, row]() { showCropDialog(row); });
+
 		menu.addSeparator();
 
 		/* Remove */
@@ -232,5 +241,251 @@ void RecastVerticalScenesDock::onContextMenu(const QPoint &pos)
 			&RecastVerticalScenesDock::onRemoveScene);
 	}
 
+	/* Mirrored cut options -- apply to the whole canvas */
+	menu.addSeparator();
+	RecastVertical *vc = RecastVertical::instance();
+
+	QAction *settings_action = menu.addAction(
+		obs_module_text("Recast.Vertical.CanvasSettings"));
+	connect(settings_action, &QAction::triggered, this,
+		&RecastVerticalScenesDock::showCanvasSettings);
+
+	QAction *prewarm_action =
+		menu.addAction(obs_module_text("Recast.Vertical.PrewarmLinked"));
+	prewarm_action->setCheckable(true);
+	prewarm_action->setChecked(vc->prewarmLinked());
+	connect(prewarm_action, &QAction::toggled, this, [this](bool on) {
+		RecastVertical::instance()->setPrewarmLinked(on);
+		emit scenesModified();
+	});
+
+	QAction *transition_action = menu.addAction(
+		obs_module_text("Recast.Vertical.FollowTransition"));
+	transition_action->setCheckable(true);
+	transition_action->setChecked(vc->followTransition());
+	connect(transition_action, &QAction::toggled, this, [this](bool on) {
+		RecastVertical::instance()->setFollowTransition(on);
+		emit scenesModified();
+	});
+
 	menu.exec(list_->mapToGlobal(pos));
 }
+
+void RecastVerticalScenesDock::showCanvasSettings()
+{
+	RecastVerticalSettingsDialog dlg(this);
+	if (dlg.exec() != QDialog::Accepted)
+		return;
+
+	RecastVertical *v = RecastVertical::instance();
+	v->setCropMode(dlg.getCropMode());
+	v->setCropPanMs(dlg.getCropPanMs());
+	emit scenesModified();
+
+	/* Only rebuild the view when the output actually changes */
+	QSize size = dlg.getOutputSize();
+	QSize current = v->outputWidth() == v->canvasWidth() &&
+				v->outputHeight() == v->canvasHeight()
+		? QSize(0, 0)
+		: QSize(v->outputWidth(), v->outputHeight());
+	if (dlg.getFpsDivisor() == v->fpsDivisor() && size == current &&
+	    dlg.getScaleType() == v->scaleType())
+		return;
+
+	if (!v->setVideoSettings(dlg.getFpsDivisor(), size.width(),
+				 size.height(), dlg.getScaleType())) {
+		QMessageBox::warning(
+			this, obs_module_text("Recast.Vertical.CanvasSettings"),
+			obs_module_text("Recast.Vertical.SettingsBusy"));
+		return;
+	}
+	emit scenesModified();
+}
+
+void RecastVerticalScenesDock::showCropDialog(int row)
+{
+	RecastVertical *v = RecastVertical::instance();
+	recast_scene_model_t *model = v->sceneModel();
+	if (!model || row < 0 || row >= model->scene_count)
+		return;
+	const recast_scene_entry_t *e = &model->scenes[row];
+
+	struct obs_video_info ovi = {};
+	obs_get_video_info(&ovi);
+
+	QDialog dlg(this);
+	dlg.setWindowTitle(QString::fromUtf8(e->name));
+	auto *form = new QFormLayout;
+
+	auto *full_check =
+		new QCheckBox(obs_module_text("Recast.Vertical.CropFull"));
+	full_check->setChecked(e->crop_w <= 0.0f);
+	form->addRow(full_check);
+
+	auto make_spin = [](int max, float value) {
+		auto *spin = new QSpinBox;
+		spin->setRange(0, max);
+		spin->setSuffix(" px");
+		spin->setValue((int)value);
+		return spin;
+	};
+	QSpinBox *x_spin = make_spin((int)ovi.base_width, e->crop_x);
+	QSpinBox *y_spin = make_spin((int)ovi.base_height, e->crop_y);
+	QSpinBox *w_spin = make_spin((int)ovi.base_width,
+				     e->crop_w > 0.0f
+					     ? e->crop_w
+					     : ovi.base_height *
+						       v->canvasWidth() /
+						       (float)v->canvasHeight());
+	w_spin->setMinimum(16);
+	form->addRow(obs_module_text("Recast.Vertical.CropX"), x_spin);
+	form->addRow(obs_module_text("Recast.Vertical.CropY"), y_spin);
+	form->addRow(obs_module_text("Recast.Vertical.CropWidth"), w_spin);
+
+	auto sync_enabled = [=](bool full) {
+		x_spin->setEnabled(!full);
+		y_spin->setEnabled(!full);
+		w_spin->setEnabled(!full);
+	};
+	sync_enabled(full_check->isChecked());
+	connect(full_check, &QCheckBox::toggled, &dlg, sync_enabled);
+
+	auto *buttons =
+		new QDialogButtonBox(QDialogButtonBox::Ok |
+				     QDialogButtonBox::Cancel);
+	connect(buttons, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+	connect(buttons, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+
+	auto *root = new QVBoxLayout(&dlg);
+	root->addLayout(form);
+	root->addWidget(buttons);
+
+	if (dlg.exec() != QDialog::Accepted)
+		return;
+
+	if (full_check->isChecked())
+		v->setSceneCrop(row, 0.0f, 0.0f, 0.0f);
+	else
+		v->setSceneCrop(row, (float)x_spin->value(),
+				(float)y_spin->value(), (float)w_spin->value());
+	emit scenesModified();
+}
+
+/* ====================================================================
+ * RecastVerticalSettingsDialog
+ * ==================================================================== */
+
+RecastVerticalSettingsDialog::RecastVerticalSettingsDialog(QWidget *parent)
+	: QDialog(parent)
+{
+	setWindowTitle(obs_module_text("Recast.Vertical.CanvasSettings"));
+	setMinimumWidth(320);
+
+	RecastVertical *v = RecastVertical::instance();
+	auto *form = new QFormLayout;
+
+	/* Frame rate as a divisor of the main rate */
+	struct obs_video_info ovi = {};
+	obs_get_video_info(&ovi);
+	double main_fps = ovi.fps_den ? (double)ovi.fps_num / ovi.fps_den : 0.0;
+
+	fps_combo_ = new QComboBox;
+	for (int div = 1; div <= 4; div++) {
+		QString label = QString("%1 fps").arg(main_fps / div, 0, 'g', 4);
+		if (div == 1)
+			label += QString(" (%1)").arg(
+				obs_module_text("Recast.Vertical.FpsMain"));
+		fps_combo_->addItem(label, div);
+	}
+	fps_combo_->setCurrentIndex(v->fpsDivisor() - 1);
+	fps_combo_->setEnabled(RECAST_HAVE_FPS_DIVISOR);
+	form->addRow(obs_module_text("Recast.Vertical.Fps"), fps_combo_);
+
+	/* Output resolution: the canvas, or GPU-scaled down from it */
+	int cw = v->canvasWidth();
+	int ch = v->canvasHeight();
+	size_combo_ = new QComboBox;
+	size_combo_->addItem(QString("%1x%2").arg(cw).arg(ch), QSize(0, 0));
+	const int fractions[][2] = {{2, 3}, {1, 2}};
+	for (const auto &f : fractions) {
+		QSize s((cw * f[0] / f[1]) & ~1, (ch * f[0] / f[1]) & ~1);
+		size_combo_->addItem(
+			QString("%1x%2").arg(s.width()).arg(s.height()), s);
+	}
+	if (v->outputWidth() != cw || v->outputHeight() != ch) {
+		QSize cur(v->outputWidth(), v->outputHeight());
+		int idx = size_combo_->findData(cur);
+		if (idx < 0) {
+			size_combo_->addItem(QString("%1x%2")
+						     .arg(cur.width())
+						     .arg(cur.height()),
+					     cur);
+			idx = size_combo_->count() - 1;
+		}
+		size_combo_->setCurrentIndex(idx);
+	}
+	form->addRow(obs_module_text("Recast.Vertical.OutputSize"),
+		     size_combo_);
+
+	scale_combo_ = new QComboBox;
+	scale_combo_->addItem("Bilinear", (int)OBS_SCALE_BILINEAR);
+	scale_combo_->addItem("Bicubic", (int)OBS_SCALE_BICUBIC);
+	scale_combo_->addItem("Lanczos", (int)OBS_SCALE_LANCZOS);
+	scale_combo_->addItem("Area", (int)OBS_SCALE_AREA);
+	int scale_idx = scale_combo_->findData((int)v->scaleType());
+	scale_combo_->setCurrentIndex(scale_idx >= 0 ? scale_idx : 1);
+	form->addRow(obs_module_text("Recast.Vertical.ScaleFilter"),
+		     scale_combo_);
+
+	/* Crop-from-main: one blit of the main program plus overlays */
+	crop_check_ = new QCheckBox(obs_module_text("Recast.Vertical.CropMode"));
+	crop_check_->setToolTip(obs_module_text("Recast.Vertical.CropModeTip"));
+	crop_check_->setChecked(v->cropMode());
+	form->addRow(crop_check_);
+
+	crop_pan_spin_ = new QSpinBox;
+	crop_pan_spin_->setRange(0, 5000);
+	crop_pan_spin_->setSingleStep(100);
+	crop_pan_spin_->setSuffix(" ms");
+	crop_pan_spin_->setValue(v->cropPanMs());
+	crop_pan_spin_->setEnabled(v->cropMode());
+	connect(crop_check_, &QCheckBox::toggled, crop_pan_spin_,
+		&QWidget::setEnabled);
+	form->addRow(obs_module_text("Recast.Vertical.CropPan"),
+		     crop_pan_spin_);
+
+	auto *buttons =
+		new QDialogButtonBox(QDialogButtonBox::Ok |
+				     QDialogButtonBox::Cancel);
+	connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+	connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+	auto *root = new QVBoxLayout(this);
+	root->addLayout(form);
+	root->addWidget(buttons);
+}
+
+int RecastVerticalSettingsDialog::getFpsDivisor() const
+{
+	return fps_combo_->currentData().toInt();
+}
+
+QSize RecastVerticalSettingsDialog::getOutputSize() const
+{
+	return size_combo_->currentData().toSize();
+}
+
+enum obs_scale_type RecastVerticalSettingsDialog::getScaleType() const
+{
+	return (enum obs_scale_type)scale_combo_->currentData().toInt();
+}
+
+bool RecastVerticalSettingsDialog::getCropMode() const
+{
+	return crop_check_->isChecked();
+}
+
+int RecastVerticalSettingsDialog::getCropPanMs() const
+{
+	return crop_pan_spin_->value();
+}
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialog>
+#include <QSpinBox>
 #include <QListWidget>
 #include <QPushButton>
 #include <QWidget>
 
+extern "C" {
+#include <obs.h>
+}
+
 /*
  * RecastVerticalScenesDock -- Always-present scenes dock for vertical canvas.
  *
@@ -35,4 +43,32 @@ private:
 	QListWidget *list_;
 	QPushButton *add_btn_;
 	QPushButton *remove_btn_;
+
+	void showCanvasSettings();
+	void showCropDialog(int row);
+};
+
+/*
+ * RecastVerticalSettingsDialog -- Frame rate divisor, output resolution
+ * and scale filter of the vertical canvas output, plus crop-from-main.
+ */
+
+class RecastVerticalSettingsDialog : public QDialog {
+	Q_OBJECT
+
+public:
+	explicit RecastVerticalSettingsDialog(QWidget *parent = nullptr);
+
+	int getFpsDivisor() const;
+	QSize getOutputSize() const; /* (0, 0) = canvas size */
+	enum obs_scale_type getScaleType() const;
+	bool getCropMode() const;
+	int getCropPanMs() const;
+
+private:
+	QComboBox *fps_combo_;
+	QComboBox *size_combo_;
+	QComboBox *scale_combo_;
+	QCheckBox *crop_check_;
+	QSpinBox *crop_pan_spin_;
 };
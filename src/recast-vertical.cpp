@@ -2,24 +2,49 @@
  * recast-vertical.cpp -- Singleton vertical canvas controller.
  *
  * Owns the 1080x1920 canvas with its own scene model, obs_view_t,
- * and video_t pipeline. Always running for preview. Provides a
- * shared encoder for multistream destinations targeting vertical.
+ * and video_t pipeline. The view is only bound while a destination
+ * holds a pooled encoder or the preview is visible. Provides pooled
+ * encoders for multistream destinations targeting vertical.
+ *
+ * The view renders a private proxy source that composites the active
+ * scene into a texrender once per frame; the preview dock samples the
+ * same texture so heavy scenes are only composited once.
+ *
+ * With prewarm enabled, the scenes linked to the main program and
+ * preview scenes stay active under the proxy (at most PREWARM_MAX), so
+ * mirrored cuts land on an already running scene.
+ *
+ * Scene items are created lazily: the active scene at load, any other
+ * scene when it becomes active or warm, and the rest from a low-rate
+ * timer so startup does not pay for every source at once.
  */
 
 #include "recast-vertical.h"
+#include "recast-perf.h"
+
+#include <algorithm>
 
 extern "C" {
 #include <obs-module.h>
+#include <graphics/vec4.h>
 #include <util/platform.h>
 #include "recast-config.h"
 }
 
 RecastVertical *RecastVertical::instance_ = nullptr;
 
+static const size_t PREWARM_MAX = 3;
+static const int LAZY_LOAD_INTERVAL_MS = 250;
+
 RecastVertical::RecastVertical(QObject *parent)
 	: QObject(parent)
 {
 	scene_model_ = recast_scene_model_create();
+
+	lazy_load_timer_ = new QTimer(this);
+	lazy_load_timer_->setInterval(LAZY_LOAD_INTERVAL_MS);
+	connect(lazy_load_timer_, &QTimer::timeout, this,
+		&RecastVertical::loadNextPendingScene);
 }
 
 RecastVertical::~RecastVertical()
@@ -40,8 +65,13 @@ RecastVertical *RecastVertical::instance()
 
 void RecastVertical::destroyInstance()
 {
-	delete instance_;
+	/* Draw callbacks run under the graphics lock; clearing the pointer
+	 * inside it keeps them from reaching a dying instance. */
+	RecastVertical *v = instance_;
+	obs_enter_graphics();
 	instance_ = nullptr;
+	obs_leave_graphics();
+	delete v;
 }
 
 /* ---- Scene model wrappers ---- */
@@ -86,6 +116,7 @@ void RecastVertical::removeScene(int idx)
 
 	recast_scene_model_remove_scene(scene_model_, idx);
 	bindActiveSceneToView();
+	updateWarmScenes();
 	emit scenesModified();
 	emit activeSceneChanged(scene_model_->active_scene_idx);
 }
@@ -104,6 +135,7 @@ void RecastVertical::setActiveScene(int idx)
 	if (!scene_model_)
 		return;
 
+	ensureSceneLoaded(idx);
 	recast_scene_model_set_active(scene_model_, idx);
 	bindActiveSceneToView();
 	emit activeSceneChanged(idx);
@@ -115,6 +147,7 @@ void RecastVertical::linkScene(int idx, const char *main_scene_name)
 		return;
 
 	recast_scene_model_link_scene(scene_model_, idx, main_scene_name);
+	updateWarmScenes();
 	emit scenesModified();
 }
 
@@ -130,6 +163,8 @@ const char *RecastVertical::sceneLinkedMain(int idx) const
 void RecastVertical::initialize()
 {
 	setupView();
+	setupTransition();
+	updateWarmScenes();
 	obs_frontend_add_event_callback(onFrontendEvent, this);
 	blog(LOG_INFO, "[Recast] Vertical canvas initialized (%dx%d)",
 	     canvas_width_, canvas_height_);
@@ -138,15 +173,33 @@ void RecastVertical::initialize()
 void RecastVertical::shutdown()
 {
 	obs_frontend_remove_event_callback(onFrontendEvent, this);
+	lazy_load_timer_->stop();
 
-	/* Release shared encoder */
-	if (shared_video_encoder_) {
-		obs_encoder_release(shared_video_encoder_);
-		shared_video_encoder_ = nullptr;
-		shared_encoder_refs_ = 0;
+	/* Release pooled encoders */
+	if (encoder_pool_) {
+		recast_encoder_pool_destroy(encoder_pool_);
+		encoder_pool_ = nullptr;
 	}
 
 	teardownView();
+
+	setWarmScenes({});
+	setCanvasScene(nullptr);
+	if (transition_) {
+		obs_source_release(transition_);
+		transition_ = nullptr;
+	}
+	if (canvas_source_) {
+		obs_source_release(canvas_source_);
+		canvas_source_ = nullptr;
+	}
+	if (canvas_texrender_) {
+		obs_enter_graphics();
+		gs_texrender_destroy(canvas_texrender_);
+		obs_leave_graphics();
+		canvas_texrender_ = nullptr;
+	}
+
 	blog(LOG_INFO, "[Recast] Vertical canvas shut down");
 }
 
@@ -157,14 +210,30 @@ void RecastVertical::setupView()
 
 	view_ = obs_view_create();
 
+	if (!canvas_source_) {
+		canvas_source_ = obs_source_create_private(
+			"recast_vertical_canvas", "Recast Vertical Canvas",
+			nullptr);
+		if (!canvas_source_)
+			blog(LOG_WARNING,
+			     "[Recast] Canvas proxy unavailable, preview will "
+			     "render the scene directly");
+	}
+
 	struct obs_video_info ovi;
 	obs_get_video_info(&ovi);
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		canvas_fps_num_ = ovi.fps_num ? ovi.fps_num : 30;
+		canvas_fps_den_ = ovi.fps_den ? ovi.fps_den : 1;
+	}
 
 	struct obs_video_info custom_ovi = ovi;
 	custom_ovi.base_width = (uint32_t)canvas_width_;
 	custom_ovi.base_height = (uint32_t)canvas_height_;
-	custom_ovi.output_width = (uint32_t)canvas_width_;
-	custom_ovi.output_height = (uint32_t)canvas_height_;
+	custom_ovi.output_width = (uint32_t)outputWidth();
+	custom_ovi.output_height = (uint32_t)outputHeight();
+	custom_ovi.scale_type = scale_type_;
 
 	video_ = obs_view_add2(view_, &custom_ovi);
 	if (!video_) {
@@ -175,10 +244,63 @@ void RecastVertical::setupView()
 		return;
 	}
 
+	if (fps_divisor_ > 1 || output_width_ > 0)
+		blog(LOG_INFO,
+		     "[Recast] Vertical output %dx%d at 1/%d of %u/%u fps",
+		     outputWidth(), outputHeight(), fps_divisor_,
+		     ovi.fps_num, ovi.fps_den);
+
 	/* Bind active scene if we have one */
 	bindActiveSceneToView();
 }
 
+/* Output at canvas size (stored as 0x0), or smaller; keep the encoders'
+ * even sizes */
+static void clamp_output_size(int &width, int &height, int canvas_width,
+			      int canvas_height)
+{
+	if (width <= 0 || height <= 0 || width >= canvas_width ||
+	    height >= canvas_height) {
+		width = 0;
+		height = 0;
+	} else {
+		width &= ~1;
+		height &= ~1;
+	}
+}
+
+bool RecastVertical::setVideoSettings(int fps_divisor, int output_width,
+				      int output_height,
+				      enum obs_scale_type scale)
+{
+	if (recast_encoder_pool_active_refs(encoder_pool_) > 0) {
+		blog(LOG_WARNING,
+		     "[Recast] Vertical video settings not changed: "
+		     "vertical encoders are in use");
+		return false;
+	}
+
+#if !RECAST_HAVE_FPS_DIVISOR
+	fps_divisor = 1;
+#endif
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		fps_divisor_ = fps_divisor < 1 ? 1
+			     : fps_divisor > 4 ? 4
+					       : fps_divisor;
+	}
+
+	clamp_output_size(output_width, output_height, canvas_width_,
+			  canvas_height_);
+	output_width_ = output_width;
+	output_height_ = output_height;
+	scale_type_ = scale;
+
+	teardownView();
+	setupView();
+	return true;
+}
+
 void RecastVertical::teardownView()
 {
 	if (view_ && video_) {
@@ -190,9 +312,10 @@ void RecastVertical::teardownView()
 		obs_view_destroy(view_);
 		view_ = nullptr;
 	}
+	view_bound_ = false;
 }
 
-void RecastVertical::bindActiveSceneToView()
+void RecastVertical::bindActiveSceneToView(bool animate)
 {
 	if (!view_)
 		return;
@@ -200,12 +323,593 @@ void RecastVertical::bindActiveSceneToView()
 	obs_source_t *src = scene_model_
 		? recast_scene_model_get_active_source(scene_model_)
 		: nullptr;
-	obs_view_set_source(view_, 0, src);
+	bool consumed = hasConsumers();
+
+	/* Through the transition, only animate when someone sees it and
+	 * something was showing before */
+	obs_source_t *draw = src;
+	if (transition_) {
+		obs_source_t *cur = obs_transition_get_active_source(transition_);
+		if (cur != src) {
+			if (animate && consumed && view_bound_ && cur && src)
+				obs_transition_start(
+					transition_, OBS_TRANSITION_MODE_AUTO,
+					(uint32_t)obs_frontend_get_transition_duration(),
+					src);
+			else
+				obs_transition_set(transition_, src);
+		}
+		obs_source_release(cur);
+		if (src)
+			draw = transition_;
+	}
+	setCanvasScene(draw);
+	if (crop_mode_)
+		updateCropTarget(animate);
+
+	/* Nobody is watching or encoding: leave the view empty so the
+	 * canvas costs nothing. Binding again takes effect next frame. */
+	obs_view_set_source(view_, 0,
+			    consumed ? (canvas_source_ ? canvas_source_ : draw)
+				     : nullptr);
+
+	if (consumed != view_bound_) {
+		view_bound_ = consumed;
+		blog(LOG_INFO, "[Recast] Vertical canvas %s",
+		     consumed ? "resumed" : "paused (no consumers)");
+	}
+}
+
+/* ---- Demand-driven activation ---- */
+
+bool RecastVertical::hasConsumers() const
+{
+	return preview_visible_ ||
+	       recast_encoder_pool_active_refs(encoder_pool_) > 0;
+}
+
+void RecastVertical::setPreviewVisible(bool visible)
+{
+	if (preview_visible_ == visible)
+		return;
+	preview_visible_ = visible;
+	bindActiveSceneToView();
+}
+
+void RecastVertical::setCanvasScene(obs_source_t *scene)
+{
+	obs_source_t *old;
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		if (canvas_scene_ == scene)
+			return;
+		old = canvas_scene_;
+		canvas_scene_ = scene ? obs_source_get_ref(scene) : nullptr;
+		scene = canvas_scene_;
+	}
+
+	/* Keep the proxy's activation tree in sync with what it draws */
+	if (canvas_source_) {
+		if (scene)
+			obs_source_add_active_child(canvas_source_, scene);
+		if (old)
+			obs_source_remove_active_child(canvas_source_, old);
+	}
+	obs_source_release(old);
 }
 
-/* ---- Shared encoder ---- */
+/* ---- Mirrored cuts ---- */
 
-obs_encoder_t *RecastVertical::acquireSharedEncoder()
+void RecastVertical::setPrewarmLinked(bool enabled)
+{
+	if (prewarm_linked_ == enabled)
+		return;
+	prewarm_linked_ = enabled;
+	updateWarmScenes();
+	blog(LOG_INFO, "[Recast] Vertical prewarm of linked scenes %s",
+	     enabled ? "enabled" : "disabled");
+}
+
+void RecastVertical::setFollowTransition(bool enabled)
+{
+	if (follow_transition_ == enabled)
+		return;
+	follow_transition_ = enabled;
+	setupTransition();
+}
+
+/* Index of the vertical scene linked to a main scene, or -1 */
+static int linked_target(const recast_scene_model_t *model,
+			 obs_source_t *main_scene)
+{
+	if (!model || !main_scene)
+		return -1;
+	return recast_scene_model_find_linked(model,
+					      obs_source_get_name(main_scene));
+}
+
+static bool model_has_source(const recast_scene_model_t *model,
+			     obs_source_t *source)
+{
+	for (int i = 0; model && i < model->scene_count; i++) {
+		if (model->scenes[i].scene_source == source)
+			return true;
+	}
+	return false;
+}
+
+void RecastVertical::updateWarmScenes()
+{
+	std::vector<obs_source_t *> next;
+	if (!prewarm_linked_ || !canvas_source_ || !scene_model_) {
+		setWarmScenes(next);
+		return;
+	}
+
+	auto add = [&](obs_source_t *s) {
+		if (!s || next.size() >= PREWARM_MAX)
+			return;
+		for (obs_source_t *n : next) {
+			if (n == s)
+				return;
+		}
+		next.push_back(s);
+	};
+
+	/* Program and preview targets first, then whatever was warm
+	 * before and still exists, so cutting back stays warm too */
+	obs_source_t *program = obs_frontend_get_current_scene();
+	obs_source_t *preview = obs_frontend_preview_program_mode_active()
+		? obs_frontend_get_current_preview_scene()
+		: nullptr;
+	/* A warm scene must have its items before it goes active */
+	for (obs_source_t *main_scene : {program, preview}) {
+		int idx = linked_target(scene_model_, main_scene);
+		if (idx < 0)
+			continue;
+		ensureSceneLoaded(idx);
+		add(scene_model_->scenes[idx].scene_source);
+	}
+	obs_source_release(program);
+	obs_source_release(preview);
+
+	for (obs_source_t *s : warm_scenes_) {
+		if (model_has_source(scene_model_, s))
+			add(s);
+	}
+
+	setWarmScenes(next);
+}
+
+void RecastVertical::setWarmScenes(const std::vector<obs_source_t *> &next)
+{
+	auto contains = [](const std::vector<obs_source_t *> &v,
+			   obs_source_t *s) {
+		for (obs_source_t *x : v) {
+			if (x == s)
+				return true;
+		}
+		return false;
+	};
+
+	std::vector<obs_source_t *> added, old;
+	std::vector<obs_source_t *> refs;
+	for (obs_source_t *s : next) {
+		if (contains(warm_scenes_, s))
+			refs.push_back(s);
+		else if (obs_source_t *ref = obs_source_get_ref(s)) {
+			refs.push_back(ref);
+			added.push_back(ref);
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		for (obs_source_t *s : warm_scenes_) {
+			if (!contains(refs, s))
+				old.push_back(s);
+		}
+		warm_scenes_.swap(refs);
+	}
+
+	for (obs_source_t *s : added)
+		obs_source_add_active_child(canvas_source_, s);
+	for (obs_source_t *s : old) {
+		obs_source_remove_active_child(canvas_source_, s);
+		obs_source_release(s);
+	}
+}
+
+void RecastVertical::setupTransition()
+{
+	obs_source_t *next = nullptr;
+	obs_source_t *main = follow_transition_
+		? obs_frontend_get_current_transition()
+		: nullptr;
+	if (main) {
+		obs_data_t *settings = obs_source_get_settings(main);
+		next = obs_source_create_private(obs_source_get_id(main),
+						 "Recast Vertical Transition",
+						 settings);
+		obs_data_release(settings);
+		if (next) {
+			obs_transition_set_size(next, (uint32_t)canvas_width_,
+						(uint32_t)canvas_height_);
+			obs_transition_set_alignment(next, OBS_ALIGN_CENTER);
+			obs_transition_set_scale_type(
+				next, OBS_TRANSITION_SCALE_ASPECT);
+			blog(LOG_INFO,
+			     "[Recast] Vertical cuts follow main transition "
+			     "'%s'",
+			     obs_source_get_id(main));
+		} else {
+			blog(LOG_WARNING,
+			     "[Recast] Could not copy main transition '%s', "
+			     "vertical cuts will be hard swaps",
+			     obs_source_get_id(main));
+		}
+		obs_source_release(main);
+	}
+
+	if (!next && !transition_)
+		return;
+
+	obs_source_t *old = transition_;
+	transition_ = next;
+	bindActiveSceneToView();
+	obs_source_release(old);
+}
+
+/* ---- Crop from main ---- */
+
+void RecastVertical::setCropMode(bool enabled)
+{
+	if (crop_mode_ == enabled)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		crop_mode_ = enabled;
+		crop_valid_ = false;
+	}
+	bindActiveSceneToView();
+	blog(LOG_INFO, "[Recast] Vertical crop-from-main %s",
+	     enabled ? "enabled" : "disabled");
+}
+
+void RecastVertical::setCropPanMs(int ms)
+{
+	std::lock_guard<std::mutex> lock(canvas_mutex_);
+	crop_pan_ms_ = ms < 0 ? 0 : ms;
+}
+
+void RecastVertical::setSceneCrop(int idx, float x, float y, float w)
+{
+	if (!scene_model_)
+		return;
+	recast_scene_model_set_crop(scene_model_, idx, x, y, w);
+	if (crop_mode_ && idx == scene_model_->active_scene_idx)
+		updateCropTarget(true);
+}
+
+/* The scene's window in main canvas pixels, at the vertical aspect
+ * ratio and kept inside the main canvas */
+RecastVertical::CropRect RecastVertical::sceneCropRect(int idx) const
+{
+	struct obs_video_info ovi = {};
+	obs_get_video_info(&ovi);
+	float bw = (float)ovi.base_width;
+	float bh = (float)ovi.base_height;
+	float aspect = (float)canvas_width_ / (float)canvas_height_;
+
+	const recast_scene_entry_t *e =
+		scene_model_ && idx >= 0 && idx < scene_model_->scene_count
+			? &scene_model_->scenes[idx]
+			: nullptr;
+
+	CropRect r;
+	if (e && e->crop_w > 0.0f) {
+		r.w = e->crop_w;
+		r.h = r.w / aspect;
+	} else {
+		r.h = bh;
+		r.w = r.h * aspect;
+	}
+	if (r.w > bw) {
+		r.w = bw;
+		r.h = r.w / aspect;
+	}
+	if (r.h > bh) {
+		r.h = bh;
+		r.w = r.h * aspect;
+	}
+
+	if (e && e->crop_w > 0.0f) {
+		r.x = std::clamp(e->crop_x, 0.0f, bw - r.w);
+		r.y = std::clamp(e->crop_y, 0.0f, bh - r.h);
+	} else {
+		r.x = (bw - r.w) * 0.5f;
+		r.y = (bh - r.h) * 0.5f;
+	}
+	return r;
+}
+
+RecastVertical::CropRect
+RecastVertical::currentCropLocked(uint64_t now_ns) const
+{
+	uint64_t dur_ns = (uint64_t)crop_pan_ms_ * 1000000ULL;
+	if (!dur_ns || now_ns >= crop_start_ns_ + dur_ns)
+		return crop_to_;
+
+	float t = now_ns > crop_start_ns_
+		? (float)(now_ns - crop_start_ns_) / (float)dur_ns
+		: 0.0f;
+	t = t * t * (3.0f - 2.0f * t); /* ease in/out */
+
+	auto lerp = [t](float a, float b) { return a + (b - a) * t; };
+	return {lerp(crop_from_.x, crop_to_.x), lerp(crop_from_.y, crop_to_.y),
+		lerp(crop_from_.w, crop_to_.w), lerp(crop_from_.h, crop_to_.h)};
+}
+
+void RecastVertical::updateCropTarget(bool animate)
+{
+	CropRect target = sceneCropRect(activeSceneIndex());
+	uint64_t now = os_gettime_ns();
+
+	std::lock_guard<std::mutex> lock(canvas_mutex_);
+	if (crop_valid_ && target.x == crop_to_.x && target.y == crop_to_.y &&
+	    target.w == crop_to_.w && target.h == crop_to_.h)
+		return;
+
+	if (!crop_valid_ || !animate || crop_pan_ms_ <= 0) {
+		crop_from_ = target;
+	} else {
+		/* Start from wherever a running pan currently is */
+		crop_from_ = currentCropLocked(now);
+	}
+	crop_to_ = target;
+	crop_start_ns_ = now;
+	crop_valid_ = true;
+}
+
+/* Graphics thread, inside the canvas texrender */
+void RecastVertical::drawMainCrop(uint32_t cx, uint32_t cy)
+{
+	gs_texture_t *main_tex = obs_get_main_texture();
+	if (!main_tex)
+		return;
+
+	CropRect r;
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		if (!crop_valid_)
+			return;
+		r = currentCropLocked(obs_get_video_frame_time());
+	}
+
+	uint32_t x = (uint32_t)std::max(r.x, 0.0f);
+	uint32_t y = (uint32_t)std::max(r.y, 0.0f);
+	uint32_t w = (uint32_t)r.w;
+	uint32_t h = (uint32_t)r.h;
+	if (!w || !h)
+		return;
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(true);
+
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture_srgb(image, main_tex);
+
+	gs_matrix_push();
+	gs_matrix_scale3f((float)cx / (float)w, (float)cy / (float)h, 1.0f);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprite_subregion(main_tex, 0, x, y, w, h);
+	gs_matrix_pop();
+
+	gs_enable_framebuffer_srgb(previous);
+}
+
+/* ---- Composited canvas ---- */
+
+gs_texture_t *RecastVertical::renderCanvasTexture()
+{
+	uint64_t frame_ts = obs_get_video_frame_time();
+	if (canvas_texrender_ && frame_ts == canvas_frame_ts_)
+		return gs_texrender_get_texture(canvas_texrender_);
+
+	int divisor;
+	uint32_t fps_num, fps_den;
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		divisor = fps_divisor_;
+		fps_num = canvas_fps_num_;
+		fps_den = canvas_fps_den_;
+	}
+
+	/* Encoders only take one frame in every fps_divisor_. Frames are
+	 * grouped by their position on the video clock, so a lagged frame
+	 * does not shift which frames get composited; the first frame
+	 * rendered in a group composites and the rest reuse it. */
+	if (!canvas_texrender_ || divisor <= 1 || frame_ts < canvas_base_ts_)
+		canvas_base_ts_ = frame_ts;
+	uint64_t group = UINT64_MAX;
+	if (divisor > 1) {
+		uint64_t frame_ns = 1000000000ULL * fps_den;
+		uint64_t index = ((frame_ts - canvas_base_ts_) * fps_num +
+				  frame_ns / 2) /
+				 frame_ns;
+		group = index / (uint64_t)divisor;
+		if (canvas_texrender_ && group == canvas_frame_group_) {
+			canvas_frame_ts_ = frame_ts;
+			return gs_texrender_get_texture(canvas_texrender_);
+		}
+	}
+
+	obs_source_t *scene = nullptr;
+	bool crop;
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		if (canvas_scene_)
+			scene = obs_source_get_ref(canvas_scene_);
+		crop = crop_mode_;
+	}
+	if (!scene && !crop)
+		return nullptr;
+
+	RECAST_PERF_SCOPE(RECAST_PERF_VERTICAL_RENDER);
+
+	if (!canvas_texrender_)
+		canvas_texrender_ = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+	uint32_t cx = (uint32_t)canvas_width_;
+	uint32_t cy = (uint32_t)canvas_height_;
+
+	gs_texrender_reset(canvas_texrender_);
+	if (gs_texrender_begin(canvas_texrender_, cx, cy)) {
+		struct vec4 clear;
+		vec4_zero(&clear);
+		gs_clear(GS_CLEAR_COLOR, &clear, 0.0f, 0);
+		gs_ortho(0.0f, (float)cx, 0.0f, (float)cy, -100.0f, 100.0f);
+
+		/* Crop mode: the main program underneath, overlays on top */
+		if (crop)
+			drawMainCrop(cx, cy);
+		if (scene)
+			obs_source_video_render(scene);
+
+		gs_texrender_end(canvas_texrender_);
+	}
+	canvas_frame_ts_ = frame_ts;
+	canvas_frame_group_ = group;
+
+	obs_source_release(scene);
+	return gs_texrender_get_texture(canvas_texrender_);
+}
+
+gs_texture_t *RecastVertical::canvasTextureCallback(void *)
+{
+	/* The preview may outlive the controller; go through instance_ */
+	return instance_ ? instance_->renderCanvasTexture() : nullptr;
+}
+
+/* ---- Canvas proxy source ---- */
+
+const char *RecastVertical::canvasGetName(void *)
+{
+	return "Recast Vertical Canvas";
+}
+
+void *RecastVertical::canvasCreate(obs_data_t *, obs_source_t *)
+{
+	return instance_;
+}
+
+void RecastVertical::canvasDestroy(void *) {}
+
+uint32_t RecastVertical::canvasGetWidth(void *data)
+{
+	auto *self = static_cast<RecastVertical *>(data);
+	return self ? (uint32_t)self->canvas_width_ : 0;
+}
+
+uint32_t RecastVertical::canvasGetHeight(void *data)
+{
+	auto *self = static_cast<RecastVertical *>(data);
+	return self ? (uint32_t)self->canvas_height_ : 0;
+}
+
+void RecastVertical::canvasVideoRender(void *data, gs_effect_t *)
+{
+	auto *self = static_cast<RecastVertical *>(data);
+	if (!self)
+		return;
+
+	gs_texture_t *tex = self->renderCanvasTexture();
+	if (!tex)
+		return;
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(true);
+
+	gs_effect_t *effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture_srgb(image, tex);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+	while (gs_effect_loop(effect, "Draw"))
+		gs_draw_sprite(tex, 0, (uint32_t)self->canvas_width_,
+			       (uint32_t)self->canvas_height_);
+	gs_blend_state_pop();
+
+	gs_enable_framebuffer_srgb(previous);
+}
+
+void RecastVertical::canvasEnumActive(void *data,
+				      obs_source_enum_proc_t enum_callback,
+				      void *param)
+{
+	auto *self = static_cast<RecastVertical *>(data);
+	if (!self || !self->canvas_source_)
+		return;
+
+	obs_source_t *scene = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(self->canvas_mutex_);
+		if (self->canvas_scene_)
+			scene = obs_source_get_ref(self->canvas_scene_);
+	}
+	if (scene) {
+		enum_callback(self->canvas_source_, scene, param);
+		obs_source_release(scene);
+	}
+
+	std::vector<obs_source_t *> warm;
+	{
+		std::lock_guard<std::mutex> lock(self->canvas_mutex_);
+		for (obs_source_t *s : self->warm_scenes_)
+			warm.push_back(obs_source_get_ref(s));
+	}
+	for (obs_source_t *s : warm) {
+		if (s) {
+			enum_callback(self->canvas_source_, s, param);
+			obs_source_release(s);
+		}
+	}
+}
+
+void RecastVertical::registerCanvasSource()
+{
+	struct obs_source_info info = {};
+	info.id = "recast_vertical_canvas";
+	info.type = OBS_SOURCE_TYPE_INPUT;
+	info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW |
+			    OBS_SOURCE_CAP_DISABLED;
+	info.get_name = canvasGetName;
+	info.create = canvasCreate;
+	info.destroy = canvasDestroy;
+	info.get_width = canvasGetWidth;
+	info.get_height = canvasGetHeight;
+	info.video_render = canvasVideoRender;
+	info.enum_active_sources = canvasEnumActive;
+	obs_register_source(&info);
+}
+
+/* ---- Pooled encoders ---- */
+
+obs_encoder_t *RecastVertical::acquireSharedEncoder(
+	const recast_encoder_settings_t *settings)
+{
+	return acquireEncoder(settings, false);
+}
+
+obs_encoder_t *RecastVertical::acquireDedicatedEncoder(
+	const recast_encoder_settings_t *settings)
+{
+	return acquireEncoder(settings, true);
+}
+
+obs_encoder_t *RecastVertical::acquireEncoder(
+	const recast_encoder_settings_t *settings, bool exclusive)
 {
 	if (!video_) {
 		blog(LOG_ERROR,
@@ -213,44 +917,56 @@ obs_encoder_t *RecastVertical::acquireSharedEncoder()
 		return nullptr;
 	}
 
-	if (!shared_video_encoder_) {
-		obs_data_t *enc_settings = obs_data_create();
-		obs_data_set_int(enc_settings, "bitrate", 4000);
-		obs_data_set_string(enc_settings, "rate_control", "CBR");
-
-		shared_video_encoder_ = obs_video_encoder_create(
-			"obs_x264", "recast_vertical_venc",
-			enc_settings, nullptr);
-		obs_data_release(enc_settings);
+	if (!encoder_pool_)
+		encoder_pool_ = recast_encoder_pool_create("recast_vertical_venc");
 
-		if (!shared_video_encoder_) {
-			blog(LOG_ERROR,
-			     "[Recast] Failed to create shared vertical encoder");
-			return nullptr;
-		}
+	recast_encoder_settings_t defaults;
+	if (!settings) {
+		recast_encoder_settings_init(&defaults);
+		settings = &defaults;
+	}
 
-		obs_encoder_set_video(shared_video_encoder_, video_);
-		blog(LOG_INFO,
-		     "[Recast] Created shared vertical encoder");
+	/* Pacing is a canvas property; scaling a destination to the
+	 * output size it already gets is a no-op */
+	recast_encoder_settings_t s = *settings;
+	s.fps_divisor = fps_divisor_;
+	if (s.scaled_width >= outputWidth() ||
+	    s.scaled_height >= outputHeight()) {
+		s.scaled_width = 0;
+		s.scaled_height = 0;
 	}
 
-	shared_encoder_refs_++;
-	return shared_video_encoder_;
+	obs_encoder_t *enc =
+		exclusive ? recast_encoder_pool_acquire_exclusive(
+				    encoder_pool_, video_, &s)
+			  : recast_encoder_pool_acquire(encoder_pool_, video_,
+							&s);
+
+	/* Bind before the output starts pulling frames */
+	if (enc && !view_bound_)
+		bindActiveSceneToView();
+	return enc;
 }
 
-void RecastVertical::releaseSharedEncoder()
+void RecastVertical::releaseSharedEncoder(obs_encoder_t *encoder)
 {
-	if (shared_encoder_refs_ <= 0)
+	if (!encoder_pool_ || !encoder)
 		return;
 
-	shared_encoder_refs_--;
-
-	if (shared_encoder_refs_ == 0 && shared_video_encoder_) {
-		obs_encoder_release(shared_video_encoder_);
-		shared_video_encoder_ = nullptr;
-		blog(LOG_INFO,
-		     "[Recast] Released shared vertical encoder (no more refs)");
+	if (!recast_encoder_pool_release(encoder_pool_, encoder)) {
+		blog(LOG_WARNING,
+		     "[Recast] Released encoder not owned by vertical pool");
+		return;
 	}
+
+	if (view_bound_ && !hasConsumers())
+		bindActiveSceneToView();
+}
+
+bool RecastVertical::setEncoderBitrate(obs_encoder_t *encoder, int kbps)
+{
+	return encoder_pool_ &&
+	       recast_encoder_pool_set_bitrate(encoder_pool_, encoder, kbps);
 }
 
 /* ---- Frontend event handler ---- */
@@ -258,8 +974,23 @@ void RecastVertical::releaseSharedEncoder()
 void RecastVertical::onFrontendEvent(enum obs_frontend_event event, void *data)
 {
 	auto *self = static_cast<RecastVertical *>(data);
-	if (event == OBS_FRONTEND_EVENT_SCENE_CHANGED)
+	switch (event) {
+	case OBS_FRONTEND_EVENT_SCENE_CHANGED:
 		self->handleMainSceneChanged();
+		self->updateWarmScenes();
+		break;
+	case OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED:
+		self->updateWarmScenes();
+		break;
+	case OBS_FRONTEND_EVENT_TRANSITION_CHANGED:
+		if (self->follow_transition_)
+			self->setupTransition();
+		break;
+	default:
+		break;
+	}
 }
 
 void RecastVertical::handleMainSceneChanged()
@@ -277,8 +1008,9 @@ void RecastVertical::handleMainSceneChanged()
 
 	if (linked_idx >= 0 &&
 	    linked_idx != scene_model_->active_scene_idx) {
+		ensureSceneLoaded(linked_idx);
 		recast_scene_model_set_active(scene_model_, linked_idx);
-		bindActiveSceneToView();
+		bindActiveSceneToView(true);
 		emit activeSceneChanged(linked_idx);
 		blog(LOG_INFO,
 		     "[Recast] Vertical scene auto-switched to %d "
@@ -289,6 +1021,25 @@ void RecastVertical::handleMainSceneChanged()
 	obs_source_release(current);
 }
 
+/* ---- Lazy scene loading ---- */
+
+void RecastVertical::ensureSceneLoaded(int idx)
+{
+	if (scene_model_)
+		recast_config_load_scene_items(scene_model_, idx);
+}
+
+void RecastVertical::loadNextPendingScene()
+{
+	for (int i = 0; scene_model_ && i < scene_model_->scene_count; i++) {
+		if (scene_model_->scenes[i].pending_items) {
+			ensureSceneLoaded(i);
+			return;
+		}
+	}
+	lazy_load_timer_->stop();
+}
+
 /* ---- Config save/load ---- */
 
 void RecastVertical::loadFromConfig(obs_data_t *vertical_data)
@@ -301,6 +1052,42 @@ void RecastVertical::loadFromConfig(obs_data_t *vertical_data)
 	if (canvas_width_ <= 0) canvas_width_ = 1080;
 	if (canvas_height_ <= 0) canvas_height_ = 1920;
 
+	int divisor = (int)obs_data_get_int(vertical_data, "fps_divisor");
+	if (divisor < 1 || divisor > 4 || !RECAST_HAVE_FPS_DIVISOR)
+		divisor = 1;
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		fps_divisor_ = divisor;
+	}
+	output_width_ = (int)obs_data_get_int(vertical_data, "output_width");
+	output_height_ = (int)obs_data_get_int(vertical_data, "output_height");
+	clamp_output_size(output_width_, output_height_, canvas_width_,
+			  canvas_height_);
+	long long scale = obs_data_has_user_value(vertical_data,
+						  "scale_filter")
+				  ? obs_data_get_int(vertical_data,
+						     "scale_filter")
+				  : OBS_SCALE_BICUBIC;
+	scale_type_ = scale >= OBS_SCALE_DISABLE && scale <= OBS_SCALE_AREA
+			      ? (enum obs_scale_type)scale
+			      : OBS_SCALE_BICUBIC;
+
+	{
+		std::lock_guard<std::mutex> lock(canvas_mutex_);
+		crop_mode_ =
+			obs_data_get_bool(vertical_data, "crop_from_main");
+		crop_pan_ms_ =
+			obs_data_has_user_value(vertical_data, "crop_pan_ms")
+				? (int)obs_data_get_int(vertical_data,
+							"crop_pan_ms")
+				: 400;
+		crop_valid_ = false;
+	}
+
+	prewarm_linked_ = obs_data_get_bool(vertical_data, "prewarm_linked");
+	follow_transition_ =
+		obs_data_get_bool(vertical_data, "follow_main_transition");
+
 	/* Load scene model */
 	if (scene_model_) {
 		recast_scene_model_destroy(scene_model_);
@@ -317,10 +1104,13 @@ void RecastVertical::loadFromConfig(obs_data_t *vertical_data)
 
 	if (!scene_model_)
 		scene_model_ = recast_scene_model_create();
+	lazy_load_timer_->start();
 
 	/* Teardown and re-setup view with potentially new resolution */
 	teardownView();
 	setupView();
+	setupTransition();
+	updateWarmScenes();
 
 	emit canvasSizeChanged(canvas_width_, canvas_height_);
 }
@@ -331,6 +1121,14 @@ obs_data_t *RecastVertical::saveToConfig() const
 
 	obs_data_set_int(d, "canvas_width", canvas_width_);
 	obs_data_set_int(d, "canvas_height", canvas_height_);
+	obs_data_set_int(d, "fps_divisor", fps_divisor_);
+	obs_data_set_int(d, "output_width", output_width_);
+	obs_data_set_int(d, "output_height", output_height_);
+	obs_data_set_int(d, "scale_filter", scale_type_);
+	obs_data_set_bool(d, "crop_from_main", crop_mode_);
+	obs_data_set_int(d, "crop_pan_ms", crop_pan_ms_);
+	obs_data_set_bool(d, "prewarm_linked", prewarm_linked_);
+	obs_data_set_bool(d, "follow_main_transition", follow_transition_);
 
 	if (scene_model_) {
 		obs_data_t *sm = recast_config_save_scene_model(scene_model_);
@@ -363,17 +1161,36 @@ video_t *recast_vertical_get_video(void)
 	return v ? v->getOutputVideo() : nullptr;
 }
 
-obs_encoder_t *recast_vertical_acquire_encoder(void)
+void recast_vertical_register_source(void)
+{
+	RecastVertical::registerCanvasSource();
+}
+
+obs_encoder_t *recast_vertical_acquire_encoder(
+	const recast_encoder_settings_t *settings)
 {
 	RecastVertical *v = RecastVertical::instance();
-	return v ? v->acquireSharedEncoder() : nullptr;
+	return v ? v->acquireSharedEncoder(settings) : nullptr;
 }
 
-void recast_vertical_release_encoder(void)
+void recast_vertical_release_encoder(obs_encoder_t *encoder)
 {
 	RecastVertical *v = RecastVertical::instance();
 	if (v)
-		v->releaseSharedEncoder();
+		v->releaseSharedEncoder(encoder);
+}
+
+obs_encoder_t *recast_vertical_acquire_dedicated_encoder(
+	const recast_encoder_settings_t *settings)
+{
+	RecastVertical *v = RecastVertical::instance();
+	return v ? v->acquireDedicatedEncoder(settings) : nullptr;
+}
+
+bool recast_vertical_set_encoder_bitrate(obs_encoder_t *encoder, int kbps)
+{
+	RecastVertical *v = RecastVertical::instance();
+	return v && v->setEncoderBitrate(encoder, kbps);
 }
 
 } /* extern "C" */
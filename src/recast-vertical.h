@@ -1,21 +1,45 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
+
+#include <mutex>
+#include <vector>
 
 extern "C" {
 #include <obs.h>
 #include <obs-frontend-api.h>
 #include "recast-scene-model.h"
+#include "recast-encoder-pool.h"
 }
 
 /*
  * RecastVertical -- Singleton controller for the 9:16 vertical canvas.
  *
  * Owns the single recast_scene_model_t, obs_view_t, and video_t
- * for the vertical canvas (always running for preview).
+ * for the vertical canvas. The view only has a source bound while
+ * something consumes it (a pooled encoder is referenced or the preview
+ * is visible); otherwise it composites nothing.
  * Provides getOutputVideo() for multistream destinations targeting
- * the vertical canvas, and manages a shared vertical encoder
- * (ref-counted: created on first start, destroyed on last stop).
+ * the vertical canvas, and owns the vertical encoder pool: destinations
+ * with identical encoder settings share one ref-counted encoder.
+ *
+ * The view is bound to a private "canvas" proxy source that composites
+ * the active scene into a texture at most once per frame. The preview
+ * draws that same texture instead of rendering the scene again.
+ *
+ * Optionally (prewarm), the vertical scenes linked to the main program
+ * and studio-mode preview scenes are kept active as extra children of
+ * the proxy, so a mirrored cut shows them without a cold start. The
+ * proxy can also draw through a private copy of the main transition.
+ *
+ * In crop mode the proxy starts from a crop of the main program texture
+ * (one blit) and draws the active private scene over it, so that scene
+ * only holds overlays. Each scene carries its own crop window; cuts pan
+ * between them.
+ *
+ * Loading a config only creates the sources of the active scene; the
+ * other scenes are filled in on first use or one per tick afterwards.
  */
 
 class RecastVertical : public QObject {
@@ -44,9 +68,61 @@ public:
 	int canvasWidth() const { return canvas_width_; }
 	int canvasHeight() const { return canvas_height_; }
 
-	/* Shared vertical encoder (ref-counted) */
-	obs_encoder_t *acquireSharedEncoder();
-	void releaseSharedEncoder();
+	/* Output pacing and size: vertical encoders take every Nth frame
+	 * of the main rate, and the view GPU-scales the canvas to the
+	 * output size with scale_type. Changing them rebuilds the view, so
+	 * it fails while a vertical encoder is in use. */
+	int fpsDivisor() const { return fps_divisor_; }
+	int outputWidth() const
+	{
+		return output_width_ > 0 ? output_width_ : canvas_width_;
+	}
+	int outputHeight() const
+	{
+		return output_height_ > 0 ? output_height_ : canvas_height_;
+	}
+	enum obs_scale_type scaleType() const { return scale_type_; }
+	bool setVideoSettings(int fps_divisor, int output_width,
+			      int output_height, enum obs_scale_type scale);
+
+	/* Pooled vertical encoders (ref-counted per settings) */
+	obs_encoder_t *acquireSharedEncoder(
+		const recast_encoder_settings_t *settings);
+	void releaseSharedEncoder(obs_encoder_t *encoder);
+
+	/* Unshared pooled encoder whose bitrate can be steered live;
+	 * released with releaseSharedEncoder. */
+	obs_encoder_t *acquireDedicatedEncoder(
+		const recast_encoder_settings_t *settings);
+	bool setEncoderBitrate(obs_encoder_t *encoder, int kbps);
+
+	/* Composited canvas texture for the current frame (graphics thread
+	 * only). Renders the active scene if the view has not done so yet
+	 * this frame. NULL if there is nothing to show. */
+	gs_texture_t *renderCanvasTexture();
+	static gs_texture_t *canvasTextureCallback(void *param);
+
+	/* Demand-driven activation: the preview reports its visibility,
+	 * encoder refs are tracked through the pool. */
+	void setPreviewVisible(bool visible);
+	bool hasConsumers() const;
+
+	/* Mirrored cuts: keep linked targets warm, and cut with a copy of
+	 * the main transition instead of swapping sources. Both opt-in. */
+	void setPrewarmLinked(bool enabled);
+	bool prewarmLinked() const { return prewarm_linked_; }
+	void setFollowTransition(bool enabled);
+	bool followTransition() const { return follow_transition_; }
+
+	/* Crop-from-main mode and per-scene crop windows (main px) */
+	void setCropMode(bool enabled);
+	bool cropMode() const { return crop_mode_; }
+	void setCropPanMs(int ms);
+	int cropPanMs() const { return crop_pan_ms_; }
+	void setSceneCrop(int idx, float x, float y, float w);
+
+	/* Register the private canvas source type (module load) */
+	static void registerCanvasSource();
 
 	/* Initialize/teardown (called from plugin-main) */
 	void initialize();
@@ -74,13 +150,87 @@ private:
 	int canvas_width_ = 1080;
 	int canvas_height_ = 1920;
 
-	/* Shared vertical encoder */
-	obs_encoder_t *shared_video_encoder_ = nullptr;
-	int shared_encoder_refs_ = 0;
+	/* 0 = canvas size */
+	int output_width_ = 0;
+	int output_height_ = 0;
+	int fps_divisor_ = 1; /* written under canvas_mutex_ */
+	enum obs_scale_type scale_type_ = OBS_SCALE_BICUBIC;
+
+	/* Vertical encoder pool */
+	recast_encoder_pool_t *encoder_pool_ = nullptr;
+
+	/* Consumers of the view besides encoders */
+	bool preview_visible_ = false;
+	bool view_bound_ = false;
+
+	/* Canvas proxy bound to the view; canvas_scene_ is what it draws.
+	 * The texrender, frame stamp and frame group are touched on the
+	 * graphics thread only; canvas_fps_* are set by setupView under
+	 * canvas_mutex_. */
+	obs_source_t *canvas_source_ = nullptr;
+	obs_source_t *canvas_scene_ = nullptr;
+	std::mutex canvas_mutex_;
+	gs_texrender_t *canvas_texrender_ = nullptr;
+	uint64_t canvas_frame_ts_ = 0;
+	uint64_t canvas_base_ts_ = 0;
+	uint64_t canvas_frame_group_ = UINT64_MAX;
+	uint32_t canvas_fps_num_ = 30;
+	uint32_t canvas_fps_den_ = 1;
+
+	/* Prewarmed scenes (refs held, newest first), active children of
+	 * the proxy. Guarded by canvas_mutex_ for canvasEnumActive. */
+	bool prewarm_linked_ = false;
+	std::vector<obs_source_t *> warm_scenes_;
+
+	/* Private copy of the main transition; when set, the proxy draws
+	 * this and linked cuts animate through it */
+	bool follow_transition_ = false;
+	obs_source_t *transition_ = nullptr;
+
+	/* Fills in scenes whose items were deferred at load */
+	QTimer *lazy_load_timer_ = nullptr;
+	void ensureSceneLoaded(int idx);
+	void loadNextPendingScene();
 
 	void setupView();
 	void teardownView();
-	void bindActiveSceneToView();
+	void bindActiveSceneToView(bool animate = false);
+	void updateWarmScenes();
+	void setWarmScenes(const std::vector<obs_source_t *> &next);
+	void setupTransition();
+
+	/* Crop window, animated from crop_from_ to crop_to_ over
+	 * crop_pan_ms_ (guarded by canvas_mutex_). crop_mode_ and
+	 * crop_pan_ms_ are only written on the UI thread, under the
+	 * mutex, so UI-thread reads can skip it. */
+	struct CropRect {
+		float x, y, w, h;
+	};
+	bool crop_mode_ = false;
+	int crop_pan_ms_ = 400;
+	CropRect crop_from_ = {};
+	CropRect crop_to_ = {};
+	uint64_t crop_start_ns_ = 0;
+	bool crop_valid_ = false;
+
+	CropRect sceneCropRect(int idx) const;
+	void updateCropTarget(bool animate);
+	CropRect currentCropLocked(uint64_t now_ns) const;
+	void drawMainCrop(uint32_t cx, uint32_t cy);
+	void setCanvasScene(obs_source_t *scene);
+	obs_encoder_t *acquireEncoder(const recast_encoder_settings_t *settings,
+				      bool exclusive);
+
+	/* Canvas proxy source callbacks */
+	static const char *canvasGetName(void *type_data);
+	static void *canvasCreate(obs_data_t *settings, obs_source_t *source);
+	static void canvasDestroy(void *data);
+	static uint32_t canvasGetWidth(void *data);
+	static uint32_t canvasGetHeight(void *data);
+	static void canvasVideoRender(void *data, gs_effect_t *effect);
+	static void canvasEnumActive(void *data,
+				     obs_source_enum_proc_t enum_callback,
+				     void *param);
 
 	/* Frontend event handler for scene linking */
 	static void onFrontendEvent(enum obs_frontend_event event, void *data);
@@ -93,8 +243,13 @@ extern "C" {
 #endif
 
 video_t *recast_vertical_get_video(void);
-obs_encoder_t *recast_vertical_acquire_encoder(void);
-void recast_vertical_release_encoder(void);
+void recast_vertical_register_source(void);
+obs_encoder_t *recast_vertical_acquire_encoder(
+	const recast_encoder_settings_t *settings);
+void recast_vertical_release_encoder(obs_encoder_t *encoder);
+obs_encoder_t *recast_vertical_acquire_dedicated_encoder(
+	const recast_encoder_settings_t *settings);
+bool recast_vertical_set_encoder_bitrate(obs_encoder_t *encoder, int kbps);
 
 #ifdef __cplusplus
 }
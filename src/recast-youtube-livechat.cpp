@@ -0,0 +1,621 @@
+/*
+ * recast-youtube-livechat.cpp -- Shared YouTube liveChat poller.
+ *
+ * Resolves the active broadcast's liveChatId once and reads
+ * liveChat/messages (streamed, or polled as a fallback) on behalf of
+ * both the chat and events providers.
+ */
+
+#include "recast-youtube-livechat.h"
+#include "recast-network.h"
+#include "recast-perf.h"
+#include "recast-auth.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QUrl>
+#include <QUrlQuery>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+static const int MIN_POLL_INTERVAL_MS = 1000;
+static const int RETRY_ERROR_MS = 5000;
+static const int RETRY_NO_BROADCAST_MS = 15000;
+static const int STREAM_RESTART_MS = 1000;
+static const int STREAM_IDLE_MS = 90000; /* no bytes: reopen the stream */
+
+/* ====================================================================
+ * RecastJsonObjectSplitter
+ * ==================================================================== */
+
+QList<QByteArray> RecastJsonObjectSplitter::feed(const QByteArray &chunk)
+{
+	QList<QByteArray> out;
+	buf_.append(chunk);
+
+	const char *data = buf_.constData();
+	qsizetype size = buf_.size();
+
+	for (qsizetype i = scan_; i < size; i++) {
+		char c = data[i];
+
+		if (depth_ == 0) {
+			/* Between objects: skip separators */
+			if (c == '{') {
+				start_ = i;
+				depth_ = 1;
+			}
+			continue;
+		}
+
+		if (in_string_) {
+			if (escape_)
+				escape_ = false;
+			else if (c == '\\')
+				escape_ = true;
+			else if (c == '"')
+				in_string_ = false;
+			continue;
+		}
+
+		if (c == '"') {
+			in_string_ = true;
+		} else if (c == '{' || c == '[') {
+			depth_++;
+		} else if (c == '}' || c == ']') {
+			if (--depth_ == 0) {
+				out.append(buf_.mid(start_, i - start_ + 1));
+				start_ = -1;
+			}
+		}
+	}
+
+	/* Keep only the unfinished object, if any */
+	if (depth_ == 0) {
+		buf_.clear();
+		scan_ = 0;
+	} else {
+		buf_.remove(0, start_);
+		scan_ = buf_.size();
+		start_ = 0;
+	}
+	return out;
+}
+
+void RecastJsonObjectSplitter::reset()
+{
+	buf_.clear();
+	scan_ = 0;
+	start_ = -1;
+	depth_ = 0;
+	in_string_ = false;
+	escape_ = false;
+}
+
+/* ====================================================================
+ * RecastYouTubeLiveChat
+ * ==================================================================== */
+
+RecastYouTubeLiveChat *RecastYouTubeLiveChat::instance_ = nullptr;
+QMutex RecastYouTubeLiveChat::instance_mutex_;
+
+RecastYouTubeLiveChat::RecastYouTubeLiveChat(QObject *parent)
+	: QObject(parent)
+{
+	/* Re-armed after every response with the server's interval, so
+	 * requests never overlap. */
+	poll_timer_ = new QTimer(this);
+	poll_timer_->setSingleShot(true);
+	connect(poll_timer_, &QTimer::timeout, this,
+		&RecastYouTubeLiveChat::nextRequest);
+
+	reconnect_timer_ = new QTimer(this);
+	reconnect_timer_->setSingleShot(true);
+	connect(reconnect_timer_, &QTimer::timeout, this,
+		&RecastYouTubeLiveChat::fetchLiveChatId);
+}
+
+RecastYouTubeLiveChat::~RecastYouTubeLiveChat()
+{
+	stop();
+}
+
+RecastYouTubeLiveChat *RecastYouTubeLiveChat::instance()
+{
+	QMutexLocker lock(&instance_mutex_);
+	if (!instance_)
+		instance_ = new RecastYouTubeLiveChat();
+	return instance_;
+}
+
+void RecastYouTubeLiveChat::destroyInstance()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+/* ---- Subscribers ---- */
+
+void RecastYouTubeLiveChat::subscribe(QObject *subscriber)
+{
+	if (!subscriber || subscribers_.contains(subscriber))
+		return;
+
+	subscribers_.insert(subscriber);
+	connect(subscriber, &QObject::destroyed, this,
+		[this](QObject *obj) { unsubscribe(obj); });
+
+	if (subscribers_.size() == 1)
+		start();
+}
+
+void RecastYouTubeLiveChat::unsubscribe(QObject *subscriber)
+{
+	if (!subscribers_.remove(subscriber))
+		return;
+
+	QObject::disconnect(subscriber, &QObject::destroyed, this, nullptr);
+
+	if (subscribers_.isEmpty())
+		stop();
+}
+
+/* ---- Lifecycle ---- */
+
+void RecastYouTubeLiveChat::start()
+{
+	if (connected_ || reconnect_timer_->isActive() || pending_reply_)
+		return;
+
+	blog(LOG_INFO, "[Recast YouTube] Starting liveChat poller");
+	fetchLiveChatId();
+}
+
+void RecastYouTubeLiveChat::stop()
+{
+	poll_timer_->stop();
+	reconnect_timer_->stop();
+
+	abortPending();
+	dropTokenWait();
+
+	live_chat_id_.clear();
+	next_page_token_.clear();
+	streaming_ = false;
+	stream_got_data_ = false;
+	stream_splitter_.reset();
+	setConnected(false);
+}
+
+/* Drop the in-flight request without running its handlers */
+void RecastYouTubeLiveChat::abortPending()
+{
+	if (!pending_reply_)
+		return;
+
+	QNetworkReply *reply = pending_reply_;
+	pending_reply_ = nullptr;
+	QObject::disconnect(reply, nullptr, this, nullptr);
+	reply->abort();
+	reply->deleteLater();
+}
+
+void RecastYouTubeLiveChat::setStreamingEnabled(bool enabled)
+{
+	if (stream_enabled_ == enabled)
+		return;
+	stream_enabled_ = enabled;
+
+	/* Leaving an open stream: switch to polling right away */
+	if (!enabled && streaming_ && pending_reply_) {
+		abortPending();
+		streaming_ = false;
+		stream_splitter_.reset();
+		poll_timer_->start(0);
+	}
+}
+
+void RecastYouTubeLiveChat::setConnected(bool connected)
+{
+	if (connected_ == connected)
+		return;
+	connected_ = connected;
+	emit connectionStateChanged(connected);
+}
+
+void RecastYouTubeLiveChat::scheduleReconnect(int delay_ms)
+{
+	poll_timer_->stop();
+	dropTokenWait();
+	live_chat_id_.clear();
+	next_page_token_.clear();
+	setConnected(false);
+
+	if (!subscribers_.isEmpty())
+		reconnect_timer_->start(delay_ms);
+}
+
+/* ---- Requests ---- */
+
+/* Requests wait here while the YouTube token is being refreshed, so
+ * they go out with the new token */
+void RecastYouTubeLiveChat::waitForToken()
+{
+	token_wait_ = true;
+	quint64 gen = token_gen_;
+	RecastAuthManager::instance()->withAccessToken(
+		QStringLiteral("youtube"), this,
+		[this, gen](const QString &token) {
+			if (gen != token_gen_)
+				return; /* stopped or reconnected meanwhile */
+			token_wait_ = false;
+			sendRequest(token);
+		});
+}
+
+void RecastYouTubeLiveChat::dropTokenWait()
+{
+	token_wait_ = false;
+	token_gen_++;
+}
+
+/* Decided when the token arrives, not when the wait began: streaming
+ * may have been turned off or have failed in between */
+void RecastYouTubeLiveChat::sendRequest(const QString &token)
+{
+	if (live_chat_id_.isEmpty())
+		requestLiveChatId(token);
+	else if (stream_enabled_ && !stream_failed_)
+		requestStream(token);
+	else
+		requestMessages(token);
+}
+
+void RecastYouTubeLiveChat::fetchLiveChatId()
+{
+	if (subscribers_.isEmpty() || pending_reply_ || token_wait_)
+		return;
+
+	waitForToken();
+}
+
+void RecastYouTubeLiveChat::requestLiveChatId(const QString &token)
+{
+	if (subscribers_.isEmpty() || pending_reply_)
+		return;
+
+	if (token.isEmpty()) {
+		blog(LOG_WARNING,
+		     "[Recast YouTube] No auth token available");
+		scheduleReconnect(RETRY_ERROR_MS);
+		return;
+	}
+
+	QUrl url(QStringLiteral(
+		"https://www.googleapis.com/youtube/v3/liveBroadcasts"));
+	QUrlQuery query;
+	query.addQueryItem(QStringLiteral("part"), QStringLiteral("snippet"));
+	query.addQueryItem(QStringLiteral("broadcastStatus"),
+			   QStringLiteral("active"));
+	query.addQueryItem(QStringLiteral("broadcastType"),
+			   QStringLiteral("all"));
+	url.setQuery(query);
+
+	QNetworkRequest req(url);
+	req.setTransferTimeout(15000);
+	req.setRawHeader("Authorization",
+			 QStringLiteral("Bearer %1").arg(token).toUtf8());
+
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
+	pending_reply_ = reply;
+
+	connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+		reply->deleteLater();
+		pending_reply_ = nullptr;
+
+		if (reply->error() != QNetworkReply::NoError) {
+			blog(LOG_WARNING,
+			     "[Recast YouTube] liveBroadcasts error: %s",
+			     reply->errorString().toUtf8().constData());
+			RecastAuthManager::instance()->handleUnauthorized(
+				QStringLiteral("youtube"), reply);
+			scheduleReconnect(RETRY_ERROR_MS);
+			return;
+		}
+
+		QJsonDocument doc =
+			QJsonDocument::fromJson(reply->readAll());
+		QJsonArray items =
+			doc.object().value(QStringLiteral("items")).toArray();
+
+		if (items.isEmpty()) {
+			blog(LOG_INFO,
+			     "[Recast YouTube] No active broadcast found, "
+			     "retrying...");
+			scheduleReconnect(RETRY_NO_BROADCAST_MS);
+			return;
+		}
+
+		live_chat_id_ = items.first()
+					.toObject()
+					.value(QStringLiteral("snippet"))
+					.toObject()
+					.value(QStringLiteral("liveChatId"))
+					.toString();
+
+		if (live_chat_id_.isEmpty()) {
+			blog(LOG_WARNING,
+			     "[Recast YouTube] liveChatId missing");
+			scheduleReconnect(RETRY_NO_BROADCAST_MS);
+			return;
+		}
+
+		blog(LOG_INFO, "[Recast YouTube] Connected, liveChatId=%s",
+		     live_chat_id_.toUtf8().constData());
+
+		next_page_token_.clear();
+		stream_failed_ = false;
+		setConnected(true);
+
+		/* First request immediately */
+		nextRequest();
+	});
+}
+
+void RecastYouTubeLiveChat::nextRequest()
+{
+	if (stream_enabled_ && !stream_failed_)
+		openStream();
+	else
+		pollMessages();
+}
+
+void RecastYouTubeLiveChat::pollMessages()
+{
+	if (live_chat_id_.isEmpty() || pending_reply_ || token_wait_)
+		return;
+
+	waitForToken();
+}
+
+void RecastYouTubeLiveChat::requestMessages(const QString &token)
+{
+	if (live_chat_id_.isEmpty() || pending_reply_)
+		return;
+
+	if (token.isEmpty()) {
+		poll_timer_->start(poll_interval_ms_);
+		return;
+	}
+
+	QUrl url(QStringLiteral(
+		"https://www.googleapis.com/youtube/v3/liveChat/messages"));
+	QUrlQuery query;
+	query.addQueryItem(QStringLiteral("liveChatId"), live_chat_id_);
+	query.addQueryItem(QStringLiteral("part"),
+			   QStringLiteral("snippet,authorDetails"));
+	if (!next_page_token_.isEmpty())
+		query.addQueryItem(QStringLiteral("pageToken"),
+				   next_page_token_);
+	url.setQuery(query);
+
+	QNetworkRequest req(url);
+	req.setTransferTimeout(15000);
+	req.setRawHeader("Authorization",
+			 QStringLiteral("Bearer %1").arg(token).toUtf8());
+
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
+	pending_reply_ = reply;
+
+	connect(reply, &QNetworkReply::finished, this,
+		[this, reply]() { handlePollReply(reply); });
+}
+
+void RecastYouTubeLiveChat::handlePollReply(QNetworkReply *reply)
+{
+	reply->deleteLater();
+	pending_reply_ = nullptr;
+
+	if (reply->error() != QNetworkReply::NoError) {
+		blog(LOG_WARNING, "[Recast YouTube] Poll error: %s",
+		     reply->errorString().toUtf8().constData());
+
+		/* 401: the next poll refreshes the token first. 403/404:
+		 * the chat ended or is no longer accessible */
+		RecastAuthManager::instance()->handleUnauthorized(
+			QStringLiteral("youtube"), reply);
+		int status = reply->attribute(
+			QNetworkRequest::HttpStatusCodeAttribute).toInt();
+		if (status == 403 || status == 404)
+			scheduleReconnect(RETRY_ERROR_MS);
+		else
+			poll_timer_->start(poll_interval_ms_);
+		return;
+	}
+
+	QJsonObject root;
+	{
+		RECAST_PERF_SCOPE(RECAST_PERF_JSON_PARSE);
+		root = QJsonDocument::fromJson(reply->readAll()).object();
+	}
+
+	if (dispatchPage(root))
+		poll_timer_->start(poll_interval_ms_);
+}
+
+/* ---- streamList transport ---- */
+
+void RecastYouTubeLiveChat::openStream()
+{
+	if (live_chat_id_.isEmpty() || pending_reply_ || token_wait_)
+		return;
+
+	waitForToken();
+}
+
+void RecastYouTubeLiveChat::requestStream(const QString &token)
+{
+	if (live_chat_id_.isEmpty() || pending_reply_)
+		return;
+
+	if (token.isEmpty()) {
+		poll_timer_->start(poll_interval_ms_);
+		return;
+	}
+
+	QUrl url(QStringLiteral(
+		"https://youtube.googleapis.com/youtube/v3/liveChat/messages/stream"));
+	QUrlQuery query;
+	query.addQueryItem(QStringLiteral("liveChatId"), live_chat_id_);
+	query.addQueryItem(QStringLiteral("part"),
+			   QStringLiteral("snippet,authorDetails"));
+	if (!next_page_token_.isEmpty())
+		query.addQueryItem(QStringLiteral("pageToken"),
+				   next_page_token_);
+	url.setQuery(query);
+
+	/* Long-lived, so no overall deadline, but Qt's transfer timeout
+	 * counts from the last byte: a stalled stream is aborted and
+	 * onStreamFinished() takes the usual restart path */
+	QNetworkRequest req(url);
+	req.setTransferTimeout(STREAM_IDLE_MS);
+	req.setRawHeader("Authorization",
+			 QStringLiteral("Bearer %1").arg(token).toUtf8());
+
+	stream_splitter_.reset();
+	stream_got_data_ = false;
+
+	QNetworkReply *reply = RecastNetwork::manager()->get(req);
+	pending_reply_ = reply;
+
+	connect(reply, &QNetworkReply::readyRead, this,
+		[this, reply]() { onStreamData(reply); });
+	connect(reply, &QNetworkReply::finished, this,
+		[this, reply]() { onStreamFinished(reply); });
+}
+
+void RecastYouTubeLiveChat::onStreamData(QNetworkReply *reply)
+{
+	int status = reply->attribute(
+		QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	if (status >= 400)
+		return; /* error body; handled in onStreamFinished */
+
+	const QList<QByteArray> objects =
+		stream_splitter_.feed(reply->readAll());
+
+	for (const QByteArray &raw : objects) {
+		QJsonDocument doc;
+		{
+			RECAST_PERF_SCOPE(RECAST_PERF_JSON_PARSE);
+			doc = QJsonDocument::fromJson(raw);
+		}
+		if (!doc.isObject())
+			continue;
+
+		if (!stream_got_data_) {
+			stream_got_data_ = true;
+			streaming_ = true;
+			blog(LOG_INFO, "[Recast YouTube] streamList connected");
+		}
+
+		if (!dispatchPage(doc.object())) {
+			/* Chat ended; close the stream so the reconnect can
+			 * look up the next broadcast. */
+			abortPending();
+			streaming_ = false;
+			stream_got_data_ = false;
+			stream_splitter_.reset();
+			return;
+		}
+	}
+}
+
+void RecastYouTubeLiveChat::onStreamFinished(QNetworkReply *reply)
+{
+	reply->deleteLater();
+	pending_reply_ = nullptr;
+
+	bool had_data = stream_got_data_;
+	streaming_ = false;
+	stream_got_data_ = false;
+	stream_splitter_.reset();
+
+	if (reply->error() != QNetworkReply::NoError)
+		blog(LOG_WARNING, "[Recast YouTube] streamList error: %s",
+		     reply->errorString().toUtf8().constData());
+
+	/* dispatchPage() may have seen the chat go offline */
+	if (live_chat_id_.isEmpty())
+		return;
+
+	/* Expired token, not a missing transport: reopen once refreshed */
+	if (RecastAuthManager::instance()->handleUnauthorized(
+		    QStringLiteral("youtube"), reply)) {
+		poll_timer_->start(STREAM_RESTART_MS);
+		return;
+	}
+
+	if (!had_data) {
+		/* Never got a response: treat streaming as unavailable and
+		 * poll until the next liveChatId lookup. */
+		blog(LOG_INFO,
+		     "[Recast YouTube] streamList unavailable, "
+		     "falling back to polling");
+		stream_failed_ = true;
+		poll_timer_->start(0);
+		return;
+	}
+
+	/* The server ends streams periodically; resume from the last
+	 * page token. */
+	poll_timer_->start(reply->error() == QNetworkReply::NoError
+				   ? 0
+				   : STREAM_RESTART_MS);
+}
+
+/* ---- Dispatch ---- */
+
+bool RecastYouTubeLiveChat::dispatchPage(const QJsonObject &root)
+{
+	QString token = root.value(QStringLiteral("nextPageToken")).toString();
+	if (!token.isEmpty())
+		next_page_token_ = token;
+
+	/* Respect the polling interval from the server */
+	int interval = root.value(QStringLiteral("pollingIntervalMillis"))
+			       .toInt(poll_interval_ms_);
+	poll_interval_ms_ = qMax(interval, MIN_POLL_INTERVAL_MS);
+
+	/* Split the page between chat text and everything else */
+	QJsonArray chat;
+	QJsonArray events;
+	const QJsonArray items = root.value(QStringLiteral("items")).toArray();
+	for (const QJsonValue &val : items) {
+		QString type = val.toObject()
+				       .value(QStringLiteral("snippet"))
+				       .toObject()
+				       .value(QStringLiteral("type"))
+				       .toString();
+		if (type == QStringLiteral("textMessageEvent"))
+			chat.append(val);
+		else
+			events.append(val);
+	}
+
+	if (!chat.isEmpty())
+		emit chatItems(chat);
+	if (!events.isEmpty())
+		emit eventItems(events);
+
+	/* offlineAt is set once the chat has ended */
+	if (root.contains(QStringLiteral("offlineAt"))) {
+		blog(LOG_INFO, "[Recast YouTube] Live chat went offline");
+		scheduleReconnect(RETRY_NO_BROADCAST_MS);
+		return false;
+	}
+	return true;
+}
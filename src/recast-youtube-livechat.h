@@ -0,0 +1,121 @@
+#pragma once
+
+#include <QObject>
+#include <QNetworkReply>
+#include <QTimer>
+#include <QJsonArray>
+#include <QMutex>
+#include <QByteArray>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+/*
+ * RecastJsonObjectSplitter -- Incremental decoder for a stream of JSON
+ * objects.
+ *
+ * Feed it response bytes as they arrive; it returns each top-level
+ * object as soon as its closing brace is seen. Anything between objects
+ * (whitespace, or the '[' ',' ']' of a streamed array) is skipped, and
+ * braces inside strings are ignored.
+ */
+class RecastJsonObjectSplitter {
+public:
+	QList<QByteArray> feed(const QByteArray &chunk);
+	void reset();
+
+private:
+	QByteArray buf_;
+	qsizetype scan_ = 0;   /* next byte of buf_ to look at */
+	qsizetype start_ = -1; /* start of the object being read */
+	int depth_ = 0;
+	bool in_string_ = false;
+	bool escape_ = false;
+};
+
+/*
+ * RecastYouTubeLiveChat -- Singleton liveChat/messages poller.
+ *
+ * YouTube delivers chat text and monetization (Super Chats, memberships,
+ * ...) through the same liveChat/messages feed. Instead of the chat and
+ * events providers each resolving the liveChatId and polling on their
+ * own timers, both subscribe here, and every page's items are split into
+ * chatItems (textMessageEvent) and eventItems (everything else).
+ *
+ * The preferred transport is liveChat/messages/stream (streamList): one
+ * long-lived request whose responses are decoded as they arrive, for
+ * sub-second latency. If streaming is unavailable the poller falls back
+ * to one liveChat/messages request per pollingIntervalMillis until the
+ * next liveChatId lookup.
+ *
+ * Runs while at least one subscriber is registered.
+ */
+class RecastYouTubeLiveChat : public QObject {
+	Q_OBJECT
+
+public:
+	static RecastYouTubeLiveChat *instance();
+	static void destroyInstance();
+
+	void subscribe(QObject *subscriber);
+	void unsubscribe(QObject *subscriber);
+
+	bool isConnected() const { return connected_; }
+	bool isStreaming() const { return streaming_; }
+	QString liveChatId() const { return live_chat_id_; }
+
+	/* Prefer the streamList transport (default on). */
+	void setStreamingEnabled(bool enabled);
+
+signals:
+	void connectionStateChanged(bool connected);
+	void chatItems(const QJsonArray &items);
+	void eventItems(const QJsonArray &items);
+
+private:
+	explicit RecastYouTubeLiveChat(QObject *parent = nullptr);
+	~RecastYouTubeLiveChat();
+
+	static RecastYouTubeLiveChat *instance_;
+	static QMutex instance_mutex_;
+
+	QTimer *poll_timer_ = nullptr;
+	QTimer *reconnect_timer_ = nullptr;
+	QNetworkReply *pending_reply_ = nullptr;
+	QSet<QObject *> subscribers_;
+	QString live_chat_id_;
+	QString next_page_token_;
+	int poll_interval_ms_ = 5000;
+	bool connected_ = false;
+	bool token_wait_ = false; /* a request waits on a token refresh */
+	quint64 token_gen_ = 0;   /* bumped to drop a stale token wait */
+
+	/* streamList transport */
+	RecastJsonObjectSplitter stream_splitter_;
+	bool stream_enabled_ = true;
+	bool stream_failed_ = false; /* fall back to polling */
+	bool streaming_ = false;
+	bool stream_got_data_ = false;
+
+	void start();
+	void stop();
+	void setConnected(bool connected);
+	void scheduleReconnect(int delay_ms);
+	void abortPending();
+
+	void waitForToken();
+	void dropTokenWait();
+	void sendRequest(const QString &token);
+
+	void fetchLiveChatId();
+	void requestLiveChatId(const QString &token);
+	void nextRequest();
+	void pollMessages();
+	void requestMessages(const QString &token);
+	void handlePollReply(QNetworkReply *reply);
+	void openStream();
+	void requestStream(const QString &token);
+	void onStreamData(QNetworkReply *reply);
+	void onStreamFinished(QNetworkReply *reply);
+	bool dispatchPage(const QJsonObject &root);
+};